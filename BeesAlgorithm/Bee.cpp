@@ -31,8 +31,8 @@ Bee::setParameters(const std::vector<double> &theParameters)
     Parameters = theParameters;
 }
 
-std::vector<double>
-Bee::getParameters()
+const std::vector<double>&
+Bee::getParameters() const
 {
     return Parameters;
 }
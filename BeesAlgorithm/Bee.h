@@ -16,7 +16,7 @@ public:
     void setFitness(const double &fitness);
     double getFitness();
     void setParameters(const std::vector<double> &theParameters);
-    std::vector<double> getParameters();
+    const std::vector<double>& getParameters() const;
 
     // Define this operator for sorting purposes.
     bool operator< (const Bee &other) const {
@@ -4,30 +4,46 @@
 
 BeesAlgorithm::BeesAlgorithm(nmfStructsQt::ModelDataStruct theBeeStruct,
                              const bool &verbose)
+    : BeesAlgorithm(nmfStructsQt::SharedModelData(theBeeStruct),verbose)
 {
-    bool isAggProd  = (theBeeStruct.CompetitionForm == "AGG-PROD");
+}
+
+BeesAlgorithm::BeesAlgorithm(const nmfStructsQt::SharedModelData& theBeeData,
+                             const bool &verbose)
+{
+    const nmfStructsQt::ModelRunSettings& theBeeStruct = theBeeData.Settings;
     int  numSpecies =  theBeeStruct.NumSpecies;
     int  numGuilds  =  theBeeStruct.NumGuilds;
-    m_BeeStruct      = theBeeStruct;
+    m_BeeData        = theBeeData;
     m_Seed           = -1;
+    m_RunSeed        =  0;
+    m_NumBeesCreated =  0;
     m_DefaultFitness =  99999;
     m_NullFitness    = -999.9;
+    m_ConvergenceGenerations = 0;
+    m_ConvergenceTolerance   = 0;
+    m_Pool                   = nullptr;
 
     std::string growthForm      = theBeeStruct.GrowthForm;
     std::string harvestForm     = theBeeStruct.HarvestForm;
     std::string competitionForm = theBeeStruct.CompetitionForm;
     std::string predationForm   = theBeeStruct.PredationForm;
 
-    m_GuildSpecies = theBeeStruct.GuildSpecies;
-    m_GuildNum     = theBeeStruct.GuildNum;
+    m_GuildSpecies = theBeeData.inputs().GuildSpecies;
+    m_GuildNum     = theBeeData.inputs().GuildNum;
+
+    // Give every guild an entry, so the objective function only reads the map
+    for (int i=0; i<numGuilds; ++i) {
+        m_GuildSpecies.insert({i,std::vector<int>()});
+    }
 
     // Get number of independent runs
     m_Scaling = theBeeStruct.ScalingAlgorithm;
     if (verbose) {
-        std::cout << "\nBeesAlgorithm: Parameters to Estimate: " << m_BeeStruct.TotalNumberParameters << std::endl;
+        std::cout << "\nBeesAlgorithm: Parameters to Estimate: " << theBeeStruct.TotalNumberParameters << std::endl;
     }
     // Make patch size a percentage of parameter space
-    m_PatchSizePct = m_BeeStruct.BeesNeighborhoodSize/100.0;
+    m_PatchSizePct = theBeeStruct.BeesNeighborhoodSize/100.0;
     if (verbose) {
         std::cout << "BeesAlgorithm: Patch Size Pct: " << m_PatchSizePct << std::endl;
         std::cout << "BeesAlgorithm: Scaling Algorithm: " << m_Scaling << std::endl;
@@ -40,7 +56,7 @@ BeesAlgorithm::BeesAlgorithm(nmfStructsQt::ModelDataStruct theBeeStruct,
     m_PredationForm   = std::make_unique<nmfPredationForm>(predationForm);
 
     // Set up default parameters ranges and neighborhood patch sizes
-    initializeParameterRangesAndPatchSizes(theBeeStruct);
+    m_IsValid = initializeParameterRangesAndPatchSizes(theBeeStruct,theBeeData.inputs());
 
     if (verbose) {
         std::cout << "BeesAlgorithm: Initialized " << m_ParameterRanges.size() << " parameter ranges" << std::endl;
@@ -52,60 +68,43 @@ BeesAlgorithm::BeesAlgorithm(nmfStructsQt::ModelDataStruct theBeeStruct,
                              competitionForm,predationForm);
     }
 
-    // Get the observed biomass
-    if (isAggProd) {
-        nmfUtils::initialize(m_ObsBiomassBySpeciesOrGuilds,
-                             theBeeStruct.ObservedBiomassByGuilds.size1(),
-                             theBeeStruct.ObservedBiomassByGuilds.size2());
-        m_ObsBiomassBySpeciesOrGuilds = theBeeStruct.ObservedBiomassByGuilds;
+std::cout << "BeesAlgorithm::BeesAlgorithm end" << std::endl;
+}
 
-    } else {
-        nmfUtils::initialize(m_ObsBiomassBySpeciesOrGuilds,
-                             theBeeStruct.ObservedBiomassBySpecies.size1(),
-                             theBeeStruct.ObservedBiomassBySpecies.size2());
-        m_ObsBiomassBySpeciesOrGuilds = theBeeStruct.ObservedBiomassBySpecies;
-    }
+BeesAlgorithm::~BeesAlgorithm()
+{
+}
 
-    nmfUtils::initialize(m_ObsBiomassByGuilds,
-                         theBeeStruct.ObservedBiomassByGuilds.size1(),
-                         theBeeStruct.ObservedBiomassByGuilds.size2());
-    m_ObsBiomassByGuilds = theBeeStruct.ObservedBiomassByGuilds;
-//nmfUtils::printMatrix("BiomassByGuild",m_ObsBiomassByGuilds,10,6);
-    if (verbose) {
-        std::cout << "BeesAlgorithm: Read Observed Biomass" << std::endl;
-    }
+void
+BeesAlgorithm::setProgressSink(ProgressSink Sink)
+{
+    m_ProgressSink = Sink;
+}
 
-    // Get the Catch
-    nmfUtils::initialize(m_Catch,
-                         theBeeStruct.Catch.size1(),
-                         theBeeStruct.Catch.size2());
-    m_Catch = theBeeStruct.Catch;
-    if (verbose) {
-        std::cout << "BeesAlgorithm: Read Catch" << std::endl;
-    }
+void
+BeesAlgorithm::setStartParameters(const std::vector<double>& StartParameters)
+{
+    m_StartParameters = StartParameters;
+}
 
-    // Get the Effort
-    nmfUtils::initialize(m_Effort,
-                         theBeeStruct.Effort.size1(),
-                         theBeeStruct.Effort.size2());
-    m_Effort = theBeeStruct.Effort;
-    if (verbose) {
-        std::cout << "BeesAlgorithm: Read Effort" << std::endl;
-    }
+void
+BeesAlgorithm::setConvergence(const int& NumGenerations,
+                              const double& Tolerance)
+{
+    m_ConvergenceGenerations = NumGenerations;
+    m_ConvergenceTolerance   = Tolerance;
+}
 
-    // Get the Exploitation
-    nmfUtils::initialize(m_Exploitation,
-                         theBeeStruct.Exploitation.size1(),
-                         theBeeStruct.Exploitation.size2());
-    m_Exploitation = theBeeStruct.Exploitation;
-    if (verbose) {
-        std::cout << "BeesAlgorithm: Read Exploitation" << std::endl;
-    }
-std::cout << "BeesAlgorithm::BeesAlgorithm end" << std::endl;
+void
+BeesAlgorithm::setWorkStealingPool(nmfWorkStealingPool* Pool)
+{
+    m_Pool = Pool;
 }
 
-BeesAlgorithm::~BeesAlgorithm()
+void
+BeesAlgorithm::setSeed(const int& Seed)
 {
+    m_Seed = Seed;
 }
 
 
@@ -225,10 +224,11 @@ BeesAlgorithm::printParameterRanges(const int& NumSpecies,
 void
 BeesAlgorithm::loadInitBiomassParameterRanges(
         std::vector<std::pair<double,double> >& parameterRanges,
-        nmfStructsQt::ModelDataStruct& dataStruct)
+        const nmfStructsQt::ModelRunSettings& settings,
+        const nmfStructsQt::ModelInputData& dataStruct)
 {
     std::pair<double,double> aPair;
-    bool isCheckedInitBiomass = nmfUtils::isEstimateParameterChecked(dataStruct,"InitBiomass");
+    bool isCheckedInitBiomass = nmfUtils::isEstimateParameterChecked(settings,"InitBiomass");
 
     // Always load initial biomass values
     for (unsigned species=0; species<dataStruct.InitBiomassMin.size(); ++species) {
@@ -246,10 +246,11 @@ BeesAlgorithm::loadInitBiomassParameterRanges(
 void
 BeesAlgorithm::loadSurveyQParameterRanges(
         std::vector<std::pair<double,double> >& parameterRanges,
-        nmfStructsQt::ModelDataStruct& dataStruct)
+        const nmfStructsQt::ModelRunSettings& settings,
+        const nmfStructsQt::ModelInputData& dataStruct)
 {
     std::pair<double,double> aPair;
-    bool isCheckedSurveyQ = nmfUtils::isEstimateParameterChecked(dataStruct,"SurveyQ");
+    bool isCheckedSurveyQ = nmfUtils::isEstimateParameterChecked(settings,"SurveyQ");
 
     // If Survey Q is not estimated, hardcode 1.0's as min and max
     for (unsigned species=0; species<dataStruct.SurveyQMin.size(); ++species) {
@@ -269,22 +270,54 @@ BeesAlgorithm::loadSurveyQParameterRanges(
  * Create the parameters based upon the initial biomass and the 4 different
  * forms: growth, catch, competition, predation.
  */
-void
+bool
 BeesAlgorithm::initializeParameterRangesAndPatchSizes(nmfStructsQt::ModelDataStruct& theBeeStruct)
+{
+    m_IsValid = initializeParameterRangesAndPatchSizes(theBeeStruct,theBeeStruct);
+
+    return m_IsValid;
+}
+
+bool
+BeesAlgorithm::isValid() const
+{
+    return m_IsValid;
+}
+
+bool
+BeesAlgorithm::initializeParameterRangesAndPatchSizes(
+        const nmfStructsQt::ModelRunSettings& theBeeStruct,
+        const nmfStructsQt::ModelInputData& theInputs)
 {
 std::cout << "*** BeesAlgorithm::initializeParameterRangesAndPatchSizes ** " << std::endl;
     std::vector<std::pair<double,double> > parameterRanges;
 
     m_ParameterRanges.clear();
     m_PatchSizes.clear();
-    loadInitBiomassParameterRanges(        parameterRanges, theBeeStruct);
-    m_GrowthForm->loadParameterRanges(     parameterRanges, theBeeStruct);
-    m_HarvestForm->loadParameterRanges(    parameterRanges, theBeeStruct);
-    m_CompetitionForm->loadParameterRanges(parameterRanges, theBeeStruct);
-    m_PredationForm->loadParameterRanges(  parameterRanges, theBeeStruct);
-    loadSurveyQParameterRanges(            parameterRanges, theBeeStruct);
+    loadInitBiomassParameterRanges(        parameterRanges, theBeeStruct, theInputs);
+    m_GrowthForm->loadParameterRanges(     parameterRanges, theBeeStruct, theInputs);
+    m_HarvestForm->loadParameterRanges(    parameterRanges, theBeeStruct, theInputs);
+    m_CompetitionForm->loadParameterRanges(parameterRanges, theBeeStruct, theInputs);
+    m_PredationForm->loadParameterRanges(  parameterRanges, theBeeStruct, theInputs);
+    loadSurveyQParameterRanges(            parameterRanges, theBeeStruct, theInputs);
     m_ParameterRanges = parameterRanges;
 
+    // The offset table only depends upon the forms and the number of species and guilds,
+    // so compute it once here rather than for every evaluation.
+    m_ParameterOffsets.load(theBeeStruct);
+    if (m_ParameterOffsets.getTotalNumberParameters() != int(m_ParameterRanges.size())) {
+        std::cout << "Error: BeesAlgorithm::initializeParameterRangesAndPatchSizes: Parameter offset table size (" <<
+                     m_ParameterOffsets.getTotalNumberParameters() << ") differs from number of parameter ranges (" <<
+                     m_ParameterRanges.size() << ")" << std::endl;
+        return false;
+    }
+    if (theBeeStruct.TotalNumberParameters != int(m_ParameterRanges.size())) {
+        std::cout << "Error: BeesAlgorithm::initializeParameterRangesAndPatchSizes: Number of parameters to estimate (" <<
+                     theBeeStruct.TotalNumberParameters << ") differs from number of parameter ranges (" <<
+                     m_ParameterRanges.size() << ")" << std::endl;
+        return false;
+    }
+
     // Calculate the patch sizes for each parameter range
     for (unsigned int i=0;i<m_ParameterRanges.size();++i) {
         if (m_ParameterRanges[i].second == m_ParameterRanges[i].first) {
@@ -294,6 +327,7 @@ std::cout << "*** BeesAlgorithm::initializeParameterRangesAndPatchSizes ** " <<
         }
     }
 
+    return true;
 }
 
 
@@ -425,7 +459,7 @@ BeesAlgorithm::extractInitBiomass(const std::vector<double>& parameters,
                                   int&                       startPos,
                                   std::vector<double>&       initBiomass)
 {
-    int numInitBiomassParameters = m_BeeStruct.InitBiomassMin.size();
+    int numInitBiomassParameters = m_BeeData.inputs().InitBiomassMin.size();
 
     for (int i=startPos; i<numInitBiomassParameters; ++i) {
         initBiomass.emplace_back(parameters[i]);
@@ -507,7 +541,7 @@ BeesAlgorithm::extractSurveyQParameters(const std::vector<double>& parameters,
                                         int&                       startPos,
                                         std::vector<double>&       surveyQ)
 {
-    int numSurveyQParameters = m_BeeStruct.SurveyQMin.size();
+    int numSurveyQParameters = m_BeeData.inputs().SurveyQMin.size();
     for (int i=startPos; i<startPos+numSurveyQParameters; ++i) {
         surveyQ.emplace_back(parameters[i]);
     }
@@ -517,7 +551,10 @@ BeesAlgorithm::extractSurveyQParameters(const std::vector<double>& parameters,
 double
 BeesAlgorithm::evaluateObjectiveFunction(const std::vector<double> &parameters)
 {
-    bool   isAggProd = (m_BeeStruct.CompetitionForm == "AGG-PROD");
+    const nmfStructsQt::ModelInputData& inputs = m_BeeData.inputs();
+    bool   isAggProd = (m_BeeData.Settings.CompetitionForm == "AGG-PROD");
+    const boost::numeric::ublas::matrix<double>& observedBiomass = (isAggProd) ?
+            inputs.ObservedBiomassByGuilds : inputs.ObservedBiomassBySpecies;
     double estBiomassVal;
     double growthTerm;
     double harvestTerm;
@@ -527,65 +564,55 @@ BeesAlgorithm::evaluateObjectiveFunction(const std::vector<double> &parameters)
     double guildK;
     double fitness=0;
     double surveyQVal;
-    int startPos=0;
     int timeMinus1;
-    int NumYears   = m_BeeStruct.RunLength+1;
-    int NumSpecies = m_BeeStruct.NumSpecies;
-    int NumGuilds  = m_BeeStruct.NumGuilds;
+    int NumYears   = m_BeeData.Settings.RunLength+1;
+    int NumSpecies = m_BeeData.Settings.NumSpecies;
+    int NumGuilds  = m_BeeData.Settings.NumGuilds;
     int guildNum;
     int NumSpeciesOrGuilds = (isAggProd) ? NumGuilds : NumSpecies;
-    std::vector<double> initBiomass;
-    std::vector<double> growthRate;
-    std::vector<double> carryingCapacity;
     std::vector<double> guildCarryingCapacity;
-    std::vector<double> exponent;
-    std::vector<double> catchabilityRate;
-    std::vector<double> surveyQ;
+    nmfVectorView initBiomass;
+    nmfVectorView growthRate;
+    nmfVectorView carryingCapacity;
+    nmfVectorView exponent;
+    nmfVectorView catchabilityRate;
+    nmfVectorView surveyQ;
+    nmfMatrixView competitionAlpha;
+    nmfMatrixView competitionBetaSpecies;
+    nmfMatrixView competitionBetaGuilds;
+    nmfMatrixView competitionBetaGuildsGuilds;
+    nmfMatrixView predation;
+    nmfMatrixView handling;
     boost::numeric::ublas::matrix<double> estBiomassSpecies;
     boost::numeric::ublas::matrix<double> estBiomassGuilds;
     boost::numeric::ublas::matrix<double> estBiomassRescaled;
     boost::numeric::ublas::matrix<double> obsBiomassBySpeciesOrGuildsRescaled;
     boost::numeric::ublas::matrix<double> obsBiomassBySpeciesOrGuilds;
-    boost::numeric::ublas::matrix<double> competitionAlpha;
-    boost::numeric::ublas::matrix<double> competitionBetaSpecies;
-    boost::numeric::ublas::matrix<double> competitionBetaGuilds;
-    boost::numeric::ublas::matrix<double> competitionBetaGuildsGuilds;
-    boost::numeric::ublas::matrix<double> predation;
-    boost::numeric::ublas::matrix<double> handling;
     nmfUtils::initialize(estBiomassSpecies,                   NumYears,           NumSpeciesOrGuilds);
     nmfUtils::initialize(estBiomassGuilds,                    NumYears,           NumGuilds);
     nmfUtils::initialize(estBiomassRescaled,                  NumYears,           NumSpeciesOrGuilds);
     nmfUtils::initialize(obsBiomassBySpeciesOrGuildsRescaled, NumYears,           NumSpeciesOrGuilds);
-    nmfUtils::initialize(competitionAlpha,                    NumSpeciesOrGuilds, NumSpeciesOrGuilds);
-    nmfUtils::initialize(competitionBetaSpecies,              NumSpecies,         NumSpecies);
-    nmfUtils::initialize(competitionBetaGuilds,               NumSpeciesOrGuilds, NumGuilds);
-    nmfUtils::initialize(competitionBetaGuildsGuilds,         NumGuilds,          NumGuilds);
-    nmfUtils::initialize(predation,                           NumSpeciesOrGuilds, NumSpeciesOrGuilds);
-    nmfUtils::initialize(handling,                            NumSpeciesOrGuilds, NumSpeciesOrGuilds);
-
-    if (isAggProd) {
-        NumSpeciesOrGuilds = NumGuilds;
-        obsBiomassBySpeciesOrGuilds = m_BeeStruct.ObservedBiomassByGuilds;
-    } else {
-        NumSpeciesOrGuilds = NumSpecies;
-        obsBiomassBySpeciesOrGuilds = m_BeeStruct.ObservedBiomassBySpecies;
+
+    obsBiomassBySpeciesOrGuilds = observedBiomass;
+
+    // Every view below must be inside the candidate
+    if (int(parameters.size()) < m_ParameterOffsets.getTotalNumberParameters()) {
+        return m_DefaultFitness;
     }
 
-//std::cout << "num params: " << parameters.size() << std::endl;
-    // Load the parameters into their respective data structures for use in the objective function.
-    extractInitBiomass(parameters,startPos,initBiomass);
-//std::cout << "start pos: " << startPos << std::endl;
-//std::cout << "num parameters: " << parameters.size() << std::endl;
-    m_GrowthForm->extractParameters(parameters,startPos,growthRate,
+    // Point views at the parameters for use in the objective function. The views read
+    // directly from the parameters vector, so nothing is copied per evaluation.
+    initBiomass = m_ParameterOffsets.vectorView(parameters,m_ParameterOffsets.InitBiomass);
+    m_GrowthForm->extractParameters(parameters,m_ParameterOffsets,growthRate,
                                     carryingCapacity,systemCarryingCapacity);
-    m_HarvestForm->extractParameters(parameters,startPos,catchabilityRate);
-    m_CompetitionForm->extractParameters(parameters,startPos,competitionAlpha,
+    m_HarvestForm->extractParameters(parameters,m_ParameterOffsets,catchabilityRate);
+    m_CompetitionForm->extractParameters(parameters,m_ParameterOffsets,competitionAlpha,
                                          competitionBetaSpecies,competitionBetaGuilds,
                                          competitionBetaGuildsGuilds);
-    m_PredationForm->extractPredationParameters(parameters,startPos,predation);
-    m_PredationForm->extractHandlingParameters(parameters,startPos,handling);
-    m_PredationForm->extractExponentParameters(parameters,startPos,exponent);
-    extractSurveyQParameters(parameters,startPos,surveyQ);
+    m_PredationForm->extractPredationParameters(parameters,m_ParameterOffsets,predation);
+    m_PredationForm->extractHandlingParameters(parameters,m_ParameterOffsets,handling);
+    m_PredationForm->extractExponentParameters(parameters,m_ParameterOffsets,exponent);
+    surveyQ = m_ParameterOffsets.vectorView(parameters,m_ParameterOffsets.SurveyQ);
 
     // Since we may be estimating SurveyQ, need to divide the Observed Biomass by the SurveyQ
     for (int species=0; species<int(obsBiomassBySpeciesOrGuilds.size2()); ++species) {
@@ -595,7 +622,6 @@ BeesAlgorithm::evaluateObjectiveFunction(const std::vector<double> &parameters)
         }
     }
 
-//std::cout << "last start pos: " << startPos << std::endl;
 
     // guildCarryingCapacity is carrying capacity for the guild the species is a member of
 
@@ -607,10 +633,12 @@ BeesAlgorithm::evaluateObjectiveFunction(const std::vector<double> &parameters)
 //std::cout << "m_GuildSpecies[i].size(): " << m_GuildSpecies[i].size() << std::endl;
 //std::cout << "carryingCapacity.size(): " << carryingCapacity.size() << std::endl;
 
-        for (unsigned j=0; j<m_GuildSpecies[i].size(); ++j) {
+        for (unsigned j=0; j<m_GuildSpecies.at(i).size(); ++j) {
 //std::cout << "m_GuildSpecies[" << i << "][" << j << "]: " << m_GuildSpecies[i][j] << std::endl;
 
-            guildK += carryingCapacity[m_GuildSpecies[i][j]];
+            if (! carryingCapacity.empty()) {
+                guildK += carryingCapacity[m_GuildSpecies.at(i)[j]];
+            }
 //std::cout << "carryingCapacity[m_GuildSpecies[i][j]]: " << carryingCapacity[m_GuildSpecies[i][j]] << std::endl;
 
             systemCarryingCapacity += guildK;
@@ -624,14 +652,14 @@ BeesAlgorithm::evaluateObjectiveFunction(const std::vector<double> &parameters)
     // Evaluate the objective function for all years and species or guilds and put
     // result in matrix
     for (int i=0; i<NumSpeciesOrGuilds; ++i) {
-        estBiomassSpecies(0,i) = m_ObsBiomassBySpeciesOrGuilds(0,i);
+        estBiomassSpecies(0,i) = observedBiomass(0,i);
     }
 
     for (int i=0; i<NumGuilds; ++i) {
-        estBiomassGuilds(0,i)  = m_ObsBiomassByGuilds(0,i); // Remember there's only initial guild biomass data.
+        estBiomassGuilds(0,i)  = inputs.ObservedBiomassByGuilds(0,i); // Remember there's only initial guild biomass data.
     }
 
-    bool isCheckedInitBiomass = nmfUtils::isEstimateParameterChecked(m_BeeStruct,"InitBiomass");
+    bool isCheckedInitBiomass = nmfUtils::isEstimateParameterChecked(m_BeeData.Settings,"InitBiomass");
 
     for (int time=1; time<NumYears; ++time) {
         timeMinus1 = time - 1;
@@ -652,7 +680,7 @@ BeesAlgorithm::evaluateObjectiveFunction(const std::vector<double> &parameters)
             growthTerm      = m_GrowthForm->evaluate(i,estBiomassVal,
                                                      growthRate,carryingCapacity);
             harvestTerm     = m_HarvestForm->evaluate(timeMinus1,i,
-                                                      m_Catch,m_Effort,m_Exploitation,
+                                                      inputs.Catch,inputs.Effort,inputs.Exploitation,
                                                       estBiomassVal,catchabilityRate);
 //std::cout << "guild cc: " << guildCarryingCapacity[guildNum] << std::endl;
 //std::cout << "system cc: " << systemCarryingCapacity << std::endl;
@@ -690,8 +718,8 @@ if (estBiomassVal < 0) {
 
             // update estBiomassGuilds for next time step
             for (int i=0; i<NumGuilds; ++i) {
-                for (unsigned j=0; j<m_GuildSpecies[i].size(); ++j) {
-                    estBiomassGuilds(time,i) += estBiomassSpecies(time,m_GuildSpecies[i][j]);
+                for (unsigned j=0; j<m_GuildSpecies.at(i).size(); ++j) {
+                    estBiomassGuilds(time,i) += estBiomassSpecies(time,m_GuildSpecies.at(i)[j]);
                 }
             }
         }
@@ -700,39 +728,39 @@ if (estBiomassVal < 0) {
     // Scale the data
     if (m_Scaling == "Min Max") {
         rescaleMinMax(estBiomassSpecies, estBiomassRescaled);
-        rescaleMinMax(m_ObsBiomassBySpeciesOrGuilds, obsBiomassBySpeciesOrGuildsRescaled);
+        rescaleMinMax(observedBiomass, obsBiomassBySpeciesOrGuildsRescaled);
     } else if (m_Scaling == "Mean") {
         rescaleMean(estBiomassSpecies, estBiomassRescaled);
-        rescaleMean(m_ObsBiomassBySpeciesOrGuilds, obsBiomassBySpeciesOrGuildsRescaled);
+        rescaleMean(observedBiomass, obsBiomassBySpeciesOrGuildsRescaled);
     } else if (m_Scaling == "Z-Score") {
         rescaleZScore(estBiomassSpecies, estBiomassRescaled);
-        rescaleZScore(m_ObsBiomassBySpeciesOrGuilds, obsBiomassBySpeciesOrGuildsRescaled);
+        rescaleZScore(observedBiomass, obsBiomassBySpeciesOrGuildsRescaled);
     } else {
 //        std::cout << "Error: No Scaling Algorithm detected. Defaulting to Min Max." << std::endl;
         rescaleMinMax(estBiomassSpecies, estBiomassRescaled);
-        rescaleMinMax(m_ObsBiomassBySpeciesOrGuilds, obsBiomassBySpeciesOrGuildsRescaled);
+        rescaleMinMax(observedBiomass, obsBiomassBySpeciesOrGuildsRescaled);
     }
 
     // Calculate fitness using the appropriate objective criterion
-    if (m_BeeStruct.ObjectiveCriterion == "Least Squares") {
+    if (m_BeeData.Settings.ObjectiveCriterion == "Least Squares") {
 
         fitness =  nmfUtilsStatistics::calculateSumOfSquares(
                     estBiomassRescaled,
                     obsBiomassBySpeciesOrGuildsRescaled);
 
-    } else if (m_BeeStruct.ObjectiveCriterion == "Model Efficiency") {
+    } else if (m_BeeData.Settings.ObjectiveCriterion == "Model Efficiency") {
 
         // Negate the MEF here since the ranges is from -inf to 1, where 1 is best.  So we negate it,
         // then minimize that, and then negate and plot the resulting value.
         fitness = -nmfUtilsStatistics::calculateModelEfficiency(
                     estBiomassRescaled,
                     obsBiomassBySpeciesOrGuildsRescaled);
-    } else if (m_BeeStruct.ObjectiveCriterion == "Maximum Likelihood") {
+    } else if (m_BeeData.Settings.ObjectiveCriterion == "Maximum Likelihood") {
         // The maximum likelihood calculations must use the unscaled data or else the
         // results will be incorrect.
         fitness =  nmfUtilsStatistics::calculateMaximumLikelihoodNoRescale(
                     estBiomassSpecies,
-                    m_ObsBiomassBySpeciesOrGuilds);
+                    observedBiomass);
     }
 
     return fitness;
@@ -740,7 +768,9 @@ if (estBiomassVal < 0) {
 
 
 std::unique_ptr<Bee>
-BeesAlgorithm::createRandomBee(bool doWhileLoop, std::string& errorMsg)
+BeesAlgorithm::createRandomBee(bool doWhileLoop,
+                               std::mt19937_64& rng,
+                               std::string& errorMsg)
 {
     bool foundAPotentialBee = false;
     bool timesUp = false;
@@ -751,16 +781,17 @@ BeesAlgorithm::createRandomBee(bool doWhileLoop, std::string& errorMsg)
     QDateTime startTime = nmfUtilsQt::getCurrentTime();
     QDateTime endTime;
     std::vector<double> NullParameters = {};
-    std::vector<double> parameters(m_BeeStruct.TotalNumberParameters,0.0);
+    std::vector<double> parameters(m_BeeData.Settings.TotalNumberParameters,0.0);
+    std::uniform_real_distribution<double> dist(0.0,1.0);
 
-//std::cout << "--> Num Parameters: " << m_BeeStruct.TotalNumberParameters << std::endl;
+//std::cout << "--> Num Parameters: " << m_BeeData.Settings.TotalNumberParameters << std::endl;
     while (! foundAPotentialBee) {
-        for (int i=0; i<m_BeeStruct.TotalNumberParameters; ++i) {
+        for (int i=0; i<m_BeeData.Settings.TotalNumberParameters; ++i) {
             minVal = m_ParameterRanges[i].first;
             maxVal = m_ParameterRanges[i].second;
 //std::cout << "--> range: " << i << "  [" << minVal << "," << maxVal << "] ";
             parameters[i] = (maxVal == minVal) ? minVal :
-                             minVal+(maxVal-minVal)*(nmfUtils::getRandomNumber(m_Seed,0.0,1.0));
+                             minVal+(maxVal-minVal)*dist(rng);
 //std::cout << "--> " << parameters[i] << std::endl;
         }
         fitness = evaluateObjectiveFunction(parameters);
@@ -783,7 +814,22 @@ BeesAlgorithm::createRandomBee(bool doWhileLoop, std::string& errorMsg)
 
 
 std::unique_ptr<Bee>
-BeesAlgorithm::createNeighborhoodBee(std::vector<double> &bestSiteParameters)
+BeesAlgorithm::createStartBee()
+{
+    std::vector<double> parameters = m_StartParameters;
+
+    for (unsigned int i=0; i<parameters.size(); ++i) {
+        parameters[i] = std::max(m_ParameterRanges[i].first,
+                                 std::min(parameters[i],m_ParameterRanges[i].second));
+    }
+
+    return std::make_unique<Bee>(evaluateObjectiveFunction(parameters),parameters);
+}
+
+
+std::unique_ptr<Bee>
+BeesAlgorithm::createNeighborhoodBee(const std::vector<double> &bestSiteParameters,
+                                     std::mt19937_64& rng)
 {
     double val;
     double fitness;
@@ -791,12 +837,13 @@ BeesAlgorithm::createNeighborhoodBee(std::vector<double> &bestSiteParameters)
     //double rval = rand()/double(RAND_MAX);
     double rval;
     std::vector<double> parameters = {};
+    std::uniform_real_distribution<double> dist(0.0,1.0);
 //std::cout << "rval: " << rval << std::endl;
     for (unsigned int i=0; i<bestSiteParameters.size(); ++i) {
         patchSize = m_PatchSizes[i];
 //std::cout << i << ", " << patchSize << std::endl;
         val = bestSiteParameters[i];
-        rval = nmfUtils::getRandomNumber(m_Seed,0.0,1.0);
+        rval = dist(rng);
         if (patchSize > 0) {
             val = (rval < 0.5) ? (val+rval*patchSize) : (val-rval*patchSize);
             // In c++17, use...
@@ -814,23 +861,75 @@ BeesAlgorithm::createNeighborhoodBee(std::vector<double> &bestSiteParameters)
 
 std::unique_ptr<Bee>
 BeesAlgorithm::searchNeighborhoodForBestBee(std::unique_ptr<Bee> bestSite,
-                                            int &neighborhoodSize)
+                                            int &neighborhoodSize,
+                                            std::mt19937_64& rng)
 {
     std::unique_ptr<Bee> bee;
     std::vector<std::unique_ptr<Bee> > neighborhoodBees;
-    std::vector<double> bestSiteParameters = bestSite->getParameters();
+    const std::vector<double>& bestSiteParameters = bestSite->getParameters();
 
     for (int i=0; i<neighborhoodSize; ++i) {
-        bee = createNeighborhoodBee(bestSiteParameters);
+        bee = createNeighborhoodBee(bestSiteParameters,rng);
         neighborhoodBees.emplace_back(std::move(bee));
     }
 
-    std::sort(neighborhoodBees.begin(),neighborhoodBees.end(),beesCompareLT());
+    // Only the best bee is needed, so there's no need to sort the whole neighborhood
+    nmfUtils::partialSortStable(neighborhoodBees,1,beesCompareLT());
 
     return std::move(neighborhoodBees.front());
 }
 
 
+void
+BeesAlgorithm::seedBee(const unsigned& BeeIndex,
+                       std::mt19937_64& rng)
+{
+    // Seeding from the pair keeps the streams of runs with adjacent seeds apart
+    std::seed_seq seeds{m_RunSeed,BeeIndex};
+    rng.seed(seeds);
+}
+
+
+void
+BeesAlgorithm::createBees(const int& NumBees,
+                          std::function<std::unique_ptr<Bee>(const int& BeeNum,
+                                                             std::mt19937_64& rng,
+                                                             std::string& errorMsg)> CreateBee,
+                          std::vector<std::unique_ptr<Bee> >& Bees,
+                          std::string& errorMsg)
+{
+    std::mutex errorMutex;
+    unsigned firstBee = m_NumBeesCreated;
+
+    Bees.clear();
+    Bees.resize(std::max(NumBees,0));
+    m_NumBeesCreated += unsigned(Bees.size());
+    if (m_Pool == nullptr) {
+        std::mt19937_64 rng;
+        for (int i=0; i<NumBees; ++i) {
+            seedBee(firstBee+unsigned(i),rng);
+            Bees[i] = CreateBee(i,rng,errorMsg);
+        }
+        return;
+    }
+
+    // Each bee only writes its own slot and draws from its own engine, so the population
+    // is the same as above
+    m_Pool->parallelFor(0,NumBees,0,[&](int Begin, int End) {
+        std::mt19937_64 rng;
+        std::string chunkErrorMsg;
+        for (int i=Begin; i<End; ++i) {
+            seedBee(firstBee+unsigned(i),rng);
+            Bees[i] = CreateBee(i,rng,chunkErrorMsg);
+        }
+        if (! chunkErrorMsg.empty()) {
+            std::lock_guard<std::mutex> lock(errorMutex);
+            errorMsg = chunkErrorMsg;
+        }
+    });
+}
+
+
 std::unique_ptr<Bee>
 BeesAlgorithm::searchParameterSpaceForBestBee(int &RunNum,
                                               int& subRunNum,
@@ -838,16 +937,15 @@ BeesAlgorithm::searchParameterSpaceForBestBee(int &RunNum,
 {
     bool done = false;
     int currentGeneration=0;
-    int neighborhoodSize;
     int genNum;
     int numScoutBees;
-    int numParameters  = m_BeeStruct.TotalNumberParameters;
-    int numTotalBees   = m_BeeStruct.BeesNumTotal;
-    int numEliteBees   = m_BeeStruct.BeesNumElite;
-    int numOtherBees   = m_BeeStruct.BeesNumOther;
-    int numBestSites   = m_BeeStruct.BeesNumBestSites;
-    int numEliteSites  = m_BeeStruct.BeesNumEliteSites;
-    int maxGenerations = m_BeeStruct.BeesMaxGenerations;
+    int numParameters  = m_BeeData.Settings.TotalNumberParameters;
+    int numTotalBees   = m_BeeData.Settings.BeesNumTotal;
+    int numEliteBees   = m_BeeData.Settings.BeesNumElite;
+    int numOtherBees   = m_BeeData.Settings.BeesNumOther;
+    int numBestSites   = m_BeeData.Settings.BeesNumBestSites;
+    int numEliteSites  = m_BeeData.Settings.BeesNumEliteSites;
+    int maxGenerations = m_BeeData.Settings.BeesMaxGenerations;
     std::unique_ptr<Bee> bestBee;
     std::vector<std::unique_ptr<Bee> > totalBeePopulation;
     std::vector<std::unique_ptr<Bee> > nextGenerationBees;
@@ -858,27 +956,35 @@ BeesAlgorithm::searchParameterSpaceForBestBee(int &RunNum,
     double bestFitness;
     double bestFitnessInPopulation;
     double bestBeesFitness;
-    int unused;
+    double lastImprovedFitness = m_DefaultFitness;
+    int numGensSinceBestFit = 0;
+    bool isWarmStart = (int(m_StartParameters.size()) == numParameters);
+    std::mt19937_64 rng;
+
+    m_RunSeed = (m_Seed < 0) ? unsigned(nmfUtilsQt::getCurrentTime().currentMSecsSinceEpoch()) :
+                               unsigned(m_Seed);
+    m_NumBeesCreated = 1;
+    seedBee(0,rng);
 
 std::cout << "Searching parameter space for initial bees..." << std::endl;
 
-    theBestBee = createRandomBee(false,errorMsg);
+    theBestBee = (isWarmStart) ? createStartBee() : createRandomBee(false,rng,errorMsg);
 std::cout << "Found a bee" << std::endl;
 
     if (theBestBee->getFitness() == m_NullFitness) {
         return theBestBee;
     }
-    for (int i=0; i<numTotalBees; ++i) {
-std::cout << "Creating bee: " << i << std::endl;
-        totalBeePopulation.emplace_back(createRandomBee(false,errorMsg));
-    }
+    createBees(numTotalBees,[&](const int& i, std::mt19937_64& beeRng, std::string& beeErrorMsg) {
+        return (isWarmStart && (i == 0)) ? createStartBee() : createRandomBee(false,beeRng,beeErrorMsg);
+    },totalBeePopulation,errorMsg);
 std::cout << "Found initial bees." << std::endl;
 
     while (! done) {
 
-        std::sort(totalBeePopulation.begin(),
-                  totalBeePopulation.end(),
-                  beesCompareLT());
+        // Only the best numBestSites bees are needed (in order), so just select those
+        nmfUtils::partialSortStable(totalBeePopulation,
+                                    numBestSites,
+                                    beesCompareLT());
 
         bestFitnessInPopulation = totalBeePopulation[0]->getFitness();
         bestBeesFitness         = theBestBee->getFitness();
@@ -898,21 +1004,17 @@ std::cout << "Found initial bees." << std::endl;
 
         // For each best bee, calculate the neighborhood size in terms of bees,
         // find those bees in each neighborhood and add only the best one to next_gen
-        nextGenerationBees.clear();
-        for (int i=0; i<numBestSites; ++i) {
-            neighborhoodSize = (i < numEliteSites) ? numEliteBees : numOtherBees;
-            nextGenerationBees.emplace_back(searchNeighborhoodForBestBee(std::move(bestSites[i]),
-                                                                         neighborhoodSize));
-        }
+        createBees(numBestSites,[&](const int& i, std::mt19937_64& beeRng, std::string&) {
+            int neighborhoodSize = (i < numEliteSites) ? numEliteBees : numOtherBees;
+            return searchNeighborhoodForBestBee(std::move(bestSites[i]),neighborhoodSize,beeRng);
+        },nextGenerationBees,errorMsg);
 
         // Now find the rest of the bees that make up the total number of bees as we'll
         // use them for new scouts.
         numScoutBees = numTotalBees - numBestSites;
-        scoutBees.clear();
-        for (int i=0; i<numScoutBees; ++i) {
-            scoutBees.emplace_back(createRandomBee(false,errorMsg));
-//std::cout << "scout bee: " << i << ": " << scoutBees[i]->getFitness() << std::endl;
-        }
+        createBees(numScoutBees,[&](const int&, std::mt19937_64& beeRng, std::string& beeErrorMsg) {
+            return createRandomBee(false,beeRng,beeErrorMsg);
+        },scoutBees,errorMsg);
 
         totalBeePopulation.clear();
         for (int i=0; i<numBestSites; ++i) {
@@ -937,12 +1039,22 @@ std::cout << "Found initial bees." << std::endl;
                     "-"    + std::to_string(subRunNum);
         bestFitness = theBestBee->getFitness();
 
-        unused = 0;
+        // Also done once the best fitness hasn't improved for the convergence generations
+        if (lastImprovedFitness-bestFitness > m_ConvergenceTolerance*std::fabs(lastImprovedFitness)) {
+            lastImprovedFitness = bestFitness;
+            numGensSinceBestFit = 0;
+        } else {
+            ++numGensSinceBestFit;
+        }
+        if ((m_ConvergenceGenerations > 0) && (numGensSinceBestFit >= m_ConvergenceGenerations)) {
+            done = true;
+        }
+
         genNum = currentGeneration - 1;
         WriteCurrentLoopFile(MSSPMName,
                      genNum,
                      bestFitness,
-                     unused);
+                     numGensSinceBestFit);
 
         if (StoppedByUser()) {
             std::cout << "BeesAlgorithm StoppedByUser" << std::endl;
@@ -954,7 +1066,7 @@ std::cout << "Found initial bees." << std::endl;
     WriteCurrentLoopFile(MSSPMName,
                  genNum,
                  bestFitness,
-                 unused);
+                 numGensSinceBestFit);
     return std::move(theBestBee);
 }
 
@@ -988,8 +1100,6 @@ BeesAlgorithm::WriteCurrentLoopFile(std::string &MSSPMName,
                                    int         &NumGensSinceBestFit)
 {
     double adjustedBestFitness; // May need negating if ObjCrit is Model Efficiency
-    std::ofstream outputFile(nmfConstantsMSSPM::MSSPMProgressChartFile,
-                             std::ios::out|std::ios::app);
 
     adjustedBestFitness = BestFitness;
     //
@@ -999,10 +1109,18 @@ BeesAlgorithm::WriteCurrentLoopFile(std::string &MSSPMName,
     // Now, I just need to negate the fitness again so the plot will
     // show the fitness approaching +1.
     //
-    if (m_BeeStruct.ObjectiveCriterion == "Model Efficiency") {
+    if (m_BeeData.Settings.ObjectiveCriterion == "Model Efficiency") {
         adjustedBestFitness = -adjustedBestFitness;
     }
 
+    // Without a progress chart (e.g., in the headless batch tool) the progress goes to the sink
+    if (m_ProgressSink) {
+        m_ProgressSink(MSSPMName,NumGens,adjustedBestFitness);
+        return;
+    }
+
+    std::ofstream outputFile(nmfConstantsMSSPM::MSSPMProgressChartFile,
+                             std::ios::out|std::ios::app);
     outputFile << MSSPMName   << ", "
                << NumGens     << ", "
                << adjustedBestFitness << ", "
@@ -1051,6 +1169,11 @@ BeesAlgorithm::estimateParameters(double &bestFitness,
     m_DefaultFitness =  99999;
     m_NullFitness    = -999.9;
 
+    if (! m_IsValid) {
+        errorMsg = "The parameter layout doesn't match the parameter ranges for the selected forms";
+        return false;
+    }
+
     bestBee = searchParameterSpaceForBestBee(RunNum,subRunNum,errorMsg);
 
     if (bestBee->getFitness() != m_NullFitness) {
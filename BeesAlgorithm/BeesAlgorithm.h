@@ -1,5 +1,7 @@
 #pragma once
 
+#include <random>
+
 #include "Bee.h"
 #include "nmfUtils.h"
 #include "nmfUtilsStatistics.h"
@@ -9,7 +11,8 @@
 #include "nmfCompetitionForm.h"
 #include "nmfPredationForm.h"
 
-#include "nmfUtilsQt.h"
+#include "nmfUtilsQtCore.h"
+#include "nmfWorkStealingPool.h"
 
 typedef boost::numeric::ublas::matrix<double> Matrix;
 
@@ -34,31 +37,54 @@ struct beesCompareGT
 class BeesAlgorithm
 {
 
+public:
+    /**
+     * @brief Receives the run name (e.g., "Run 1-1"), the generation, and the best fitness
+     * at the end of each generation
+     */
+    typedef std::function<void(const std::string& RunName,
+                               const int& Generation,
+                               const double& BestFitness)> ProgressSink;
+
     const int kTimeToSpendSearching = 30; //3; // time to look for a bee in microseconds
 
 private:
     int                                    m_Seed;
+    unsigned                               m_RunSeed;        // m_Seed, or the clock if m_Seed < 0
+    unsigned                               m_NumBeesCreated; // bees given an engine so far this run
     int                                    m_DefaultFitness;
     int                                    m_NullFitness;
     double                                 m_PatchSizePct;
     std::string                            m_Scaling;
-    boost::numeric::ublas::matrix<double>  m_ObsBiomassBySpeciesOrGuilds;
-    boost::numeric::ublas::matrix<double>  m_ObsBiomassByGuilds;
-    boost::numeric::ublas::matrix<double>  m_Catch;
-    boost::numeric::ublas::matrix<double>  m_Effort;
-    boost::numeric::ublas::matrix<double>  m_Exploitation;
     std::vector<std::pair<double,double> > m_ParameterRanges;
     std::vector<double>                    m_PatchSizes;
-    nmfStructsQt::ModelDataStruct              m_BeeStruct;
+    nmfParameterOffsets                    m_ParameterOffsets;
+    bool                                   m_IsValid;
+    nmfStructsQt::SharedModelData          m_BeeData;
     std::unique_ptr<nmfGrowthForm>         m_GrowthForm;
     std::unique_ptr<nmfHarvestForm>        m_HarvestForm;
     std::unique_ptr<nmfCompetitionForm>    m_CompetitionForm;
     std::unique_ptr<nmfPredationForm>      m_PredationForm;
     std::map<int,std::vector<int> >        m_GuildSpecies;
     std::vector<int>                       m_GuildNum;
+    ProgressSink                           m_ProgressSink;
+    std::vector<double>                    m_StartParameters;
+    int                                    m_ConvergenceGenerations;
+    double                                 m_ConvergenceTolerance;
+    nmfWorkStealingPool*                   m_Pool;
 
     std::unique_ptr<Bee> createRandomBee(bool doWhileLoop,
+                                         std::mt19937_64& rng,
                                          std::string& errorMsg);
+    std::unique_ptr<Bee> createStartBee();
+    void seedBee(const unsigned& BeeIndex,
+                 std::mt19937_64& rng);
+    void createBees(const int& NumBees,
+                    std::function<std::unique_ptr<Bee>(const int& BeeNum,
+                                                       std::mt19937_64& rng,
+                                                       std::string& errorMsg)> CreateBee,
+                    std::vector<std::unique_ptr<Bee> >& Bees,
+                    std::string& errorMsg);
     std::unique_ptr<Bee> searchParameterSpaceForBestBee(int& RunNum,
                                                         int& subRunNum,
                                                         std::string& errorMsg);
@@ -69,8 +95,10 @@ private:
     void rescaleZScore(const boost::numeric::ublas::matrix<double> &matrix,
                              boost::numeric::ublas::matrix<double> &rescaledMatrix);
     std::unique_ptr<Bee> searchNeighborhoodForBestBee(std::unique_ptr<Bee> bestSite,
-                                                      int &neighborhoodSize);
-    std::unique_ptr<Bee> createNeighborhoodBee(std::vector<double> &bestSiteParameters);
+                                                      int &neighborhoodSize,
+                                                      std::mt19937_64& rng);
+    std::unique_ptr<Bee> createNeighborhoodBee(const std::vector<double> &bestSiteParameters,
+                                               std::mt19937_64& rng);
     void printBee(double &fitness, std::vector<double> &parameters);
     void WriteCurrentLoopFile(std::string &MSSPMName,
                               int         &NumGens,
@@ -87,17 +115,81 @@ private:
                           double& bestBeesFitness);
     void loadInitBiomassParameterRanges(
             std::vector<std::pair<double,double> >& parameterRanges,
-            nmfStructsQt::ModelDataStruct& dataStruct);
+            const nmfStructsQt::ModelRunSettings& settings,
+            const nmfStructsQt::ModelInputData& dataStruct);
     void loadSurveyQParameterRanges(
             std::vector<std::pair<double,double> >& parameterRanges,
-            nmfStructsQt::ModelDataStruct& dataStruct);
+            const nmfStructsQt::ModelRunSettings& settings,
+            const nmfStructsQt::ModelInputData& dataStruct);
+    bool initializeParameterRangesAndPatchSizes(
+            const nmfStructsQt::ModelRunSettings& settings,
+            const nmfStructsQt::ModelInputData& inputs);
 
 public:
     BeesAlgorithm(nmfStructsQt::ModelDataStruct BeeStruct,
                   const bool &verbose);
+    /**
+     * @brief Sets up an estimation that reads the model's input data from the shared
+     * block instead of copying it, so that concurrent runs of a multi-run line keep only
+     * one copy of the inputs between them
+     * @param BeeData : the run's settings and the shared input data
+     * @param verbose : print the set up to the console
+     */
+    BeesAlgorithm(const nmfStructsQt::SharedModelData& BeeData,
+                  const bool &verbose);
    ~BeesAlgorithm();
 
-    void initializeParameterRangesAndPatchSizes(nmfStructsQt::ModelDataStruct& theBeeStruct);
+    /**
+     * @brief Sends the progress of each generation to the sink instead of appending it
+     * to the progress chart file, e.g. to print it or keep it in memory
+     * @param Sink : function to receive the progress (an empty function restores the file)
+     */
+    void setProgressSink(ProgressSink Sink);
+    /**
+     * @brief Starts the search from a known parameter set (e.g., an earlier estimate) instead
+     * of only from random bees. The start parameters are the first best bee and one bee of the
+     * initial population, the rest of which is random.
+     * @param StartParameters : parameters in nmfParameterOffsets order, clamped to the parameter
+     * ranges (ignored unless there's one per parameter, an empty vector turns it off)
+     */
+    void setStartParameters(const std::vector<double>& StartParameters);
+    /**
+     * @brief Stops the search before the maximum number of generations once the best fitness
+     * has stopped improving
+     * @param NumGenerations : generations without improvement after which to stop (0 turns it off)
+     * @param Tolerance : smallest relative decrease of the best fitness that counts as an improvement
+     */
+    void setConvergence(const int& NumGenerations,
+                        const double& Tolerance);
+    /**
+     * @brief Splits the bees of each generation (the initial population, the neighborhood
+     * searches of the best sites, and the scouts) over a pool's threads. The estimation may
+     * itself be running as one of the pool's tasks.
+     * @param Pool : pool to use, which must outlive the estimation (nullptr runs every bee
+     * on the calling thread)
+     */
+    void setWorkStealingPool(nmfWorkStealingPool* Pool);
+    /**
+     * @brief Seeds the search. Every bee draws from its own engine, seeded from the seed and
+     * the bee's index in the run, so an estimate only depends upon the seed and not upon
+     * the number of threads.
+     * @param Seed : seed of the search (if < 0, the clock is read once per estimation)
+     */
+    void setSeed(const int& Seed);
+
+    /**
+     * @brief Loads the parameter ranges and patch sizes and the parameter offset table
+     * @param theBeeStruct : the model data
+     * @return False if the offset table or the number of parameters to estimate doesn't
+     * match the parameter ranges (e.g., for an unexpected combination of forms), else True
+     */
+    bool initializeParameterRangesAndPatchSizes(nmfStructsQt::ModelDataStruct& theBeeStruct);
+    /**
+     * @brief Checks that the constructor could lay out the parameters. estimateParameters
+     * fails with an error message for an estimator that isn't valid.
+     * @return True if the parameter layout matches the parameter ranges, else False
+     */
+    bool isValid() const;
     int calculateActualNumEstParameters();
     bool estimateParameters(double &bestFitness,
                             std::vector<double> &bestParameters,
@@ -0,0 +1,79 @@
+#include "nmfBeesEstimators.h"
+
+nmfRetrospective::Estimator
+nmfBeesEstimators::retrospective(BeesAlgorithm::ProgressSink Sink)
+{
+    return [Sink](const nmfStructsQt::ModelDataStruct& PeelData,
+                  nmfRetrospectivePeel& Peel) {
+        int runNum    = Peel.Peel+1;
+        int subRunNum = 1;
+        double fitness;
+        std::string errorMsg;
+        nmfStructsQt::SharedModelData SharedPeelData(PeelData); // shared by the estimation and the fit
+
+        BeesAlgorithm Bees(SharedPeelData,false);
+        Bees.setProgressSink((Sink) ? Sink : [](const std::string&, const int&, const double&) {});
+        if (! Bees.estimateParameters(fitness,Peel.Parameters,runNum,subRunNum,errorMsg)) {
+            std::cout << "Error nmfBeesEstimators: Peel " << Peel.Peel <<
+                         " failed: " << errorMsg << std::endl;
+            return false;
+        }
+
+        return nmfBootstrap::fitBiomass(SharedPeelData,Peel.Parameters,Peel.EstBiomass);
+    };
+}
+
+nmfBootstrap::Estimator
+nmfBeesEstimators::bootstrap(const int& ConvergenceGenerations,
+                             const double& ConvergenceTolerance,
+                             BeesAlgorithm::ProgressSink Sink)
+{
+    return [ConvergenceGenerations,ConvergenceTolerance,Sink](
+            const nmfStructsQt::SharedModelData& ReplicateData,
+            const int& ReplicateNum,
+            const std::vector<double>& StartParameters,
+            std::vector<double>& Parameters) {
+        int runNum    = 1;
+        int subRunNum = ReplicateNum+1;
+        double fitness;
+        std::string errorMsg;
+
+        BeesAlgorithm Bees(ReplicateData,false);
+        Bees.setProgressSink((Sink) ? Sink : [](const std::string&, const int&, const double&) {});
+        Bees.setStartParameters(StartParameters);
+        Bees.setConvergence(ConvergenceGenerations,ConvergenceTolerance);
+        if (! Bees.estimateParameters(fitness,Parameters,runNum,subRunNum,errorMsg)) {
+            std::cout << "Error nmfBeesEstimators: Replicate " << ReplicateNum <<
+                         " failed: " << errorMsg << std::endl;
+            return false;
+        }
+
+        return true;
+    };
+}
+
+nmfFormSelection::Estimator
+nmfBeesEstimators::formSelection(BeesAlgorithm::ProgressSink Sink)
+{
+    return [Sink](const nmfStructsQt::SharedModelData& FormData,
+                  const std::vector<double>& StartParameters,
+                  std::vector<double>& Parameters,
+                  boost::numeric::ublas::matrix<double>& EstBiomass) {
+        int runNum    = 1;
+        int subRunNum = 1;
+        double fitness;
+        std::string errorMsg;
+
+        BeesAlgorithm Bees(FormData,false);
+        Bees.setProgressSink((Sink) ? Sink : [](const std::string&, const int&, const double&) {});
+        Bees.setStartParameters(StartParameters);
+        if (! Bees.estimateParameters(fitness,Parameters,runNum,subRunNum,errorMsg)) {
+            std::cout << "Error nmfBeesEstimators: " << FormData.Settings.GrowthForm << "/" <<
+                         FormData.Settings.HarvestForm << "/" << FormData.Settings.CompetitionForm << "/" <<
+                         FormData.Settings.PredationForm << " failed: " << errorMsg << std::endl;
+            return false;
+        }
+
+        return nmfBootstrap::fitBiomass(FormData,Parameters,EstBiomass);
+    };
+}
@@ -0,0 +1,61 @@
+/**
+ * @file nmfBeesEstimators.h
+ * @brief Definition for the Bees Algorithm estimators of the MSSPM analyses
+ * @date Oct 19, 2026
+ *
+ * The retrospective, bootstrap, and form selection analyses take the estimation as a
+ * callback so that any of the MSSPM estimators can be used. These are the default
+ * callbacks, built on the Bees Algorithm, the one estimator in the shared utilities.
+ *
+ */
+
+#pragma once
+
+#include "BeesAlgorithm.h"
+#include "nmfBootstrap.h"
+#include "nmfFormSelection.h"
+#include "nmfRetrospective.h"
+
+/**
+ * @brief Makes Bees Algorithm estimation callbacks for the MSSPM analyses. Each call of a
+ * callback sets up its own BeesAlgorithm, so a callback can be run on several threads at
+ * once. The estimations' progress goes to the passed sink. An empty sink drops it, since
+ * concurrent estimations would otherwise all append to the one progress chart file.
+ */
+class nmfBeesEstimators {
+
+public:
+    /**
+     * @brief Estimator for nmfRetrospective. Each peel is estimated from its own model data
+     * and its biomass is the projection of the estimated parameters over the peel's years.
+     * @param Sink : receives the progress of each peel's estimation (run "Run <Peel+1>-1")
+     * @return The estimator
+     */
+    static nmfRetrospective::Estimator retrospective(
+            BeesAlgorithm::ProgressSink Sink = BeesAlgorithm::ProgressSink());
+    /**
+     * @brief Estimator for nmfBootstrap. Each replicate's search starts at the point estimate
+     * and stops once its best fitness no longer improves. The replicate's BeesAlgorithm
+     * shares the replicate data instead of copying it. The Bees Algorithm isn't given a
+     * seed and reads the clock, so the estimates don't only depend upon the bootstrap seed.
+     * @param ConvergenceGenerations : generations without improvement after which a replicate
+     * stops (0 runs the model's BeesMaxGenerations)
+     * @param ConvergenceTolerance : smallest relative decrease of the fitness that counts as
+     * an improvement
+     * @param Sink : receives the progress of each replicate's estimation (run "Run 1-<Replicate+1>")
+     * @return The estimator
+     */
+    static nmfBootstrap::Estimator bootstrap(
+            const int& ConvergenceGenerations,
+            const double& ConvergenceTolerance,
+            BeesAlgorithm::ProgressSink Sink = BeesAlgorithm::ProgressSink());
+    /**
+     * @brief Estimator for nmfFormSelection. Each combination is estimated with its forms and
+     * generation limit, starting from its first pass estimate if it has one, and its biomass
+     * is the projection of the estimated parameters over the model's years.
+     * @param Sink : receives the progress of each combination's estimation (run "Run 1-1")
+     * @return The estimator
+     */
+    static nmfFormSelection::Estimator formSelection(
+            BeesAlgorithm::ProgressSink Sink = BeesAlgorithm::ProgressSink());
+};
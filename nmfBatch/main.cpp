@@ -0,0 +1,88 @@
+/**
+ * @file main.cpp
+ * @brief Command line tool that runs multi-run estimation batches without the GUI
+ * @date Oct 19, 2026
+ *
+ * Usage: nmfBatch --model ModelData.txt --multirun MultiRunSetup.csv --output Estimates.csv
+ *                 [--threads N] [--seed N] [--progress]
+ *
+ * The exit code is one of nmfBatchDriver::ExitCode.
+ *
+ * Built by nmfBatch.pro with NMF_HEADLESS defined and QT = core sql from this directory,
+ * BeesAlgorithm, nmfModels (the form, parameter view, and multi-run scheduler files), and
+ * nmfUtilities (nmfUtils, nmfUtilsQtCore, nmfUtilsStatistics, nmfUtilsComplex, nmfLogger,
+ * and nmfWorkStealingPool).
+ *
+ */
+
+#include <QCoreApplication>
+#include <QCommandLineParser>
+
+#include "nmfBatchDriver.h"
+
+int main(int argc, char *argv[])
+{
+    bool ok;
+    nmfBatchOptions Options;
+    QCoreApplication app(argc, argv);
+    QCoreApplication::setApplicationName("nmfBatch");
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("Runs the estimations of an MSSPM multi-run setup file without the GUI.");
+    QCommandLineOption helpOption = parser.addHelpOption();
+    QCommandLineOption modelOption({"m","model"},
+            "Model data file, as saved by nmfUtilsQt::saveModelData.","file");
+    QCommandLineOption multiRunOption({"r","multirun"},
+            "Multi-run setup file, one estimation setup per line after the header.","file");
+    QCommandLineOption outputOption({"o","output"},
+            "Output csv file of the estimates, one row per run.","file");
+    QCommandLineOption threadsOption({"t","threads"},
+            "Number of threads (default: one per core).","num","0");
+    QCommandLineOption seedOption({"s","seed"},
+            "Seed of the searches, to reproduce a batch (default: from the clock).","num");
+    QCommandLineOption progressOption({"p","progress"},
+            "Print the best fitness of every generation.");
+    parser.addOption(modelOption);
+    parser.addOption(multiRunOption);
+    parser.addOption(outputOption);
+    parser.addOption(threadsOption);
+    parser.addOption(seedOption);
+    parser.addOption(progressOption);
+
+    if (! parser.parse(app.arguments())) {
+        std::cout << "Error nmfBatch: " << parser.errorText().toStdString() << std::endl;
+        return nmfBatchDriver::UsageError;
+    }
+    if (parser.isSet(helpOption)) {
+        std::cout << parser.helpText().toStdString();
+        return nmfBatchDriver::Success;
+    }
+    if (! parser.isSet(modelOption) || ! parser.isSet(multiRunOption) || ! parser.isSet(outputOption)) {
+        std::cout << "Error nmfBatch: --model, --multirun, and --output are required\n\n" <<
+                     parser.helpText().toStdString();
+        return nmfBatchDriver::UsageError;
+    }
+
+    Options.ModelFilename    = parser.value(modelOption).toStdString();
+    Options.MultiRunFilename = parser.value(multiRunOption).toStdString();
+    Options.OutputFilename   = parser.value(outputOption).toStdString();
+    Options.ShowProgress     = parser.isSet(progressOption);
+    Options.NumThreads       = parser.value(threadsOption).toInt(&ok);
+    if (! ok || (Options.NumThreads < 0)) {
+        std::cout << "Error nmfBatch: Invalid number of threads: " <<
+                     parser.value(threadsOption).toStdString() << std::endl;
+        return nmfBatchDriver::UsageError;
+    }
+    if (parser.isSet(seedOption)) {
+        Options.Seed = parser.value(seedOption).toInt(&ok);
+        if (! ok || (Options.Seed < 0)) {
+            std::cout << "Error nmfBatch: Invalid seed: " <<
+                         parser.value(seedOption).toStdString() << std::endl;
+            return nmfBatchDriver::UsageError;
+        }
+    }
+
+    nmfBatchDriver Driver(Options);
+
+    return Driver.run();
+}
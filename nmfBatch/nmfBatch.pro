@@ -0,0 +1,57 @@
+#
+# nmfBatch: headless multi-run estimation driver
+#
+# Only needs QtCore (and QtSql for the shared utilities' headers), none of the
+# widget or chart libraries, so it can be built and run on a compute cluster.
+#
+
+QT       = core sql
+
+CONFIG  += c++14 console
+CONFIG  -= app_bundle
+
+TARGET   = nmfBatch
+TEMPLATE = app
+
+DEFINES += NMF_HEADLESS
+
+INCLUDEPATH += \
+    ../BeesAlgorithm \
+    ../nmfModels \
+    ../nmfUtilities
+
+SOURCES += \
+    main.cpp \
+    nmfBatchDriver.cpp \
+    ../BeesAlgorithm/Bee.cpp \
+    ../BeesAlgorithm/BeesAlgorithm.cpp \
+    ../nmfModels/nmfCompetitionForm.cpp \
+    ../nmfModels/nmfGrowthForm.cpp \
+    ../nmfModels/nmfHarvestForm.cpp \
+    ../nmfModels/nmfMultiRunScheduler.cpp \
+    ../nmfModels/nmfParameterView.cpp \
+    ../nmfModels/nmfPredationForm.cpp \
+    ../nmfUtilities/nmfLogger.cpp \
+    ../nmfUtilities/nmfUtils.cpp \
+    ../nmfUtilities/nmfUtilsComplex.cpp \
+    ../nmfUtilities/nmfUtilsQtCore.cpp \
+    ../nmfUtilities/nmfUtilsStatistics.cpp \
+    ../nmfUtilities/nmfWorkStealingPool.cpp
+
+HEADERS += \
+    nmfBatchDriver.h \
+    ../BeesAlgorithm/Bee.h \
+    ../BeesAlgorithm/BeesAlgorithm.h \
+    ../nmfModels/nmfCompetitionForm.h \
+    ../nmfModels/nmfGrowthForm.h \
+    ../nmfModels/nmfHarvestForm.h \
+    ../nmfModels/nmfMultiRunScheduler.h \
+    ../nmfModels/nmfParameterView.h \
+    ../nmfModels/nmfPredationForm.h \
+    ../nmfUtilities/nmfLogger.h \
+    ../nmfUtilities/nmfStructsQt.h \
+    ../nmfUtilities/nmfUtils.h \
+    ../nmfUtilities/nmfUtilsComplex.h \
+    ../nmfUtilities/nmfUtilsQtCore.h \
+    ../nmfUtilities/nmfUtilsStatistics.h \
+    ../nmfUtilities/nmfWorkStealingPool.h
@@ -0,0 +1,216 @@
+#include "nmfBatchDriver.h"
+#include "BeesAlgorithm.h"
+
+#include <iomanip>
+
+nmfBatchDriver::nmfBatchDriver(const nmfBatchOptions& Options)
+{
+    m_Options = Options;
+    m_Seed    = (Options.Seed < 0) ? unsigned(nmfUtilsQt::getCurrentTime().currentMSecsSinceEpoch()) :
+                                     unsigned(Options.Seed);
+}
+
+int
+nmfBatchDriver::repetitionSeed(const unsigned& BatchSeed,
+                               const int& RepetitionIndex)
+{
+    // Kept non-negative since BeesAlgorithm::setSeed reads a negative seed as the clock
+    return int((BatchSeed + unsigned(RepetitionIndex)) & 0x7fffffffu);
+}
+
+bool
+nmfBatchDriver::isSupported(const std::string& Algorithm) const
+{
+    return (Algorithm.find("Bees") != std::string::npos);
+}
+
+int
+nmfBatchDriver::loadInput()
+{
+    int NumRuns = 0;
+    int NumRepetitions = 0;
+    int TotalIndividualRuns;
+    std::vector<QString> MultiRunLines;
+
+    if (! nmfUtilsQt::loadModelData(m_Options.ModelFilename,m_ModelData)) {
+        return InputError;
+    }
+    m_ModelData.MultiRunSetupFilename = m_Options.MultiRunFilename;
+    if (! nmfUtilsQt::loadMultiRunData(m_ModelData,MultiRunLines,TotalIndividualRuns)) {
+        std::cout << "Error nmfBatchDriver: Couldn't read " << m_Options.MultiRunFilename << std::endl;
+        return InputError;
+    }
+
+    // The lines only differ in their settings, so they all share one copy of the inputs
+    nmfStructsQt::SharedModelData SharedData(m_ModelData);
+
+    // reloadDataStruct expects every column up to the NLopt iteration limit
+    m_LineData.clear();
+    m_FirstRun.clear();
+    m_FirstRepetition.clear();
+    for (unsigned line = 0; line < MultiRunLines.size(); ++line) {
+        if (MultiRunLines[line].trimmed().isEmpty()) {
+            continue;
+        }
+        if (MultiRunLines[line].split(",").size() < 22) {
+            std::cout << "Error nmfBatchDriver: Multi-run line " << line+1 << " of " <<
+                         m_Options.MultiRunFilename << " has too few columns" << std::endl;
+            return InputError;
+        }
+        m_LineData.push_back(SharedData);
+        nmfStructsQt::ModelRunSettings& Settings = m_LineData.back().Settings;
+        nmfUtilsQt::reloadDataStruct(Settings,MultiRunLines[line]);
+        if (! isSupported(Settings.EstimationAlgorithm)) {
+            std::cout << "Error nmfBatchDriver: Multi-run line " << line+1 << " uses the " <<
+                         Settings.EstimationAlgorithm <<
+                         ", only the Bees Algorithm can be run headless" << std::endl;
+            return UnsupportedAlgorithm;
+        }
+        m_FirstRun.push_back(NumRuns);
+        m_FirstRepetition.push_back(NumRepetitions);
+        NumRuns        += std::max(Settings.NLoptNumberOfRuns,0);
+        NumRepetitions += std::max(Settings.NLoptNumberOfRuns,0)*std::max(Settings.BeesNumRepetitions,1);
+    }
+    if (NumRuns == 0) {
+        std::cout << "Error nmfBatchDriver: No runs in " << m_Options.MultiRunFilename << std::endl;
+        return InputError;
+    }
+    m_Progress.assign(NumRuns,RunProgress());
+
+    return Success;
+}
+
+bool
+nmfBatchDriver::estimateRun(const nmfStructsQt::SharedModelData& LineData,
+                            const int& LineNum,
+                            const int& RunNum,
+                            nmfWorkStealingPool& Pool,
+                            std::vector<double>& Parameters,
+                            double& Fitness)
+{
+    int runNum    = LineNum+1;
+    int subRunNum = RunNum+1;
+    int NumRepetitions = std::max(LineData.Settings.BeesNumRepetitions,1);
+    int FirstRepetition = m_FirstRepetition[LineNum] + RunNum*NumRepetitions;
+    int best = -1;
+    std::string errorMsg;
+    std::vector<int>         Estimated(NumRepetitions,0);
+    std::vector<double>      RepetitionFitness(NumRepetitions,0.0);
+    std::vector<std::string> RepetitionErrorMsg(NumRepetitions);
+    std::vector<RunProgress> RepetitionProgress(NumRepetitions);
+    std::vector<std::vector<double> > RepetitionParameters(NumRepetitions);
+
+    // Each repetition has its own estimator, which only reads the shared input data, and
+    // its own seed, so the repetitions are independent searches
+    Pool.parallelFor(0,NumRepetitions,1,[&](int Begin, int End) {
+        for (int rep = Begin; rep < End; ++rep) {
+            int repRunNum    = runNum;
+            int repSubRunNum = subRunNum;
+            RunProgress& Progress = RepetitionProgress[rep];
+            BeesAlgorithm Bees(LineData,false);
+            Bees.setWorkStealingPool(&Pool);
+            Bees.setSeed(repetitionSeed(m_Seed,FirstRepetition+rep));
+            Bees.setProgressSink([&](const std::string& RunName,
+                                     const int& Generation,
+                                     const double& BestFitness) {
+                Progress.Generation  = Generation;
+                Progress.BestFitness = BestFitness;
+                if (m_Options.ShowProgress) {
+                    std::lock_guard<std::mutex> lock(m_PrintMutex);
+                    std::cout << RunName << ": Generation " << Generation <<
+                                 ", Best Fitness " << BestFitness << std::endl;
+                }
+            });
+            Estimated[rep] = Bees.estimateParameters(RepetitionFitness[rep],RepetitionParameters[rep],
+                                                     repRunNum,repSubRunNum,RepetitionErrorMsg[rep]);
+        }
+    });
+
+    // The run's estimate is the best repetition's
+    for (int rep = 0; rep < NumRepetitions; ++rep) {
+        if (Estimated[rep] && ((best < 0) || (RepetitionFitness[rep] < RepetitionFitness[best]))) {
+            best = rep;
+        }
+    }
+    if (best < 0) {
+        errorMsg = RepetitionErrorMsg[0];
+        std::lock_guard<std::mutex> lock(m_PrintMutex);
+        std::cout << "Error nmfBatchDriver: Run " << runNum << "-" << subRunNum <<
+                     " failed: " << errorMsg << std::endl;
+        return false;
+    }
+    Fitness    = RepetitionFitness[best];
+    Parameters = RepetitionParameters[best];
+    m_Progress[m_FirstRun[LineNum]+RunNum] = RepetitionProgress[best];
+
+    return true;
+}
+
+void
+nmfBatchDriver::writeHeader()
+{
+    m_OutputFile << "Line,Run,Algorithm,Minimizer,ObjectiveCriterion,Scaling,"
+                    "Estimated,Generations,Fitness,Seconds,Parameters" << std::endl;
+}
+
+void
+nmfBatchDriver::writeResult(const nmfMultiRunResult& Result)
+{
+    const nmfStructsQt::ModelRunSettings& LineData = m_LineData[Result.LineNum].Settings;
+    const RunProgress& Progress = m_Progress[m_FirstRun[Result.LineNum]+Result.RunNum];
+
+    m_OutputFile << Result.LineNum+1            << "," <<
+                    Result.RunNum+1             << "," <<
+                    LineData.EstimationAlgorithm << "," <<
+                    LineData.MinimizerAlgorithm  << "," <<
+                    LineData.ObjectiveCriterion  << "," <<
+                    LineData.ScalingAlgorithm    << "," <<
+                    int(Result.Estimated)       << "," <<
+                    Progress.Generation         << "," <<
+                    Result.Fitness              << "," <<
+                    Result.Seconds;
+    for (const double& parameter : Result.Parameters) {
+        m_OutputFile << "," << parameter;
+    }
+    m_OutputFile << std::endl;
+}
+
+int
+nmfBatchDriver::run()
+{
+    int status = loadInput();
+    bool allEstimated;
+    std::vector<nmfMultiRunResult> Results;
+
+    if (status != Success) {
+        return status;
+    }
+
+    m_OutputFile.open(m_Options.OutputFilename);
+    if (! m_OutputFile.is_open()) {
+        std::cout << "Error nmfBatchDriver: Couldn't open " << m_Options.OutputFilename << std::endl;
+        return OutputError;
+    }
+    m_OutputFile << std::setprecision(17);
+    writeHeader();
+
+    nmfMultiRunScheduler Scheduler(m_LineData);
+    allEstimated = Scheduler.run(
+        [&](const nmfStructsQt::SharedModelData& LineData, const int& LineNum, const int& RunNum,
+            nmfWorkStealingPool& Pool, std::vector<double>& Parameters, double& Fitness) {
+            return estimateRun(LineData,LineNum,RunNum,Pool,Parameters,Fitness);
+        },
+        m_Options.NumThreads,
+        [&](const nmfMultiRunResult& Result) { writeResult(Result); },
+        Results);
+
+    m_OutputFile.close();
+    if (! m_OutputFile) {
+        std::cout << "Error nmfBatchDriver: Couldn't write " << m_Options.OutputFilename << std::endl;
+        return OutputError;
+    }
+    std::cout << "nmfBatchDriver: Ran " << Results.size() << " runs in " <<
+                 Scheduler.getWallSeconds() << " seconds" << std::endl;
+
+    return (allEstimated) ? Success : EstimationFailed;
+}
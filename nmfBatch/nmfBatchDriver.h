@@ -0,0 +1,118 @@
+/**
+ * @file nmfBatchDriver.h
+ * @brief Definition for the headless multi-run estimation driver
+ * @date Oct 19, 2026
+ *
+ * The driver runs the estimations of a multi-run setup file without the GUI, so that
+ * batches can be run on a compute cluster. It's built with NMF_HEADLESS defined and only
+ * needs QtCore, none of the widget or chart libraries. The estimates are written to a flat
+ * file since nmfDatabase still needs the widget libraries.
+ *
+ */
+
+#pragma once
+
+#include <mutex>
+#include <vector>
+#include <string>
+#include <fstream>
+#include <iostream>
+
+#include "nmfUtilsQtCore.h"
+#include "nmfMultiRunScheduler.h"
+
+/**
+ * @brief Command line options of the batch driver
+ */
+struct nmfBatchOptions {
+    std::string ModelFilename;    // model data written by nmfUtilsQt::saveModelData
+    std::string MultiRunFilename; // multi-run setup file, as read by nmfUtilsQt::loadMultiRunData
+    std::string OutputFilename;   // csv file of the estimates, one row per run
+    int  NumThreads;              // 0 uses one thread per core
+    int  Seed;                    // seed of the batch's searches (if < 0, the clock)
+    bool ShowProgress;            // print each generation's best fitness
+    nmfBatchOptions() : NumThreads(0), Seed(-1), ShowProgress(false) {}
+};
+
+/**
+ * @brief Loads the model data and the multi-run lines, runs every line's estimations on the
+ * multi-run scheduler, and writes the estimates to a flat file in line and run order. The
+ * estimators report their progress to the driver instead of to the progress chart file, and
+ * the driver keeps it in memory (the last generation and best fitness of each run go in the
+ * output) or prints it.
+ *
+ * A run is BeesNumRepetitions independent searches, whose best is the run's estimate. The
+ * searches and the bees of each search are split over the scheduler's pool, so a long run
+ * doesn't hold up the end of a batch on one thread. Every search of the batch has its own
+ * seed, the batch seed plus the search's index in the batch, so a batch with a given seed
+ * gives the same estimates on any number of threads.
+ *
+ * Only the Bees Algorithm is in the shared utilities, so lines that use other algorithms are
+ * rejected before anything is run.
+ */
+class nmfBatchDriver {
+
+public:
+    /**
+     * @brief Exit codes of the batch tool
+     */
+    enum ExitCode {
+        Success              = 0,  // every run was estimated
+        UsageError           = 1,  // missing or invalid command line arguments
+        InputError           = 2,  // the model data or multi-run file couldn't be read
+        UnsupportedAlgorithm = 3,  // a line uses an estimation algorithm the tool doesn't have
+        EstimationFailed     = 4,  // at least one run failed, the others were still written
+        OutputError          = 5   // the output file couldn't be written
+    };
+
+private:
+    struct RunProgress {
+        int    Generation;
+        double BestFitness;
+        RunProgress() : Generation(0), BestFitness(0) {}
+    };
+
+    nmfBatchOptions                            m_Options;
+    unsigned                                   m_Seed;      // batch seed, read once from the clock if not given
+    nmfStructsQt::ModelDataStruct              m_ModelData;
+    std::vector<nmfStructsQt::SharedModelData> m_LineData;  // all share m_ModelData's inputs
+    std::vector<int>                           m_FirstRun;  // index of each line's first run
+    std::vector<int>                           m_FirstRepetition; // index of each line's first search
+    std::vector<RunProgress>                   m_Progress;  // per run, in line and run order
+    std::mutex                                 m_PrintMutex;
+    std::ofstream                              m_OutputFile;
+
+    bool isSupported(const std::string& Algorithm) const;
+    int  loadInput();
+    bool estimateRun(const nmfStructsQt::SharedModelData& LineData,
+                     const int& LineNum,
+                     const int& RunNum,
+                     nmfWorkStealingPool& Pool,
+                     std::vector<double>& Parameters,
+                     double& Fitness);
+    void writeHeader();
+    void writeResult(const nmfMultiRunResult& Result);
+
+public:
+    /**
+     * @brief Sets up a batch
+     * @param Options : input and output files, threads, and progress printing
+     */
+    nmfBatchDriver(const nmfBatchOptions& Options);
+   ~nmfBatchDriver() {}
+
+    /**
+     * @brief Seed of one search (repetition) of a batch
+     * @param BatchSeed : seed of the batch
+     * @param RepetitionIndex : index of the search in the batch, in line, run, and repetition order
+     * @return The seed to pass to BeesAlgorithm::setSeed
+     */
+    static int repetitionSeed(const unsigned& BatchSeed,
+                              const int& RepetitionIndex);
+
+    /**
+     * @brief Runs the batch
+     * @return The exit code of the tool
+     */
+    int run();
+};
@@ -0,0 +1,37 @@
+#
+# Checks of the headless multi-run estimation driver. Run with "make check".
+#
+
+QT       = core sql
+
+CONFIG  += c++14 console testcase
+CONFIG  -= app_bundle
+
+TARGET   = tst_nmfBatch
+TEMPLATE = app
+
+DEFINES += NMF_HEADLESS
+
+INCLUDEPATH += \
+    .. \
+    ../../BeesAlgorithm \
+    ../../nmfModels \
+    ../../nmfUtilities
+
+SOURCES += \
+    tst_nmfBatch.cpp \
+    ../nmfBatchDriver.cpp \
+    ../../BeesAlgorithm/Bee.cpp \
+    ../../BeesAlgorithm/BeesAlgorithm.cpp \
+    ../../nmfModels/nmfCompetitionForm.cpp \
+    ../../nmfModels/nmfGrowthForm.cpp \
+    ../../nmfModels/nmfHarvestForm.cpp \
+    ../../nmfModels/nmfMultiRunScheduler.cpp \
+    ../../nmfModels/nmfParameterView.cpp \
+    ../../nmfModels/nmfPredationForm.cpp \
+    ../../nmfUtilities/nmfLogger.cpp \
+    ../../nmfUtilities/nmfUtils.cpp \
+    ../../nmfUtilities/nmfUtilsComplex.cpp \
+    ../../nmfUtilities/nmfUtilsQtCore.cpp \
+    ../../nmfUtilities/nmfUtilsStatistics.cpp \
+    ../../nmfUtilities/nmfWorkStealingPool.cpp
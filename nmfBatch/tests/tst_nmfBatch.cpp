@@ -0,0 +1,272 @@
+/**
+ * @file tst_nmfBatch.cpp
+ * @brief Checks of the headless multi-run estimation driver
+ * @date Oct 19, 2026
+ *
+ * Returns 0 if every check passes, else the number of failed checks. The model data and
+ * multi-run files are written to, and removed from, the current directory.
+ *
+ */
+
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <vector>
+
+#include "BeesAlgorithm.h"
+#include "nmfBatchDriver.h"
+
+static int NumFailed = 0;
+
+static const std::string ModelFilename    = "tst_nmfBatch_model.txt";
+static const std::string MultiRunFilename = "tst_nmfBatch_multirun.csv";
+
+static void
+check(const bool& ok, const std::string& what)
+{
+    std::cout << ((ok) ? "PASS   : " : "FAIL!  : ") << what << std::endl;
+    if (! ok) {
+        ++NumFailed;
+    }
+}
+
+static bool
+sameBits(const std::vector<double>& a, const std::vector<double>& b)
+{
+    return (a.size() == b.size()) &&
+           (std::memcmp(a.data(),b.data(),a.size()*sizeof(double)) == 0);
+}
+
+static boost::numeric::ublas::vector<double>
+toVector(const std::vector<double>& values)
+{
+    boost::numeric::ublas::vector<double> vec(values.size());
+    for (unsigned i = 0; i < values.size(); ++i) {
+        vec[i] = values[i];
+    }
+    return vec;
+}
+
+// Two species logistic model with a constant catch, whose biomass is the
+// model's own projection from known parameters
+static void
+buildModelData(nmfStructsQt::ModelDataStruct& ModelData)
+{
+    const int NumSpecies = 2;
+    const int RunLength  = 20;
+    double biomass[NumSpecies] = {500.0, 800.0};
+    const double r[NumSpecies] = {0.4, 0.2};
+    const double K[NumSpecies] = {2000.0, 3000.0};
+    nmfParameterOffsets Offsets;
+    nmfStructsQt::EstimateRunBox runBox;
+
+    ModelData.NumSpecies          = NumSpecies;
+    ModelData.NumGuilds           = 1;
+    ModelData.RunLength           = RunLength;
+    ModelData.GrowthForm          = "Logistic";
+    ModelData.HarvestForm         = "Catch";
+    ModelData.CompetitionForm     = "Null";
+    ModelData.PredationForm       = "Null";
+    ModelData.ObjectiveCriterion  = "Least Squares";
+    ModelData.ScalingAlgorithm    = "Min Max";
+    ModelData.EstimationAlgorithm = "Bees Algorithm";
+    ModelData.GuildSpecies[0]     = {0,1};
+    ModelData.GuildNum            = {0,0};
+    ModelData.BeesMaxGenerations  = 10;
+    ModelData.BeesNumTotal        = 20;
+    ModelData.BeesNumBestSites    = 5;
+    ModelData.BeesNumEliteSites   = 2;
+    ModelData.BeesNumElite        = 4;
+    ModelData.BeesNumOther        = 2;
+    ModelData.BeesNeighborhoodSize = 20;
+    ModelData.BeesNumRepetitions  = 2;
+
+    nmfUtils::initialize(ModelData.ObservedBiomassBySpecies,RunLength+1,NumSpecies);
+    nmfUtils::initialize(ModelData.ObservedBiomassByGuilds, RunLength+1,1);
+    nmfUtils::initialize(ModelData.Catch,                   RunLength+1,NumSpecies);
+    nmfUtils::initialize(ModelData.Effort,                  RunLength+1,NumSpecies);
+    nmfUtils::initialize(ModelData.Exploitation,            RunLength+1,NumSpecies);
+    for (int time = 0; time <= RunLength; ++time) {
+        for (int i = 0; i < NumSpecies; ++i) {
+            ModelData.Catch(time,i) = 20.0 + 10.0*i;
+            ModelData.ObservedBiomassBySpecies(time,i) = biomass[i];
+            biomass[i] += r[i]*biomass[i]*(1.0-biomass[i]/K[i]) - ModelData.Catch(time,i);
+        }
+        ModelData.ObservedBiomassByGuilds(time,0) = ModelData.ObservedBiomassBySpecies(time,0) +
+                                                    ModelData.ObservedBiomassBySpecies(time,1);
+    }
+
+    ModelData.InitBiomass         = toVector({500.0, 800.0});
+    ModelData.InitBiomassMin      = toVector({400.0, 600.0});
+    ModelData.InitBiomassMax      = toVector({600.0, 1000.0});
+    ModelData.GrowthRate          = toVector({0.4, 0.2});
+    ModelData.GrowthRateMin       = toVector({0.1, 0.1});
+    ModelData.GrowthRateMax       = toVector({1.0, 1.0});
+    ModelData.CarryingCapacity    = toVector({2000.0, 3000.0});
+    ModelData.CarryingCapacityMin = toVector({1000.0, 1000.0});
+    ModelData.CarryingCapacityMax = toVector({5000.0, 5000.0});
+    ModelData.Catchability        = toVector({0.0, 0.0});
+    ModelData.CatchabilityMin     = toVector({0.0, 0.0});
+    ModelData.CatchabilityMax     = toVector({0.0, 0.0});
+    ModelData.ExploitationRateMin = toVector({0.0, 0.0});
+    ModelData.ExploitationRateMax = toVector({0.0, 0.0});
+    ModelData.SurveyQ             = toVector({1.0, 1.0});
+    ModelData.SurveyQMin          = toVector({1.0, 1.0});
+    ModelData.SurveyQMax          = toVector({1.0, 1.0});
+
+    // Same estimated parameters as the multi-run line
+    runBox.state = std::make_pair(true,true);
+    for (std::string parameter : {"InitBiomass","GrowthRate"}) {
+        runBox.parameter = parameter;
+        ModelData.EstimateRunBoxes.push_back(runBox);
+    }
+
+    Offsets.load(ModelData);
+    ModelData.TotalNumberParameters = Offsets.getTotalNumberParameters();
+}
+
+static bool
+estimate(const nmfStructsQt::ModelDataStruct& ModelData,
+         const int& Seed,
+         std::vector<double>& Parameters)
+{
+    int runNum    = 1;
+    int subRunNum = 1;
+    double fitness;
+    std::string errorMsg;
+    BeesAlgorithm Bees(ModelData,false);
+
+    Bees.setProgressSink([](const std::string&, const int&, const double&) {});
+    Bees.setSeed(Seed);
+
+    return Bees.estimateParameters(fitness,Parameters,runNum,subRunNum,errorMsg);
+}
+
+// Reads a batch's estimates without the Seconds column, which varies from run to run
+static bool
+readEstimates(const std::string& Filename,
+              std::vector<std::string>& Rows)
+{
+    const int SecondsColumn = 9;
+    int column;
+    std::string line;
+    std::string field;
+    std::string row;
+    std::ifstream inputFile(Filename);
+
+    Rows.clear();
+    if (! std::getline(inputFile,line)) {
+        return false;
+    }
+    while (std::getline(inputFile,line)) {
+        std::stringstream fields(line);
+        row.clear();
+        for (column = 0; std::getline(fields,field,','); ++column) {
+            if (column != SecondsColumn) {
+                row += field + ",";
+            }
+        }
+        Rows.push_back(row);
+    }
+
+    return ! Rows.empty();
+}
+
+static int
+runBatch(const int& NumThreads,
+         const int& Seed,
+         const std::string& OutputFilename,
+         std::vector<std::string>& Rows)
+{
+    int status;
+    nmfBatchOptions Options;
+
+    Options.ModelFilename    = ModelFilename;
+    Options.MultiRunFilename = MultiRunFilename;
+    Options.OutputFilename   = OutputFilename;
+    Options.NumThreads       = NumThreads;
+    Options.Seed             = Seed;
+
+    nmfBatchDriver Driver(Options);
+    status = Driver.run();
+    if (! readEstimates(OutputFilename,Rows)) {
+        Rows.clear();
+    }
+    std::remove(OutputFilename.c_str());
+
+    return status;
+}
+
+// The repetitions of a run must be independent searches that a batch seed reproduces
+static void
+testRepetitionSeeds(const nmfStructsQt::ModelDataStruct& ModelData)
+{
+    const unsigned BatchSeed = 1234;
+    int seed0 = nmfBatchDriver::repetitionSeed(BatchSeed,0);
+    int seed1 = nmfBatchDriver::repetitionSeed(BatchSeed,1);
+    std::vector<double> repetition0;
+    std::vector<double> repetition1;
+    std::vector<double> repetition0Again;
+
+    check((seed0 >= 0) && (seed1 >= 0) && (seed0 != seed1),
+          "repetitionSeed: repetitions get distinct non-negative seeds");
+    check(nmfBatchDriver::repetitionSeed(0xffffffffu,1) >= 0,
+          "repetitionSeed: a seed past the int range stays non-negative");
+
+    check(estimate(ModelData,seed0,repetition0) &&
+          estimate(ModelData,seed1,repetition1) &&
+          estimate(ModelData,seed0,repetition0Again),
+          "estimateParameters: the repetitions are estimated");
+    check(! sameBits(repetition0,repetition1),
+          "estimateParameters: two repetitions of a run differ");
+    check(sameBits(repetition0,repetition0Again),
+          "estimateParameters: a repetition's seed reproduces its estimate");
+}
+
+// A seeded batch must give the same estimates on any number of threads
+static void
+testBatchReproducible()
+{
+    std::vector<std::string> rows1;
+    std::vector<std::string> rows2;
+    std::vector<std::string> rowsOtherSeed;
+
+    check((runBatch(1,7,"tst_nmfBatch_out1.csv",rows1) == nmfBatchDriver::Success) &&
+          (runBatch(2,7,"tst_nmfBatch_out2.csv",rows2) == nmfBatchDriver::Success) &&
+          (runBatch(2,8,"tst_nmfBatch_out3.csv",rowsOtherSeed) == nmfBatchDriver::Success),
+          "nmfBatchDriver::run: the batches are estimated");
+    check((rows1.size() == 2) && (rows1 == rows2),
+          "nmfBatchDriver::run: a seeded batch is the same on 1 and 2 threads");
+    check(rows1 != rowsOtherSeed,
+          "nmfBatchDriver::run: another seed gives other estimates");
+}
+
+int main()
+{
+    nmfStructsQt::ModelDataStruct ModelData;
+    std::ofstream multiRunFile;
+
+    buildModelData(ModelData);
+    if (! nmfUtilsQt::saveModelData(ModelData,ModelFilename)) {
+        std::cout << "FAIL!  : Couldn't write " << ModelFilename << std::endl;
+        return 1;
+    }
+    // Two runs of a Bees Algorithm line with two repetitions each
+    multiRunFile.open(MultiRunFilename);
+    multiRunFile << "header" << std::endl <<
+                    "2,Least Squares,Bees Algorithm,,Min Max,10,20,5,2,4,2,20,2,"
+                    "x,0,0,x,0,0,x,0,0,x,1,1,x,1,1,x,0,0,x" << std::endl;
+    multiRunFile.close();
+
+    testRepetitionSeeds(ModelData);
+    testBatchReproducible();
+
+    std::remove(ModelFilename.c_str());
+    std::remove(MultiRunFilename.c_str());
+
+    std::cout << "Totals: " << NumFailed << " failed" << std::endl;
+
+    return NumFailed;
+}
@@ -18,6 +18,60 @@ nmfChartLine::clear(QChart* chart)
     chart->removeAllSeries();
 }
 
+bool
+nmfChartLine::updateChart(
+        QChart*            chart,
+        const bool&        ShowFirstPoint,
+        const boost::numeric::ublas::matrix<double> &YAxisData,
+        const int&         FirstRow)
+{
+    int XStartVal  = (ShowFirstPoint) ? 0 : 1;
+    int NumXValues = YAxisData.size1();
+    int firstRow   = std::max(FirstRow,XStartVal);
+    double yVal;
+    double yMax;
+    QLineSeries* lineSeries;
+    QList<QAbstractSeries*> seriesList = chart->series();
+    QVector<QPointF> points;
+
+    QList<QAbstractAxis*> axesY = chart->axes(Qt::Vertical);
+
+    // Without a y axis to rescale the caller has to repopulate the chart
+    if ((unsigned(seriesList.size()) != YAxisData.size2()) || axesY.isEmpty()) {
+        return false;
+    }
+    QValueAxis *currentAxisY = qobject_cast<QValueAxis*>(axesY.back());
+    if (currentAxisY == nullptr) {
+        return false;
+    }
+
+    yMax = currentAxisY->max();
+    for (unsigned line=0; line<YAxisData.size2(); ++line) {
+        lineSeries = qobject_cast<QLineSeries*>(seriesList[line]);
+        if ((lineSeries == nullptr) || (lineSeries->count() != NumXValues-XStartVal)) {
+            return false;
+        }
+        // Replace all of the points at once so the series only redraws a single time
+        points = lineSeries->pointsVector();
+        for (int j=firstRow; j<NumXValues; ++j) {
+            yVal = YAxisData(j,line);
+            if (yVal == nmfConstants::NoValueDouble) {
+                return false;
+            }
+            points[j-XStartVal].setY(yVal);
+            yMax = std::max(yMax,yVal);
+        }
+        lineSeries->replace(points);
+    }
+
+    if (yMax > currentAxisY->max()) {
+        currentAxisY->setMax(yMax);
+        currentAxisY->applyNiceNumbers();
+    }
+
+    return true;
+}
+
 void
 nmfChartLine::populateChart(
         QChart*            chart,
@@ -64,6 +64,23 @@ public:
             const QColor&      LineColor,
             const std::string& LineColorName,
             const double&      XInc);
+    /**
+     * @brief Moves the points of the lines already in the chart to new y values instead of
+     * rebuilding the series and axes as populateChart does. Meant for charts redrawn many
+     * times a second, such as while the user drags a what-if line. Only rows from FirstRow
+     * on are replaced and the y axis is only ever widened.
+     * @param chart : chart previously filled by populateChart with type "Line"
+     * @param ShowFirstPoint : the same value that was passed to populateChart
+     * @param YAxisData : new (x, line) data the same size as that passed to populateChart
+     * @param FirstRow : first row of YAxisData that may have changed
+     * @return False if the chart's series don't line up with the data or it has no y axis (the
+     * caller should then call populateChart), else True
+     */
+    bool updateChart(
+            QChart*            chart,
+            const bool&        ShowFirstPoint,
+            const boost::numeric::ublas::matrix<double> &YAxisData,
+            const int&         FirstRow);
     void clear(QChart* chart);
 
 signals:
@@ -88,6 +88,21 @@ nmfChartMovableLine::checkChartBoundaries(QPointF *point)
     if (point->y() < m_MinY) point->setY(m_MinY);
 }
 
+int
+nmfChartMovableLine::getPreviousVertexX(const QPointF& point)
+{
+    int previousX = m_MinX;
+
+    for (const QPointF& vertex : m_Scatter->points()) {
+        if (vertex.x() >= point.x()) {
+            break;
+        }
+        previousX = int(vertex.x());
+    }
+
+    return previousX;
+}
+
 int
 nmfChartMovableLine::getMaxYScaleFactor()
 {
@@ -332,17 +347,22 @@ nmfChartMovableLine::callback_KeyPressed(QKeyEvent *event)
     // that the user is holding down the mouse button
     if (event->key() == Qt::Key_Delete) {
         QList<QPointF> points = m_Scatter->points();
+        int firstChangedX = m_MaxX+1;
         for (int i = 0; i < selectedPoints.length(); i++) {
             if (points.at(0) == selectedPoints[i] ||
                 points.at(points.length() - 1) == selectedPoints[i]) {
                 continue;
             } else {
+                firstChangedX = std::min(firstChangedX,getPreviousVertexX(selectedPoints[i])+1);
                 m_Scatter->remove(selectedPoints[i]);
                 m_Line->remove(selectedPoints[i]);
             }
         }
         m_SelectedScatter->clear();
         m_Chart->update();
+        if (firstChangedX <= m_MaxX) {
+            emit LineChanged(firstChangedX-m_MinX);
+        }
     }
 
     else if (event->key() == Qt::Key_Escape) {
@@ -355,6 +375,7 @@ nmfChartMovableLine::callback_KeyPressed(QKeyEvent *event)
         // that the user is holding down the mouse button
         if (selectedPoints.length() > 0) {
             resetPoints();
+            emit LineChanged(0);
         }
     }
 }
@@ -410,10 +431,19 @@ nmfChartMovableLine::callback_MouseMoved(QMouseEvent *event)
         newCoords.setY(roundTo(m_RoundingFactor,newCoords.y()));
         checkChartBoundaries(&newCoords);
 
+        // Most mouse moves land on the same rounded value, so only redraw
+        // and notify listeners when the vertex actually moves
+        if (newCoords == m_CurrPoint) {
+            return;
+        }
+
         m_Scatter->replace(m_CurrPoint, newCoords);
         m_Line->replace(m_CurrPoint, newCoords);
         m_SelectedScatter->replace(m_CurrPoint, newCoords);
         m_CurrPoint = newCoords;
+
+        // The line only changes after the vertex before the one being dragged
+        emit LineChanged(getPreviousVertexX(m_CurrPoint)+1-m_MinX);
     }
 }
 
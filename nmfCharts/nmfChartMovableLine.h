@@ -49,6 +49,13 @@ private:
     QScatterSeries* m_SelectedScatter;
 
     void checkChartBoundaries(QPointF *point);
+    /**
+     * @brief Finds the x value of the vertex before the passed point. The line is unchanged
+     * up to and including that vertex when the point is moved or removed.
+     * @param point : a vertex on the line
+     * @return Returns the previous vertex's x value (m_MinX if there's none)
+     */
+    int getPreviousVertexX(const QPointF& point);
     /**
      * @brief Removes all points from line chart. N.B. This will also remove the end points.
      */
@@ -153,6 +160,15 @@ public:
             const int& startYear,
             const int& endYear);
 
+Q_SIGNALS:
+    /**
+     * @brief Signal emitted when the user changes the line, so a what-if projection
+     * may be rerun from the first changed year instead of from the start
+     * @param FirstChangedYear : first year, as an offset from the start year, whose
+     * y value may have changed
+     */
+    void LineChanged(int FirstChangedYear);
+
 public Q_SLOTS:
     /**
      * @brief Callback invoked when the user presses a key over the plot
@@ -49,46 +49,47 @@ nmfDatabase::nmfDatabase() {
 //  db = QSqlDatabase::addDatabase("QMYSQL");
 //  db = QSqlDatabase::addDatabase("QSQLITE");
 
-    m_FunctionMap["Application"]          = createApplication;          //  0 of 39
-    m_FunctionMap["ForeEnergyDens"]       = createForeEnergyDens;       //  1 of 39
-    m_FunctionMap["ForeOutput"]           = createForeOutput;           //  2 of 39
-    m_FunctionMap["ForePredGrowth"]       = createForePredGrowth;       //  3 of 39
-    m_FunctionMap["ForePredVonB"]         = createForePredVonB;         //  4 of 39
-    m_FunctionMap["ForeSRQ"]              = createForeSRQ;              //  5 of 39
-    m_FunctionMap["ForeSRR"]              = createForeSRR;              //  6 of 39
-    m_FunctionMap["ForeSuitPreyBiomass"]  = createForeSuitPreyBiomass;  //  7 of 39
-    m_FunctionMap["Forecasts"]            = createForecasts;            //  8 of 39
-    m_FunctionMap["MSVPAEnergyDens"]      = createMSVPAEnergyDens;      //  9 of 39
-    m_FunctionMap["MSVPAOthPrey"]         = createMSVPAOthPrey;         // 10 of 39
-    m_FunctionMap["MSVPAOthPreyAnn"]      = createMSVPAOthPreyAnn;      // 11 of 39
-    m_FunctionMap["MSVPASeasBiomass"]     = createMSVPASeasBiomass;     // 12 of 39
-    m_FunctionMap["MSVPASeasInfo"]        = createMSVPASeasInfo;        // 13 of 39
-    m_FunctionMap["MSVPASizePref"]        = createMSVPASizePref;        // 14 of 39
-    m_FunctionMap["MSVPASpaceO"]          = createMSVPASpaceO;          // 15 of 39
-    m_FunctionMap["MSVPAStomCont"]        = createMSVPAStomCont;        // 16 of 39
-    m_FunctionMap["MSVPASuitPreyBiomass"] = createMSVPASuitPreyBiomass; // 17 of 39
-    m_FunctionMap["MSVPAlist"]            = createMSVPAlist;            // 18 of 39
-    m_FunctionMap["MSVPAprefs"]           = createMSVPAprefs;           // 19 of 39
-    m_FunctionMap["MSVPAspecies"]         = createMSVPAspecies;         // 20 of 39
-    m_FunctionMap["OthPredSizeData"]      = createOthPredSizeData;      // 21 of 39
-    m_FunctionMap["OtherPredBM"]          = createOtherPredBM;          // 22 of 39
-    m_FunctionMap["OtherPredSpecies"]     = createOtherPredSpecies;     // 23 of 39
-    m_FunctionMap["SSVPAAgeM"]            = createSSVPAAgeM;            // 24 of 39
-    m_FunctionMap["ScenarioF"]            = createScenarioF;            // 25 of 39
-    m_FunctionMap["ScenarioOthPred"]      = createScenarioOthPred;      // 26 of 39
-    m_FunctionMap["ScenarioOthPrey"]      = createScenarioOthPrey;      // 27 of 39
-    m_FunctionMap["ScenarioRec"]          = createScenarioRec;          // 28 of 39
-    m_FunctionMap["Scenarios"]            = createScenarios;            // 29 of 39
-    m_FunctionMap["SpeCatch"]             = createSpeCatch;             // 30 of 39
-    m_FunctionMap["SpeMaturity"]          = createSpeMaturity;          // 31 of 39
-    m_FunctionMap["SpeSSVPA"]             = createSpeSSVPA;             // 32 of 39
-    m_FunctionMap["SpeSize"]              = createSpeSize;              // 33 of 39
-    m_FunctionMap["SpeTuneCatch"]         = createSpeTuneCatch;         // 34 of 39
-    m_FunctionMap["SpeTuneEffort"]        = createSpeTuneEffort;        // 35 of 39
-    m_FunctionMap["SpeWeight"]            = createSpeWeight;            // 36 of 39
-    m_FunctionMap["SpeXSAData"]           = createSpeXSAData;           // 37 of 39
-    m_FunctionMap["SpeXSAIndices"]        = createSpeXSAIndices;        // 38 of 39
-    m_FunctionMap["Species"]              = createSpecies;              // 39 of 39
+    m_FunctionMap["Application"]                      = createApplication;                      //  0 of 40
+    m_FunctionMap["ForeEnergyDens"]                   = createForeEnergyDens;                   //  1 of 40
+    m_FunctionMap["ForeOutput"]                       = createForeOutput;                       //  2 of 40
+    m_FunctionMap["ForePredGrowth"]                   = createForePredGrowth;                   //  3 of 40
+    m_FunctionMap["ForePredVonB"]                     = createForePredVonB;                     //  4 of 40
+    m_FunctionMap["ForeSRQ"]                          = createForeSRQ;                          //  5 of 40
+    m_FunctionMap["ForeSRR"]                          = createForeSRR;                          //  6 of 40
+    m_FunctionMap["ForeSuitPreyBiomass"]              = createForeSuitPreyBiomass;              //  7 of 40
+    m_FunctionMap["Forecasts"]                        = createForecasts;                        //  8 of 40
+    m_FunctionMap["ForecastBiomassMonteCarloSummary"] = createForecastBiomassMonteCarloSummary; //  9 of 40
+    m_FunctionMap["MSVPAEnergyDens"]                  = createMSVPAEnergyDens;                  // 10 of 40
+    m_FunctionMap["MSVPAOthPrey"]                     = createMSVPAOthPrey;                     // 11 of 40
+    m_FunctionMap["MSVPAOthPreyAnn"]                  = createMSVPAOthPreyAnn;                  // 12 of 40
+    m_FunctionMap["MSVPASeasBiomass"]                 = createMSVPASeasBiomass;                 // 13 of 40
+    m_FunctionMap["MSVPASeasInfo"]                    = createMSVPASeasInfo;                    // 14 of 40
+    m_FunctionMap["MSVPASizePref"]                    = createMSVPASizePref;                    // 15 of 40
+    m_FunctionMap["MSVPASpaceO"]                      = createMSVPASpaceO;                      // 16 of 40
+    m_FunctionMap["MSVPAStomCont"]                    = createMSVPAStomCont;                    // 17 of 40
+    m_FunctionMap["MSVPASuitPreyBiomass"]             = createMSVPASuitPreyBiomass;             // 18 of 40
+    m_FunctionMap["MSVPAlist"]                        = createMSVPAlist;                        // 19 of 40
+    m_FunctionMap["MSVPAprefs"]                       = createMSVPAprefs;                       // 20 of 40
+    m_FunctionMap["MSVPAspecies"]                     = createMSVPAspecies;                     // 21 of 40
+    m_FunctionMap["OthPredSizeData"]                  = createOthPredSizeData;                  // 22 of 40
+    m_FunctionMap["OtherPredBM"]                      = createOtherPredBM;                      // 23 of 40
+    m_FunctionMap["OtherPredSpecies"]                 = createOtherPredSpecies;                 // 24 of 40
+    m_FunctionMap["SSVPAAgeM"]                        = createSSVPAAgeM;                        // 25 of 40
+    m_FunctionMap["ScenarioF"]                        = createScenarioF;                        // 26 of 40
+    m_FunctionMap["ScenarioOthPred"]                  = createScenarioOthPred;                  // 27 of 40
+    m_FunctionMap["ScenarioOthPrey"]                  = createScenarioOthPrey;                  // 28 of 40
+    m_FunctionMap["ScenarioRec"]                      = createScenarioRec;                      // 29 of 40
+    m_FunctionMap["Scenarios"]                        = createScenarios;                        // 30 of 40
+    m_FunctionMap["SpeCatch"]                         = createSpeCatch;                         // 31 of 40
+    m_FunctionMap["SpeMaturity"]                      = createSpeMaturity;                      // 32 of 40
+    m_FunctionMap["SpeSSVPA"]                         = createSpeSSVPA;                         // 33 of 40
+    m_FunctionMap["SpeSize"]                          = createSpeSize;                          // 34 of 40
+    m_FunctionMap["SpeTuneCatch"]                     = createSpeTuneCatch;                     // 35 of 40
+    m_FunctionMap["SpeTuneEffort"]                    = createSpeTuneEffort;                    // 36 of 40
+    m_FunctionMap["SpeWeight"]                        = createSpeWeight;                        // 37 of 40
+    m_FunctionMap["SpeXSAData"]                       = createSpeXSAData;                       // 38 of 40
+    m_FunctionMap["SpeXSAIndices"]                    = createSpeXSAIndices;                    // 39 of 40
+    m_FunctionMap["Species"]                          = createSpecies;                          // 40 of 40
 }
 
 void
@@ -2223,6 +2224,162 @@ nmfDatabase::updateForecastMonteCarloParameters(
     return true;
 }
 
+bool
+nmfDatabase::updateForecastBiomassMonteCarlo(
+        nmfLogger*           logger,
+        const std::string&   ProjectName,
+        const std::string&   ForecastName,
+        const std::string&   Algorithm,
+        const std::string&   Minimizer,
+        const std::string&   ObjectiveCriterion,
+        const std::string&   Scaling,
+        const std::vector<std::string>& SpeciesNames,
+        const std::vector<boost::numeric::ublas::matrix<double> >& SampledBiomass)
+{
+    int NumRuns = SampledBiomass.size();
+    int NumSpecies = SpeciesNames.size();
+    std::string saveCmd;
+    std::string deleteCmd;
+    std::string errorMsg;
+    std::string tableName = "ForecastBiomassMonteCarlo";
+
+    deleteCmd  = "DELETE FROM " + tableName;
+    deleteCmd += " WHERE ProjectName = '"  + ProjectName +
+            "' AND ForecastName = '"       + ForecastName +
+            "' AND Algorithm = '"          + Algorithm +
+            "' AND Minimizer = '"          + Minimizer +
+            "' AND ObjectiveCriterion = '" + ObjectiveCriterion +
+            "' AND Scaling = '"            + Scaling + "'";
+    errorMsg = nmfUpdateDatabase(deleteCmd);
+    if (nmfUtilsQt::isAnError(errorMsg)) {
+        logger->logMsg(nmfConstants::Error,"nmfDatabase::updateForecastBiomassMonteCarlo: DELETE error: " + errorMsg);
+        logger->logMsg(nmfConstants::Error,"cmd: " + deleteCmd);
+        return false;
+    }
+    if (NumRuns == 0) {
+        return true;
+    }
+
+    // The runs are numbered 0..NumRuns-1 so they read back with getForecastBiomassMonteCarlo
+    saveCmd  = "INSERT INTO " + tableName + " (ProjectName,ForecastName,RunNum,Algorithm,Minimizer,ObjectiveCriterion,Scaling,";
+    saveCmd += "SpeName,Year,Value) VALUES ";
+    for (int run=0; run<NumRuns; ++run) {
+        for (int species=0; species<NumSpecies; ++species) {
+            for (int time=0; time<int(SampledBiomass[run].size1()); ++time) {
+                saveCmd += "('"   + ProjectName +
+                            "','" + ForecastName +
+                            "',"  + std::to_string(run) +
+                            ",'"  + Algorithm +
+                            "','" + Minimizer +
+                            "','" + ObjectiveCriterion +
+                            "','" + Scaling +
+                            "','" + SpeciesNames[species] +
+                            "',"  + std::to_string(time) +
+                            ","   + std::to_string(SampledBiomass[run](time,species)) + "),";
+            }
+        }
+    }
+    saveCmd = saveCmd.substr(0,saveCmd.size()-1);
+
+    errorMsg = nmfUpdateDatabase(saveCmd);
+    if (nmfUtilsQt::isAnError(errorMsg)) {
+        logger->logMsg(nmfConstants::Error,"[Error] nmfDatabase::updateForecastBiomassMonteCarlo: Write table error: " + errorMsg);
+        logger->logMsg(nmfConstants::Error,"saveCmd: " + saveCmd);
+        return false;
+    }
+
+    return true;
+}
+
+bool
+nmfDatabase::updateForecastMonteCarloSummary(
+        nmfLogger*           logger,
+        const std::string&   ProjectName,
+        const std::string&   ForecastName,
+        const std::string&   Algorithm,
+        const std::string&   Minimizer,
+        const std::string&   ObjectiveCriterion,
+        const std::string&   Scaling,
+        const std::vector<std::string>& SpeciesNames,
+        const std::vector<double>& Quantiles,
+        const std::vector<boost::numeric::ublas::matrix<double> >& QuantileBiomass,
+        const boost::numeric::ublas::matrix<double>& MeanBiomass,
+        const boost::numeric::ublas::matrix<double>& MinBiomass,
+        const boost::numeric::ublas::matrix<double>& MaxBiomass)
+{
+    int NumQuantiles = std::min(Quantiles.size(),QuantileBiomass.size());
+    int NumSpecies = SpeciesNames.size();
+    int NumRows = 0;
+    std::string saveCmd;
+    std::string deleteCmd;
+    std::string errorMsg;
+    std::string tableName = "ForecastBiomassMonteCarloSummary";
+    std::vector<std::string> Statistics;
+    std::vector<double> StatisticQuantiles;
+    std::vector<const boost::numeric::ublas::matrix<double>* > StatisticBiomass;
+
+    checkForTableAndCreate(QString::fromStdString(tableName));
+
+    deleteCmd  = "DELETE FROM " + tableName;
+    deleteCmd += " WHERE ProjectName = '"  + ProjectName +
+            "' AND ForecastName = '"       + ForecastName +
+            "' AND Algorithm = '"          + Algorithm +
+            "' AND Minimizer = '"          + Minimizer +
+            "' AND ObjectiveCriterion = '" + ObjectiveCriterion +
+            "' AND Scaling = '"            + Scaling + "'";
+    errorMsg = nmfUpdateDatabase(deleteCmd);
+    if (nmfUtilsQt::isAnError(errorMsg)) {
+        logger->logMsg(nmfConstants::Error,"nmfDatabase::updateForecastMonteCarloSummary: DELETE error: " + errorMsg);
+        logger->logMsg(nmfConstants::Error,"cmd: " + deleteCmd);
+        return false;
+    }
+
+    // One row per statistic, species, and year
+    Statistics         = {"Mean","Min","Max"};
+    StatisticQuantiles = {0,0,0};
+    StatisticBiomass   = {&MeanBiomass,&MinBiomass,&MaxBiomass};
+    for (int quantile=0; quantile<NumQuantiles; ++quantile) {
+        Statistics.push_back("Quantile");
+        StatisticQuantiles.push_back(Quantiles[quantile]);
+        StatisticBiomass.push_back(&QuantileBiomass[quantile]);
+    }
+
+    saveCmd  = "INSERT INTO " + tableName + " (ProjectName,ForecastName,Algorithm,Minimizer,ObjectiveCriterion,Scaling,";
+    saveCmd += "SpeName,Year,Statistic,Quantile,Value) VALUES ";
+    for (int statistic=0; statistic<int(Statistics.size()); ++statistic) {
+        const boost::numeric::ublas::matrix<double>& Biomass = *StatisticBiomass[statistic];
+        for (int species=0; species<std::min(NumSpecies,int(Biomass.size2())); ++species) {
+            for (int time=0; time<int(Biomass.size1()); ++time) {
+                saveCmd += "('"   + ProjectName +
+                            "','" + ForecastName +
+                            "','" + Algorithm +
+                            "','" + Minimizer +
+                            "','" + ObjectiveCriterion +
+                            "','" + Scaling +
+                            "','" + SpeciesNames[species] +
+                            "',"  + std::to_string(time) +
+                            ",'"  + Statistics[statistic] +
+                            "',"  + std::to_string(StatisticQuantiles[statistic]) +
+                            ","   + std::to_string(Biomass(time,species)) + "),";
+                ++NumRows;
+            }
+        }
+    }
+    if (NumRows == 0) {
+        return true;
+    }
+    saveCmd = saveCmd.substr(0,saveCmd.size()-1);
+
+    errorMsg = nmfUpdateDatabase(saveCmd);
+    if (nmfUtilsQt::isAnError(errorMsg)) {
+        logger->logMsg(nmfConstants::Error,"[Error] nmfDatabase::updateForecastMonteCarloSummary: Write table error: " + errorMsg);
+        logger->logMsg(nmfConstants::Error,"saveCmd: " + saveCmd);
+        return false;
+    }
+
+    return true;
+}
+
 
 bool
 nmfDatabase::getAllTables(std::vector<std::string>& databaseTables)
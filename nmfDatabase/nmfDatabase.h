@@ -294,6 +294,30 @@ public:
             std::vector<double>& PredationRandomValues,
             std::vector<double>& HandlingRandomValues,
             std::vector<double>& HarvestRandomValues);
+    bool updateForecastBiomassMonteCarlo(
+            nmfLogger*           logger,
+            const std::string&   ProjectName,
+            const std::string&   ForecastName,
+            const std::string&   Algorithm,
+            const std::string&   Minimizer,
+            const std::string&   ObjectiveCriterion,
+            const std::string&   Scaling,
+            const std::vector<std::string>& SpeciesNames,
+            const std::vector<boost::numeric::ublas::matrix<double> >& SampledBiomass);
+    bool updateForecastMonteCarloSummary(
+            nmfLogger*           logger,
+            const std::string&   ProjectName,
+            const std::string&   ForecastName,
+            const std::string&   Algorithm,
+            const std::string&   Minimizer,
+            const std::string&   ObjectiveCriterion,
+            const std::string&   Scaling,
+            const std::vector<std::string>& SpeciesNames,
+            const std::vector<double>& Quantiles,
+            const std::vector<boost::numeric::ublas::matrix<double> >& QuantileBiomass,
+            const boost::numeric::ublas::matrix<double>& MeanBiomass,
+            const boost::numeric::ublas::matrix<double>& MinBiomass,
+            const boost::numeric::ublas::matrix<double>& MaxBiomass);
 
     QStringList getVectorParameterNames(
             nmfLogger*   logger,
@@ -668,6 +692,7 @@ public:
     static void createForeSRR(QString &table, QString &qcmd);
     static void createForeSuitPreyBiomass(QString &table, QString &qcmd);
     static void createForecasts(QString &table, QString &qcmd);
+    static void createForecastBiomassMonteCarloSummary(QString &table, QString &qcmd);
     static void createMSVPAEnergyDens(QString &table, QString &qcmd);
     static void createMSVPAOthPrey(QString &table, QString &qcmd);
     static void createMSVPAOthPreyAnn(QString &table, QString &qcmd);
@@ -230,6 +230,26 @@ nmfDatabase::createForecasts(QString &table, QString &qcmd)
     qcmd += " PRIMARY KEY (MSVPAName,ForeName))";
 
 } // end createForecasts
+
+void
+nmfDatabase::createForecastBiomassMonteCarloSummary(QString &table, QString &qcmd)
+{
+    // Statistic is Mean, Min, Max, or Quantile (Quantile is 0 for the others)
+    qcmd  = "CREATE TABLE IF NOT EXISTS " + table;
+    qcmd += "(ProjectName        VARCHAR(100) NOT NULL,";
+    qcmd += " ForecastName       VARCHAR(100) NOT NULL,";
+    qcmd += " Algorithm          VARCHAR(50)  NOT NULL,";
+    qcmd += " Minimizer          VARCHAR(50)  NOT NULL,";
+    qcmd += " ObjectiveCriterion VARCHAR(50)  NOT NULL,";
+    qcmd += " Scaling            VARCHAR(50)  NOT NULL,";
+    qcmd += " SpeName            VARCHAR(100) NOT NULL,";
+    qcmd += " Year               int(11)      NOT NULL,";
+    qcmd += " Statistic          VARCHAR(20)  NOT NULL,";
+    qcmd += " Quantile           double       NOT NULL,";
+    qcmd += " Value              double,";
+    qcmd += " PRIMARY KEY (ProjectName,ForecastName,Algorithm,Minimizer,ObjectiveCriterion,Scaling,SpeName,Year,Statistic,Quantile))";
+
+} // end createForecastBiomassMonteCarloSummary
 void
 nmfDatabase::createMSVPAEnergyDens(QString &table, QString &qcmd)
 {
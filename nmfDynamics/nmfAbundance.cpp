@@ -4,6 +4,7 @@
 #include "nmfConstantsMSCAA.h"
 #include "nmfConstants.h"
 
+#include <thread>
 
 
 nmfAbundance::nmfAbundance(
@@ -20,6 +21,8 @@ nmfAbundance::nmfAbundance(
     m_databasePtr = databasePtr;
     m_logger      = logger;
     m_nuOther     = 0;
+    m_NumThreads  = 1;
+    m_UsePredationContraction = true;
     m_ModelName.clear();
     m_PreferredRatioEta.clear();
     m_PreferredGTRatio.clear();
@@ -36,10 +39,12 @@ nmfAbundance::nmfAbundance(
 
     ReadSettings();
 
+    m_SystemStruct.NumSpecies = 0;
+    m_SystemStruct.NumYears   = 0;
+    m_SystemStruct.NumAges    = 0;
+
     int NumYears;
     int NumAges;
-    int MinAge,MaxAge,FirstYear,LastYear,NumLengthBins;
-    float MinLength,MaxLength;
     std::vector<std::string> allSpecies;
 
 
@@ -71,114 +76,179 @@ nmfAbundance::nmfAbundance(
     // Get all the species names
     m_databasePtr->getAllSpecies(m_logger,allSpecies);
 
-    // Initialize weight, initial abundance, consumption, and maturity
+    // Load the species data and all of the weight, initial abundance, consumption,
+    // maturity, mortality, and catch tables with one query per table. These don't
+    // change during a run so the simulation only reads from these in memory copies.
+    if (! getSpeciesData(allSpecies)) {
+        m_logger->logMsg(nmfConstants::Warning,"No Species data found.");
+        return;
+    }
+    getYearAgeData(  allSpecies,"Weight",          m_WeightMap);
+    getYearAgeData(  allSpecies,"InitialAbundance",m_InitialAbundance);
+    getYearAgeData(  allSpecies,"Consumption",     m_ConsumptionBiomassRatio);
+    getYearAgeData(  allSpecies,"Maturity",        m_Maturity);
+    getMortalityData(allSpecies,"MortalityNatural",m_NaturalMortality);
+    getMortalityData(allSpecies,"MortalityFishing",m_FishingMortality);
+    getFisheryCatch( allSpecies,"CatchFishery",    m_FisheryCatch);
+
     for (std::string species : allSpecies) {
-        m_databasePtr->getSpeciesData(m_logger,species,
-                                      MinAge,MaxAge,FirstYear,LastYear,
-                                      MinLength,MaxLength,NumLengthBins);
-        NumYears = LastYear - FirstYear + 1;
-        NumAges  = MaxAge - MinAge + 1;
-
-        getYearAgeData(  species,NumYears,NumAges,"Weight",          m_WeightMap);
-        getYearAgeData(  species,NumYears,NumAges,"InitialAbundance",m_InitialAbundance);
-        getYearAgeData(  species,NumYears,NumAges,"Consumption",     m_ConsumptionBiomassRatio);
-        getYearAgeData(  species,NumYears,NumAges,"Maturity",        m_Maturity);
-        getMortalityData(species,NumYears,NumAges,"MortalityNatural",m_NaturalMortality);
-        getMortalityData(species,NumYears,NumAges,"MortalityFishing",m_FishingMortality);
-        getFisheryCatch( species,NumYears,NumAges,"CatchFishery",    m_FisheryCatch);
+        NumYears = m_SpeciesData[species].LastYear - m_SpeciesData[species].FirstYear + 1;
+        NumAges  = m_SpeciesData[species].MaxAge   - m_SpeciesData[species].MinAge    + 1;
+        m_SystemStruct.NumYears = std::max(m_SystemStruct.NumYears,NumYears);
+        m_SystemStruct.NumAges  = std::max(m_SystemStruct.NumAges, NumAges);
 
         // Store initial abundance into Abundance as well as mortalities
         Abundance[species]        = m_InitialAbundance[species];
         NaturalMortality[species] = m_NaturalMortality[species];
         FishingMortality[species] = m_FishingMortality[species];
     }
+    m_SystemStruct.NumSpecies = allSpecies.size();
+}
+
+bool
+nmfAbundance::getSpeciesData(const std::vector<std::string>& AllSpecies)
+{
+    int NumRecords;
+    std::vector<std::string> fields;
+    std::map<std::string, std::vector<std::string> > dataMap;
+    std::string queryStr;
+    std::string msg;
+    AbundanceSpeciesStruct SpeciesData;
+
+    m_SpeciesData.clear();
+
+    fields     = {"SpeName","MinAge","MaxAge","FirstYear","LastYear","MinLength","MaxLength","NumLengthBins"};
+    queryStr   = "SELECT SpeName,MinAge,MaxAge,FirstYear,LastYear,MinLength,MaxLength,NumLengthBins FROM Species";
+    dataMap    = m_databasePtr->nmfQueryDatabase(queryStr, fields);
+    NumRecords = dataMap["SpeName"].size();
+    for (int i=0; i<NumRecords; ++i) {
+        SpeciesData.MinAge        = std::stoi(dataMap["MinAge"][i]);
+        SpeciesData.MaxAge        = std::stoi(dataMap["MaxAge"][i]);
+        SpeciesData.FirstYear     = std::stoi(dataMap["FirstYear"][i]);
+        SpeciesData.LastYear      = std::stoi(dataMap["LastYear"][i]);
+        SpeciesData.MinLength     = std::stof(dataMap["MinLength"][i]);
+        SpeciesData.MaxLength     = std::stof(dataMap["MaxLength"][i]);
+        SpeciesData.NumLengthBins = std::stoi(dataMap["NumLengthBins"][i]);
+        m_SpeciesData[dataMap["SpeName"][i]] = SpeciesData;
+    }
+
+    for (std::string species : AllSpecies) {
+        if (m_SpeciesData.find(species) == m_SpeciesData.end()) {
+            msg = "nmfAbundance::getSpeciesData: No records found in Species for: " + species;
+            m_logger->logMsg(nmfConstants::Error,msg);
+            return false;
+        }
+    }
+
+    return true;
 }
 
 void
-nmfAbundance::getFisheryCatch(const std::string &Species,
-                              const int &NumYears,
-                              const int &NumAges,
+nmfAbundance::getSpeciesRecordRanges(
+        std::vector<std::string>& SpeNames,
+        std::map<std::string,std::pair<int,int> >& Ranges)
+{
+    int NumRecords = SpeNames.size();
+    int first = 0;
+
+    Ranges.clear();
+    for (int m = 1; m <= NumRecords; ++m) {
+        if ((m == NumRecords) || (SpeNames[m] != SpeNames[first])) {
+            Ranges[SpeNames[first]] = std::make_pair(first,m-first);
+            first = m;
+        }
+    }
+}
+
+void
+nmfAbundance::getFisheryCatch(const std::vector<std::string>& AllSpecies,
                               const std::string TableName,
                               std::map<std::string,boost::numeric::ublas::matrix<double> >& TableData)
 {
-    if (! getFleetCatchTotals(Species,NumYears,NumAges,TableName,TableData)) {
+    if (! getFleetCatchTotals(AllSpecies,TableName,TableData)) {
         m_logger->logMsg(nmfConstants::Warning,"No " + TableName + " Year-Age data found.");
         return;
     }
 }
 
 bool
-nmfAbundance::getFleetCatchTotals(const std::string &Species,
-                                  const int &NumYears,
-                                  const int &NumAges,
+nmfAbundance::getFleetCatchTotals(const std::vector<std::string>& AllSpecies,
                                   const std::string &TableName,
                                   std::map<std::string,boost::numeric::ublas::matrix<double> >& m_FisheryCatch)
 {
+    bool retv = true;
     int m;
+    int first;
     int NumRecords;
     int NumFleets;
+    int NumYears;
+    int NumAges;
     std::vector<std::string> fields;
     std::map<std::string, std::vector<std::string> > dataMap;
+    std::map<std::string,std::pair<int,int> > ranges;
     std::string queryStr;
     std::string msg;
     std::string units;
-    double sf = 1.0;
+    double sf;
     boost::numeric::ublas::matrix<double> tempMatrix;
 
-    // Find number of fleets for the species
-    fields = {"NumFleets"};
-    queryStr  = "SELECT COUNT(DISTINCT(Fleet)) AS NumFleets FROM " + TableName;
-    queryStr += " WHERE ModelName = '" + m_ModelName + "'";
-    queryStr += " AND SpeName = '" + Species + "'";
-    dataMap   = m_databasePtr->nmfQueryDatabase(queryStr, fields);
-    NumFleets = std::stoi(dataMap["NumFleets"][0]);
-
-    // Sum up yearly totals per fleet per age
+    // Sum up yearly totals per fleet per age for all species at once
     fields     = {"ModelName","SpeName","Fleet","Year","Age","Value","Units"};
     queryStr   = "SELECT ModelName,SpeName,Fleet,Year,Age,Value,Units FROM " + TableName;
     queryStr  += " WHERE ModelName = '" + m_ModelName + "'";
-    queryStr  += " AND SpeName = '" + Species + "'";
-    queryStr  += " ORDER BY Fleet,Year,Age";
+    queryStr  += " ORDER BY SpeName,Fleet,Year,Age";
     dataMap    = m_databasePtr->nmfQueryDatabase(queryStr, fields);
-    NumRecords = dataMap["SpeName"].size();
+    getSpeciesRecordRanges(dataMap["SpeName"],ranges);
 
-    if (NumFleets == 0) {
-        msg = "ByYear: No fleets found in table: " + TableName;
-        m_logger->logMsg(nmfConstants::Error,msg);
-        return false;
-    }
-    if (NumRecords == 0) {
-        msg = "ByYear: No records found in table: " + TableName;
-        m_logger->logMsg(nmfConstants::Error,msg);
-        return false;
-    }
-    if (NumRecords != NumFleets*NumYears*NumAges) {
-        msg  = "ByYear: Incorrect number of records found in table: " + TableName + "\n";
-        msg += "Found " + std::to_string(NumRecords) + " records.\n";
-        msg += "Expecting NumFleets*NumYears*NumAges: " + std::to_string(NumFleets*NumYears*NumAges);
-        m_logger->logMsg(nmfConstants::Error,msg);
-        return false;
-    }
-    nmfUtils::initialize(tempMatrix,NumYears,NumAges);
-
-    // Get scalefactor from units.  Put values into units of fish.
-    units = dataMap["Units"][0];
-    if (units == "000 Fish")
-        sf = 0.001;
-    else if (units == "000 000 Fish")
-        sf = 0.000001;
-
-    m = 0;
-    for (int Fleet = 0; Fleet < NumFleets; ++Fleet) {
-        for (int Year = 0; Year < NumYears; ++Year) {
-            for (int Age = 0; Age < NumAges; ++Age) {
-                tempMatrix(Year,Age) += sf*std::stod(dataMap["Value"][m++]);
+    for (std::string Species : AllSpecies) {
+        NumYears = m_SpeciesData[Species].LastYear - m_SpeciesData[Species].FirstYear + 1;
+        NumAges  = m_SpeciesData[Species].MaxAge   - m_SpeciesData[Species].MinAge    + 1;
+        if (ranges.find(Species) == ranges.end()) {
+            msg = "ByYear: No records found in table: " + TableName + " for Species: " + Species;
+            m_logger->logMsg(nmfConstants::Error,msg);
+            retv = false;
+            continue;
+        }
+        first      = ranges[Species].first;
+        NumRecords = ranges[Species].second;
+
+        // Find number of fleets for the species (the records are ordered by fleet)
+        NumFleets = 1;
+        for (m = first+1; m < first+NumRecords; ++m) {
+            if (dataMap["Fleet"][m] != dataMap["Fleet"][m-1]) {
+                ++NumFleets;
             }
         }
+        if (NumRecords != NumFleets*NumYears*NumAges) {
+            msg  = "ByYear: Incorrect number of records found in table: " + TableName + "\n";
+            msg += "Found " + std::to_string(NumRecords) + " records.\n";
+            msg += "Expecting NumFleets*NumYears*NumAges: " + std::to_string(NumFleets*NumYears*NumAges);
+            m_logger->logMsg(nmfConstants::Error,msg);
+            retv = false;
+            continue;
+        }
+        nmfUtils::initialize(tempMatrix,NumYears,NumAges);
+
+        // Get scalefactor from units.  Put values into units of fish.
+        sf = 1.0;
+        units = dataMap["Units"][first];
+        if (units == "000 Fish")
+            sf = 0.001;
+        else if (units == "000 000 Fish")
+            sf = 0.000001;
+
+        m = first;
+        for (int Fleet = 0; Fleet < NumFleets; ++Fleet) {
+            for (int Year = 0; Year < NumYears; ++Year) {
+                for (int Age = 0; Age < NumAges; ++Age) {
+                    tempMatrix(Year,Age) += sf*std::stod(dataMap["Value"][m++]);
+                }
+            }
+        }
+        m_FisheryCatch[Species] = tempMatrix;
     }
-    m_FisheryCatch[Species] = tempMatrix;
 
-    return true;
+    return retv;
 }
 
 bool
@@ -233,43 +303,122 @@ nmfAbundance::getSpeciesParameters(
 }
 
 void
-nmfAbundance::getMortalityData(const std::string& species,
-                               const int& numYears,
-                               const int& numAges,
+nmfAbundance::getMortalityData(const std::vector<std::string>& AllSpecies,
                                const std::string tableName,
                                std::map<std::string,boost::numeric::ublas::matrix<double> >& tableMap)
 {
+    int m;
+    int last;
+    int NumYears;
+    int NumAges;
+    int FirstYear,LastYear,VeryFirstYear;
+    std::vector<std::string> fields;
+    std::map<std::string, std::vector<std::string> > dataMap;
+    std::map<std::string,std::pair<int,int> > ranges;
+    std::string queryStr;
     boost::numeric::ublas::matrix<double> tempMatrix;
 
-    if (! m_databasePtr->getMortalityData(
-                m_logger,m_ModelName,species,
-                numYears,numAges,tableName,tempMatrix)) {
-        m_logger->logMsg(nmfConstants::Warning,"No " + tableName + " data found.");
-        return;
+    // Same segment format as nmfDatabase::getMortalityData but for all species at once
+    fields     = {"ModelName","SpeName","Segment","ColName","Value"};
+    queryStr   = "SELECT ModelName,SpeName,Segment,ColName,Value FROM " + tableName;
+    queryStr  += " WHERE ModelName = '" + m_ModelName + "'";
+    queryStr  += " ORDER BY SpeName,Segment";
+    dataMap    = m_databasePtr->nmfQueryDatabase(queryStr, fields);
+    getSpeciesRecordRanges(dataMap["SpeName"],ranges);
+
+    for (std::string species : AllSpecies) {
+        if (ranges.find(species) == ranges.end()) {
+            m_logger->logMsg(nmfConstants::Warning,"No " + tableName + " data found.");
+            continue;
+        }
+        NumYears = m_SpeciesData[species].LastYear - m_SpeciesData[species].FirstYear + 1;
+        NumAges  = m_SpeciesData[species].MaxAge   - m_SpeciesData[species].MinAge    + 1;
+        nmfUtils::initialize(tempMatrix,NumYears,NumAges);
+
+        m    = ranges[species].first;
+        last = m + ranges[species].second;
+        VeryFirstYear = std::stoi(dataMap["Value"][m]);
+        while (m < last) {
+            FirstYear = std::stoi(dataMap["Value"][m++]);
+            LastYear  = std::stoi(dataMap["Value"][m++]);
+            for (int year=FirstYear; year<=LastYear; ++year) {
+                if (year == FirstYear) {
+                    for (int age=0; age<NumAges; ++age) {
+                        tempMatrix(year-VeryFirstYear,age) =
+                                std::stod(dataMap["Value"][m++]);
+                    }
+                } else {
+                    for (int age=0; age<NumAges; ++age) {
+                        tempMatrix(year-VeryFirstYear,age) =
+                                tempMatrix(year-VeryFirstYear-1,age);
+                    }
+                }
+            }
+        }
+        tableMap[species] = tempMatrix;
     }
-    tableMap[species] = tempMatrix;
 }
 
 void
-nmfAbundance::getYearAgeData(const std::string& species,
-                             const int& numYears,
-                             const int& numAges,
+nmfAbundance::getYearAgeData(const std::vector<std::string>& AllSpecies,
                              const std::string tableName,
                              std::map<std::string,boost::numeric::ublas::matrix<double> >& tableMap)
 {
+    int m;
+    int NumYears;
+    int NumYears2;
+    int NumAges;
+    int NumRecords;
+    std::vector<std::string> fields;
+    std::map<std::string, std::vector<std::string> > dataMap;
+    std::map<std::string,std::pair<int,int> > ranges;
+    std::string queryStr;
+    std::string msg;
+    double sf;
     boost::numeric::ublas::matrix<double> tempMatrix;
 
-    if (! getDatabaseData(species,numYears,numAges,tableName, tempMatrix)) {
-        m_logger->logMsg(nmfConstants::Warning,"No " + tableName + " Year-Age data found for Species: "+species);
-        return;
+    // Same as getDatabaseData but for all species at once
+    fields     = {"ModelName","SpeName","Year","Age","Value","Units"};
+    queryStr   = "SELECT ModelName,SpeName,Year,Age,Value,Units FROM " + tableName;
+    queryStr  += " WHERE ModelName = '" + m_ModelName + "'";
+    queryStr  += " ORDER BY SpeName,Year,Age";
+    dataMap    = m_databasePtr->nmfQueryDatabase(queryStr, fields);
+    getSpeciesRecordRanges(dataMap["SpeName"],ranges);
+
+    for (std::string species : AllSpecies) {
+        NumYears   = m_SpeciesData[species].LastYear - m_SpeciesData[species].FirstYear + 1;
+        NumAges    = m_SpeciesData[species].MaxAge   - m_SpeciesData[species].MinAge    + 1;
+        NumYears2  = (tableName == "InitialAbundance") ? 1 : NumYears;
+        NumRecords = (ranges.find(species) == ranges.end()) ? 0 : ranges[species].second;
+        if (NumRecords == 0) {
+            msg = "Error: nmfAbundance::getYearAgeData: No records found in table: " + tableName;
+            m_logger->logMsg(nmfConstants::Error,msg);
+            m_logger->logMsg(nmfConstants::Warning,"No " + tableName + " Year-Age data found for Species: "+species);
+            continue;
+        }
+        if (NumRecords != NumYears2*NumAges) {
+            msg = "Error: nmfAbundance::getYearAgeData: Incorrect number of records found in table: " + tableName + "\n";
+            msg += "Found " + std::to_string(NumRecords) + " records.\n";
+            msg += "Calculated NumYears2*NumAges (" +
+                    std::to_string(NumYears2) + "*" +
+                    std::to_string(NumAges) + "=" +
+                    std::to_string(NumYears2*NumAges) + ") records.";
+            m_logger->logMsg(nmfConstants::Error,msg);
+            m_logger->logMsg(nmfConstants::Warning,"No " + tableName + " Year-Age data found for Species: "+species);
+            continue;
+        }
+        nmfUtils::initialize(tempMatrix,NumYears,NumAges);
+
+        // Scale to kilograms if Weight table
+        m  = ranges[species].first;
+        sf = ((tableName == "Weight") && (dataMap["Units"][m] == "Grams")) ? 1000.0 : 1.0;
+        for (int year = 0; year < NumYears2; ++year) {
+            for (int age = 0; age < NumAges; ++age) {
+                tempMatrix(year,age) = sf*std::stod(dataMap["Value"][m++]);
+            }
+        }
+        tableMap[species] = tempMatrix;
     }
-    tableMap[species] = tempMatrix;
-//    if (tableName == "InitialAbundance") {
-//        m_Abundance[species] = tempMatrix;
-//qDebug() << "Loaded abundance for :" << QString::fromStdString(species)
-//         << ", size1 and 2: " << m_Abundance[species].size1() <<
-//            m_Abundance[species].size2();
-//    }
 }
 
 void
@@ -491,46 +640,129 @@ nmfAbundance::getDatabaseData(
 }
 
 
+void
+nmfAbundance::internSpecies(const std::vector<std::string>& AllSpecies)
+{
+    int NumSpecies = AllSpecies.size();
+    int NumYears   = 0;
+    int NumAges    = 0;
+
+    if (AllSpecies == m_SpeciesNames) {
+        return;
+    }
+    m_SpeciesNames = AllSpecies;
+    m_NumYears.assign(NumSpecies,0);
+    m_NumAges.assign(NumSpecies,0);
+    m_NumConsumptionYears.assign(NumSpecies,0);
+
+    for (int species = 0; species < NumSpecies; ++species) {
+        m_NumYears[species]            = m_WeightMap[AllSpecies[species]].size1();
+        m_NumAges[species]             = m_WeightMap[AllSpecies[species]].size2();
+        m_NumConsumptionYears[species] = m_ConsumptionBiomassRatio[AllSpecies[species]].size1();
+        NumYears = std::max(NumYears,m_NumYears[species]);
+        NumYears = std::max(NumYears,m_NumConsumptionYears[species]);
+        NumAges  = std::max(NumAges, m_NumAges[species]);
+    }
+
+    // Copy the weights and consumption to biomass ratios into flat arrays indexed by species id
+    m_Weight.resize(NumYears,NumSpecies,NumAges);
+    m_Consumption.resize(NumYears,NumSpecies,NumAges);
+    for (int species = 0; species < NumSpecies; ++species) {
+        const boost::numeric::ublas::matrix<double>& weight      = m_WeightMap[AllSpecies[species]];
+        const boost::numeric::ublas::matrix<double>& consumption = m_ConsumptionBiomassRatio[AllSpecies[species]];
+        for (int year = 0; year < int(weight.size1()); ++year) {
+            for (int age = 0; age < int(weight.size2()); ++age) {
+                m_Weight(year,species,age) = weight(year,age);
+            }
+        }
+        for (int year = 0; year < int(consumption.size1()); ++year) {
+            for (int age = 0; age < std::min(NumAges,int(consumption.size2())); ++age) {
+                m_Consumption(year,species,age) = consumption(year,age);
+            }
+        }
+    }
+}
+
+void
+nmfAbundance::setNumThreads(const int& numThreads)
+{
+    m_NumThreads = (numThreads > 0) ? numThreads : int(std::thread::hardware_concurrency());
+    m_NumThreads = std::max(1,m_NumThreads);
+}
+
+int
+nmfAbundance::getNumThreads()
+{
+    return m_NumThreads;
+}
+
+void
+nmfAbundance::setUsePredationContraction(const bool& usePredationContraction)
+{
+    m_UsePredationContraction = usePredationContraction;
+}
+
+void
+nmfAbundance::runTasks(const int& NumTasks,
+                       const std::function<void(const int& taskNum)>& task)
+{
+    // A task only writes to its own slots so no locking is needed
+    nmfUtils::runWorkers(m_NumThreads,NumTasks,[&](const nmfUtils::NextTask& nextTask) {
+        int taskNum;
+        while (nextTask(taskNum)) {
+            task(taskNum);
+        }
+    });
+}
+
 void
 nmfAbundance::calculateSizePreference(
         const std::vector<std::string>& AllSpecies,
         const boost::numeric::ublas::matrix<double>& PreferredRatioEta,
         const boost::numeric::ublas::matrix<double>& PreferredLTRatio,
         const boost::numeric::ublas::matrix<double>& PreferredGTRatio,
-        Boost5DArrayDouble& SizePreferenceG)
+        nmfPredatorPreyTensor& SizePreferenceG)
 {
-    int predNum = -1;
-    int preyNum = -1;
-    double weightFactor;
-    double variance;
-    double weightRatio;
-    double eta;
+    int NumSpecies = AllSpecies.size();
+    int NumYears;
+
+    internSpecies(AllSpecies);
 
     // RSK - This assumes all species have same num years!!
-    for (int year = 0; year < int(m_WeightMap[AllSpecies[0]].size1()); ++year) {
-        preyNum = -1;
-        for (std::string preySpecies : AllSpecies) {
-            ++preyNum;
-            for (int preyAge = 0; preyAge < int(m_WeightMap[preySpecies].size2()); ++preyAge) {
-                predNum = -1;
-                for (std::string predSpecies : AllSpecies) {
-                    ++predNum;
-                    for (int predAge = 0; predAge < int(m_WeightMap[predSpecies].size2()); ++predAge) {
-                        weightRatio  = m_WeightMap[predSpecies](year,predAge) /
-                                       m_WeightMap[preySpecies](year,preyAge);
-                        eta = PreferredRatioEta(predNum,preyNum);
+    NumYears = (NumSpecies == 0) ? 0 : m_NumYears[0];
+    runTasks(NumSpecies,[&](const int& predNum) {
+        double weightFactor;
+        double variance;
+        double weightRatio;
+        double eta;
+        double preyWeight;
+        double varianceLT;
+        double varianceGT;
+        const double* predWeight;
+        double* sizePreference;
+
+        for (int year = 0; year < NumYears; ++year) {
+            predWeight = m_Weight.ages(year,predNum);
+            for (int preyNum = 0; preyNum < NumSpecies; ++preyNum) {
+                eta        = PreferredRatioEta(predNum,preyNum);
+                varianceLT = PreferredLTRatio(predNum,preyNum);
+                varianceGT = PreferredGTRatio(predNum,preyNum);
+                for (int preyAge = 0; preyAge < m_NumAges[preyNum]; ++preyAge) {
+                    preyWeight     = m_Weight(year,preyNum,preyAge);
+                    sizePreference = SizePreferenceG.predatorAges(year,preyNum,preyAge,predNum);
+                    for (int predAge = 0; predAge < m_NumAges[predNum]; ++predAge) {
+                        weightRatio  = predWeight[predAge] / preyWeight;
                         weightFactor = std::log(weightRatio) - eta;
-                        variance = (weightRatio < eta) ? PreferredLTRatio(predNum,preyNum) :
-                                                         PreferredGTRatio(predNum,preyNum);
+                        variance = (weightRatio < eta) ? varianceLT : varianceGT;
 
-                        SizePreferenceG[preyNum][preyAge][predNum][predAge][year] =
+                        sizePreference[predAge] =
                                 (variance == 0) ? 0 : std::exp((-1.0/(2.0*variance*variance)) *
                                                       weightFactor*weightFactor);
                     }
                 }
             }
         }
-    }
+    });
 
 }
 
@@ -548,62 +780,58 @@ void
 nmfAbundance::calculateSuitability(
         const std::vector<std::string>& AllSpecies,
         const boost::numeric::ublas::matrix<double>& VulnerabilityRho,
-        Boost5DArrayDouble& SizePreferenceG,
-        Boost5DArrayDouble& VulnerabilityNu)
+        nmfPredatorPreyTensor& SizePreferenceG,
+        nmfPredatorPreyTensor& VulnerabilityNu)
 {
-    int predNum;
-    int preyNum;
-
-    for (int year = 0; year < int(m_WeightMap[AllSpecies[0]].size1()); ++year) {
-        preyNum = -1;
-        for (std::string preySpecies : AllSpecies) {
-            ++preyNum;
-            for (int preyAge = 0; preyAge < int(m_WeightMap[preySpecies].size2()); ++preyAge) {
-                predNum = -1;
-                for (std::string predSpecies : AllSpecies) {
-                    ++predNum;
-                    for (int predAge = 0; predAge < int(m_WeightMap[predSpecies].size2()); ++predAge) {
-                        VulnerabilityNu[preyNum][preyAge][predNum][predAge][year] =
-                                VulnerabilityRho(preyNum,predNum) *
-                                SizePreferenceG[preyNum][preyAge][predNum][predAge][year];
-//std::cout << "*** *** *** VulRho: " << preyNum << "," << predNum << ": " << VulnerabilityRho(preyNum,predNum) << std::endl;
-//std::cout << "valu: " << preyNum << "," << preyAge << "," << predNum << "," << predAge << "," << year << ","
-//          << VulnerabilityRho(preyNum,predNum)
-//          << " * " << SizePreferenceG[preyNum][preyAge][predNum][predAge][year] << std::endl;
-//std::cout << "valu: " << preyNum << "," << preyAge << "," << predNum << "," << predAge << "," << year << ","
-//          << VulnerabilityNu[preyNum][preyAge][predNum][predAge][year] << std::endl;
+    int NumSpecies = AllSpecies.size();
+    int NumYears;
+
+    internSpecies(AllSpecies);
+
+    NumYears = (NumSpecies == 0) ? 0 : m_NumYears[0];
+    runTasks(NumSpecies,[&](const int& predNum) {
+        double rho;
+        const double* sizePreference;
+        double* vulnerability;
+
+        for (int year = 0; year < NumYears; ++year) {
+            for (int preyNum = 0; preyNum < NumSpecies; ++preyNum) {
+                rho = VulnerabilityRho(preyNum,predNum);
+                for (int preyAge = 0; preyAge < m_NumAges[preyNum]; ++preyAge) {
+                    sizePreference = SizePreferenceG.predatorAges(year,preyNum,preyAge,predNum);
+                    vulnerability  = VulnerabilityNu.predatorAges(year,preyNum,preyAge,predNum);
+                    for (int predAge = 0; predAge < m_NumAges[predNum]; ++predAge) {
+                        vulnerability[predAge] = rho * sizePreference[predAge];
                     }
                 }
             }
         }
-    }
+    });
 
 }
 
 void
 nmfAbundance::calculateSuitabilityNuOther(
             const std::vector<std::string>& AllSpecies,
-            const Boost5DArrayDouble& VulnerabilityNu,
+            const nmfPredatorPreyTensor& VulnerabilityNu,
             double& nuOther)
 {
-    int predNum;
-    int NumYears = m_WeightMap[AllSpecies[0]].size1();
+    int NumSpecies = AllSpecies.size();
+    int NumYears   = (NumSpecies == 0) ? 0 : m_NumYears[0];
     double numValues = 0;
 
     // Hack just to find a reasonable nu other value...may need to modify this
     //std::cout << "Using an average nu value for nuOther." << std::endl;
     nuOther = 0;
     for (int year = 0; year < NumYears; ++year) {
-        predNum = -1;
-        for (std::string predSpecies : AllSpecies) {
-            ++predNum;
-            for (int predAge = 0; predAge < int(m_WeightMap[predSpecies].size2()); ++predAge) {
-                nuOther += VulnerabilityNu[0][0][predNum][predAge][year];
+        for (int predNum = 0; predNum < NumSpecies; ++predNum) {
+            for (int predAge = 0; predAge < m_NumAges[predNum]; ++predAge) {
+                nuOther += VulnerabilityNu(year,0,0,predNum,predAge);
                 ++numValues;
             }
         }
     }
-    nuOther = (numValues == 0) ? 0 : nuOther/= numValues;
+    nuOther = (numValues == 0) ? 0 : nuOther/numValues;
 }
 
 double
@@ -624,13 +852,20 @@ void
 nmfAbundance::calculateScaledSuitability(
     const NuOther& nuOtherUser,
     const std::vector<std::string>& AllSpecies,
-    Boost5DArrayDouble& VulnerabilityNu,
-    Boost5DArrayDouble& ScaledSuitabilityNuTilde,
+    nmfPredatorPreyTensor& VulnerabilityNu,
+    nmfPredatorPreyTensor& ScaledSuitabilityNuTilde,
     double& nuOther)
 {
-    int predNum,preyNum,preyNum2;
-    double nuSum = 0;
+    int NumSpecies = AllSpecies.size();
+    int NumYears;
+    int NumAges = VulnerabilityNu.numAges();
     double den;
+    const double* vulnerability;
+    double* nuSum;
+    double* scaledSuitability;
+    nmfSpeciesAgeTensor NuSum; // Σ ν over all prey and prey ages, per predator and predator age
+
+    internSpecies(AllSpecies);
 
     calculateSuitabilityNuOther(AllSpecies,VulnerabilityNu,nuOther);
     nuOther = (nuOtherUser.useUserNuOther) ?
@@ -638,34 +873,33 @@ nmfAbundance::calculateScaledSuitability(
     setNuOther(nuOther);
 //std::cout << "*** *** Using nu other value of: " << nuOther << std::endl;
 
-    for (int year = 0; year < int(m_WeightMap[AllSpecies[0]].size1()); ++year) {
-        preyNum = -1;
-        for (std::string preySpecies : AllSpecies) {
-            ++preyNum;
-            for (int preyAge = 0; preyAge < int(m_WeightMap[preySpecies].size2()); ++preyAge) {
-                predNum = -1;
-                for (std::string predSpecies : AllSpecies) {
-                    ++predNum;
-
-                    for (int predAge = 0; predAge < int(m_WeightMap[predSpecies].size2()); ++predAge) {
-
-                        nuSum = 0;
-                        preyNum2 = -1;
-                        for (std::string preySpecies2 : AllSpecies) {
-                            ++preyNum2;
-                            for (int preyAge2 = 0; preyAge2 < int(m_WeightMap[preySpecies2].size2()); ++preyAge2) {
-                                nuSum +=  VulnerabilityNu[preyNum2][preyAge2][predNum][predAge][year];
-                            }
-                        }
-
-                        den = nuSum + nuOther;
-                        ScaledSuitabilityNuTilde[preyNum][preyAge][predNum][predAge][year] =
-                             (den == 0) ? 0 :
-                              VulnerabilityNu[preyNum][preyAge][predNum][predAge][year] / den;
-
-//std::cout << "valss: " << preyNum << "," << preyAge << "," << predNum << "," << predAge << "," << year << ","
-//          << VulnerabilityNu[preyNum][preyAge][predNum][predAge][year]
-//          << " / " << nuSum << "+" << nuOther << std::endl;
+    NumYears = (NumSpecies == 0) ? 0 : m_NumYears[0];
+    for (int year = 0; year < NumYears; ++year) {
+
+        // The denominator doesn't depend upon the prey so find it once per
+        // predator age class in a single pass over the prey
+        NuSum.resize(1,NumSpecies,NumAges);
+        for (int preyNum = 0; preyNum < NumSpecies; ++preyNum) {
+            for (int preyAge = 0; preyAge < m_NumAges[preyNum]; ++preyAge) {
+                for (int predNum = 0; predNum < NumSpecies; ++predNum) {
+                    vulnerability = VulnerabilityNu.predatorAges(year,preyNum,preyAge,predNum);
+                    nuSum         = NuSum.ages(0,predNum);
+                    for (int predAge = 0; predAge < m_NumAges[predNum]; ++predAge) {
+                        nuSum[predAge] += vulnerability[predAge];
+                    }
+                }
+            }
+        }
+
+        for (int preyNum = 0; preyNum < NumSpecies; ++preyNum) {
+            for (int preyAge = 0; preyAge < m_NumAges[preyNum]; ++preyAge) {
+                for (int predNum = 0; predNum < NumSpecies; ++predNum) {
+                    vulnerability     = VulnerabilityNu.predatorAges(year,preyNum,preyAge,predNum);
+                    scaledSuitability = ScaledSuitabilityNuTilde.predatorAges(year,preyNum,preyAge,predNum);
+                    nuSum             = NuSum.ages(0,predNum);
+                    for (int predAge = 0; predAge < m_NumAges[predNum]; ++predAge) {
+                        den = nuSum[predAge] + nuOther;
+                        scaledSuitability[predAge] = (den == 0) ? 0 : vulnerability[predAge] / den;
                     }
                 }
             }
@@ -676,16 +910,17 @@ nmfAbundance::calculateScaledSuitability(
 
 bool
 nmfAbundance::getYearlyParameters(
-        const std::string &Species,
-        const int &NumYears,
+        const std::vector<std::string>& AllSpecies,
         const std::string TableName,
         std::map<std::string,std::vector<double> > &SigmaMap,
         std::map<std::string,std::vector<double> > &ZetaMap)
 {
     int m;
+    int NumYears;
     int NumRecords;
     std::vector<std::string> fields;
     std::map<std::string, std::vector<std::string> > dataMap;
+    std::map<std::string,std::pair<int,int> > ranges;
     std::string queryStr;
     std::string msg;
     std::vector<std::string> ParameterNames = {"sigma","zeta"};
@@ -696,101 +931,245 @@ nmfAbundance::getYearlyParameters(
     fields     = {"ModelName","SpeName","Year","ParameterName","Value"};
     queryStr   = "SELECT ModelName,SpeName,Year,ParameterName,Value FROM " + TableName;
     queryStr  += " WHERE ModelName = '" + m_ModelName + "'";
-    queryStr  += " AND SpeName = '" + Species + "'";
-    queryStr  += " ORDER BY ParameterName,Year";
+    queryStr  += " ORDER BY SpeName,ParameterName,Year";
     dataMap    = m_databasePtr->nmfQueryDatabase(queryStr, fields);
-    NumRecords = dataMap["SpeName"].size();
-    if (NumRecords == 0) {
-        msg = "nmfAbundance::getYearlyParameters: No records found in table: " + TableName;
-        m_logger->logMsg(nmfConstants::Error,msg);
-        return false;
-    }
-    if (NumRecords != NumParameters*NumYears) {
-        msg = "nmfAbundance::getYearlyParameters: Incorrect number of records found in table: " + TableName + "\n";
-        msg += "Found " + std::to_string(NumRecords) + " records.\n";
-        msg += "Calculated NumParameters*NumYears (" + std::to_string(NumParameters*NumYears) + ") records.";
-        m_logger->logMsg(nmfConstants::Error,msg);
-        return false;
-    }
+    getSpeciesRecordRanges(dataMap["SpeName"],ranges);
 
-    m = 0;
-    for (int i=0; i<NumYears; ++i) {
-        Sigma.push_back(std::stod(dataMap["Value"][m++]));
-    }
-    for (int i=0; i<NumYears; ++i) {
-        Zeta.push_back(std::stod(dataMap["Value"][m++]));
+    for (std::string Species : AllSpecies) {
+        NumYears   = m_WeightMap[Species].size1();
+        NumRecords = (ranges.find(Species) == ranges.end()) ? 0 : ranges[Species].second;
+        if (NumRecords == 0) {
+            msg = "nmfAbundance::getYearlyParameters: No records found in table: " + TableName;
+            m_logger->logMsg(nmfConstants::Error,msg);
+            return false;
+        }
+        if (NumRecords != NumParameters*NumYears) {
+            msg = "nmfAbundance::getYearlyParameters: Incorrect number of records found in table: " + TableName + "\n";
+            msg += "Found " + std::to_string(NumRecords) + " records.\n";
+            msg += "Calculated NumParameters*NumYears (" + std::to_string(NumParameters*NumYears) + ") records.";
+            m_logger->logMsg(nmfConstants::Error,msg);
+            return false;
+        }
+
+        Sigma.clear();
+        Zeta.clear();
+        m = ranges[Species].first;
+        for (int i=0; i<NumYears; ++i) {
+            Sigma.push_back(std::stod(dataMap["Value"][m++]));
+        }
+        for (int i=0; i<NumYears; ++i) {
+            Zeta.push_back(std::stod(dataMap["Value"][m++]));
+        }
+
+        SigmaMap[Species] = Sigma;
+        ZetaMap[Species]  = Zeta;
     }
 
-    SigmaMap[Species] = Sigma;
-    ZetaMap[Species]  = Zeta;
+    return true;
+}
+
+bool
+nmfAbundance::calculateConsumedBiomass(
+        const int& year,
+        const int& NumSpecies,
+        const nmfSpeciesAgeTensor& Biomass,
+        const nmfSpeciesAgeTensor& BiomassTotalPreyPhi,
+        nmfSpeciesAgeTensor& ConsumedBiomass)
+{
+    const double* consumption;
+    const double* predBiomass;
+    const double* totalPreyPhi;
+
+    ConsumedBiomass.resize(1,NumSpecies,Biomass.numAges());
+
+    // Find each predator age class's consumption once for the year, as it's the same for all prey
+    for (int predNum = 0; predNum < NumSpecies; ++predNum) {
+        if ((m_NumAges[predNum] > 0) && (year >= m_NumConsumptionYears[predNum])) {
+            m_logger->logMsg(nmfConstants::Error,"nmfAbundance::calculatePredation: Found species with different number of years.");
+            return false;
+        }
+        consumption  = m_Consumption.ages(year,predNum);
+        predBiomass  = Biomass.ages(year,predNum);
+        totalPreyPhi = BiomassTotalPreyPhi.ages(year,predNum);
+        for (int predAge = 0; predAge < m_NumAges[predNum]; ++predAge) {
+            if (totalPreyPhi[predAge] == 0) {
+                m_logger->logMsg(nmfConstants::Error,"Found phi divide by 0 error.");
+                return false;
+            }
+            ConsumedBiomass(0,predNum,predAge) = consumption[predAge] * predBiomass[predAge];
+        }
+    }
 
     return true;
 }
 
+void
+nmfAbundance::calculatePreyConsumed(
+        const int& year,
+        const int& NumSpecies,
+        const bool& useContraction,
+        const nmfSpeciesAgeTensor& ConsumedBiomass,
+        const nmfPredatorPreyTensor& BiomassAvailablePreyPhi,
+        const nmfSpeciesAgeTensor& BiomassTotalPreyPhi,
+        std::vector<double>& PreyConsumed)
+{
+    const int RowBlockSize = 64;
+    int NumAges  = ConsumedBiomass.numAges();
+    int NumSlots = NumSpecies*NumAges; // (species, age) slots, species major
+    int NumRowBlocks;
+    nmfSpeciesAgeTensor PredatorConsumption; // (predator, prey, prey age)
+    std::vector<double> PredatorWeight;      // consumed biomass over total available prey, per predator slot
+
+    PreyConsumed.assign(NumSlots,0.0);
+
+    if (useContraction) {
+        // The sum over predators and predator ages is the product of this year's
+        // (prey slot x predator slot) available prey biomass matrix, which is
+        // contiguous in the tensor, with the predator weight vector. Unused age slots
+        // have zero weight. Blocks of prey rows are independent so they're run as
+        // separate tasks and the result doesn't depend upon the number of threads.
+        PredatorWeight.assign(NumSlots,0.0);
+        for (int predNum = 0; predNum < NumSpecies; ++predNum) {
+            for (int predAge = 0; predAge < m_NumAges[predNum]; ++predAge) {
+                PredatorWeight[predNum*NumAges+predAge] =
+                        ConsumedBiomass(0,predNum,predAge) / BiomassTotalPreyPhi(year,predNum,predAge);
+            }
+        }
+        const double* availablePreyPhi = (NumSlots == 0) ? nullptr :
+                BiomassAvailablePreyPhi.predatorAges(year,0,0,0);
+        NumRowBlocks = (NumSlots + RowBlockSize - 1) / RowBlockSize;
+        runTasks(NumRowBlocks,[&](const int& block) {
+            int firstRow = block*RowBlockSize;
+            int numRows  = std::min(RowBlockSize,NumSlots-firstRow);
+            nmfUtils::multiplyBlocked(availablePreyPhi+firstRow*NumSlots,
+                                      PredatorWeight.data(),
+                                      PreyConsumed.data()+firstRow,
+                                      numRows,1,NumSlots);
+        });
+    } else {
+        calculatePredatorConsumption(year,NumSpecies,ConsumedBiomass,
+                                     BiomassAvailablePreyPhi,BiomassTotalPreyPhi,
+                                     PredatorConsumption);
+        // Sum in predator order, so the result doesn't depend upon the number of threads
+        for (int preyNum = 0; preyNum < NumSpecies; ++preyNum) {
+            for (int preyAge = 0; preyAge < m_NumAges[preyNum]; ++preyAge) {
+                for (int predNum = 0; predNum < NumSpecies; ++predNum) {
+                    PreyConsumed[preyNum*NumAges+preyAge] += PredatorConsumption(predNum,preyNum,preyAge);
+                }
+            }
+        }
+    }
+}
+
 void
 nmfAbundance::calculatePredation(
         int year,
         std::vector<std::string>& AllSpecies,
-        Boost3DArrayDouble& Biomass,
-        Boost5DArrayDouble& BiomassAvailablePreyPhi,
-        Boost3DArrayDouble& BiomassTotalPreyPhi,
+        nmfSpeciesAgeTensor& Biomass,
+        nmfPredatorPreyTensor& BiomassAvailablePreyPhi,
+        nmfSpeciesAgeTensor& BiomassTotalPreyPhi,
         std::map<std::string,boost::numeric::ublas::matrix<double> >& PredationMortality,
         std::map<std::string,boost::numeric::ublas::matrix<double> >& AbundanceTable)
 {
-//    int NumYears = 0;
-    int preyNum = -1;
-    int NumPreyAges;
-    int predNum;
-    double doubleSum;
+    int NumSpecies = AllSpecies.size();
+    int NumAges    = Biomass.numAges();
     double value;
     double den;
+    nmfSpeciesAgeTensor ConsumedBiomass;
+    std::vector<double> PreyConsumed;
 
-    for (std::string preySpecies : AllSpecies) {
-//std::cout << preySpecies << std::endl;
-
-        ++preyNum;
-        // NumYears    = m_WeightMap[preySpecies].size1();
-        NumPreyAges = m_WeightMap[preySpecies].size2();
-        for (int preyAge = 0; preyAge < NumPreyAges; ++preyAge) {
-//std::cout << "preyage: " << preyAge << std::endl;
-            doubleSum =  0;
-            predNum   = -1;
-            for (std::string predSpecies : AllSpecies) {
-//std::cout << "  " << predSpecies << std::endl;
-                ++predNum;
-                for (int predAge = 0; predAge < int(m_WeightMap[predSpecies].size2()); ++predAge) {
-                    if (year >= int(m_ConsumptionBiomassRatio[predSpecies].size1())) {
-                        m_logger->logMsg(nmfConstants::Error,"nmfAbundance::calculatePredation: Found species with different number of years.");
-                        return;
-                    }
-//std::cout << "year:    " << year << std::endl;
-//std::cout << "predage: " << predAge << std::endl;
-//std::cout << "sizes: " << m_ConsumptionBiomassRatio[predSpecies].size1() << "," << m_ConsumptionBiomassRatio[predSpecies].size2() << std::endl;
-//std::cout << "m_ConsumptionBiomassRatio: " << predSpecies << "," << year << "," << predAge << ": " << m_ConsumptionBiomassRatio[predSpecies](year,predAge) << std::endl;
-//std::cout << "Biomass: " << predNum << "," << predAge << "," << year << ": " << Biomass[predNum][predAge][year] << std::endl;
-//std::cout << "BiomassAvailablePreyPhi: " << BiomassAvailablePreyPhi[preyNum][preyAge][predNum][predAge][year] << std::endl;
-//std::cout << "  BiomassTotalPreyPhi: " << year << ": " << BiomassTotalPreyPhi[predNum][predAge][year] << std::endl;
-                    if (BiomassTotalPreyPhi[predNum][predAge][year] == 0) {
-                        m_logger->logMsg(nmfConstants::Error,"Found phi divide by 0 error.");
-                        return;
-                    }
-//std::cout << BiomassTotalPreyPhi[predNum][predAge][year] << std::endl; // This is negative...why?
-                    den = BiomassTotalPreyPhi[predNum][predAge][year];
-                    if (den != 0) {
-                        doubleSum += m_ConsumptionBiomassRatio[predSpecies](year,predAge) * Biomass[predNum][predAge][year] *
-                                (BiomassAvailablePreyPhi[preyNum][preyAge][predNum][predAge][year] / den);
-                    }
+    if (! calculateConsumedBiomass(year,NumSpecies,Biomass,BiomassTotalPreyPhi,ConsumedBiomass)) {
+        return;
+    }
+    calculatePreyConsumed(year,NumSpecies,m_UsePredationContraction,ConsumedBiomass,
+                          BiomassAvailablePreyPhi,BiomassTotalPreyPhi,PreyConsumed);
+
+    for (int preyNum = 0; preyNum < NumSpecies; ++preyNum) {
+        // The string keyed tables are only looked up once per prey species
+        boost::numeric::ublas::matrix<double>& preyAbundance       = AbundanceTable[AllSpecies[preyNum]];
+        boost::numeric::ublas::matrix<double>& preyPredation       = PredationMortality[AllSpecies[preyNum]];
+        boost::numeric::ublas::matrix<double>& preyMemberPredation = m_PredationMortality[AllSpecies[preyNum]];
+
+        for (int preyAge = 0; preyAge < m_NumAges[preyNum]; ++preyAge) {
+            den = preyAbundance(year,preyAge) * m_Weight(year,preyNum,preyAge);
+            value = (den == 0) ? 0 : (1.0/den) * PreyConsumed[preyNum*NumAges+preyAge];
+            preyMemberPredation(year,preyAge) = value;
+            preyPredation(year,preyAge)       = value;
+        }
+    }
+}
+
+bool
+nmfAbundance::checkPredationContraction(double& MaxRelativeDifference)
+{
+    const double Tolerance = 1e-12;
+    int NumSpecies = m_SpeciesNames.size();
+    int NumYears   = std::min(m_Biomass.numYears(),int(m_Bother.size()));
+    double scale;
+    nmfSpeciesAgeTensor ConsumedBiomass;
+    std::vector<double> ContractionConsumed;
+    std::vector<double> LoopConsumed;
+
+    MaxRelativeDifference = 0;
+    if (NumYears == 0) {
+        m_logger->logMsg(nmfConstants::Error,"nmfAbundance::checkPredationContraction: No getData results found.");
+        return false;
+    }
 
+    for (int year = 0; year < NumYears; ++year) {
+        if (! calculateConsumedBiomass(year,NumSpecies,m_Biomass,m_BiomassTotalPreyPhi,ConsumedBiomass)) {
+            return false;
+        }
+        calculatePreyConsumed(year,NumSpecies,true,ConsumedBiomass,
+                              m_BiomassAvailablePreyPhi,m_BiomassTotalPreyPhi,ContractionConsumed);
+        calculatePreyConsumed(year,NumSpecies,false,ConsumedBiomass,
+                              m_BiomassAvailablePreyPhi,m_BiomassTotalPreyPhi,LoopConsumed);
+        for (int slot = 0; slot < int(LoopConsumed.size()); ++slot) {
+            scale = std::max(1.0,std::fabs(LoopConsumed[slot]));
+            MaxRelativeDifference = std::max(MaxRelativeDifference,
+                                             std::fabs(ContractionConsumed[slot]-LoopConsumed[slot])/scale);
+        }
+    }
+
+    if (MaxRelativeDifference > Tolerance) {
+        m_logger->logMsg(nmfConstants::Error,"nmfAbundance::checkPredationContraction: Contraction differs from the per predator loops by: " +
+                         std::to_string(MaxRelativeDifference));
+        return false;
+    }
+
+    return true;
+}
+
+void
+nmfAbundance::calculatePredatorConsumption(
+        const int& year,
+        const int& NumSpecies,
+        const nmfSpeciesAgeTensor& ConsumedBiomass,
+        const nmfPredatorPreyTensor& BiomassAvailablePreyPhi,
+        const nmfSpeciesAgeTensor& BiomassTotalPreyPhi,
+        nmfSpeciesAgeTensor& PredatorConsumption)
+{
+    PredatorConsumption.resize(NumSpecies,NumSpecies,ConsumedBiomass.numAges());
+
+    // Each predator's consumption of every prey age class goes into its own slot
+    runTasks(NumSpecies,[&](const int& predNum) {
+        const double* consumedBiomass = ConsumedBiomass.ages(0,predNum);
+        const double* predTotalPreyPhi = BiomassTotalPreyPhi.ages(year,predNum);
+        const double* availablePreyPhi;
+        double sum;
+
+        for (int preyNum = 0; preyNum < NumSpecies; ++preyNum) {
+            for (int preyAge = 0; preyAge < m_NumAges[preyNum]; ++preyAge) {
+                availablePreyPhi = BiomassAvailablePreyPhi.predatorAges(year,preyNum,preyAge,predNum);
+                sum = 0;
+                for (int predAge = 0; predAge < m_NumAges[predNum]; ++predAge) {
+                    sum += consumedBiomass[predAge] *
+                          (availablePreyPhi[predAge] / predTotalPreyPhi[predAge]);
                 }
+                PredatorConsumption(predNum,preyNum,preyAge) = sum;
             }
-            den = AbundanceTable[preySpecies](year,preyAge) *
-                  m_WeightMap[preySpecies](year,preyAge);
-            value = (den == 0) ? 0 : (1.0/den) * doubleSum;
-            m_PredationMortality[preySpecies](year,preyAge) = value;
-            PredationMortality[preySpecies](year,preyAge)   = value;
         }
-//std::cout << "preyAge loop done" << std::endl;
-    }
+    });
 }
 
 void
@@ -799,28 +1178,27 @@ nmfAbundance::calculateBiomassForCurrentYear(
             std::vector<std::string>& AllSpecies,
             std::map<std::string,boost::numeric::ublas::matrix<double> >& WeightMap,
             std::map<std::string,boost::numeric::ublas::matrix<double> >& Abundance,
-            Boost3DArrayDouble& Biomass,
+            nmfSpeciesAgeTensor& Biomass,
             double& sumBiomass)
 {
     int speciesNum = -1;
-    int MinAge,MaxAge,FirstYear,LastYear,NumLengthBins;
-    float MinLength,MaxLength;
+    int NumAges;
     double value;
 
     sumBiomass = 0;
     for (std::string species : AllSpecies) {
         ++speciesNum;
-        m_databasePtr->getSpeciesData(m_logger,
-                                      species,MinAge,MaxAge,FirstYear,LastYear,
-                                      MinLength,MaxLength,NumLengthBins);
-        for (int age = 0; age < MaxAge-MinAge+1; ++age) {
-            value = WeightMap[species](year,age) *
-                    Abundance[species](year,age);
+        NumAges = m_SpeciesData[species].MaxAge - m_SpeciesData[species].MinAge + 1;
+        boost::numeric::ublas::matrix<double>& speciesWeight    = WeightMap[species];
+        boost::numeric::ublas::matrix<double>& speciesAbundance = Abundance[species];
+        for (int age = 0; age < NumAges; ++age) {
+            value = speciesWeight(year,age) *
+                    speciesAbundance(year,age);
             if (value < 0) {
                 m_logger->logMsg(nmfConstants::Error,"Got Biomass < 0. Setting to 0.");
                 value = 0;
             }
-            Biomass[speciesNum][age][year] = value;
+            Biomass(year,speciesNum,age) = value;
 //std::cout << "=========> Biomass " << species << "," << age << "," << year << ": " << value << ", weight: " <<
 //          WeightMap[species](year,age) << std::endl;
             sumBiomass += value;
@@ -832,26 +1210,24 @@ void
 nmfAbundance::calculateBiomassAvailablePreyPhi(
         int year,
         std::vector<std::string>& AllSpecies,
-        Boost5DArrayDouble& ScaledSuitabilityNuTilde,
-        Boost3DArrayDouble& Biomass,
-        Boost5DArrayDouble& BiomassAvailablePreyPhi)
+        nmfPredatorPreyTensor& ScaledSuitabilityNuTilde,
+        nmfSpeciesAgeTensor& Biomass,
+        nmfPredatorPreyTensor& BiomassAvailablePreyPhi)
 {
     // Calculate phi(i,a,j,b,t)
-    int predNum;
-    int preyNum = -1;
-    for (std::string preySpecies : AllSpecies) {
-        ++preyNum;
-        for (int preyAge = 0; preyAge < int(m_WeightMap[preySpecies].size2()); ++preyAge) {
-            predNum = -1;
-            for (std::string predSpecies : AllSpecies) {
-                ++predNum;
-                for (int predAge = 0; predAge < int(m_WeightMap[predSpecies].size2()); ++predAge) {
-                    BiomassAvailablePreyPhi[preyNum][preyAge][predNum][predAge][year] =
-                            ScaledSuitabilityNuTilde[preyNum][preyAge][predNum][predAge][year] *
-                            Biomass[preyNum][preyAge][year];
-//std::cout << "vals: " << preyNum << "," << preyAge << "," << predNum << "," << predAge << "," << year << ","
-//          << ScaledSuitabilityNuTilde[preyNum][preyAge][predNum][predAge][year]
-//          << "," << Biomass[preyNum][preyAge][year] << std::endl;
+    int NumSpecies = AllSpecies.size();
+    double preyBiomass;
+    const double* scaledSuitability;
+    double* availablePreyPhi;
+
+    for (int preyNum = 0; preyNum < NumSpecies; ++preyNum) {
+        for (int preyAge = 0; preyAge < m_NumAges[preyNum]; ++preyAge) {
+            preyBiomass = Biomass(year,preyNum,preyAge);
+            for (int predNum = 0; predNum < NumSpecies; ++predNum) {
+                scaledSuitability = ScaledSuitabilityNuTilde.predatorAges(year,preyNum,preyAge,predNum);
+                availablePreyPhi  = BiomassAvailablePreyPhi.predatorAges(year,preyNum,preyAge,predNum);
+                for (int predAge = 0; predAge < m_NumAges[predNum]; ++predAge) {
+                    availablePreyPhi[predAge] = scaledSuitability[predAge] * preyBiomass;
                 }
             }
         }
@@ -864,38 +1240,36 @@ nmfAbundance::calculateBiomassTotalPreyPhi(
             double nuOther,
             std::vector<std::string>& AllSpecies,
             std::vector<double>& Bother,
-            Boost5DArrayDouble& BiomassAvailablePreyPhi,
-            Boost3DArrayDouble& BiomassTotalPreyPhi)
+            nmfPredatorPreyTensor& BiomassAvailablePreyPhi,
+            nmfSpeciesAgeTensor& BiomassTotalPreyPhi)
 {
-    // Calculate phi(j,b,t)
-    int predNum;
-    int preyNum2;
-    int preyNum = -1;
-    double PhiOther;
-    double sumPhi;
-
-    for (std::string preySpecies : AllSpecies) {
-       ++preyNum;
-       for (int preyAge = 0; preyAge < int(m_WeightMap[preySpecies].size2()); ++preyAge) {
-           predNum = -1;
-           for (std::string predSpecies : AllSpecies) {
-               ++predNum;
-               for (int predAge = 0; predAge < int(m_WeightMap[predSpecies].size2()); ++predAge) {
-                   sumPhi   = 0;
-                   preyNum2 = -1;
-                   for (std::string preySpecies : AllSpecies) {
-                       ++preyNum2;
-                       for (int preyAge2 = 0; preyAge2 < int(m_WeightMap[preySpecies].size2()); ++preyAge2) {
-                           sumPhi += BiomassAvailablePreyPhi[preyNum2][preyAge2][predNum][predAge][year];
-                       }
-                   }
-                   PhiOther = nuOther*Bother[year];
-//std::cout << "=> " << nuOther << "," << Bother[year] << std::endl; // Bother is negative, why?
-                   BiomassTotalPreyPhi[predNum][predAge][year] = PhiOther + sumPhi;
-               }
-           }
-       }
-   }
+    // Calculate phi(j,b,t). Only this year's sums are rebuilt, so a change to one
+    // year's abundance only requires this to be called again for that year.
+    int NumSpecies = AllSpecies.size();
+    int NumAges    = BiomassTotalPreyPhi.numAges();
+    double PhiOther = nuOther*Bother[year];
+    const double* availablePreyPhi;
+    double* sumPhi;
+    nmfSpeciesAgeTensor SumPhi(1,NumSpecies,NumAges);
+
+    // Accumulate the available prey biomass for every predator age class in a single pass over the prey
+    for (int preyNum = 0; preyNum < NumSpecies; ++preyNum) {
+        for (int preyAge = 0; preyAge < m_NumAges[preyNum]; ++preyAge) {
+            for (int predNum = 0; predNum < NumSpecies; ++predNum) {
+                availablePreyPhi = BiomassAvailablePreyPhi.predatorAges(year,preyNum,preyAge,predNum);
+                sumPhi           = SumPhi.ages(0,predNum);
+                for (int predAge = 0; predAge < m_NumAges[predNum]; ++predAge) {
+                    sumPhi[predAge] += availablePreyPhi[predAge];
+                }
+            }
+        }
+    }
+
+    for (int predNum = 0; predNum < NumSpecies; ++predNum) {
+        for (int predAge = 0; predAge < m_NumAges[predNum]; ++predAge) {
+            BiomassTotalPreyPhi(year,predNum,predAge) = PhiOther + SumPhi(0,predNum,predAge);
+        }
+    }
 }
 
 void
@@ -906,7 +1280,6 @@ nmfAbundance::getData(NuOther& nuOtherUser,
                       std::map<std::string,std::vector<double> >& SpawningStockBiomass,
                       std::map<std::string,boost::numeric::ublas::matrix<double> >& PredationMortality)
 {
-std::cout << "nmfAbundance::getData start" << std::endl;
     int NumPreyAges;
     int NumSpecies,NumYears,NumAges;
     double sumBiomass=0;
@@ -918,7 +1291,7 @@ std::cout << "nmfAbundance::getData start" << std::endl;
     double PenultMortality;
     double eFactorLastAge;
     double eFactorPenultAge;
-    std::vector<double> Bother;
+    std::vector<double>& Bother = m_Bother;
     std::vector<double> BiomassAvailablePreyPhiOther;
     std::vector<std::string> AllSpecies;
     std::map<std::string,std::vector<double> > SpawningBiomassValue;
@@ -932,20 +1305,30 @@ std::cout << "nmfAbundance::getData start" << std::endl;
     m_databasePtr->getAllSpecies(m_logger,AllSpecies);
     NumSpecies = AllSpecies.size();
 
-    Boost3DArrayDouble Biomass(boost::extents[NumSpecies][nmfConstants::MaxNumberAges][nmfConstants::MaxNumberYears]);
-    Boost3DArrayDouble BiomassTotalPreyPhi(boost::extents[NumSpecies][nmfConstants::MaxNumberAges][nmfConstants::MaxNumberYears]);
-    Boost3DArrayDouble Predation(boost::extents[NumSpecies][nmfConstants::MaxNumberAges][nmfConstants::MaxNumberYears]);
-    Boost5DArrayDouble SizePreferenceG(boost::extents[NumSpecies][nmfConstants::MaxNumberAges][NumSpecies][nmfConstants::MaxNumberAges][nmfConstants::MaxNumberYears]);
-    Boost5DArrayDouble VulnerabilityNu(boost::extents[NumSpecies][nmfConstants::MaxNumberAges][NumSpecies][nmfConstants::MaxNumberAges][nmfConstants::MaxNumberYears]);
-    Boost5DArrayDouble ScaledSuitabilityNuTilde(boost::extents[NumSpecies][nmfConstants::MaxNumberAges][NumSpecies][nmfConstants::MaxNumberAges][nmfConstants::MaxNumberYears]);
-    Boost5DArrayDouble BiomassAvailablePreyPhi(boost::extents[NumSpecies][nmfConstants::MaxNumberAges][NumSpecies][nmfConstants::MaxNumberAges][nmfConstants::MaxNumberYears]);
-
-    nmfUtils::initialize(SizePreferenceG);
-    nmfUtils::initialize(VulnerabilityNu);
-    nmfUtils::initialize(ScaledSuitabilityNuTilde);
-    nmfUtils::initialize(Biomass);
-    nmfUtils::initialize(BiomassTotalPreyPhi);
-    nmfUtils::initialize(Predation);
+    if ((NumSpecies != m_SystemStruct.NumSpecies) || (m_SystemStruct.NumYears == 0)) {
+        m_logger->logMsg(nmfConstants::Error,"nmfAbundance::getData: System dimensions not loaded for current species.");
+        return;
+    }
+
+    // Size the working arrays from the actual system dimensions (all values start at 0).
+    // The biomass and prey availability terms are kept so recalculateYear can update a
+    // single year afterwards.
+    NumYears = m_SystemStruct.NumYears;
+    NumAges  = m_SystemStruct.NumAges;
+    nmfSpeciesAgeTensor&   Biomass                  = m_Biomass;
+    nmfSpeciesAgeTensor&   BiomassTotalPreyPhi      = m_BiomassTotalPreyPhi;
+    nmfPredatorPreyTensor& ScaledSuitabilityNuTilde = m_ScaledSuitabilityNuTilde;
+    nmfPredatorPreyTensor& BiomassAvailablePreyPhi  = m_BiomassAvailablePreyPhi;
+    nmfPredatorPreyTensor  SizePreferenceG(NumYears,NumSpecies,NumAges);
+    nmfPredatorPreyTensor  VulnerabilityNu(NumYears,NumSpecies,NumAges);
+    Biomass.resize(NumYears,NumSpecies,NumAges);
+    BiomassTotalPreyPhi.resize(NumYears,NumSpecies,NumAges);
+    ScaledSuitabilityNuTilde.resize(NumYears,NumSpecies,NumAges);
+    BiomassAvailablePreyPhi.resize(NumYears,NumSpecies,NumAges);
+    Bother.clear();
+
+    // Map the species names to integer ids for use in the calculations below
+    internSpecies(AllSpecies);
 
     // Initialize Predation data structures
     for (std::string species : AllSpecies) {
@@ -962,12 +1345,9 @@ std::cout << "nmfAbundance::getData start" << std::endl;
         return;
     }
 
-    for (std::string Species : AllSpecies) {
-        NumYears = m_WeightMap[Species].size1();
-        if (! getYearlyParameters(Species,NumYears,"SimulationParametersYearly",sigma,zeta)) {
-            m_logger->logMsg(nmfConstants::Warning,"nmfAbundance::getAbundance: No sigma,zeta parameter data found.");
-            return;
-        }
+    if (! getYearlyParameters(AllSpecies,"SimulationParametersYearly",sigma,zeta)) {
+        m_logger->logMsg(nmfConstants::Warning,"nmfAbundance::getAbundance: No sigma,zeta parameter data found.");
+        return;
     }
 
     // Calculate the size preference: g(i,a,j,b,t)
@@ -1005,7 +1385,6 @@ std::cout << "nmfAbundance::getData start" << std::endl;
         NumYears = m_WeightMap[species].size1();
         NumAges  = m_WeightMap[species].size2();
         for (int year = 0; year < NumYears-1; ++year) {
-//std::cout << "-----------Year: " << std::to_string(year)  << " of " << NumYears-1 << std::endl;
            // First get abundance for first age group
            RecruitmentValue = getRecruitment(species,RecruitmentType,year+1,
                                              alpha,beta,gamma,sigma,zeta,
@@ -1065,7 +1444,6 @@ std::cout << "nmfAbundance::getData start" << std::endl;
            // Update the Biomass and Predation tables for the next year
            calculateBiomassForCurrentYear(year+1,AllSpecies,m_WeightMap,Abundance,Biomass,sumBiomass);
            Bother.push_back(m_SystemStruct.TotalBiomass-sumBiomass);
-//std::cout << "~~~~> " << m_SystemStruct.TotalBiomass << "," << sumBiomass << std::endl;
            calculateBiomassAvailablePreyPhi(year+1,AllSpecies,ScaledSuitabilityNuTilde,
                                             Biomass,BiomassAvailablePreyPhi);
            BiomassAvailablePreyPhiOther.push_back(nuOther*Bother[year+1]);
@@ -1078,20 +1456,64 @@ std::cout << "nmfAbundance::getData start" << std::endl;
        } // end for year
 
    } // end for species
+}
+
+bool
+nmfAbundance::recalculateYear(
+        const int& year,
+        std::map<std::string,boost::numeric::ublas::matrix<double> >& Abundance,
+        std::map<std::string,boost::numeric::ublas::matrix<double> >& PredationMortality)
+{
+    double sumBiomass = 0;
+    std::vector<std::string> AllSpecies = m_SpeciesNames;
+
+    if ((year < 0) || (year >= m_Biomass.numYears()) || (year >= int(m_Bother.size()))) {
+        m_logger->logMsg(nmfConstants::Error,"nmfAbundance::recalculateYear: No getData results found for year: " + std::to_string(year));
+        return false;
+    }
 
-// Write out predation matrix
-std::cout << "Predation Matrix" << std::endl;
-for (std::string species : AllSpecies) {
-   std::cout << species << std::endl;
-   for (int i = 0; i < int(PredationMortality[species].size1()); ++i) {
-       for (int j = 0; j < int(PredationMortality[species].size2()); ++j) {
-           std::cout << PredationMortality[species](i,j) << " ";
-       }
-       std::cout << std::endl;
-   }
+    // The suitabilities don't depend upon the abundance, so only this year's
+    // biomass, prey availability sums, and predation need to be rebuilt
+    calculateBiomassForCurrentYear(year,AllSpecies,m_WeightMap,Abundance,m_Biomass,sumBiomass);
+    m_Bother[year] = m_SystemStruct.TotalBiomass-sumBiomass;
+    calculateBiomassAvailablePreyPhi(year,AllSpecies,m_ScaledSuitabilityNuTilde,
+                                     m_Biomass,m_BiomassAvailablePreyPhi);
+    calculateBiomassTotalPreyPhi(year,m_nuOther,AllSpecies,m_Bother,
+                                 m_BiomassAvailablePreyPhi,m_BiomassTotalPreyPhi);
+    calculatePredation(year,AllSpecies,m_Biomass,
+                       m_BiomassAvailablePreyPhi,m_BiomassTotalPreyPhi,
+                       PredationMortality,Abundance);
+
+    return true;
 }
 
+bool
+nmfAbundance::projectRecruitment(const std::string& Species,
+                                 const QString& RecruitmentType,
+                                 const std::vector<nmfProjectionSet>& Sets,
+                                 nmfProjectionOutput& Output)
+{
+    nmfProjectionInput Input;
+
+    if (m_WeightMap.find(Species) == m_WeightMap.end()) {
+        m_logger->logMsg(nmfConstants::Error,"nmfAbundance::projectRecruitment: No data loaded for Species: " + Species);
+        return false;
+    }
+    Input.RecruitmentType  = RecruitmentType.toStdString();
+    Input.Weight           = m_WeightMap[Species];
+    Input.Maturity         = m_Maturity[Species];
+    Input.NaturalMortality = m_NaturalMortality[Species];
+    Input.FishingMortality = m_FishingMortality[Species];
+    Input.OtherMortality   = m_PredationMortality[Species];
+    Input.InitialAbundance = m_InitialAbundance[Species];
+
+    nmfRecruitmentProjection Projection(Input);
+    if (! Projection.isValid()) {
+        m_logger->logMsg(nmfConstants::Error,"nmfAbundance::projectRecruitment: Inconsistent tables found for Species: " + Species);
+        return false;
+    }
 
+    return Projection.project(Sets,Output);
 }
 
 double
@@ -1142,7 +1564,6 @@ nmfAbundance::getSpawningBiomass(std::string species,
                std::exp((totalMortality) * (Ts/12.0));
 //             std::exp(-m_naturalMortality(yearIdx,age) * (Ts/12.0));
     }
-std::cout << "WARNING: Check summation for catch vs fishing mortality correctness" << std::endl;
 
     return sum * nmfConstantsMSCAA::Kg2Mt;
 }
@@ -4,12 +4,15 @@
 #include <iostream>
 #include <math.h>
 #include <map>
+#include <functional>
 
 #include <QSettings>
 
 #include <boost/numeric/ublas/matrix.hpp>
 #include <boost/numeric/ublas/io.hpp>
 
+#include "nmfAbundanceTensor.h"
+#include "nmfRecruitmentProjection.h"
 #include "nmfDatabase.h"
 #include "nmfLogger.h"
 //#include "nmfMSCAATableIO.h"
@@ -24,6 +27,22 @@ struct AbundanceSystemStruct {
     int         NumSpInter;
     std::string SystemName;
     std::string AbundanceDriver;
+    int         NumSpecies; // Number of species in the system
+    int         NumYears;   // Maximum number of years over all species
+    int         NumAges;    // Maximum number of ages over all species
+};
+
+/**
+ * @brief Species table values that don't change during a run
+ */
+struct AbundanceSpeciesStruct {
+    int   MinAge;
+    int   MaxAge;
+    int   FirstYear;
+    int   LastYear;
+    float MinLength;
+    float MaxLength;
+    int   NumLengthBins;
 };
 
 struct NuOther {
@@ -39,6 +58,8 @@ private:
     std::string  m_ProjectName;
     std::string  m_ModelName;
     double       m_nuOther;
+    int          m_NumThreads;
+    bool         m_UsePredationContraction;
     boost::numeric::ublas::matrix<double> m_PreferredRatioEta;
     boost::numeric::ublas::matrix<double> m_PreferredGTRatio;
     boost::numeric::ublas::matrix<double> m_PreferredLTRatio;
@@ -53,19 +74,61 @@ private:
     std::map<std::string,boost::numeric::ublas::matrix<double> > m_PredationMortality;
     std::map<std::string,boost::numeric::ublas::matrix<double> > m_FisheryCatch;
     AbundanceSystemStruct m_SystemStruct;
+    std::map<std::string,AbundanceSpeciesStruct> m_SpeciesData;
+
+    // Species interned to dense integer ids (the position in m_SpeciesNames) for use in the hot loops
+    std::vector<std::string> m_SpeciesNames;
+    std::vector<int>         m_NumYears;
+    std::vector<int>         m_NumAges;
+    std::vector<int>         m_NumConsumptionYears;
+    nmfSpeciesAgeTensor      m_Weight;
+    nmfSpeciesAgeTensor      m_Consumption;
+
+    // Working terms from the last call to getData, kept for recalculateYear
+    std::vector<double>      m_Bother;
+    nmfSpeciesAgeTensor      m_Biomass;
+    nmfSpeciesAgeTensor      m_BiomassTotalPreyPhi;
+    nmfPredatorPreyTensor    m_ScaledSuitabilityNuTilde;
+    nmfPredatorPreyTensor    m_BiomassAvailablePreyPhi;
 
       void ReadSettings();
-      void getYearAgeData(const std::string& species,
-                          const int& numYear,
-                          const int& numAges,
+      /**
+       * @brief Runs a task once for every task number (e.g., predator id), spreading
+       * the tasks over m_NumThreads threads. A task must only write to its own slots.
+       * @param NumTasks : number of tasks
+       * @param task : function to run for each task number
+       */
+      void runTasks(const int& NumTasks,
+                    const std::function<void(const int& taskNum)>& task);
+      /**
+       * @brief Maps the species names to dense integer ids and copies the weight and
+       * consumption tables into flat arrays indexed by those ids. The string keyed
+       * maps are then only used when reading from and writing to the database. Does
+       * nothing if the species have already been interned.
+       * @param AllSpecies : species names, in id order
+       */
+      void internSpecies(const std::vector<std::string>& AllSpecies);
+      /**
+       * @brief Loads the Species table values for all species with a single query
+       * @param AllSpecies : species names
+       * @return True if all species were found, else False
+       */
+      bool getSpeciesData(const std::vector<std::string>& AllSpecies);
+      /**
+       * @brief Finds the contiguous range of records belonging to each species in
+       * a query result ordered by species name
+       * @param SpeNames : the SpeName column of the query result
+       * @param Ranges : first record and number of records per species
+       */
+      void getSpeciesRecordRanges(std::vector<std::string>& SpeNames,
+                                  std::map<std::string,std::pair<int,int> >& Ranges);
+      void getYearAgeData(const std::vector<std::string>& AllSpecies,
                           const std::string tableName,
                           std::map<std::string,boost::numeric::ublas::matrix<double> >& tableMap);
       double getSpawningBiomass(std::string species,
                                 int year, int numAges,
                                 std::map<std::string,boost::numeric::ublas::matrix<double> >& Abundance);
-      void getMortalityData(const std::string& species,
-                            const int& numYears,
-                            const int& numAges,
+      void getMortalityData(const std::vector<std::string>& AllSpecies,
                             const std::string tableName,
                             std::map<std::string,boost::numeric::ublas::matrix<double> >& tableMap);
       bool getTheMortalityData(
@@ -93,59 +156,107 @@ private:
               std::map<std::string,double>& gamma);
 
       bool getYearlyParameters(
-              const std::string &Species,
-              const int &NumYears,
+              const std::vector<std::string>& AllSpecies,
               const std::string TableName,
               std::map<std::string,std::vector<double> > &SigmaMap,
               std::map<std::string,std::vector<double> > &ZetaMap);
 
-      void getFisheryCatch(const std::string &Species,
-                           const int &NumYears,
-                           const int &NumAges,
+      void getFisheryCatch(const std::vector<std::string>& AllSpecies,
                            const std::string TableName,
                            std::map<std::string,boost::numeric::ublas::matrix<double> >& m_FisheryCatch);
 
-      bool getFleetCatchTotals(const std::string &Species,
-                               const int &NumYears,
-                               const int &NumAges,
+      bool getFleetCatchTotals(const std::vector<std::string>& AllSpecies,
                                const std::string &TableName,
                                std::map<std::string,boost::numeric::ublas::matrix<double> >& m_FisheryCatch);
 
       void calculatePredation(
               int year,
               std::vector<std::string>& AllSpecies,
-              Boost3DArrayDouble& Biomass,
-              Boost5DArrayDouble& BiomassAvailablePreyPhi,
-              Boost3DArrayDouble& BiomassTotalPreyPhi,
+              nmfSpeciesAgeTensor& Biomass,
+              nmfPredatorPreyTensor& BiomassAvailablePreyPhi,
+              nmfSpeciesAgeTensor& BiomassTotalPreyPhi,
               std::map<std::string,boost::numeric::ublas::matrix<double> >& PredationMortality,
               std::map<std::string,boost::numeric::ublas::matrix<double> >& AbundanceTable);
 
+      /**
+       * @brief Finds the consumption times biomass of every predator age class for a year
+       * @param year : year of interest
+       * @param NumSpecies : number of species
+       * @param Biomass : biomass
+       * @param BiomassTotalPreyPhi : total available prey biomass per predator age class
+       * @param ConsumedBiomass : consumption times biomass per predator age class (year 0 only)
+       * @return False if a species has too few consumption years or a total available prey biomass is 0, else True
+       */
+      bool calculateConsumedBiomass(
+              const int& year,
+              const int& NumSpecies,
+              const nmfSpeciesAgeTensor& Biomass,
+              const nmfSpeciesAgeTensor& BiomassTotalPreyPhi,
+              nmfSpeciesAgeTensor& ConsumedBiomass);
+
+      /**
+       * @brief Finds the biomass of every prey age class consumed by all predators for a year
+       * @param year : year of interest
+       * @param NumSpecies : number of species
+       * @param useContraction : true for the blocked contraction, false for the per predator loops
+       * @param ConsumedBiomass : consumption times biomass per predator age class (year 0 only)
+       * @param BiomassAvailablePreyPhi : available prey biomass
+       * @param BiomassTotalPreyPhi : total available prey biomass per predator age class
+       * @param PreyConsumed : consumed biomass per (prey, prey age) slot, species major
+       */
+      void calculatePreyConsumed(
+              const int& year,
+              const int& NumSpecies,
+              const bool& useContraction,
+              const nmfSpeciesAgeTensor& ConsumedBiomass,
+              const nmfPredatorPreyTensor& BiomassAvailablePreyPhi,
+              const nmfSpeciesAgeTensor& BiomassTotalPreyPhi,
+              std::vector<double>& PreyConsumed);
+
+      /**
+       * @brief Finds each predator's consumption of every prey age class for a year
+       * using the per predator loops
+       * @param year : year of interest
+       * @param NumSpecies : number of species
+       * @param ConsumedBiomass : consumption times biomass per predator age class (year 0 only)
+       * @param BiomassAvailablePreyPhi : available prey biomass
+       * @param BiomassTotalPreyPhi : total available prey biomass per predator age class
+       * @param PredatorConsumption : (predator, prey, prey age) consumption
+       */
+      void calculatePredatorConsumption(
+              const int& year,
+              const int& NumSpecies,
+              const nmfSpeciesAgeTensor& ConsumedBiomass,
+              const nmfPredatorPreyTensor& BiomassAvailablePreyPhi,
+              const nmfSpeciesAgeTensor& BiomassTotalPreyPhi,
+              nmfSpeciesAgeTensor& PredatorConsumption);
+
       void calculateBiomassForCurrentYear(
               int year,
               std::vector<std::string>& AllSpecies,
               std::map<std::string,boost::numeric::ublas::matrix<double> >& WeightMap,
               std::map<std::string,boost::numeric::ublas::matrix<double> >& Abundance,
-              Boost3DArrayDouble& Biomass,
+              nmfSpeciesAgeTensor& Biomass,
               double& sumBiomass);
 
       void calculateBiomassAvailablePreyPhi(
               int year,
               std::vector<std::string>& AllSpecies,
-              Boost5DArrayDouble& ScaledSuitabilityNuTilde,
-              Boost3DArrayDouble& Biomass,
-              Boost5DArrayDouble& BiomassAvailablePreyPhi);
+              nmfPredatorPreyTensor& ScaledSuitabilityNuTilde,
+              nmfSpeciesAgeTensor& Biomass,
+              nmfPredatorPreyTensor& BiomassAvailablePreyPhi);
 
       void calculateBiomassTotalPreyPhi(
               int year,
               double nuOther,
               std::vector<std::string>& AllSpecies,
               std::vector<double>& Bother,
-              Boost5DArrayDouble& BiomassAvailablePreyPhi,
-              Boost3DArrayDouble& BiomassTotalPreyPhi);
+              nmfPredatorPreyTensor& BiomassAvailablePreyPhi,
+              nmfSpeciesAgeTensor& BiomassTotalPreyPhi);
 
       void calculateSuitabilityNuOther(
               const std::vector<std::string>& AllSpecies,
-              const Boost5DArrayDouble& VulnerabilityNu,
+              const nmfPredatorPreyTensor& VulnerabilityNu,
               double& nuOther);
 
 public:
@@ -162,6 +273,34 @@ public:
 
     double getNuOther();
     void setNuOther(double nuOther);
+    /**
+     * @brief Sets the number of threads the predators are spread over when finding the
+     * size preference, suitability, and predation mortality. The predation mortality is
+     * the same regardless of the number of threads used.
+     * @param numThreads : number of threads (1 runs serially, 0 uses one per core)
+     */
+    void setNumThreads(const int& numThreads);
+    /**
+     * @brief Returns the number of threads used for the per predator calculations
+     * @return Number of threads
+     */
+    int getNumThreads();
+    /**
+     * @brief Selects how the predation mortality sum over predators is found. The
+     * contraction (the default) treats each year's available prey biomass as a
+     * matrix and multiplies it by the predator weights with a cache blocked kernel.
+     * Otherwise the per predator loops are used. The two agree to round off.
+     * @param usePredationContraction : true to use the blocked contraction
+     */
+    void setUsePredationContraction(const bool& usePredationContraction);
+    /**
+     * @brief Checks the blocked contraction against the per predator loops for every
+     * year of the last call to getData. The consumed prey biomass from the two must agree
+     * to a relative difference (absolute below 1) of 1e-12.
+     * @param MaxRelativeDifference : largest difference found
+     * @return True if the two agree, else False
+     */
+    bool checkPredationContraction(double& MaxRelativeDifference);
 
     void getData(NuOther& nuOtherUser,
                  QString RecruitmentType,
@@ -170,6 +309,20 @@ public:
                  std::map<std::string,std::vector<double> >& SpawningStockBiomass,
                  std::map<std::string,boost::numeric::ublas::matrix<double> >& PredationMortality);
 
+    /**
+     * @brief Rebuilds a single year's biomass, available prey biomass sums, and
+     * predation mortality after that year's abundance has changed. The suitabilities
+     * and the other years' terms from the last call to getData are reused.
+     * @param year : year whose abundance changed
+     * @param Abundance : abundance tables (with the changed year)
+     * @param PredationMortality : predation mortality tables to update for the year
+     * @return True if the year was recalculated, False if getData hasn't been run for it
+     */
+    bool recalculateYear(
+            const int& year,
+            std::map<std::string,boost::numeric::ublas::matrix<double> >& Abundance,
+            std::map<std::string,boost::numeric::ublas::matrix<double> >& PredationMortality);
+
     bool getSystemData(
             const std::string&  TableName,
                   AbundanceSystemStruct& SystemData);
@@ -190,20 +343,34 @@ public:
             const boost::numeric::ublas::matrix<double>& PreferredRatioEta,
             const boost::numeric::ublas::matrix<double>& PreferredLTRatio,
             const boost::numeric::ublas::matrix<double>& PreferredGTRatio,
-            Boost5DArrayDouble& SizePreferenceG);
+            nmfPredatorPreyTensor& SizePreferenceG);
     void calculateSuitability(
             const std::vector<std::string>& AllSpecies,
             const boost::numeric::ublas::matrix<double>& VulnerabilityRho,
-            Boost5DArrayDouble& SizePreferenceG,
-            Boost5DArrayDouble& Suitability);
+            nmfPredatorPreyTensor& SizePreferenceG,
+            nmfPredatorPreyTensor& Suitability);
     void calculateScaledSuitability(
             const NuOther& nuOtherUser,
             const std::vector<std::string>& allSpecies,
-            Boost5DArrayDouble& vulnerabilityNu,
-            Boost5DArrayDouble& scaledSuitabilityNuTilde,
+            nmfPredatorPreyTensor& vulnerabilityNu,
+            nmfPredatorPreyTensor& scaledSuitabilityNuTilde,
             double& nuOther);
 
     void getData(QString RecruitmentType);
+    /**
+     * @brief Projects a species forward for many stock-recruitment parameter sets at once
+     * using the loaded weight, maturity, mortality, and initial abundance tables. The
+     * predation mortality from the last call to getData (if any) is included.
+     * @param Species : species to project
+     * @param RecruitmentType : "Ricker" or "Beverton-Holt"
+     * @param Sets : parameter sets to project
+     * @param Output : abundance at age, spawning biomass, and recruitment of every set
+     * @return True if the projection was run, else False
+     */
+    bool projectRecruitment(const std::string& Species,
+                            const QString& RecruitmentType,
+                            const std::vector<nmfProjectionSet>& Sets,
+                            nmfProjectionOutput& Output);
 //    void getAbundance(
 //            boost::numeric::ublas::matrix<double> &Abundance,
 //            std::vector<double> &Recruitment,
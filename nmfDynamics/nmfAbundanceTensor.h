@@ -0,0 +1,152 @@
+
+#pragma once
+
+#include <vector>
+#include <cstddef>
+
+/**
+ * @brief Dynamically sized, contiguous (year, species, age) array of doubles. The
+ * layout is year-major with age varying fastest, so walking over the ages of a
+ * species in a given year is unit stride. Species with fewer ages than the
+ * maximum simply leave their trailing ages unused.
+ */
+class nmfSpeciesAgeTensor {
+
+private:
+    std::size_t m_NumYears;
+    std::size_t m_NumSpecies;
+    std::size_t m_NumAges;
+    std::vector<double> m_Data;
+
+public:
+    nmfSpeciesAgeTensor() : m_NumYears(0), m_NumSpecies(0), m_NumAges(0) {}
+    nmfSpeciesAgeTensor(const int& numYears,
+                        const int& numSpecies,
+                        const int& numAges) {
+        resize(numYears,numSpecies,numAges);
+    }
+
+    /**
+     * @brief Sizes the tensor and sets all values to 0
+     * @param numYears : number of years
+     * @param numSpecies : number of species
+     * @param numAges : maximum number of ages over all species
+     */
+    void resize(const int& numYears,
+                const int& numSpecies,
+                const int& numAges) {
+        m_NumYears   = numYears;
+        m_NumSpecies = numSpecies;
+        m_NumAges    = numAges;
+        m_Data.assign(m_NumYears*m_NumSpecies*m_NumAges,0.0);
+    }
+
+    inline double& operator()(const int& year,
+                              const int& species,
+                              const int& age) {
+        return m_Data[(year*m_NumSpecies + species)*m_NumAges + age];
+    }
+    inline const double& operator()(const int& year,
+                                    const int& species,
+                                    const int& age) const {
+        return m_Data[(year*m_NumSpecies + species)*m_NumAges + age];
+    }
+    /**
+     * @brief Returns a pointer to the (unit stride) ages of a species for a year
+     */
+    inline double* ages(const int& year,
+                        const int& species) {
+        return &m_Data[(year*m_NumSpecies + species)*m_NumAges];
+    }
+    inline const double* ages(const int& year,
+                              const int& species) const {
+        return &m_Data[(year*m_NumSpecies + species)*m_NumAges];
+    }
+
+    inline int numYears()   const { return m_NumYears;   }
+    inline int numSpecies() const { return m_NumSpecies; }
+    inline int numAges()    const { return m_NumAges;    }
+    inline std::size_t size() const { return m_Data.size(); }
+};
+
+/**
+ * @brief Dynamically sized, contiguous (year, prey, prey age, predator, predator age)
+ * array of doubles used for the predator-prey size preference, suitability, and
+ * available prey biomass terms. The layout is year-major with predator age varying
+ * fastest, so the predator loops over a fixed prey age class in a given year are
+ * unit stride.
+ */
+class nmfPredatorPreyTensor {
+
+private:
+    std::size_t m_NumYears;
+    std::size_t m_NumSpecies;
+    std::size_t m_NumAges;
+    std::size_t m_PreyStride; // number of values for one prey age class in one year
+    std::size_t m_YearStride; // number of values for one year
+    std::vector<double> m_Data;
+
+public:
+    nmfPredatorPreyTensor() : m_NumYears(0), m_NumSpecies(0), m_NumAges(0),
+                              m_PreyStride(0), m_YearStride(0) {}
+    nmfPredatorPreyTensor(const int& numYears,
+                          const int& numSpecies,
+                          const int& numAges) {
+        resize(numYears,numSpecies,numAges);
+    }
+
+    /**
+     * @brief Sizes the tensor and sets all values to 0
+     * @param numYears : number of years
+     * @param numSpecies : number of species (both predator and prey)
+     * @param numAges : maximum number of ages over all species
+     */
+    void resize(const int& numYears,
+                const int& numSpecies,
+                const int& numAges) {
+        m_NumYears   = numYears;
+        m_NumSpecies = numSpecies;
+        m_NumAges    = numAges;
+        m_PreyStride = m_NumSpecies*m_NumAges;
+        m_YearStride = m_PreyStride*m_PreyStride;
+        m_Data.assign(m_NumYears*m_YearStride,0.0);
+    }
+
+    inline double& operator()(const int& year,
+                              const int& prey,
+                              const int& preyAge,
+                              const int& pred,
+                              const int& predAge) {
+        return m_Data[year*m_YearStride + (prey*m_NumAges + preyAge)*m_PreyStride +
+                      pred*m_NumAges + predAge];
+    }
+    inline const double& operator()(const int& year,
+                                    const int& prey,
+                                    const int& preyAge,
+                                    const int& pred,
+                                    const int& predAge) const {
+        return m_Data[year*m_YearStride + (prey*m_NumAges + preyAge)*m_PreyStride +
+                      pred*m_NumAges + predAge];
+    }
+    /**
+     * @brief Returns a pointer to the (unit stride) predator ages of a predator for a
+     * given year and prey age class
+     */
+    inline double* predatorAges(const int& year,
+                                const int& prey,
+                                const int& preyAge,
+                                const int& pred) {
+        return &m_Data[year*m_YearStride + (prey*m_NumAges + preyAge)*m_PreyStride + pred*m_NumAges];
+    }
+    inline const double* predatorAges(const int& year,
+                                      const int& prey,
+                                      const int& preyAge,
+                                      const int& pred) const {
+        return &m_Data[year*m_YearStride + (prey*m_NumAges + preyAge)*m_PreyStride + pred*m_NumAges];
+    }
+
+    inline int numYears()   const { return m_NumYears;   }
+    inline int numSpecies() const { return m_NumSpecies; }
+    inline int numAges()    const { return m_NumAges;    }
+    inline std::size_t size() const { return m_Data.size(); }
+};
@@ -0,0 +1,149 @@
+#include "nmfRecruitmentProjection.h"
+#include "nmfConstantsMSCAA.h"
+
+#include <cmath>
+#include <iostream>
+
+nmfRecruitmentProjection::nmfRecruitmentProjection(const nmfProjectionInput& Input)
+{
+    m_Input    = Input;
+    m_NumYears = Input.Weight.size1();
+    m_NumAges  = Input.Weight.size2();
+    m_IsRicker = (Input.RecruitmentType == "Ricker");
+
+    if (! isValid()) {
+        std::cout << "Error nmfRecruitmentProjection: Inconsistent or missing input tables for "
+                  << Input.RecruitmentType << " projection" << std::endl;
+        m_NumYears = 0;
+        m_NumAges  = 0;
+        return;
+    }
+
+    m_WeightMaturity.resize(m_NumYears,m_NumAges);
+    for (int year = 0; year < m_NumYears; ++year) {
+        for (int age = 0; age < m_NumAges; ++age) {
+            m_WeightMaturity(year,age) = m_Input.Maturity(year,age) * m_Input.Weight(year,age);
+        }
+    }
+}
+
+bool
+nmfRecruitmentProjection::isValid() const
+{
+    bool hasOther = (m_Input.OtherMortality.size1() > 0);
+
+    return ((m_Input.RecruitmentType == "Ricker") ||
+            (m_Input.RecruitmentType == "Beverton-Holt")) &&
+           (m_NumYears > 0) && (m_NumAges > 1) &&
+           (int(m_Input.Maturity.size1())         == m_NumYears) && (int(m_Input.Maturity.size2())         == m_NumAges) &&
+           (int(m_Input.NaturalMortality.size1()) == m_NumYears) && (int(m_Input.NaturalMortality.size2()) == m_NumAges) &&
+           (int(m_Input.FishingMortality.size1()) == m_NumYears) && (int(m_Input.FishingMortality.size2()) == m_NumAges) &&
+           (! hasOther || ((int(m_Input.OtherMortality.size1()) == m_NumYears) &&
+                           (int(m_Input.OtherMortality.size2()) == m_NumAges))) &&
+           (m_Input.InitialAbundance.size1() > 0) && (int(m_Input.InitialAbundance.size2()) == m_NumAges);
+}
+
+void
+nmfRecruitmentProjection::calculateFactors(const std::vector<nmfProjectionSet>& Sets)
+{
+    int NumSets = Sets.size();
+    bool hasOther = (m_Input.OtherMortality.size1() > 0);
+    double totalMortality;
+    double halfSurvival;
+    double* halfSurvivalAges;
+    double* spawningFactorAges;
+
+    m_HalfSurvival.resize(m_NumYears,NumSets,m_NumAges);
+    m_SpawningFactor.resize(m_NumYears,NumSets,m_NumAges);
+
+    // Spawning occurs at T^s = 6 months (from the Butterworth paper, as in nmfAbundance),
+    // so the spawning survival exp(-Z*Ts/12) is the same as the half year survival.
+    for (int year = 0; year < m_NumYears; ++year) {
+        for (int set = 0; set < NumSets; ++set) {
+            halfSurvivalAges   = m_HalfSurvival.ages(year,set);
+            spawningFactorAges = m_SpawningFactor.ages(year,set);
+            for (int age = 0; age < m_NumAges; ++age) {
+                totalMortality = Sets[set].NaturalMortalityScale * m_Input.NaturalMortality(year,age) +
+                                 Sets[set].FishingMortalityScale * m_Input.FishingMortality(year,age);
+                if (hasOther) {
+                    totalMortality += m_Input.OtherMortality(year,age);
+                }
+                halfSurvival = std::exp(-totalMortality/2.0);
+                halfSurvivalAges[age]   = halfSurvival;
+                spawningFactorAges[age] = m_WeightMaturity(year,age) * halfSurvival;
+            }
+        }
+    }
+}
+
+double
+nmfRecruitmentProjection::recruitment(const nmfProjectionSet& Set,
+                                      const double& SpawningBiomass) const
+{
+    if (m_IsRicker) {
+        return Set.Alpha * SpawningBiomass *
+               std::exp(-Set.Beta * std::pow(SpawningBiomass,Set.Gamma));
+    }
+    return (Set.Alpha * SpawningBiomass) / (Set.Beta + SpawningBiomass);
+}
+
+bool
+nmfRecruitmentProjection::project(const std::vector<nmfProjectionSet>& Sets,
+                                  nmfProjectionOutput& Output)
+{
+    int NumSets  = Sets.size();
+    int lastAge  = m_NumAges-1;
+    double spawningBiomass;
+    const double* abundance;
+    const double* halfSurvival;
+    const double* spawningFactor;
+    double* nextAbundance;
+
+    if ((m_NumYears == 0) || (NumSets == 0)) {
+        return false;
+    }
+
+    calculateFactors(Sets);
+    Output.Abundance.resize(m_NumYears,NumSets,m_NumAges);
+    Output.SpawningBiomass.resize(NumSets,m_NumYears);
+    Output.Recruitment.resize(NumSets,m_NumYears);
+    for (int set = 0; set < NumSets; ++set) {
+        nextAbundance = Output.Abundance.ages(0,set);
+        for (int age = 0; age < m_NumAges; ++age) {
+            nextAbundance[age] = m_Input.InitialAbundance(0,age);
+        }
+        Output.Recruitment(set,0) = nextAbundance[0];
+    }
+
+    for (int year = 0; year < m_NumYears; ++year) {
+        for (int set = 0; set < NumSets; ++set) {
+            abundance      = Output.Abundance.ages(year,set);
+            halfSurvival   = m_HalfSurvival.ages(year,set);
+            spawningFactor = m_SpawningFactor.ages(year,set);
+
+            spawningBiomass = 0;
+            for (int age = 0; age < m_NumAges; ++age) {
+                spawningBiomass += spawningFactor[age] * abundance[age];
+            }
+            spawningBiomass *= nmfConstantsMSCAA::Kg2Mt;
+            Output.SpawningBiomass(set,year) = spawningBiomass;
+            if (year == m_NumYears-1) {
+                continue;
+            }
+
+            // Recruits come from this year's spawning biomass, all other ages survive
+            // into the next age class and the last age is a plus group
+            nextAbundance = Output.Abundance.ages(year+1,set);
+            nextAbundance[0] = recruitment(Sets[set],spawningBiomass);
+            Output.Recruitment(set,year+1) = nextAbundance[0];
+            for (int age = 0; age < lastAge-1; ++age) {
+                nextAbundance[age+1] = (abundance[age]*halfSurvival[age]) * halfSurvival[age];
+            }
+            nextAbundance[lastAge] =
+                    (abundance[lastAge-1]*halfSurvival[lastAge-1]) * halfSurvival[lastAge-1] +
+                    (abundance[lastAge]  *halfSurvival[lastAge])   * halfSurvival[lastAge];
+        }
+    }
+
+    return true;
+}
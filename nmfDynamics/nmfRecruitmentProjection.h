@@ -0,0 +1,99 @@
+
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include <boost/numeric/ublas/matrix.hpp>
+
+#include "nmfAbundanceTensor.h"
+
+/**
+ * @brief Year by age tables for one species that a recruitment projection is run from
+ */
+struct nmfProjectionInput {
+    std::string RecruitmentType; // "Ricker" or "Beverton-Holt"
+    boost::numeric::ublas::matrix<double> Weight;           // (year,age) kilograms
+    boost::numeric::ublas::matrix<double> Maturity;         // (year,age)
+    boost::numeric::ublas::matrix<double> NaturalMortality; // (year,age)
+    boost::numeric::ublas::matrix<double> FishingMortality; // (year,age)
+    boost::numeric::ublas::matrix<double> OtherMortality;   // (year,age) i.e., predation, may be empty
+    boost::numeric::ublas::matrix<double> InitialAbundance; // first row is the initial abundance at age
+};
+
+/**
+ * @brief One set of stock-recruitment parameters and mortality multipliers to project
+ */
+struct nmfProjectionSet {
+    double Alpha;
+    double Beta;
+    double Gamma;                 // Ricker only
+    double NaturalMortalityScale; // multiplies the input natural mortality
+    double FishingMortalityScale; // multiplies the input fishing mortality
+    nmfProjectionSet() : Alpha(0), Beta(0), Gamma(1),
+                         NaturalMortalityScale(1), FishingMortalityScale(1) {}
+};
+
+/**
+ * @brief Results of projecting a group of parameter sets
+ */
+struct nmfProjectionOutput {
+    nmfSpeciesAgeTensor Abundance;                       // (year, set, age)
+    boost::numeric::ublas::matrix<double> SpawningBiomass; // (set,year) metric tons
+    boost::numeric::ublas::matrix<double> Recruitment;     // (set,year) year 0 is the initial age 0 abundance
+};
+
+/**
+ * @brief Projects an age structured population forward with Ricker or Beverton-Holt
+ * recruitment for many parameter sets at once. The same equations as nmfAbundance are
+ * used (fishing mortality driven, plus group in the last age), but the per age survival
+ * and weight x maturity x survival factors for every year and set are found up front,
+ * so the year loop is only a dot product for the spawning biomass and an element-wise
+ * shift for the abundance. All sets are stored contiguously, year major, so each year
+ * of the projection walks memory with unit stride.
+ */
+class nmfRecruitmentProjection {
+
+private:
+    int m_NumYears;
+    int m_NumAges;
+    bool m_IsRicker;
+    nmfProjectionInput m_Input;
+    boost::numeric::ublas::matrix<double> m_WeightMaturity; // (year,age), same for all sets
+
+    // Per set factors, (year, set, age)
+    nmfSpeciesAgeTensor m_HalfSurvival;
+    nmfSpeciesAgeTensor m_SpawningFactor;
+
+    void calculateFactors(const std::vector<nmfProjectionSet>& Sets);
+
+public:
+    /**
+     * @brief Checks and stores the input tables
+     * @param Input : year by age tables of the species to project
+     */
+    nmfRecruitmentProjection(const nmfProjectionInput& Input);
+   ~nmfRecruitmentProjection() {}
+
+    /**
+     * @brief Returns whether the input tables were consistent and may be projected
+     * @return True if valid, else False
+     */
+    bool isValid() const;
+    /**
+     * @brief Projects all of the parameter sets over all of the input years
+     * @param Sets : the parameter sets to project
+     * @param Output : abundance at age, spawning biomass, and recruitment of every set
+     * @return True if the projection was run, else False
+     */
+    bool project(const std::vector<nmfProjectionSet>& Sets,
+                 nmfProjectionOutput& Output);
+    /**
+     * @brief Recruitment from spawning biomass for one parameter set
+     * @param Set : parameter set
+     * @param SpawningBiomass : spawning biomass (metric tons)
+     * @return Number of recruits
+     */
+    double recruitment(const nmfProjectionSet& Set,
+                       const double& SpawningBiomass) const;
+};
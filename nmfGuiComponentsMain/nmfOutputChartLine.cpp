@@ -1,6 +1,12 @@
 
 #include "nmfConstants.h"
 #include "nmfOutputChartLine.h"
+#include "nmfUtilsYieldPerRecruit.h"
+
+// YPR engines are kept between redraws so the reference points of a species and
+// year are only found once (the engines are keyed by their input values)
+static nmfYieldPerRecruitCache YieldPerRecruitCache;
+static const boost::numeric::ublas::vector<double> NoMaturity;
 
 
 nmfOutputChartLine::nmfOutputChartLine(nmfLogger *theLogger):
@@ -194,36 +200,8 @@ double nmfOutputChartLine::YPR(boost::numeric::ublas::vector<double> &WeightAtAg
         boost::numeric::ublas::vector<double> &M1,
         int Nage)
 {
-    double Death;   // for death rate
-    double PropF;   // for F/Z
-    double TempVal; // hold sum through iterations
-    double NAlive;  // holds the product for number alive at age t
-    double Z;       // mortality as sum of M1 + M2 + F
-    double M2;
-
     //FatAge holds PRF values
-
-    TempVal = 0.0;
-    NAlive = 1.0;
-//std::cout << "-> -------------------------------------" << std::endl;
-    for (int i = 0; i < Nage; ++i) {
-        M2 = (M2atAge(i) < 0) ? 0 : M2atAge(i);
-//std::cout << "-> M2: " << M2 << std::endl;
-        Z = (FatAge(i) * FullF) + M2 + M1(i);        // total mortality
-//std::cout << "-> FatAge(i): " << FatAge(i) << std::endl;
-//std::cout << "-> FullF: " << FullF << std::endl;
-//std::cout << "-> M1(i): " << M1(i) << std::endl;
-//std::cout << "-> Z: " << Z << std::endl;
-        Death = NAlive * (1 - std::exp(-Z));         // death rate
-//std::cout << "-> Death: " << Death << std::endl;
-        NAlive *= std::exp(-Z);                      // number alive at age - accumulating product
-//std::cout << "-> NAlive: " << NAlive << std::endl;
-
-        PropF = (FatAge(i) * FullF) / Z;             // proportion of Z due to fishing
-        TempVal += (Death * PropF * WeightAtAge(i)); // accumulates yield at age
-    }
-
-    return TempVal;
+    return YieldPerRecruitCache.get(WeightAtAge,FatAge,M2atAge,M1,NoMaturity,Nage)->yieldPerRecruit(FullF);
 } // end YPR
 
 
@@ -233,37 +211,8 @@ double nmfOutputChartLine::F01(boost::numeric::ublas::vector<double> &WeightAtAg
         boost::numeric::ublas::vector<double> &M1,
         double Nage)
 {
-
-    double YPR0;
-    double YPR1;
-    double Slope;
-    double SlopeRef;
-    double F0;
-    double Diff;
-
-    // Find F0.1
-    // First calculate slope at origin - Slope0
-    YPR1 = YPR(WeightAtAge, FatAge, M2atAge, 0.001, M1, Nage);
-    YPR0 = YPR(WeightAtAge, FatAge, M2atAge, 0.0, M1, Nage);
-
-    // Ref slope is 10% of slope at origin
-    SlopeRef = ((YPR1 - YPR0) / 0.001) * 0.1;
-    Slope = (YPR1 - YPR0) / 0.001; // this is the slope at the origin
-    Diff = Slope - SlopeRef; // this is the difference to minimize
-    F0 = 0.001;
-    while (Diff > 0.001) {
-
-        YPR1 = YPR(WeightAtAge, FatAge, M2atAge, F0 + 0.001, M1, Nage);
-        YPR0 = YPR(WeightAtAge, FatAge, M2atAge, F0, M1, Nage);
-
-        Slope = (YPR1 - YPR0) / 0.001;
-        Diff = Slope - SlopeRef; // this is the difference to minimize
-
-        F0 += 0.001;
-    }
-
-    return (F0-0.001);
-
+    // F where the YPR slope is 10% of the slope at the origin
+    return YieldPerRecruitCache.get(WeightAtAge,FatAge,M2atAge,M1,NoMaturity,int(Nage))->F01();
 } // end F01
 
 
@@ -273,32 +222,8 @@ double nmfOutputChartLine::FMax(boost::numeric::ublas::vector<double> &WeightAtA
         boost::numeric::ublas::vector<double> &M1,
         double Nage)
 {
-    double YPR0;
-    double YPR1;
-    double Slope;
-    double F0;
-
-    // Calculate Fmax
-    YPR1 = YPR(WeightAtAge, FatAge, M2atAge, 0.001, M1, Nage);
-    YPR0 = YPR(WeightAtAge, FatAge, M2atAge, 0.0, M1, Nage);
-
-    Slope = (YPR1 - YPR0) / 0.001; // this is the slope at the origin
-    F0 = 0.001;
-    bool done=false;
-    while ((Slope > 0) and (! done)) {
-
-        YPR1 = YPR(WeightAtAge, FatAge, M2atAge, F0 + 0.001, M1, Nage);
-        YPR0 = YPR(WeightAtAge, FatAge, M2atAge, F0, M1, Nage);
-
-        Slope = (YPR1 - YPR0) / 0.001;
-        F0 += 0.001;
-
-        // Put in a break to bounce it out if F gets bigger than 4....max Fmax undefined
-        // this will at least prevent infinite loops...
-        done = (F0 > 4);
-    }
-
-    return (F0 < 4) ? (F0-0.001) : -9;
+    // Returns -9 if the YPR is still increasing at F = 4 (i.e., Fmax undefined)
+    return YieldPerRecruitCache.get(WeightAtAge,FatAge,M2atAge,M1,NoMaturity,int(Nage))->FMax();
 } // end FMax
 
 
@@ -310,19 +235,7 @@ double nmfOutputChartLine::SSB(boost::numeric::ublas::vector<double> &WeightAtAg
         int &Nage,
         boost::numeric::ublas::vector<double> &Pmature)
 {
-    double Z;  // mortality as sum of M + F
-    double M2;
-    double SSBtemp = 0.0; // hold sum through iterations
-    double NAlive = 1.0;  // holds the product for number alive at age t
-
-    for (int i = 0; i < Nage; ++i) {
-        M2 = (M2atAge(i) < 0) ? 0 : M2atAge(i);
-        Z = M1(i) + M2 + (FullF * FatAge(i));  // total mortality for that age
-        NAlive *= std::exp(-Z);  // number alive at age - accumulating product
-        SSBtemp += (NAlive * WeightAtAge(i) * Pmature(i)); //  accumulates SSB at age
-    } // end for i
-
-    return SSBtemp;
+    return YieldPerRecruitCache.get(WeightAtAge,FatAge,M2atAge,M1,Pmature,Nage)->spawningBiomassPerRecruit(FullF);
 } // end SSB
 
 
@@ -334,26 +247,47 @@ double nmfOutputChartLine::SSBBench(boost::numeric::ublas::vector<double> &Weigh
         boost::numeric::ublas::vector<double> &Pmature,
         double BenchVal)
 {
-    double SSBtemp;
-    double SSBMax;
-    double F0 = 0.001;
-    double Ratio;
-
     // Find F giving SSB/R = benchval of max
-    SSBMax  = SSB(WeightAtAge, FatAge, M2atAge, 0, M1, Nage, Pmature);
-    SSBtemp = SSBMax;
-    Ratio   = SSBtemp / SSBMax;
-
-    // RSK check this logic for potential of infinite loop
-    while (Ratio > BenchVal) {
-        SSBtemp = SSB(WeightAtAge, FatAge, M2atAge, F0, M1, Nage, Pmature);
-        Ratio = SSBtemp / SSBMax;
-        F0 += 0.001;
-    }
+    return YieldPerRecruitCache.get(WeightAtAge,FatAge,M2atAge,M1,Pmature,Nage)->FAtSpawningRatio(BenchVal);
+} // end SSBBench
 
-    return (F0 - 0.001);
 
-} // end SSBBench
+void nmfOutputChartLine::YPRCurve(boost::numeric::ublas::vector<double> &WeightAtAge,
+        boost::numeric::ublas::vector<double> &FatAge,
+        boost::numeric::ublas::vector<double> &M2atAge,
+        boost::numeric::ublas::vector<double> &M1,
+        int Nage,
+        const std::vector<double> &FullF,
+        std::vector<double> &YPROut)
+{
+    YieldPerRecruitCache.get(WeightAtAge,FatAge,M2atAge,M1,NoMaturity,Nage)->yieldPerRecruit(FullF,YPROut);
+} // end YPRCurve
+
+
+void nmfOutputChartLine::SSBCurve(boost::numeric::ublas::vector<double> &WeightAtAge,
+        boost::numeric::ublas::vector<double> &FatAge,
+        boost::numeric::ublas::vector<double> &M2atAge,
+        boost::numeric::ublas::vector<double> &M1,
+        int &Nage,
+        boost::numeric::ublas::vector<double> &Pmature,
+        const std::vector<double> &FullF,
+        std::vector<double> &SSBOut)
+{
+    YieldPerRecruitCache.get(WeightAtAge,FatAge,M2atAge,M1,Pmature,Nage)->spawningBiomassPerRecruit(FullF,SSBOut);
+} // end SSBCurve
+
+
+std::vector<double> nmfOutputChartLine::getFGrid()
+{
+    std::vector<double> FGrid;
+
+    // Same F values as the chart x axis labels
+    for (double XX = 0.0; XX <= 2.6; XX += 0.1) {
+        FGrid.push_back(XX);
+    }
+
+    return FGrid;
+} // end getFGrid
 
 
 void nmfOutputChartLine::calculateWeightAveFAndAssignPRFs(
@@ -1161,6 +1095,9 @@ void nmfOutputChartLine::Forecast_YieldPerRecruit_YPRvsF(
     double yprOut;
     colLabels << "Avg F";
 
+    std::vector<double> FGrid = getFGrid();
+    std::vector<double> Curve;
+
     for (int i = 0; i < NumYears; ++ i) {
 
         colLabels << QString::number(Forecast_FirstYear+i);
@@ -1174,6 +1111,7 @@ void nmfOutputChartLine::Forecast_YieldPerRecruit_YPRvsF(
         }
 
         YPRObs(i) = YPR(tmpWt, tmpPRF, tmpM2, FullF(i), tmpM1, Nage);
+        YPRCurve(tmpWt, tmpPRF, tmpM2, tmpM1, Nage, FGrid, Curve);
 
         // Generate YPR across a range of Fs..25 values in all
         LoopCount = 0;
@@ -1184,7 +1122,7 @@ void nmfOutputChartLine::Forecast_YieldPerRecruit_YPRvsF(
             }
             sprintf(buf,"%0.1f",XX);
             XLabelNames.push_back(buf);
-            yprOut = YPR(tmpWt, tmpPRF, tmpM2, XX, tmpM1, Nage);   // RSK - tbd - error here, -nan with Menhaden
+            yprOut = Curve[LoopCount];
             YPROut(LoopCount,i) = yprOut;
             if (yprOut > YMax)
                 YMax = yprOut;
@@ -1309,6 +1247,9 @@ nmfOutputChartLine::Forecast_YieldPerRecruit_SSBvsF(
     nmfUtils::initialize(tmpWt,  Nage);
     nmfUtils::initialize(tmpMat, Nage);
 
+    std::vector<double> FGrid = getFGrid();
+    std::vector<double> Curve;
+
     for (int i = 0; i < NumYears; ++ i) {
 
         for (int j = 0; j < Nage; ++j) {
@@ -1319,6 +1260,7 @@ nmfOutputChartLine::Forecast_YieldPerRecruit_SSBvsF(
             tmpMat(j) = Pmature(i,j);
         }
         YPRObs(i) = SSB(tmpWt, tmpPRF, tmpM2, FullF(i), tmpM1, Nage, tmpMat);
+        SSBCurve(tmpWt, tmpPRF, tmpM2, tmpM1, Nage, tmpMat, FGrid, Curve);
 
         LoopCount = 0;
         // Generate YPR across a range of Fs..25 values in all
@@ -1329,7 +1271,7 @@ nmfOutputChartLine::Forecast_YieldPerRecruit_SSBvsF(
             }
             sprintf(buf,"%0.1f",XX);
             XLabelNames.push_back(buf);
-            yprOut = SSB(tmpWt, tmpPRF, tmpM2, XX, tmpM1, Nage, tmpMat);
+            yprOut = Curve[LoopCount];
             YPROut(LoopCount,i) = yprOut;
             if (yprOut > YMax)
                 YMax = yprOut;
@@ -1903,6 +1845,9 @@ nmfOutputChartLine::MSVPA_YieldPerRecruit_YPRvsF (
     colLabels << "Avg. F";
     int firstYear = (theModelName == "MSVPA") ? FirstYear : Forecast_FirstYear;
 
+    std::vector<double> FGrid = getFGrid();
+    std::vector<double> Curve;
+
     for (int i = 0; i < NumYears; ++ i) {
         colLabels << QString::number(firstYear+i);
         for (int j = 0; j < Nage; ++j) {
@@ -1914,6 +1859,7 @@ nmfOutputChartLine::MSVPA_YieldPerRecruit_YPRvsF (
         }
 
         YPRObs(i) = YPR(tmpWt, tmpPRF, tmpM2, FullF(i), tmpM1, Nage);
+        YPRCurve(tmpWt, tmpPRF, tmpM2, tmpM1, Nage, FGrid, Curve);
         LoopCount = 0;
         // Generate YPR across a range of Fs..25 values in all
         k = 0;
@@ -1922,7 +1868,7 @@ nmfOutputChartLine::MSVPA_YieldPerRecruit_YPRvsF (
                 sprintf(buf,"%0.1f",XX);
                 XLabelNames.push_back(buf);
             }
-            YPROut(LoopCount,i) = YPR(tmpWt, tmpPRF, tmpM2, XX, tmpM1, Nage);
+            YPROut(LoopCount,i) = Curve[LoopCount];
             if (YPROut(LoopCount,i) > YMax)
                 YMax = YPROut(LoopCount,i);
             if (i == 0) {
@@ -2051,6 +1997,9 @@ nmfOutputChartLine::MSVPA_YieldPerRecruit_SSBvsF(
     nmfUtils::initialize(tmpMat, Nage);
     int firstYear = (theModelName == "MSVPA") ? FirstYear : Forecast_FirstYear;
 
+    std::vector<double> FGrid = getFGrid();
+    std::vector<double> Curve;
+
     for (int i = 0; i < NumYears; ++ i) {
         colLabels << QString::number(firstYear+i);
 
@@ -2062,6 +2011,7 @@ nmfOutputChartLine::MSVPA_YieldPerRecruit_SSBvsF(
             tmpMat(j) = Pmature(i,j);
         }
         YPRObs(i) = SSB(tmpWt, tmpPRF, tmpM2, FullF(i), tmpM1, Nage, tmpMat);
+        SSBCurve(tmpWt, tmpPRF, tmpM2, tmpM1, Nage, tmpMat, FGrid, Curve);
 
         LoopCount = 0;
         // Generate YPR across a range of Fs..25 values in all
@@ -2073,7 +2023,7 @@ nmfOutputChartLine::MSVPA_YieldPerRecruit_SSBvsF(
                 sprintf(buf,"%0.1f",XX);
                 XLabelNames.push_back(buf);
             }
-            YPROut(LoopCount,i) = SSB(tmpWt, tmpPRF, tmpM2, XX, tmpM1, Nage, tmpMat);
+            YPROut(LoopCount,i) = Curve[LoopCount];
             if (YPROut(LoopCount,i) > YMax)
                 YMax = YPROut(LoopCount,i);
             GridData(k,i+1) = YPROut(LoopCount,i);
@@ -616,6 +616,25 @@ class nmfOutputChartLine: public nmfOutputChartBase {
             boost::numeric::ublas::vector<double> &Pmature,
             double BenchVal);
 
+    static void YPRCurve(boost::numeric::ublas::vector<double> &WeightAtAge,
+            boost::numeric::ublas::vector<double> &FatAge,
+            boost::numeric::ublas::vector<double> &M2atAge,
+            boost::numeric::ublas::vector<double> &M1,
+            int Nage,
+            const std::vector<double> &FullF,
+            std::vector<double> &YPROut);
+
+    static void SSBCurve(boost::numeric::ublas::vector<double> &WeightAtAge,
+            boost::numeric::ublas::vector<double> &FatAge,
+            boost::numeric::ublas::vector<double> &M2atAge,
+            boost::numeric::ublas::vector<double> &M1,
+            int &Nage,
+            boost::numeric::ublas::vector<double> &Pmature,
+            const std::vector<double> &FullF,
+            std::vector<double> &SSBOut);
+
+    static std::vector<double> getFGrid();
+
     static void loadChartWithData(
             QChart *chart,
             double YMax,
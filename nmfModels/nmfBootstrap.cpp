@@ -0,0 +1,323 @@
+#include "nmfBootstrap.h"
+#include "nmfConstants.h"
+#include "nmfUtilsQtCore.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <mutex>
+
+nmfBootstrap::nmfBootstrap(
+        const nmfStructsQt::SharedModelData& ModelData,
+        const std::vector<double>& PointEstimate,
+        const boost::numeric::ublas::matrix<double>& FittedBiomass)
+{
+    int NumYears;
+    int n;
+    double mean;
+    double sumSq;
+
+    m_ModelData     = ModelData;
+    m_PointEstimate = PointEstimate;
+    m_FittedBiomass = FittedBiomass;
+    m_isAggProd     = (ModelData.Settings.CompetitionForm == "AGG-PROD");
+    m_NumSpeciesOrGuilds = (m_isAggProd) ? ModelData.Settings.NumGuilds : ModelData.Settings.NumSpecies;
+
+    const nmfStructsQt::ModelInputData& Inputs = ModelData.inputs();
+    const boost::numeric::ublas::matrix<double>& Observed = (m_isAggProd) ?
+            Inputs.ObservedBiomassByGuilds : Inputs.ObservedBiomassBySpecies;
+    NumYears = std::min(Observed.size1(),FittedBiomass.size1());
+
+    m_Residuals.assign(m_NumSpeciesOrGuilds,std::vector<double>());
+    m_ResidualStdDev.assign(m_NumSpeciesOrGuilds,0.0);
+    for (int i = 0; i < m_NumSpeciesOrGuilds; ++i) {
+        if ((i >= int(Observed.size2())) || (i >= int(FittedBiomass.size2()))) {
+            continue;
+        }
+        for (int time = 0; time < NumYears; ++time) {
+            if (! isMissing(Observed(time,i)) && (FittedBiomass(time,i) > 0)) {
+                m_Residuals[i].push_back(std::log(Observed(time,i)/FittedBiomass(time,i)));
+            }
+        }
+        n = m_Residuals[i].size();
+        if (n > 1) {
+            mean = 0;
+            for (double residual : m_Residuals[i]) {
+                mean += residual;
+            }
+            mean /= n;
+            sumSq = 0;
+            for (double residual : m_Residuals[i]) {
+                sumSq += (residual-mean)*(residual-mean);
+            }
+            m_ResidualStdDev[i] = std::sqrt(sumSq/(n-1));
+        }
+    }
+}
+
+bool
+nmfBootstrap::isMissing(const double& value) const
+{
+    return (value == nmfConstants::NoValueDouble) || (value <= 0);
+}
+
+bool
+nmfBootstrap::fitBiomass(const nmfStructsQt::SharedModelData& ModelData,
+                         const std::vector<double>& Parameters,
+                         boost::numeric::ublas::matrix<double>& FittedBiomass)
+{
+    nmfParameterOffsets Offsets;
+    std::vector<double> InitBiomass;
+    boost::numeric::ublas::matrix<double> EstBiomassGuilds;
+
+    Offsets.load(ModelData.Settings);
+    for (int k = 0; k < Offsets.InitBiomass.size(); ++k) {
+        if (Offsets.InitBiomass.Offset+k < int(Parameters.size())) {
+            InitBiomass.push_back(Parameters[Offsets.InitBiomass.Offset+k]);
+        }
+    }
+
+    nmfForecastProjection Projection(ModelData,InitBiomass);
+    nmfForecastForms Forms(ModelData.Settings);
+    if (! Projection.isValid(Parameters)) {
+        std::cout << "Error nmfBootstrap::fitBiomass: Need at least one year and species and " <<
+                     "enough parameters" << std::endl;
+        return false;
+    }
+    Projection.initializeBiomass(FittedBiomass,EstBiomassGuilds);
+
+    const nmfStructsQt::ModelInputData& Inputs = ModelData.inputs();
+    return Projection.project(Forms,Parameters,Inputs.Catch,Inputs.Effort,Inputs.Exploitation,
+                              FittedBiomass,EstBiomassGuilds);
+}
+
+void
+nmfBootstrap::resample(const nmfBootstrapOptions::Resampling& Method,
+                       std::mt19937_64& rng,
+                       nmfStructsQt::SharedModelData& ReplicateData) const
+{
+    int NumResiduals;
+    double sigma;
+    double guildBiomass;
+    bool   guildMissing;
+    std::normal_distribution<double> normal(0.0,1.0);
+    const nmfStructsQt::ModelInputData& Inputs = m_ModelData.inputs();
+    nmfStructsQt::ModelInputData& Replicate = ReplicateData.editInputs();
+    const boost::numeric::ublas::matrix<double>& Original = (m_isAggProd) ?
+            Inputs.ObservedBiomassByGuilds : Inputs.ObservedBiomassBySpecies;
+    boost::numeric::ublas::matrix<double>& Observed = (m_isAggProd) ?
+            Replicate.ObservedBiomassByGuilds : Replicate.ObservedBiomassBySpecies;
+    int NumYears = std::min(Observed.size1(),m_FittedBiomass.size1());
+
+    // Missing observations stay missing
+    for (int i = 0; i < m_NumSpeciesOrGuilds; ++i) {
+        NumResiduals = m_Residuals[i].size();
+        if (NumResiduals == 0) {
+            continue;
+        }
+        std::uniform_int_distribution<int> pick(0,NumResiduals-1);
+        sigma = m_ResidualStdDev[i];
+        for (int time = 0; time < NumYears; ++time) {
+            if (isMissing(Original(time,i)) || (m_FittedBiomass(time,i) <= 0)) {
+                continue;
+            }
+            if (Method == nmfBootstrapOptions::Residual) {
+                Observed(time,i) = m_FittedBiomass(time,i) * std::exp(m_Residuals[i][pick(rng)]);
+            } else {
+                Observed(time,i) = m_FittedBiomass(time,i) * std::exp(sigma*normal(rng) - 0.5*sigma*sigma);
+            }
+        }
+    }
+
+    // Keep the guild observations the sums of their members' resampled observations
+    if (! m_isAggProd &&
+        (Replicate.ObservedBiomassByGuilds.size1() == Replicate.ObservedBiomassBySpecies.size1())) {
+        for (unsigned guild = 0; guild < Replicate.ObservedBiomassByGuilds.size2(); ++guild) {
+            if (Inputs.GuildSpecies.find(guild) == Inputs.GuildSpecies.end()) {
+                continue;
+            }
+            for (unsigned time = 0; time < Replicate.ObservedBiomassByGuilds.size1(); ++time) {
+                guildBiomass = 0;
+                guildMissing = isMissing(Inputs.ObservedBiomassByGuilds(time,guild));
+                for (int species : Inputs.GuildSpecies.at(guild)) {
+                    if (species < int(Replicate.ObservedBiomassBySpecies.size2())) {
+                        guildMissing = guildMissing || isMissing(Replicate.ObservedBiomassBySpecies(time,species));
+                        guildBiomass += Replicate.ObservedBiomassBySpecies(time,species);
+                    }
+                }
+                if (! guildMissing) {
+                    Replicate.ObservedBiomassByGuilds(time,guild) = guildBiomass;
+                }
+            }
+        }
+    }
+}
+
+bool
+nmfBootstrap::run(Estimator EstimateReplicate,
+                  const nmfBootstrapOptions& Options,
+                  nmfBootstrapOutput& Output)
+{
+    const int ReplicateBlockSize = 25;
+    int NumReplicates = Options.NumReplicates;
+    int NumParameters = m_PointEstimate.size();
+    int NumQuantiles  = Options.Quantiles.size();
+    int NumBlocks     = (NumReplicates + ReplicateBlockSize - 1) / ReplicateBlockSize;
+    unsigned BaseSeed = (Options.Seed < 0) ? unsigned(nmfUtilsQt::getCurrentTime().currentMSecsSinceEpoch()) :
+                                             unsigned(Options.Seed);
+    int NumMerged = 0;
+    int NumGood   = 0;
+    double change;
+    double maxChange;
+    std::atomic<int> LastBlock(NumBlocks-1); // blocks after this one aren't started
+    std::mutex Mutex;
+
+    // Per block accumulators, merged in block order as soon as every earlier block is done.
+    // Sums are of the differences from the point estimate, which keeps the variance accurate.
+    struct BlockSummary {
+        bool Done;
+        int  NumGood;
+        int  NumFailed;
+        std::vector<nmfQuantileSketch> Sketches;
+        std::vector<double> Sum;
+        std::vector<double> SumSq;
+        BlockSummary() : Done(false), NumGood(0), NumFailed(0) {}
+    };
+    std::vector<BlockSummary> Blocks(std::max(NumBlocks,0));
+    std::vector<nmfQuantileSketch> Sketches(NumParameters,nmfQuantileSketch(Options.RelativeAccuracy));
+    std::vector<double> Sum(NumParameters,0.0);
+    std::vector<double> SumSq(NumParameters,0.0);
+    std::vector<double> PreviousQuantiles;
+    std::vector<double> CurrentQuantiles;
+
+    Output = nmfBootstrapOutput();
+    Output.NumReplicates       = 0;
+    Output.NumFailedReplicates = 0;
+    Output.Converged           = false;
+    Output.Quantiles           = Options.Quantiles;
+    if (NumReplicates <= 0) {
+        std::cout << "Error nmfBootstrap::run: Need at least one replicate" << std::endl;
+        return false;
+    }
+    if (NumParameters == 0) {
+        std::cout << "Error nmfBootstrap::run: No point estimate" << std::endl;
+        return false;
+    }
+
+    auto quantilesOf = [&](std::vector<double>& values) {
+        values.clear();
+        for (int k = 0; k < NumParameters; ++k) {
+            for (int q = 0; q < NumQuantiles; ++q) {
+                values.push_back(Sketches[k].quantile(Options.Quantiles[q]));
+            }
+        }
+    };
+
+    auto mergeFinishedBlocks = [&]() {
+        while ((NumMerged <= LastBlock) && Blocks[NumMerged].Done) {
+            BlockSummary& summary = Blocks[NumMerged];
+            for (int k = 0; k < NumParameters; ++k) {
+                Sketches[k].merge(summary.Sketches[k]);
+                Sum[k]   += summary.Sum[k];
+                SumSq[k] += summary.SumSq[k];
+            }
+            NumGood                    += summary.NumGood;
+            Output.NumReplicates       += summary.NumGood + summary.NumFailed;
+            Output.NumFailedReplicates += summary.NumFailed;
+            summary = BlockSummary();
+            summary.Done = true;
+            ++NumMerged;
+
+            // Stop once a whole block no longer moves any of the quantiles
+            if ((Options.ConvergenceTolerance > 0) && (NumMerged < NumBlocks) &&
+                (Output.NumReplicates >= Options.MinReplicates) && (NumGood > 0)) {
+                quantilesOf(CurrentQuantiles);
+                if (PreviousQuantiles.size() == CurrentQuantiles.size()) {
+                    maxChange = 0;
+                    for (unsigned j = 0; j < CurrentQuantiles.size(); ++j) {
+                        change = std::fabs(CurrentQuantiles[j]-PreviousQuantiles[j]);
+                        if (PreviousQuantiles[j] != 0) {
+                            change /= std::fabs(PreviousQuantiles[j]);
+                        }
+                        maxChange = std::max(maxChange,change);
+                    }
+                    if (maxChange <= Options.ConvergenceTolerance) {
+                        Output.Converged = true;
+                        LastBlock = NumMerged-1;
+                        break;
+                    }
+                }
+                PreviousQuantiles.swap(CurrentQuantiles);
+            }
+        }
+    };
+
+    auto worker = [&](const nmfUtils::NextTask& nextBlock) {
+        int block;
+        int replicateNum;
+        bool ok;
+        double difference;
+        std::vector<double> parameters;
+        nmfStructsQt::SharedModelData ReplicateData = m_ModelData; // copies the inputs on the first resample
+
+        while (nextBlock(block) && (block <= LastBlock)) {
+            BlockSummary summary;
+            summary.Sketches.assign(NumParameters,nmfQuantileSketch(Options.RelativeAccuracy));
+            summary.Sum.assign(NumParameters,0.0);
+            summary.SumSq.assign(NumParameters,0.0);
+
+            for (int replicate = 0; replicate < ReplicateBlockSize; ++replicate) {
+                replicateNum = block*ReplicateBlockSize + replicate;
+                if (replicateNum >= NumReplicates) {
+                    break;
+                }
+                std::mt19937_64 rng(BaseSeed + unsigned(replicateNum));
+                resample(Options.Method,rng,ReplicateData);
+
+                parameters.clear();
+                ok = EstimateReplicate(ReplicateData,replicateNum,m_PointEstimate,parameters) &&
+                     (int(parameters.size()) >= NumParameters);
+                for (int k = 0; ok && (k < NumParameters); ++k) {
+                    ok = std::isfinite(parameters[k]);
+                }
+                if (! ok) {
+                    ++summary.NumFailed;
+                    continue;
+                }
+                ++summary.NumGood;
+                for (int k = 0; k < NumParameters; ++k) {
+                    difference = parameters[k] - m_PointEstimate[k];
+                    summary.Sketches[k].add(parameters[k]);
+                    summary.Sum[k]   += difference;
+                    summary.SumSq[k] += difference*difference;
+                }
+            }
+
+            std::lock_guard<std::mutex> lock(Mutex);
+            summary.Done  = true;
+            Blocks[block] = std::move(summary);
+            mergeFinishedBlocks();
+        }
+    };
+    nmfUtils::runWorkers(Options.NumThreads,NumBlocks,worker);
+
+    if (NumGood == 0) {
+        std::cout << "Error nmfBootstrap::run: All replicates failed" << std::endl;
+        return false;
+    }
+
+    nmfUtils::initialize(Output.ParameterQuantiles,NumQuantiles,NumParameters);
+    Output.MeanParameters.assign(NumParameters,0.0);
+    Output.StdDevParameters.assign(NumParameters,0.0);
+    for (int k = 0; k < NumParameters; ++k) {
+        for (int q = 0; q < NumQuantiles; ++q) {
+            Output.ParameterQuantiles(q,k) = Sketches[k].quantile(Options.Quantiles[q]);
+        }
+        Output.MeanParameters[k] = m_PointEstimate[k] + Sum[k]/NumGood;
+        if (NumGood > 1) {
+            Output.StdDevParameters[k] = std::sqrt(std::max(0.0,(SumSq[k] - Sum[k]*Sum[k]/NumGood)/(NumGood-1)));
+        }
+    }
+
+    return true;
+}
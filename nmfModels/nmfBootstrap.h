@@ -0,0 +1,129 @@
+#pragma once
+
+#include <random>
+#include <vector>
+#include <string>
+#include <iostream>
+#include <functional>
+
+#include <boost/numeric/ublas/matrix.hpp>
+
+#include "nmfUtils.h"
+#include "nmfUtilsStatistics.h"
+#include "nmfForecastProjection.h"
+
+/**
+ * @brief Bootstrap run options
+ */
+struct nmfBootstrapOptions {
+    enum Resampling { Residual, Parametric };
+
+    Resampling Method;           // resample the log residuals or draw lognormal errors
+    int    NumReplicates;        // maximum number of replicates
+    int    MinReplicates;        // replicates to run before checking for convergence
+    int    Seed;                 // < 0 uses the current time
+    int    NumThreads;           // 0 uses one thread per core
+    double ConvergenceTolerance; // stop once no quantile moves by more than this fraction
+                                 // over a block of replicates (0 runs every replicate)
+    double RelativeAccuracy;     // relative accuracy of the quantiles
+    std::vector<double> Quantiles;
+    nmfBootstrapOptions() : Method(Residual), NumReplicates(0), MinReplicates(100),
+                            Seed(-1), NumThreads(0), ConvergenceTolerance(0),
+                            RelativeAccuracy(0.001), Quantiles({0.025,0.5,0.975}) {}
+};
+
+/**
+ * @brief Summary of a bootstrap. Parameters are in nmfParameterOffsets order, so e.g. the
+ * growth rate intervals are columns Offsets.GrowthRate.Offset on of ParameterQuantiles.
+ */
+struct nmfBootstrapOutput {
+    int  NumReplicates;       // replicates summarized
+    int  NumFailedReplicates; // replicates whose estimation failed, these aren't in the summaries
+    bool Converged;           // true if the quantiles converged before NumReplicates
+    std::vector<double> Quantiles;
+    boost::numeric::ublas::matrix<double> ParameterQuantiles; // (quantile, parameter)
+    std::vector<double> MeanParameters;
+    std::vector<double> StdDevParameters;
+};
+
+/**
+ * @brief Bootstraps the uncertainty of MSSPM parameter estimates. Each replicate replaces
+ * the observed biomass with the fitted biomass times resampled log residuals (or lognormal
+ * errors with each species' residual variance) and re-estimates the model, starting from the
+ * point estimate. The estimation is supplied by the caller and must be safe to run on several
+ * threads at once. nmfBeesEstimators::bootstrap() gives the Bees Algorithm estimator, which
+ * starts its search at the point estimate and stops once its fitness no longer improves.
+ *
+ * The replicates share the model's input data. A thread's first replicate copies the inputs
+ * (copy on write) and every later one only overwrites that copy's observed biomass, so the
+ * estimations don't copy the model data.
+ *
+ * The replicates run in fixed blocks spread over threads. Finished blocks are folded into
+ * streaming quantile sketches in block order, and the run stops early once a block no longer
+ * moves the quantiles. Each replicate draws from its own random stream seeded with
+ * Seed+ReplicateNum, so the results only depend upon the seed and not upon the number of threads.
+ */
+class nmfBootstrap {
+
+public:
+    /**
+     * @brief Estimates one replicate. Called on the replicate's thread with the model data
+     * holding the replicate's observed biomass, the replicate's number, and the point estimate
+     * to start from. ReplicateData may be shared, e.g. by a BeesAlgorithm, but must not be
+     * kept after the call, since the next replicate overwrites its observed biomass.
+     */
+    typedef std::function<bool(const nmfStructsQt::SharedModelData& ReplicateData,
+                               const int& ReplicateNum,
+                               const std::vector<double>& StartParameters,
+                               std::vector<double>& Parameters)> Estimator;
+
+private:
+    nmfStructsQt::SharedModelData m_ModelData;
+    std::vector<double> m_PointEstimate;
+    bool m_isAggProd;
+    int  m_NumSpeciesOrGuilds;
+    boost::numeric::ublas::matrix<double> m_FittedBiomass;
+    std::vector<std::vector<double> > m_Residuals; // non-missing log residuals per species or guild
+    std::vector<double> m_ResidualStdDev;
+
+    bool isMissing(const double& value) const;
+    void resample(const nmfBootstrapOptions::Resampling& Method,
+                  std::mt19937_64& rng,
+                  nmfStructsQt::SharedModelData& ReplicateData) const;
+
+public:
+    /**
+     * @brief Sets up a bootstrap and finds the residuals of the point estimate
+     * @param ModelData : model data the point estimate was found with, including the observed
+     * biomass and the Catch, Effort, and Exploitation (RunLength+1 years)
+     * @param PointEstimate : estimated parameters, in nmfParameterOffsets order
+     * @param FittedBiomass : (year, species or guild) biomass of the point estimate
+     */
+    nmfBootstrap(const nmfStructsQt::SharedModelData& ModelData,
+                 const std::vector<double>& PointEstimate,
+                 const boost::numeric::ublas::matrix<double>& FittedBiomass);
+   ~nmfBootstrap() {}
+
+    /**
+     * @brief Finds the fitted biomass of a parameter set by projecting from its initial
+     * biomass over the model's years with the model's harvest. The projection shares the
+     * model's input data.
+     * @param ModelData : model data with the form types and the Catch, Effort, and Exploitation
+     * @param Parameters : parameters, in nmfParameterOffsets order
+     * @param FittedBiomass : (year, species or guild) biomass
+     * @return False if the projection failed, else True
+     */
+    static bool fitBiomass(const nmfStructsQt::SharedModelData& ModelData,
+                           const std::vector<double>& Parameters,
+                           boost::numeric::ublas::matrix<double>& FittedBiomass);
+    /**
+     * @brief Runs the bootstrap replicates and summarizes the parameter estimates
+     * @param EstimateReplicate : the estimation to run on each replicate
+     * @param Options : number of replicates, resampling method, seed, threads, and quantiles
+     * @param Output : parameter quantiles, means, and standard deviations
+     * @return True if at least one replicate was estimated, else False
+     */
+    bool run(Estimator EstimateReplicate,
+             const nmfBootstrapOptions& Options,
+             nmfBootstrapOutput& Output);
+};
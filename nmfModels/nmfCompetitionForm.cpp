@@ -122,24 +122,48 @@ nmfCompetitionForm::extractParameters(
 
 }
 
+void
+nmfCompetitionForm::extractParameters(
+        const std::vector<double>& parameters,
+        const nmfParameterOffsets& offsets,
+        nmfMatrixView& competitionAlpha,
+        nmfMatrixView& competitionBetaSpecies,
+        nmfMatrixView& competitionBetaGuilds,
+        nmfMatrixView& competitionBetaGuildsGuilds)
+{
+    competitionAlpha            = offsets.matrixView(parameters,offsets.CompetitionAlpha);
+    competitionBetaSpecies      = offsets.matrixView(parameters,offsets.CompetitionBetaSpecies);
+    competitionBetaGuilds       = offsets.matrixView(parameters,offsets.CompetitionBetaGuilds);
+    competitionBetaGuildsGuilds = offsets.matrixView(parameters,offsets.CompetitionBetaGuildsGuilds);
+}
+
 
 void
 nmfCompetitionForm::loadParameterRanges(
         std::vector<std::pair<double,double> >& parameterRanges,
         nmfStructsQt::ModelDataStruct& dataStruct)
 {
-    bool isCheckedAlpha              = nmfUtils::isEstimateParameterChecked(dataStruct,"CompetitionAlpha");
-    bool isCheckedBetaSpeciesSpecies = nmfUtils::isEstimateParameterChecked(dataStruct,"CompetitionBetaSpeciesSpecies");
-    bool isCheckedBetaGuildSpecies   = nmfUtils::isEstimateParameterChecked(dataStruct,"CompetitionBetaGuildSpecies");
-    bool isCheckedBetaGuildGuild     = nmfUtils::isEstimateParameterChecked(dataStruct,"CompetitionBetaGuildGuild");
+    loadParameterRanges(parameterRanges,dataStruct,dataStruct);
+}
+
+void
+nmfCompetitionForm::loadParameterRanges(
+        std::vector<std::pair<double,double> >& parameterRanges,
+        const nmfStructsQt::ModelRunSettings& settings,
+        const nmfStructsQt::ModelInputData& dataStruct)
+{
+    bool isCheckedAlpha              = nmfUtils::isEstimateParameterChecked(settings,"CompetitionAlpha");
+    bool isCheckedBetaSpeciesSpecies = nmfUtils::isEstimateParameterChecked(settings,"CompetitionBetaSpeciesSpecies");
+    bool isCheckedBetaGuildSpecies   = nmfUtils::isEstimateParameterChecked(settings,"CompetitionBetaGuildSpecies");
+    bool isCheckedBetaGuildGuild     = nmfUtils::isEstimateParameterChecked(settings,"CompetitionBetaGuildGuild");
     double min;
     std::pair<double,double> aPair;
 
     if (m_type == "Null")
         return;
 
-    m_numSpecies = dataStruct.NumSpecies;
-    m_numGuilds  = dataStruct.NumGuilds;
+    m_numSpecies = settings.NumSpecies;
+    m_numGuilds  = settings.NumGuilds;
 
     if (m_type == "NO_K") {
         for (unsigned i=0; i<dataStruct.CompetitionMin.size(); ++i) {
@@ -217,19 +241,19 @@ nmfCompetitionForm::evaluate(const int& TimeMinus1,
                              const int& SpeciesNum,
                              const double& BiomassAtTime,
                              const double& SystemCarryingCapacity,
-                             const std::vector<double>& GrowthRate,
+                             const nmfVectorView& GrowthRate,
                              const double& GuildCarryingCapacity,
-                             const boost::numeric::ublas::matrix<double>& EstCompetitionAlpha,
-                             const boost::numeric::ublas::matrix<double>& EstCompetitionBetaSpecies,
-                             const boost::numeric::ublas::matrix<double>& EstCompetitionBetaGuild,
-                             const boost::numeric::ublas::matrix<double>& EstCompetitionBetaGuildGuild,
+                             const nmfMatrixView& EstCompetitionAlpha,
+                             const nmfMatrixView& EstCompetitionBetaSpecies,
+                             const nmfMatrixView& EstCompetitionBetaGuild,
+                             const nmfMatrixView& EstCompetitionBetaGuildGuild,
                              const boost::numeric::ublas::matrix<double>& EstBiomassSpecies,
                              const boost::numeric::ublas::matrix<double>& EstBiomassGuild)
 {
     if (m_FunctionMap.find(m_type) == m_FunctionMap.end()) {
         return 0;
     } else {
-        return (this->*m_FunctionMap[m_type])(TimeMinus1,SpeciesNum,BiomassAtTime,
+        return (this->*m_FunctionMap.at(m_type))(TimeMinus1,SpeciesNum,BiomassAtTime,
                                      SystemCarryingCapacity,GrowthRate,
                                      GuildCarryingCapacity,
                                      EstCompetitionAlpha,
@@ -246,12 +270,12 @@ nmfCompetitionForm::NoCompetition(const int& timeMinus1,
                                   const int& speciesNum,
                                   const double& biomassAtTime,
                                   const double& systemCarryingCapacity,
-                                  const std::vector<double>& growthRate,
+                                  const nmfVectorView& growthRate,
                                   const double& guildCarryingCapacity,
-                                  const boost::numeric::ublas::matrix<double> &EstCompetitionAlpha,
-                                  const boost::numeric::ublas::matrix<double> &EstCompetitionBetaSpecies,
-                                  const boost::numeric::ublas::matrix<double> &EstCompetitionBetaGuild,
-                                  const boost::numeric::ublas::matrix<double> &EstCompetitionBetaGuildGuild,
+                                  const nmfMatrixView &EstCompetitionAlpha,
+                                  const nmfMatrixView &EstCompetitionBetaSpecies,
+                                  const nmfMatrixView &EstCompetitionBetaGuild,
+                                  const nmfMatrixView &EstCompetitionBetaGuildGuild,
                                   const boost::numeric::ublas::matrix<double> &EstBiomassSpecies,
                                   const boost::numeric::ublas::matrix<double> &EstBiomassGuild)
 {
@@ -268,12 +292,12 @@ nmfCompetitionForm::NOKCompetition(const int& timeMinus1,
                                    const int& speciesNum,
                                    const double& biomassAtTime,
                                    const double& systemCarryingCapacity,
-                                   const std::vector<double>& growthRate,
+                                   const nmfVectorView& growthRate,
                                    const double& guildCarryingCapacity,
-                                   const boost::numeric::ublas::matrix<double> &EstCompetitionAlpha,
-                                   const boost::numeric::ublas::matrix<double> &EstCompetitionBetaSpecies,
-                                   const boost::numeric::ublas::matrix<double> &EstCompetitionBetaGuild,
-                                   const boost::numeric::ublas::matrix<double> &EstCompetitionBetaGuildGuild,
+                                   const nmfMatrixView &EstCompetitionAlpha,
+                                   const nmfMatrixView &EstCompetitionBetaSpecies,
+                                   const nmfMatrixView &EstCompetitionBetaGuild,
+                                   const nmfMatrixView &EstCompetitionBetaGuildGuild,
                                    const boost::numeric::ublas::matrix<double> &EstBiomassSpecies,
                                    const boost::numeric::ublas::matrix<double> &EstBiomassGuild)
 {
@@ -296,12 +320,12 @@ nmfCompetitionForm::MSPRODCompetition(
         const int& speciesNum,
         const double& biomassAtTime,
         const double& systemCarryingCapacity,
-        const std::vector<double>& growthRate,
+        const nmfVectorView& growthRate,
         const double& guildCarryingCapacity,
-        const boost::numeric::ublas::matrix<double> &EstCompetitionAlpha,
-        const boost::numeric::ublas::matrix<double> &EstCompetitionBetaSpecies,
-        const boost::numeric::ublas::matrix<double> &EstCompetitionBetaGuild,
-        const boost::numeric::ublas::matrix<double> &EstCompetitionBetaGuildGuild,
+        const nmfMatrixView &EstCompetitionAlpha,
+        const nmfMatrixView &EstCompetitionBetaSpecies,
+        const nmfMatrixView &EstCompetitionBetaGuild,
+        const nmfMatrixView &EstCompetitionBetaGuildGuild,
         const boost::numeric::ublas::matrix<double> &EstBiomassSpecies,
         const boost::numeric::ublas::matrix<double> &EstBiomassGuild)
 {
@@ -344,16 +368,16 @@ nmfCompetitionForm::AGGPRODCompetition(
         const int& speciesOrGuildNum,
         const double& biomassAtTime,
         const double& systemCarryingCapacity,
-        const std::vector<double>& growthRate,
+        const nmfVectorView& growthRate,
         const double& guildCarryingCapacity,
-        const boost::numeric::ublas::matrix<double> &EstCompetitionAlpha,
-        const boost::numeric::ublas::matrix<double> &EstCompetitionBetaSpecies,
-        const boost::numeric::ublas::matrix<double> &EstCompetitionBetaGuild,
-        const boost::numeric::ublas::matrix<double> &EstCompetitionBetaGuildGuild,
+        const nmfMatrixView &EstCompetitionAlpha,
+        const nmfMatrixView &EstCompetitionBetaSpecies,
+        const nmfMatrixView &EstCompetitionBetaGuild,
+        const nmfMatrixView &EstCompetitionBetaGuildGuild,
         const boost::numeric::ublas::matrix<double> &EstBiomassSpecies,
         const boost::numeric::ublas::matrix<double> &EstBiomassGuild)
 {
-    unsigned numGuilds  = EstCompetitionBetaGuild.size2();
+    unsigned numGuilds  = EstCompetitionBetaGuildGuild.size2();
     double sumOverGuilds  = 0;
     double term2;
 
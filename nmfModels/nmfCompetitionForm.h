@@ -13,6 +13,7 @@
 #include <boost/multi_array.hpp>
 
 #include "nmfUtils.h"
+#include "nmfParameterView.h"
 
 class nmfCompetitionForm {
 
@@ -32,12 +33,12 @@ private:
             const int& speciesNum,
             const double& biomassAtTime,
             const double& systemCarryingCapacity,
-            const std::vector<double>& growthRate,
+            const nmfVectorView& growthRate,
             const double& guildCarryingCapacity,
-            const boost::numeric::ublas::matrix<double>& EstCompetitionAlpha,
-            const boost::numeric::ublas::matrix<double>& EstCompetitionBetaSpecies,
-            const boost::numeric::ublas::matrix<double>& EstCompetitionBetaGuild,
-            const boost::numeric::ublas::matrix<double>& EstCompetitionBetaGuildGuild,
+            const nmfMatrixView& EstCompetitionAlpha,
+            const nmfMatrixView& EstCompetitionBetaSpecies,
+            const nmfMatrixView& EstCompetitionBetaGuild,
+            const nmfMatrixView& EstCompetitionBetaGuildGuild,
             const boost::numeric::ublas::matrix<double>& EstBiomassSpecies,
             const boost::numeric::ublas::matrix<double>& EstBiomassGuild
     )> m_FunctionMap;
@@ -57,67 +58,78 @@ public:
             boost::numeric::ublas::matrix<double>& competitionBetaSpecies,
             boost::numeric::ublas::matrix<double>& competitionBetaGuilds,
             boost::numeric::ublas::matrix<double>& competitionBetaGuildsGuilds);
+    void extractParameters(
+            const std::vector<double>& parameters,
+            const nmfParameterOffsets& offsets,
+            nmfMatrixView& competitionAlpha,
+            nmfMatrixView& competitionBetaSpecies,
+            nmfMatrixView& competitionBetaGuilds,
+            nmfMatrixView& competitionBetaGuildsGuilds);
     void loadParameterRanges(
             std::vector<std::pair<double,double> >& parameterRanges,
             nmfStructsQt::ModelDataStruct& beeStruct);
+    void loadParameterRanges(
+            std::vector<std::pair<double,double> >& parameterRanges,
+            const nmfStructsQt::ModelRunSettings& settings,
+            const nmfStructsQt::ModelInputData& inputs);
     long double evaluate(const int& timeMinus1,
                     const int& speciesNum,
                     const double& biomassAtTime,
                     const double& systemCarryingCapacity,
-                    const std::vector<double>& growthRate,
+                    const nmfVectorView& growthRate,
                     const double& guildCarryingCapacity,
-                    const boost::numeric::ublas::matrix<double>& EstCompetitionAlpha,
-                    const boost::numeric::ublas::matrix<double>& EstCompetitionBetaSpecies,
-                    const boost::numeric::ublas::matrix<double>& EstCompetitionBetaGuild,
-                    const boost::numeric::ublas::matrix<double>& EstCompetitionBetaGuildGuild,
+                    const nmfMatrixView& EstCompetitionAlpha,
+                    const nmfMatrixView& EstCompetitionBetaSpecies,
+                    const nmfMatrixView& EstCompetitionBetaGuild,
+                    const nmfMatrixView& EstCompetitionBetaGuildGuild,
                     const boost::numeric::ublas::matrix<double>& EstBiomassSpecies,
                     const boost::numeric::ublas::matrix<double>& EstBiomassGuild);
     long double NoCompetition(const int& timeMinus1,
                          const int& speciesNum,
                          const double& biomassAtTime,
                          const double& systemCarryingCapacity,
-                         const std::vector<double>& growthRate,
+                         const nmfVectorView& growthRate,
                          const double& guildCarryingCapacity,
-                         const boost::numeric::ublas::matrix<double>& EstCompetitionAlpha,
-                         const boost::numeric::ublas::matrix<double>& EstCompetitionBetaSpecies,
-                         const boost::numeric::ublas::matrix<double>& EstCompetitionBetaGuild,
-                         const boost::numeric::ublas::matrix<double>& EstCompetitionBetaGuildGuild,
+                         const nmfMatrixView& EstCompetitionAlpha,
+                         const nmfMatrixView& EstCompetitionBetaSpecies,
+                         const nmfMatrixView& EstCompetitionBetaGuild,
+                         const nmfMatrixView& EstCompetitionBetaGuildGuild,
                          const boost::numeric::ublas::matrix<double>& EstBiomassSpecies,
                          const boost::numeric::ublas::matrix<double>& EstBiomassGuild);
     long double NOKCompetition(const int& timeMinus1,
                           const int& speciesNum,
                           const double& biomassAtTime,
                           const double& systemCarryingCapacity,
-                          const std::vector<double>& growthRate,
+                          const nmfVectorView& growthRate,
                           const double& guildCarryingCapacity,
-                          const boost::numeric::ublas::matrix<double>& EstCompetitionAlpha,
-                          const boost::numeric::ublas::matrix<double>& EstCompetitionBetaSpecies,
-                          const boost::numeric::ublas::matrix<double>& EstCompetitionBetaGuild,
-                          const boost::numeric::ublas::matrix<double>& EstCompetitionBetaGuildGuild,
+                          const nmfMatrixView& EstCompetitionAlpha,
+                          const nmfMatrixView& EstCompetitionBetaSpecies,
+                          const nmfMatrixView& EstCompetitionBetaGuild,
+                          const nmfMatrixView& EstCompetitionBetaGuildGuild,
                           const boost::numeric::ublas::matrix<double>& EstBiomassSpecies,
                           const boost::numeric::ublas::matrix<double>& EstBiomassGuild);
     long double MSPRODCompetition(const int& timeMinus1,
                              const int& speciesNum,
                              const double& biomassAtTime,
                              const double& systemCarryingCapacity,
-                             const std::vector<double>& growthRate,
+                             const nmfVectorView& growthRate,
                              const double& guildCarryingCapacity,
-                             const boost::numeric::ublas::matrix<double>& EstCompetitionAlpha,
-                             const boost::numeric::ublas::matrix<double>& EstCompetitionBetaSpecies,
-                             const boost::numeric::ublas::matrix<double>& EstCompetitionBetaGuild,
-                             const boost::numeric::ublas::matrix<double>& EstCompetitionBetaGuildGuild,
+                             const nmfMatrixView& EstCompetitionAlpha,
+                             const nmfMatrixView& EstCompetitionBetaSpecies,
+                             const nmfMatrixView& EstCompetitionBetaGuild,
+                             const nmfMatrixView& EstCompetitionBetaGuildGuild,
                              const boost::numeric::ublas::matrix<double>& EstBiomassSpecies,
                              const boost::numeric::ublas::matrix<double>& EstBiomassGuild);
     long double AGGPRODCompetition(const int& timeMinus1,
                               const int& speciesNum,
                               const double& biomassAtTime,
                               const double& systemCarryingCapacity,
-                              const std::vector<double>& growthRate,
+                              const nmfVectorView& growthRate,
                               const double& guildCarryingCapacity,
-                              const boost::numeric::ublas::matrix<double>& EstCompetitionAlpha,
-                              const boost::numeric::ublas::matrix<double>& EstCompetitionBetaSpecies,
-                              const boost::numeric::ublas::matrix<double>& EstCompetitionBetaGuild,
-                              const boost::numeric::ublas::matrix<double>& EstCompetitionBetaGuildGuild,
+                              const nmfMatrixView& EstCompetitionAlpha,
+                              const nmfMatrixView& EstCompetitionBetaSpecies,
+                              const nmfMatrixView& EstCompetitionBetaGuild,
+                              const nmfMatrixView& EstCompetitionBetaGuildGuild,
                               const boost::numeric::ublas::matrix<double>& EstBiomassSpecies,
                               const boost::numeric::ublas::matrix<double>& EstBiomassGuild);
     void setupFormMaps();
@@ -0,0 +1,209 @@
+
+#include "nmfForecastMonteCarlo.h"
+#include "nmfUtilsQtCore.h"
+
+#include <mutex>
+#include <random>
+
+nmfForecastMonteCarlo::nmfForecastMonteCarlo(
+        const nmfStructsQt::SharedModelData& ModelData,
+        const std::vector<double>& Parameters,
+        const std::vector<double>& InitBiomass,
+        const nmfForecastUncertainty& Uncertainty)
+    : m_Projection(ModelData,InitBiomass)
+{
+    m_Parameters  = Parameters;
+    m_Uncertainty = Uncertainty;
+}
+
+void
+nmfForecastMonteCarlo::perturbBlock(const nmfParameterBlock& block,
+                                    const std::vector<double>& uncertainty,
+                                    std::mt19937_64& rng,
+                                    std::vector<double>& parameters)
+{
+    std::uniform_real_distribution<double> dist(-1.0,1.0);
+    int index;
+
+    // Every value gets its own draw so the stream advances the same way
+    // regardless of which uncertainties are set
+    for (int row = 0; row < block.Rows; ++row) {
+        double fraction = (row < int(uncertainty.size())) ? uncertainty[row] : 0.0;
+        for (int col = 0; col < block.Cols; ++col) {
+            index = block.Offset + row*block.Cols + col;
+            parameters[index] *= (1.0 + fraction*dist(rng));
+        }
+    }
+}
+
+bool
+nmfForecastMonteCarlo::run(const nmfForecastMonteCarloOptions& Options,
+                           nmfForecastMonteCarloOutput& Output)
+{
+    const int RunBlockSize = 32;
+    int NumRuns      = Options.NumRuns;
+    int NumYears     = m_Projection.numYears();
+    int NumSpeciesOrGuilds = m_Projection.numSpeciesOrGuilds();
+    int NumSampled   = std::min(std::max(Options.NumSampledRuns,0),std::max(NumRuns,0));
+    int NumBlocks    = (NumRuns + RunBlockSize - 1) / RunBlockSize;
+    int NumQuantiles = Options.Quantiles.size();
+    unsigned BaseSeed = (Options.Seed < 0) ? unsigned(nmfUtilsQt::getCurrentTime().currentMSecsSinceEpoch()) :
+                                             unsigned(Options.Seed);
+    int NumCells     = NumYears*NumSpeciesOrGuilds;
+    int NumMerged    = 0;
+    std::mutex Mutex;
+    std::map<int,int> SampledSlot; // run number -> index into Output.SampledBiomass
+    const nmfParameterOffsets& Offsets = m_Projection.offsets();
+    const nmfStructsQt::ModelInputData& Inputs = m_Projection.modelData().inputs();
+
+    // Per block accumulators, merged in block order as soon as every earlier block is
+    // done and then freed, so only the blocks still waiting on an earlier one are held
+    struct BlockSummary {
+        bool Done;
+        int  NumFailed;
+        std::vector<nmfQuantileSketch> Sketches; // (time,species) row major
+        std::vector<double> Sum;
+        BlockSummary() : Done(false), NumFailed(0) {}
+    };
+    std::vector<BlockSummary> Blocks(std::max(NumBlocks,0));
+    std::vector<nmfQuantileSketch> Sketches(NumCells,nmfQuantileSketch(Options.RelativeAccuracy));
+    std::vector<double> Sum(NumCells,0.0);
+
+    Output.NumRuns       = NumRuns;
+    Output.NumFailedRuns = 0;
+    Output.Quantiles     = Options.Quantiles;
+    Output.QuantileBiomass.clear();
+    Output.SampledRunNums.clear();
+    Output.SampledBiomass.clear();
+    if (NumRuns <= 0) {
+        std::cout << "Error nmfForecastMonteCarlo::run: Need at least one run" << std::endl;
+        return false;
+    }
+    if (! m_Projection.isValid(m_Parameters)) {
+        std::cout << "Error nmfForecastMonteCarlo::run: Need at least one year and species and " <<
+                     "enough initial biomass values and parameters" << std::endl;
+        return false;
+    }
+
+    for (int i = 0; i < NumSampled; ++i) {
+        int runNum = int((long(i)*NumRuns)/NumSampled);
+        SampledSlot[runNum] = i;
+        Output.SampledRunNums.push_back(runNum);
+    }
+    Output.SampledBiomass.assign(NumSampled,boost::numeric::ublas::matrix<double>());
+
+    auto mergeFinishedBlocks = [&]() {
+        while ((NumMerged < NumBlocks) && Blocks[NumMerged].Done) {
+            BlockSummary& summary = Blocks[NumMerged];
+            for (int cell = 0; cell < NumCells; ++cell) {
+                Sketches[cell].merge(summary.Sketches[cell]);
+                Sum[cell] += summary.Sum[cell];
+            }
+            Output.NumFailedRuns += summary.NumFailed;
+            summary = BlockSummary();
+            summary.Done = true;
+            ++NumMerged;
+        }
+    };
+
+    auto worker = [&](const nmfUtils::NextTask& nextBlock) {
+        int block;
+        int runNum;
+        nmfForecastForms forms(m_Projection.modelData().Settings);
+        std::vector<double> parameters;
+        std::uniform_real_distribution<double> dist(-1.0,1.0);
+        boost::numeric::ublas::matrix<double> catchData;
+        boost::numeric::ublas::matrix<double> effort;
+        boost::numeric::ublas::matrix<double> exploitation;
+        boost::numeric::ublas::matrix<double> estBiomassSpecies;
+        boost::numeric::ublas::matrix<double> estBiomassGuilds;
+
+        m_Projection.initializeBiomass(estBiomassSpecies,estBiomassGuilds);
+
+        while (nextBlock(block)) {
+            BlockSummary summary;
+            summary.Sketches.assign(NumCells,nmfQuantileSketch(Options.RelativeAccuracy));
+            summary.Sum.assign(NumCells,0.0);
+
+            for (int run = 0; run < RunBlockSize; ++run) {
+                runNum = block*RunBlockSize + run;
+                if (runNum >= NumRuns) {
+                    break;
+                }
+                std::mt19937_64 rng(BaseSeed + unsigned(runNum));
+
+                parameters = m_Parameters;
+                perturbBlock(Offsets.GrowthRate,                  m_Uncertainty.GrowthRate,                  rng,parameters);
+                perturbBlock(Offsets.CarryingCapacity,            m_Uncertainty.CarryingCapacity,            rng,parameters);
+                perturbBlock(Offsets.Catchability,                m_Uncertainty.Catchability,                rng,parameters);
+                perturbBlock(Offsets.CompetitionAlpha,            m_Uncertainty.CompetitionAlpha,            rng,parameters);
+                perturbBlock(Offsets.CompetitionBetaSpecies,      m_Uncertainty.CompetitionBetaSpecies,      rng,parameters);
+                perturbBlock(Offsets.CompetitionBetaGuilds,       m_Uncertainty.CompetitionBetaGuilds,       rng,parameters);
+                perturbBlock(Offsets.CompetitionBetaGuildsGuilds, m_Uncertainty.CompetitionBetaGuildsGuilds, rng,parameters);
+                perturbBlock(Offsets.PredationRho,                m_Uncertainty.Predation,                   rng,parameters);
+                perturbBlock(Offsets.PredationHandling,           m_Uncertainty.Handling,                    rng,parameters);
+                perturbBlock(Offsets.PredationExponent,           m_Uncertainty.Exponent,                    rng,parameters);
+
+                // Harvest uncertainty scales each species' whole forecast harvest
+                catchData    = Inputs.Catch;
+                effort       = Inputs.Effort;
+                exploitation = Inputs.Exploitation;
+                for (int i = 0; i < NumSpeciesOrGuilds; ++i) {
+                    double fraction = (i < int(m_Uncertainty.Harvest.size())) ? m_Uncertainty.Harvest[i] : 0.0;
+                    double scale    = 1.0 + fraction*dist(rng);
+                    for (boost::numeric::ublas::matrix<double>* harvest : {&catchData,&effort,&exploitation}) {
+                        if (i < int(harvest->size2())) {
+                            for (unsigned time = 0; time < harvest->size1(); ++time) {
+                                (*harvest)(time,i) *= scale;
+                            }
+                        }
+                    }
+                }
+
+                if (! m_Projection.project(forms,parameters,catchData,effort,exploitation,
+                                           estBiomassSpecies,estBiomassGuilds)) {
+                    ++summary.NumFailed;
+                    continue;
+                }
+                for (int time = 0; time < NumYears; ++time) {
+                    for (int i = 0; i < NumSpeciesOrGuilds; ++i) {
+                        summary.Sketches[time*NumSpeciesOrGuilds+i].add(estBiomassSpecies(time,i));
+                        summary.Sum[time*NumSpeciesOrGuilds+i] += estBiomassSpecies(time,i);
+                    }
+                }
+                if (SampledSlot.find(runNum) != SampledSlot.end()) {
+                    Output.SampledBiomass[SampledSlot.at(runNum)] = estBiomassSpecies;
+                }
+            }
+
+            std::lock_guard<std::mutex> lock(Mutex);
+            summary.Done  = true;
+            Blocks[block] = std::move(summary);
+            mergeFinishedBlocks();
+        }
+    };
+    nmfUtils::runWorkers(Options.NumThreads,NumBlocks,worker);
+
+    int NumGoodRuns = NumRuns - Output.NumFailedRuns;
+    nmfUtils::initialize(Output.MeanBiomass,NumYears,NumSpeciesOrGuilds);
+    nmfUtils::initialize(Output.MinBiomass, NumYears,NumSpeciesOrGuilds);
+    nmfUtils::initialize(Output.MaxBiomass, NumYears,NumSpeciesOrGuilds);
+    Output.QuantileBiomass.assign(NumQuantiles,Output.MeanBiomass);
+    if (NumGoodRuns == 0) {
+        std::cout << "Error nmfForecastMonteCarlo::run: All runs failed" << std::endl;
+        return false;
+    }
+    for (int time = 0; time < NumYears; ++time) {
+        for (int i = 0; i < NumSpeciesOrGuilds; ++i) {
+            nmfQuantileSketch& sketch = Sketches[time*NumSpeciesOrGuilds+i];
+            Output.MeanBiomass(time,i) = Sum[time*NumSpeciesOrGuilds+i]/NumGoodRuns;
+            Output.MinBiomass(time,i)  = sketch.min();
+            Output.MaxBiomass(time,i)  = sketch.max();
+            for (int q = 0; q < NumQuantiles; ++q) {
+                Output.QuantileBiomass[q](time,i) = sketch.quantile(Options.Quantiles[q]);
+            }
+        }
+    }
+
+    return true;
+}
@@ -0,0 +1,112 @@
+#pragma once
+
+#include <map>
+#include <random>
+#include <vector>
+#include <string>
+#include <iostream>
+
+#include <boost/numeric/ublas/matrix.hpp>
+
+#include "nmfUtils.h"
+#include "nmfUtilsStatistics.h"
+#include "nmfForecastProjection.h"
+
+/**
+ * @brief Forecast parameter uncertainty, as a fraction (e.g., 0.1 for ±10%) per species
+ * or guild. A parameter is perturbed uniformly within ± its fraction on every run. Rows
+ * of the matrix parameters use the fraction of their species or guild. Missing or empty
+ * entries mean no uncertainty.
+ */
+struct nmfForecastUncertainty {
+    std::vector<double> GrowthRate;
+    std::vector<double> CarryingCapacity;
+    std::vector<double> Catchability;
+    std::vector<double> Exponent;
+    std::vector<double> CompetitionAlpha;
+    std::vector<double> CompetitionBetaSpecies;
+    std::vector<double> CompetitionBetaGuilds;
+    std::vector<double> CompetitionBetaGuildsGuilds;
+    std::vector<double> Predation;
+    std::vector<double> Handling;
+    std::vector<double> Harvest;
+};
+
+/**
+ * @brief Monte Carlo forecast run options
+ */
+struct nmfForecastMonteCarloOptions {
+    int    NumRuns;
+    int    Seed;             // < 0 uses the current time
+    int    NumThreads;       // 0 uses one thread per core
+    int    NumSampledRuns;   // number of complete runs to keep (evenly spaced over the runs)
+    double RelativeAccuracy; // relative accuracy of the quantiles
+    std::vector<double> Quantiles;
+    nmfForecastMonteCarloOptions() : NumRuns(0), Seed(-1), NumThreads(0),
+                                     NumSampledRuns(0), RelativeAccuracy(0.005),
+                                     Quantiles({0.05,0.25,0.5,0.75,0.95}) {}
+};
+
+/**
+ * @brief Summary of a Monte Carlo forecast. All matrices are (time, species or guild).
+ */
+struct nmfForecastMonteCarloOutput {
+    int NumRuns;
+    int NumFailedRuns; // runs that went to NaN, these aren't in the summaries
+    std::vector<double> Quantiles;
+    std::vector<boost::numeric::ublas::matrix<double> > QuantileBiomass; // one per quantile
+    boost::numeric::ublas::matrix<double> MeanBiomass;
+    boost::numeric::ublas::matrix<double> MinBiomass;
+    boost::numeric::ublas::matrix<double> MaxBiomass;
+    std::vector<int> SampledRunNums;
+    std::vector<boost::numeric::ublas::matrix<double> > SampledBiomass;  // one per sampled run
+};
+
+/**
+ * @brief In process Monte Carlo forecast. Each run perturbs the estimated parameters and
+ * the forecast harvest within the requested uncertainty and projects the system forward
+ * with the growth, harvest, competition, and predation forms. The runs are spread over
+ * threads and the per year biomass is accumulated into streaming quantile sketches, so
+ * memory doesn't grow with the number of runs and only the summary bands (and optionally
+ * a few sampled runs) need to be written to the database.
+ *
+ * Each run draws from its own random stream seeded with Seed+RunNum, and the runs are
+ * accumulated in fixed blocks that are combined in block order, so the results only
+ * depend upon the seed and not upon the number of threads.
+ */
+class nmfForecastMonteCarlo {
+
+private:
+    nmfForecastProjection  m_Projection;
+    std::vector<double>    m_Parameters;
+    nmfForecastUncertainty m_Uncertainty;
+
+    void perturbBlock(const nmfParameterBlock& block,
+                      const std::vector<double>& uncertainty,
+                      std::mt19937_64& rng,
+                      std::vector<double>& parameters);
+
+public:
+    /**
+     * @brief Sets up a Monte Carlo forecast
+     * @param ModelData : model data with the form types, species and guild counts, guild
+     * membership, and the forecast Catch, Effort, and Exploitation (RunLength+1 years)
+     * @param Parameters : estimated parameters, in nmfParameterOffsets order
+     * @param InitBiomass : biomass at the start of the forecast per species or guild
+     * @param Uncertainty : per parameter group uncertainty fractions
+     */
+    nmfForecastMonteCarlo(const nmfStructsQt::SharedModelData& ModelData,
+                          const std::vector<double>& Parameters,
+                          const std::vector<double>& InitBiomass,
+                          const nmfForecastUncertainty& Uncertainty);
+   ~nmfForecastMonteCarlo() {}
+
+    /**
+     * @brief Runs the forecast ensemble and summarizes it
+     * @param Options : number of runs, seed, threads, sampled runs, and quantiles
+     * @param Output : quantile bands, mean, min, max, and the sampled runs
+     * @return True if the forecast was run, else False
+     */
+    bool run(const nmfForecastMonteCarloOptions& Options,
+             nmfForecastMonteCarloOutput& Output);
+};
@@ -0,0 +1,232 @@
+#include "nmfForecastProjection.h"
+
+#include <cmath>
+
+nmfForecastForms::nmfForecastForms(const nmfStructsQt::ModelRunSettings& Settings)
+    : Growth(Settings.GrowthForm),
+      Harvest(Settings.HarvestForm),
+      Competition(Settings.CompetitionForm),
+      Predation(Settings.PredationForm)
+{
+    bool isAggProd = (Settings.CompetitionForm == "AGG-PROD");
+
+    Growth.setAggProd(isAggProd);
+    Harvest.setAggProd(isAggProd);
+    Competition.setAggProd(isAggProd);
+    Predation.setAggProd(isAggProd);
+}
+
+nmfForecastProjection::nmfForecastProjection(
+        const nmfStructsQt::SharedModelData& ModelData,
+        const std::vector<double>& InitBiomass)
+{
+    const nmfStructsQt::ModelRunSettings& Settings = ModelData.Settings;
+    const nmfStructsQt::ModelInputData&   Inputs   = ModelData.inputs();
+
+    m_ModelData   = ModelData;
+    m_InitBiomass = InitBiomass;
+    m_isAggProd   = (Settings.CompetitionForm == "AGG-PROD");
+    m_NumYears    = Settings.RunLength+1;
+    m_NumGuilds   = std::max(Settings.NumGuilds,0);
+    m_NumSpeciesOrGuilds = (m_isAggProd) ? Settings.NumGuilds : Settings.NumSpecies;
+
+    m_Offsets.load(Settings);
+
+    // Copy the guild membership out of the map so the projecting threads only ever read it
+    m_GuildSpecies.assign(m_NumGuilds,std::vector<int>());
+    for (int i=0; i<m_NumGuilds; ++i) {
+        if (Inputs.GuildSpecies.find(i) != Inputs.GuildSpecies.end()) {
+            m_GuildSpecies[i] = Inputs.GuildSpecies.at(i);
+        }
+    }
+    // Under AGG-PROD the columns are the guilds themselves
+    m_GuildNum.assign(std::max(m_NumSpeciesOrGuilds,0),0);
+    for (int i=0; i<m_NumSpeciesOrGuilds; ++i) {
+        if (m_isAggProd) {
+            m_GuildNum[i] = i;
+        } else if (i < int(Inputs.GuildNum.size())) {
+            m_GuildNum[i] = Inputs.GuildNum[i];
+        }
+    }
+}
+
+void
+nmfForecastProjection::sumGuildBiomass(
+        const int& Time,
+        const boost::numeric::ublas::matrix<double>& EstBiomassSpecies,
+        boost::numeric::ublas::matrix<double>& EstBiomassGuilds) const
+{
+    for (int i=0; i<m_NumGuilds; ++i) {
+        EstBiomassGuilds(Time,i) = 0;
+        if (m_isAggProd) {
+            if (i < m_NumSpeciesOrGuilds) {
+                EstBiomassGuilds(Time,i) = EstBiomassSpecies(Time,i);
+            }
+            continue;
+        }
+        for (int species : m_GuildSpecies[i]) {
+            if (species < m_NumSpeciesOrGuilds) {
+                EstBiomassGuilds(Time,i) += EstBiomassSpecies(Time,species);
+            }
+        }
+    }
+}
+
+bool
+nmfForecastProjection::isValid(const std::vector<double>& Parameters) const
+{
+    return (m_NumYears > 0) && (m_NumSpeciesOrGuilds > 0) &&
+           (int(m_InitBiomass.size()) >= m_NumSpeciesOrGuilds) &&
+           (int(Parameters.size()) >= m_Offsets.getTotalNumberParameters());
+}
+
+void
+nmfForecastProjection::initializeBiomass(
+        boost::numeric::ublas::matrix<double>& EstBiomassSpecies,
+        boost::numeric::ublas::matrix<double>& EstBiomassGuilds) const
+{
+    nmfUtils::initialize(EstBiomassSpecies,m_NumYears,m_NumSpeciesOrGuilds);
+    nmfUtils::initialize(EstBiomassGuilds, m_NumYears,m_NumGuilds);
+}
+
+void
+nmfForecastProjection::getCarryingCapacity(
+        nmfForecastForms& Forms,
+        const std::vector<double>& Parameters,
+        std::vector<double>& CarryingCapacity) const
+{
+    double systemCarryingCapacity;
+    nmfVectorView growthRate;
+    nmfVectorView carryingCapacity;
+
+    Forms.Growth.extractParameters(Parameters,m_Offsets,growthRate,
+                                   carryingCapacity,systemCarryingCapacity);
+    CarryingCapacity.clear();
+    for (int i=0; i<int(carryingCapacity.size()); ++i) {
+        CarryingCapacity.push_back(carryingCapacity[i]);
+    }
+}
+
+bool
+nmfForecastProjection::project(
+        nmfForecastForms& Forms,
+        const std::vector<double>& Parameters,
+        const boost::numeric::ublas::matrix<double>& CatchData,
+        const boost::numeric::ublas::matrix<double>& Effort,
+        const boost::numeric::ublas::matrix<double>& Exploitation,
+        boost::numeric::ublas::matrix<double>& EstBiomassSpecies,
+        boost::numeric::ublas::matrix<double>& EstBiomassGuilds) const
+{
+    EstBiomassSpecies.clear();
+    EstBiomassGuilds.clear();
+    for (int i=0; i<m_NumSpeciesOrGuilds; ++i) {
+        EstBiomassSpecies(0,i) = m_InitBiomass[i];
+    }
+    sumGuildBiomass(0,EstBiomassSpecies,EstBiomassGuilds);
+
+    return projectFrom(Forms,Parameters,CatchData,Effort,Exploitation,1,
+                       EstBiomassSpecies,EstBiomassGuilds);
+}
+
+bool
+nmfForecastProjection::projectFrom(
+        nmfForecastForms& Forms,
+        const std::vector<double>& Parameters,
+        const boost::numeric::ublas::matrix<double>& CatchData,
+        const boost::numeric::ublas::matrix<double>& Effort,
+        const boost::numeric::ublas::matrix<double>& Exploitation,
+        const int& FirstTime,
+        boost::numeric::ublas::matrix<double>& EstBiomassSpecies,
+        boost::numeric::ublas::matrix<double>& EstBiomassGuilds) const
+{
+    int startTime = std::max(FirstTime,1);
+    int timeMinus1;
+    int guildNum;
+    double estBiomassVal;
+    double growthTerm;
+    double harvestTerm;
+    double competitionTerm;
+    double predationTerm;
+    double systemCarryingCapacity;
+    double guildK;
+    std::vector<double> guildCarryingCapacity;
+    nmfVectorView growthRate;
+    nmfVectorView carryingCapacity;
+    nmfVectorView exponent;
+    nmfVectorView catchabilityRate;
+    nmfMatrixView competitionAlpha;
+    nmfMatrixView competitionBetaSpecies;
+    nmfMatrixView competitionBetaGuilds;
+    nmfMatrixView competitionBetaGuildsGuilds;
+    nmfMatrixView predation;
+    nmfMatrixView handling;
+
+    Forms.Growth.extractParameters(Parameters,m_Offsets,growthRate,
+                                   carryingCapacity,systemCarryingCapacity);
+    Forms.Harvest.extractParameters(Parameters,m_Offsets,catchabilityRate);
+    Forms.Competition.extractParameters(Parameters,m_Offsets,competitionAlpha,
+                                        competitionBetaSpecies,competitionBetaGuilds,
+                                        competitionBetaGuildsGuilds);
+    Forms.Predation.extractPredationParameters(Parameters,m_Offsets,predation);
+    Forms.Predation.extractHandlingParameters(Parameters,m_Offsets,handling);
+    Forms.Predation.extractExponentParameters(Parameters,m_Offsets,exponent);
+
+    // Guild carrying capacity is the sum of its members' and the system's the sum of the guilds'.
+    // Under AGG-PROD the growth form's carrying capacities are already per guild.
+    systemCarryingCapacity = 0;
+    for (int i=0; i<m_NumGuilds; ++i) {
+        guildK = 0;
+        if (m_isAggProd) {
+            if (i < int(carryingCapacity.size())) {
+                guildK = carryingCapacity[i];
+            }
+        } else {
+            for (int species : m_GuildSpecies[i]) {
+                if (species < int(carryingCapacity.size())) {
+                    guildK += carryingCapacity[species];
+                }
+            }
+        }
+        systemCarryingCapacity += guildK;
+        guildCarryingCapacity.push_back(guildK);
+    }
+
+    for (int time=startTime; time<m_NumYears; ++time) {
+        timeMinus1 = time - 1;
+        for (int i=0; i<m_NumSpeciesOrGuilds; ++i) {
+            guildNum      = m_GuildNum[i];
+            estBiomassVal = EstBiomassSpecies(timeMinus1,i);
+
+            growthTerm      = Forms.Growth.evaluate(i,estBiomassVal,growthRate,carryingCapacity);
+            harvestTerm     = Forms.Harvest.evaluate(timeMinus1,i,CatchData,Effort,Exploitation,
+                                                     estBiomassVal,catchabilityRate);
+            competitionTerm = Forms.Competition.evaluate(
+                                   timeMinus1,i,estBiomassVal,
+                                   systemCarryingCapacity,
+                                   growthRate,
+                                   (guildNum < int(guildCarryingCapacity.size())) ?
+                                        guildCarryingCapacity[guildNum] : 0.0,
+                                   competitionAlpha,
+                                   competitionBetaSpecies,
+                                   competitionBetaGuilds,
+                                   competitionBetaGuildsGuilds,
+                                   EstBiomassSpecies,
+                                   EstBiomassGuilds);
+            predationTerm   = Forms.Predation.evaluate(
+                                   timeMinus1,i,
+                                   predation,handling,exponent,
+                                   EstBiomassSpecies,estBiomassVal);
+
+            estBiomassVal += growthTerm - harvestTerm - competitionTerm - predationTerm;
+            if (std::isnan(std::fabs(estBiomassVal))) {
+                return false;
+            }
+            EstBiomassSpecies(time,i) = (estBiomassVal < 0) ? 0 : estBiomassVal;
+        }
+
+        // Update the guild biomass for the next time step
+        sumGuildBiomass(time,EstBiomassSpecies,EstBiomassGuilds);
+    }
+
+    return true;
+}
@@ -0,0 +1,137 @@
+#pragma once
+
+#include <vector>
+#include <string>
+#include <iostream>
+
+#include <boost/numeric/ublas/matrix.hpp>
+
+#include "nmfUtils.h"
+#include "nmfParameterView.h"
+#include "nmfGrowthForm.h"
+#include "nmfHarvestForm.h"
+#include "nmfCompetitionForm.h"
+#include "nmfPredationForm.h"
+
+/**
+ * @brief The growth, harvest, competition, and predation forms of a model. The forms
+ * keep working state, so every thread that projects needs its own set.
+ */
+struct nmfForecastForms {
+    nmfGrowthForm      Growth;
+    nmfHarvestForm     Harvest;
+    nmfCompetitionForm Competition;
+    nmfPredationForm   Predation;
+
+    nmfForecastForms(const nmfStructsQt::ModelRunSettings& Settings);
+};
+
+/**
+ * @brief Read only forecast state shared by every projection of a model: the form types,
+ * species and guild membership, parameter offsets, initial biomass, and the baseline
+ * forecast harvest. It shares the model's input data instead of copying
+ * it. It's loaded once and may then be projected from any number of
+ * threads at the same time, each with its own nmfForecastForms and output matrices.
+ * Guild and system carrying capacities are the sums over the member species, except under
+ * AGG-PROD where the columns and the estimated carrying capacities are already per guild.
+ */
+class nmfForecastProjection {
+
+private:
+    nmfStructsQt::SharedModelData m_ModelData;
+    std::vector<double>    m_InitBiomass;
+    nmfParameterOffsets    m_Offsets;
+    std::vector<std::vector<int> > m_GuildSpecies; // species numbers per guild
+    std::vector<int>       m_GuildNum;             // guild number per species
+    bool m_isAggProd;
+    int  m_NumYears;
+    int  m_NumSpeciesOrGuilds;
+    int  m_NumGuilds;
+
+    void sumGuildBiomass(const int& Time,
+                         const boost::numeric::ublas::matrix<double>& EstBiomassSpecies,
+                         boost::numeric::ublas::matrix<double>& EstBiomassGuilds) const;
+
+public:
+    /**
+     * @brief Loads the shared forecast state
+     * @param ModelData : model data with the form types, species and guild counts, guild
+     * membership, and the forecast Catch, Effort, and Exploitation (RunLength+1 years)
+     * @param InitBiomass : biomass at the start of the forecast per species or guild
+     */
+    nmfForecastProjection(const nmfStructsQt::SharedModelData& ModelData,
+                          const std::vector<double>& InitBiomass);
+   ~nmfForecastProjection() {}
+
+    /**
+     * @brief Checks that there are enough years, species, initial biomass values, and parameters
+     * @param Parameters : estimated parameters, in nmfParameterOffsets order
+     * @return True if a projection may be run, else False
+     */
+    bool isValid(const std::vector<double>& Parameters) const;
+    /**
+     * @brief Sizes the biomass matrices that project fills
+     * @param EstBiomassSpecies : (time, species or guild) biomass
+     * @param EstBiomassGuilds : (time, guild) biomass
+     */
+    void initializeBiomass(boost::numeric::ublas::matrix<double>& EstBiomassSpecies,
+                           boost::numeric::ublas::matrix<double>& EstBiomassGuilds) const;
+    /**
+     * @brief Projects the system forward over the forecast years. Negative biomass is set to 0.
+     * @param Forms : this thread's model forms
+     * @param Parameters : parameters to project with, in nmfParameterOffsets order
+     * @param CatchData : forecast catch (time, species or guild)
+     * @param Effort : forecast effort (time, species or guild)
+     * @param Exploitation : forecast exploitation rate (time, species or guild)
+     * @param EstBiomassSpecies : projected biomass, sized by initializeBiomass
+     * @param EstBiomassGuilds : projected guild biomass, sized by initializeBiomass
+     * @return False if the projection went to NaN, else True
+     */
+    bool project(nmfForecastForms& Forms,
+                 const std::vector<double>& Parameters,
+                 const boost::numeric::ublas::matrix<double>& CatchData,
+                 const boost::numeric::ublas::matrix<double>& Effort,
+                 const boost::numeric::ublas::matrix<double>& Exploitation,
+                 boost::numeric::ublas::matrix<double>& EstBiomassSpecies,
+                 boost::numeric::ublas::matrix<double>& EstBiomassGuilds) const;
+    /**
+     * @brief Re-projects only the years from FirstTime on, restarting the recurrence from
+     * the biomass already in the matrices at FirstTime-1. Used when only the harvest in
+     * years FirstTime-1 and later has changed since the matrices were last projected with
+     * the same parameters. Negative biomass is set to 0.
+     * @param Forms : this thread's model forms
+     * @param Parameters : parameters to project with, in nmfParameterOffsets order
+     * @param CatchData : forecast catch (time, species or guild)
+     * @param Effort : forecast effort (time, species or guild)
+     * @param Exploitation : forecast exploitation rate (time, species or guild)
+     * @param FirstTime : first year to recompute (values less than 1 are treated as 1)
+     * @param EstBiomassSpecies : projected biomass, rows before FirstTime are kept
+     * @param EstBiomassGuilds : projected guild biomass, rows before FirstTime are kept
+     * @return False if the projection went to NaN, else True
+     */
+    bool projectFrom(nmfForecastForms& Forms,
+                     const std::vector<double>& Parameters,
+                     const boost::numeric::ublas::matrix<double>& CatchData,
+                     const boost::numeric::ublas::matrix<double>& Effort,
+                     const boost::numeric::ublas::matrix<double>& Exploitation,
+                     const int& FirstTime,
+                     boost::numeric::ublas::matrix<double>& EstBiomassSpecies,
+                     boost::numeric::ublas::matrix<double>& EstBiomassGuilds) const;
+    /**
+     * @brief Carrying capacity per species or guild for a parameter set
+     * @param Forms : this thread's model forms
+     * @param Parameters : parameters, in nmfParameterOffsets order
+     * @param CarryingCapacity : carrying capacity per species or guild (empty if the
+     * growth form has none)
+     */
+    void getCarryingCapacity(nmfForecastForms& Forms,
+                             const std::vector<double>& Parameters,
+                             std::vector<double>& CarryingCapacity) const;
+
+    const nmfStructsQt::SharedModelData& modelData() const { return m_ModelData; }
+    const nmfParameterOffsets& offsets() const { return m_Offsets; }
+    bool isAggProd()          const { return m_isAggProd; }
+    int  numYears()           const { return m_NumYears; }
+    int  numSpeciesOrGuilds() const { return m_NumSpeciesOrGuilds; }
+    int  numGuilds()          const { return m_NumGuilds; }
+};
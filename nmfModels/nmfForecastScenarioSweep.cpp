@@ -0,0 +1,187 @@
+#include "nmfForecastScenarioSweep.h"
+
+#include <algorithm>
+#include <cmath>
+#include <sstream>
+
+namespace {
+
+std::string multiplierName(const std::string& prefix,
+                           const double& multiplier)
+{
+    std::ostringstream name;
+    name << prefix << "x" << multiplier;
+    return name.str();
+}
+
+}
+
+nmfForecastScenarioSweep::nmfForecastScenarioSweep(
+        const nmfStructsQt::SharedModelData& ModelData,
+        const std::vector<double>& Parameters,
+        const std::vector<double>& InitBiomass)
+    : m_Projection(ModelData,InitBiomass)
+{
+    m_Parameters = Parameters;
+}
+
+std::vector<double>
+nmfForecastScenarioSweep::multiplierRange(const double& Min,
+                                          const double& Max,
+                                          const double& Step)
+{
+    int NumSteps;
+    std::vector<double> Multipliers;
+
+    if ((Step <= 0) || (Max < Min)) {
+        Multipliers.push_back(Min);
+        return Multipliers;
+    }
+
+    // Found from the step count so the last value isn't lost to round off
+    NumSteps = int(std::floor((Max-Min)/Step + 1e-9));
+    for (int i = 0; i <= NumSteps; ++i) {
+        Multipliers.push_back(Min + i*Step);
+    }
+
+    return Multipliers;
+}
+
+std::vector<nmfHarvestScenario>
+nmfForecastScenarioSweep::uniformGrid(const std::vector<double>& Multipliers,
+                                      const int& NumSpeciesOrGuilds)
+{
+    nmfHarvestScenario Scenario;
+    std::vector<nmfHarvestScenario> Scenarios;
+
+    for (double multiplier : Multipliers) {
+        Scenario.Name = multiplierName("All ",multiplier);
+        Scenario.Multipliers.assign(NumSpeciesOrGuilds,multiplier);
+        Scenarios.push_back(Scenario);
+    }
+
+    return Scenarios;
+}
+
+std::vector<nmfHarvestScenario>
+nmfForecastScenarioSweep::speciesGrid(const std::vector<double>& Multipliers,
+                                      const int& NumSpeciesOrGuilds,
+                                      const std::vector<std::string>& SpeciesNames)
+{
+    std::string prefix;
+    nmfHarvestScenario Scenario;
+    std::vector<nmfHarvestScenario> Scenarios;
+
+    for (int species = 0; species < NumSpeciesOrGuilds; ++species) {
+        prefix = (species < int(SpeciesNames.size())) ? SpeciesNames[species] :
+                                                        "Species " + std::to_string(species+1);
+        for (double multiplier : Multipliers) {
+            Scenario.Name = multiplierName(prefix+" ",multiplier);
+            Scenario.Multipliers.assign(NumSpeciesOrGuilds,1.0);
+            Scenario.Multipliers[species] = multiplier;
+            Scenarios.push_back(Scenario);
+        }
+    }
+
+    return Scenarios;
+}
+
+bool
+nmfForecastScenarioSweep::run(const std::vector<nmfHarvestScenario>& Scenarios,
+                              const int& NumThreads,
+                              nmfHarvestScenarioOutput& Output)
+{
+    int NumScenarios = Scenarios.size();
+    int NumYears     = m_Projection.numYears();
+    int NumSpeciesOrGuilds = m_Projection.numSpeciesOrGuilds();
+    const nmfStructsQt::ModelInputData& Inputs = m_Projection.modelData().inputs();
+
+    Output = nmfHarvestScenarioOutput();
+    if (NumScenarios == 0) {
+        std::cout << "Error nmfForecastScenarioSweep::run: No scenarios to run" << std::endl;
+        return false;
+    }
+    if (! m_Projection.isValid(m_Parameters)) {
+        std::cout << "Error nmfForecastScenarioSweep::run: Need at least one year and species and " <<
+                     "enough initial biomass values and parameters" << std::endl;
+        return false;
+    }
+
+    Output.NumScenarios       = NumScenarios;
+    Output.NumSpeciesOrGuilds = NumSpeciesOrGuilds;
+    Output.NumYears           = NumYears;
+    Output.Biomass.assign(NumScenarios*NumSpeciesOrGuilds*NumYears,0.0);
+    Output.Failed.assign(NumScenarios,0);
+    nmfUtils::initialize(Output.FinalBiomass,           NumScenarios,NumSpeciesOrGuilds);
+    nmfUtils::initialize(Output.FinalBiomassOverK,      NumScenarios,NumSpeciesOrGuilds);
+    nmfUtils::initialize(Output.MinBiomassOverK,        NumScenarios,NumSpeciesOrGuilds);
+    nmfUtils::initialize(Output.FinalBiomassOverInitial,NumScenarios,NumSpeciesOrGuilds);
+    for (const nmfHarvestScenario& Scenario : Scenarios) {
+        Output.ScenarioNames.push_back(Scenario.Name);
+    }
+
+    // Each scenario only writes its own slice of the output, so no locking is needed
+    auto worker = [&](const nmfUtils::NextTask& nextScenario) {
+        int scenario;
+        int lastYear = NumYears-1;
+        double K;
+        double scale;
+        double biomass;
+        double minBiomass;
+        nmfForecastForms forms(m_Projection.modelData().Settings);
+        std::vector<double> carryingCapacity;
+        boost::numeric::ublas::matrix<double> catchData;
+        boost::numeric::ublas::matrix<double> effort;
+        boost::numeric::ublas::matrix<double> exploitation;
+        boost::numeric::ublas::matrix<double> estBiomassSpecies;
+        boost::numeric::ublas::matrix<double> estBiomassGuilds;
+
+        m_Projection.initializeBiomass(estBiomassSpecies,estBiomassGuilds);
+        m_Projection.getCarryingCapacity(forms,m_Parameters,carryingCapacity);
+
+        while (nextScenario(scenario)) {
+            const std::vector<double>& Multipliers = Scenarios[scenario].Multipliers;
+
+            catchData    = Inputs.Catch;
+            effort       = Inputs.Effort;
+            exploitation = Inputs.Exploitation;
+            for (int i = 0; i < NumSpeciesOrGuilds; ++i) {
+                scale = (i < int(Multipliers.size())) ? Multipliers[i] : 1.0;
+                if (scale == 1.0) {
+                    continue;
+                }
+                for (boost::numeric::ublas::matrix<double>* harvest : {&catchData,&effort,&exploitation}) {
+                    if (i < int(harvest->size2())) {
+                        for (unsigned time = 0; time < harvest->size1(); ++time) {
+                            (*harvest)(time,i) *= scale;
+                        }
+                    }
+                }
+            }
+
+            if (! m_Projection.project(forms,m_Parameters,catchData,effort,exploitation,
+                                       estBiomassSpecies,estBiomassGuilds)) {
+                Output.Failed[scenario] = 1;
+                continue;
+            }
+
+            for (int i = 0; i < NumSpeciesOrGuilds; ++i) {
+                minBiomass = estBiomassSpecies(0,i);
+                for (int time = 0; time < NumYears; ++time) {
+                    biomass = estBiomassSpecies(time,i);
+                    Output.biomass(scenario,i,time) = biomass;
+                    minBiomass = std::min(minBiomass,biomass);
+                }
+                K = (i < int(carryingCapacity.size())) ? carryingCapacity[i] : 0.0;
+                Output.FinalBiomass(scenario,i) = estBiomassSpecies(lastYear,i);
+                Output.FinalBiomassOverK(scenario,i) = (K > 0) ? estBiomassSpecies(lastYear,i)/K : 0.0;
+                Output.MinBiomassOverK(scenario,i)   = (K > 0) ? minBiomass/K : 0.0;
+                Output.FinalBiomassOverInitial(scenario,i) = (estBiomassSpecies(0,i) > 0) ?
+                        estBiomassSpecies(lastYear,i)/estBiomassSpecies(0,i) : 0.0;
+            }
+        }
+    };
+    nmfUtils::runWorkers(NumThreads,NumScenarios,worker);
+
+    return true;
+}
@@ -0,0 +1,115 @@
+#pragma once
+
+#include <vector>
+#include <string>
+#include <iostream>
+
+#include <boost/numeric/ublas/matrix.hpp>
+
+#include "nmfForecastProjection.h"
+
+/**
+ * @brief One harvest scenario: a multiplier per species or guild applied to every year
+ * of the forecast harvest (catch, effort, or exploitation, whichever the harvest form uses)
+ */
+struct nmfHarvestScenario {
+    std::string Name;
+    std::vector<double> Multipliers; // missing entries are 1
+};
+
+/**
+ * @brief Results of a scenario sweep. The biomass cube is (scenario, species, year) with
+ * the year varying fastest, and the summaries are (scenario, species or guild).
+ */
+struct nmfHarvestScenarioOutput {
+    int NumScenarios;
+    int NumSpeciesOrGuilds;
+    int NumYears;
+    std::vector<std::string> ScenarioNames;
+    std::vector<double> Biomass;
+    std::vector<int>    Failed;                                      // 1 if the scenario went to NaN
+    boost::numeric::ublas::matrix<double> FinalBiomass;              // last forecast year
+    boost::numeric::ublas::matrix<double> FinalBiomassOverK;         // B/K in the last year (0 if no K)
+    boost::numeric::ublas::matrix<double> MinBiomassOverK;           // lowest B/K over the forecast (0 if no K)
+    boost::numeric::ublas::matrix<double> FinalBiomassOverInitial;   // last year's B over the initial B
+
+    nmfHarvestScenarioOutput() : NumScenarios(0), NumSpeciesOrGuilds(0), NumYears(0) {}
+
+    inline double& biomass(const int& scenario,
+                           const int& species,
+                           const int& year) {
+        return Biomass[(scenario*NumSpeciesOrGuilds + species)*NumYears + year];
+    }
+    inline const double& biomass(const int& scenario,
+                                 const int& species,
+                                 const int& year) const {
+        return Biomass[(scenario*NumSpeciesOrGuilds + species)*NumYears + year];
+    }
+};
+
+/**
+ * @brief Projects an MSSPM forecast under a grid of harvest scenarios in process. The
+ * model state is loaded once and shared by all of the scenarios, which are spread over
+ * threads, so a whole grid is found without writing each scenario to the database and
+ * reading it back. The results only depend upon the scenarios and not upon the number
+ * of threads.
+ */
+class nmfForecastScenarioSweep {
+
+private:
+    nmfForecastProjection m_Projection;
+    std::vector<double>   m_Parameters;
+
+public:
+    /**
+     * @brief Sets up a scenario sweep
+     * @param ModelData : model data with the form types, species and guild counts, guild
+     * membership, and the baseline forecast Catch, Effort, and Exploitation (RunLength+1 years)
+     * @param Parameters : estimated parameters, in nmfParameterOffsets order
+     * @param InitBiomass : biomass at the start of the forecast per species or guild
+     */
+    nmfForecastScenarioSweep(const nmfStructsQt::SharedModelData& ModelData,
+                             const std::vector<double>& Parameters,
+                             const std::vector<double>& InitBiomass);
+   ~nmfForecastScenarioSweep() {}
+
+    /**
+     * @brief Evenly spaced multipliers from Min to Max inclusive (e.g., 0 to 2 by 0.05)
+     * @param Min : first multiplier
+     * @param Max : last multiplier
+     * @param Step : spacing between the multipliers
+     * @return The multipliers
+     */
+    static std::vector<double> multiplierRange(const double& Min,
+                                               const double& Max,
+                                               const double& Step);
+    /**
+     * @brief Scenarios that scale every species' harvest by the same multiplier
+     * @param Multipliers : the harvest multipliers, one scenario each
+     * @param NumSpeciesOrGuilds : number of species or guilds
+     * @return One scenario per multiplier
+     */
+    static std::vector<nmfHarvestScenario> uniformGrid(const std::vector<double>& Multipliers,
+                                                       const int& NumSpeciesOrGuilds);
+    /**
+     * @brief Scenarios that scale one species' harvest at a time, leaving the others at
+     * their baseline harvest
+     * @param Multipliers : the harvest multipliers
+     * @param NumSpeciesOrGuilds : number of species or guilds
+     * @param SpeciesNames : names used for the scenario names (may be empty)
+     * @return NumSpeciesOrGuilds x Multipliers scenarios, species major
+     */
+    static std::vector<nmfHarvestScenario> speciesGrid(const std::vector<double>& Multipliers,
+                                                       const int& NumSpeciesOrGuilds,
+                                                       const std::vector<std::string>& SpeciesNames);
+    /**
+     * @brief Projects every scenario and summarizes the results
+     * @param Scenarios : the harvest scenarios
+     * @param NumThreads : number of threads to use (0 uses one per core)
+     * @param Output : biomass cube and B/K summaries
+     * @return True if the sweep was run, else False
+     */
+    bool run(const std::vector<nmfHarvestScenario>& Scenarios,
+             const int& NumThreads,
+             nmfHarvestScenarioOutput& Output);
+};
@@ -0,0 +1,202 @@
+#include "nmfForecastWhatIf.h"
+
+#include <algorithm>
+
+nmfForecastWhatIf::nmfForecastWhatIf(
+        const nmfStructsQt::SharedModelData& ModelData,
+        const std::vector<double>& Parameters,
+        const std::vector<double>& InitBiomass,
+        Callback OnResult)
+    : m_Projection(ModelData,InitBiomass),
+      m_Forms(ModelData.Settings)
+{
+    m_Parameters        = Parameters;
+    m_Callback          = OnResult;
+    m_Stop              = false;
+    m_Busy              = false;
+    m_HasPending        = false;
+    m_NextRequestNum    = 0;
+    m_PendingRequestNum = -1;
+    m_NumSuperseded     = 0;
+    m_HasProjected      = false;
+
+    m_Projection.initializeBiomass(m_Result.EstBiomassSpecies,m_Result.EstBiomassGuilds);
+
+    // Started last so the thread only ever sees fully set up members
+    m_Thread = std::thread(&nmfForecastWhatIf::processRequests,this);
+}
+
+nmfForecastWhatIf::~nmfForecastWhatIf()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_Mutex);
+        m_Stop       = true;
+        m_HasPending = false;
+    }
+    m_RequestCondition.notify_all();
+    m_Thread.join();
+}
+
+int
+nmfForecastWhatIf::firstChangedYear(
+        const boost::numeric::ublas::matrix<double>& Harvest1,
+        const boost::numeric::ublas::matrix<double>& Harvest2)
+{
+    if ((Harvest1.size1() != Harvest2.size1()) ||
+        (Harvest1.size2() != Harvest2.size2())) {
+        return 0;
+    }
+    for (unsigned time = 0; time < Harvest1.size1(); ++time) {
+        for (unsigned i = 0; i < Harvest1.size2(); ++i) {
+            if (Harvest1(time,i) != Harvest2(time,i)) {
+                return time;
+            }
+        }
+    }
+
+    return Harvest1.size1();
+}
+
+int
+nmfForecastWhatIf::request(
+        const boost::numeric::ublas::matrix<double>& CatchData,
+        const boost::numeric::ublas::matrix<double>& Effort,
+        const boost::numeric::ublas::matrix<double>& Exploitation)
+{
+    int RequestNum;
+
+    {
+        std::lock_guard<std::mutex> lock(m_Mutex);
+        if (m_HasPending) {
+            ++m_NumSuperseded;
+        }
+        RequestNum            = m_NextRequestNum++;
+        m_PendingRequestNum   = RequestNum;
+        m_PendingCatch        = CatchData;
+        m_PendingEffort       = Effort;
+        m_PendingExploitation = Exploitation;
+        m_HasPending          = true;
+    }
+    m_RequestCondition.notify_one();
+
+    return RequestNum;
+}
+
+int
+nmfForecastWhatIf::requestScaled(
+        const int& Species,
+        const std::vector<double>& YearlyMultipliers)
+{
+    const nmfStructsQt::ModelInputData& Inputs = m_Projection.modelData().inputs();
+    boost::numeric::ublas::matrix<double> catchData    = Inputs.Catch;
+    boost::numeric::ublas::matrix<double> effort       = Inputs.Effort;
+    boost::numeric::ublas::matrix<double> exploitation = Inputs.Exploitation;
+
+    for (boost::numeric::ublas::matrix<double>* harvest : {&catchData,&effort,&exploitation}) {
+        if ((Species < 0) || (Species >= int(harvest->size2()))) {
+            continue;
+        }
+        for (unsigned time = 0; time < harvest->size1(); ++time) {
+            if (time < YearlyMultipliers.size()) {
+                (*harvest)(time,Species) *= YearlyMultipliers[time];
+            }
+        }
+    }
+
+    return request(catchData,effort,exploitation);
+}
+
+void
+nmfForecastWhatIf::waitForIdle()
+{
+    std::unique_lock<std::mutex> lock(m_Mutex);
+    m_IdleCondition.wait(lock,[this] { return (! m_HasPending && ! m_Busy) || m_Stop; });
+}
+
+int
+nmfForecastWhatIf::numSuperseded()
+{
+    std::lock_guard<std::mutex> lock(m_Mutex);
+    return m_NumSuperseded;
+}
+
+void
+nmfForecastWhatIf::processRequests()
+{
+    int RequestNum;
+    std::unique_lock<std::mutex> lock(m_Mutex);
+
+    while (true) {
+        m_RequestCondition.wait(lock,[this] { return m_Stop || m_HasPending; });
+        if (m_Stop) {
+            break;
+        }
+
+        // Take the newest request, leaving the pending slot free for the next one
+        m_Catch.swap(m_PendingCatch);
+        m_Effort.swap(m_PendingEffort);
+        m_Exploitation.swap(m_PendingExploitation);
+        RequestNum   = m_PendingRequestNum;
+        m_HasPending = false;
+        m_Busy       = true;
+
+        lock.unlock();
+        projectRequest(RequestNum);
+        lock.lock();
+
+        m_Busy = false;
+        m_IdleCondition.notify_all();
+    }
+    m_IdleCondition.notify_all();
+}
+
+void
+nmfForecastWhatIf::projectRequest(const int& RequestNum)
+{
+    int NumYears = m_Projection.numYears();
+    int FirstTime;
+
+    m_Result.RequestNum = RequestNum;
+    m_Result.Failed     = false;
+
+    if (! m_Projection.isValid(m_Parameters)) {
+        std::cout << "Error nmfForecastWhatIf::projectRequest: Need at least one year and species and " <<
+                     "enough initial biomass values and parameters" << std::endl;
+        m_Result.FirstTime = 0;
+        m_Result.Failed    = true;
+        m_Callback(m_Result);
+        return;
+    }
+
+    // The harvest in year t only affects the biomass from year t+1 on
+    FirstTime = 0;
+    if (m_HasProjected) {
+        FirstTime = std::min({firstChangedYear(m_Catch,       m_LastCatch),
+                              firstChangedYear(m_Effort,      m_LastEffort),
+                              firstChangedYear(m_Exploitation,m_LastExploitation)});
+        FirstTime = std::min(FirstTime+1,NumYears);
+    }
+
+    if (FirstTime == 0) {
+        m_Result.Failed = ! m_Projection.project(m_Forms,m_Parameters,
+                                                 m_Catch,m_Effort,m_Exploitation,
+                                                 m_Result.EstBiomassSpecies,
+                                                 m_Result.EstBiomassGuilds);
+    } else if (FirstTime < NumYears) {
+        m_Result.Failed = ! m_Projection.projectFrom(m_Forms,m_Parameters,
+                                                     m_Catch,m_Effort,m_Exploitation,FirstTime,
+                                                     m_Result.EstBiomassSpecies,
+                                                     m_Result.EstBiomassGuilds);
+    }
+    m_Result.FirstTime = FirstTime;
+
+    // A failed projection leaves partly filled biomass, so the next one starts over
+    m_HasProjected = ! m_Result.Failed;
+    if (m_HasProjected) {
+        m_LastCatch        = m_Catch;
+        m_LastEffort       = m_Effort;
+        m_LastExploitation = m_Exploitation;
+    }
+
+    m_Callback(m_Result);
+}
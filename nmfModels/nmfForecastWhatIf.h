@@ -0,0 +1,134 @@
+#pragma once
+
+#include <vector>
+#include <string>
+#include <iostream>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+
+#include <boost/numeric/ublas/matrix.hpp>
+
+#include "nmfForecastProjection.h"
+
+/**
+ * @brief Result of one what-if projection
+ */
+struct nmfForecastWhatIfResult {
+    int  RequestNum;   // number returned by the request that was projected
+    int  FirstTime;    // first year recomputed (NumYears if nothing changed)
+    bool Failed;       // true if the projection went to NaN
+    boost::numeric::ublas::matrix<double> EstBiomassSpecies;
+    boost::numeric::ublas::matrix<double> EstBiomassGuilds;
+
+    nmfForecastWhatIfResult() : RequestNum(-1), FirstTime(0), Failed(false) {}
+};
+
+/**
+ * @brief Reruns an MSSPM forecast while the user drags a harvest line (e.g., with
+ * nmfChartMovableLine). Requests are projected on a single background thread, so at
+ * most one projection is ever running. A request made while one is running replaces
+ * any request still waiting, so only the newest harvest is projected next and the
+ * in between ones are dropped. Each projection only recomputes the years after the
+ * first harvest year that differs from the last projection, restarting from the
+ * biomass already found for the year before.
+ */
+class nmfForecastWhatIf {
+
+public:
+    typedef std::function<void(const nmfForecastWhatIfResult&)> Callback;
+
+private:
+    nmfForecastProjection m_Projection;
+    nmfForecastForms      m_Forms;
+    std::vector<double>   m_Parameters;
+    Callback              m_Callback;
+
+    // Guarded by m_Mutex
+    std::mutex m_Mutex;
+    std::condition_variable m_RequestCondition;
+    std::condition_variable m_IdleCondition;
+    bool m_Stop;
+    bool m_Busy;
+    bool m_HasPending;
+    int  m_NextRequestNum;
+    int  m_PendingRequestNum;
+    int  m_NumSuperseded;
+    boost::numeric::ublas::matrix<double> m_PendingCatch;
+    boost::numeric::ublas::matrix<double> m_PendingEffort;
+    boost::numeric::ublas::matrix<double> m_PendingExploitation;
+
+    // Only used by the projecting thread
+    bool m_HasProjected;
+    boost::numeric::ublas::matrix<double> m_Catch;
+    boost::numeric::ublas::matrix<double> m_Effort;
+    boost::numeric::ublas::matrix<double> m_Exploitation;
+    boost::numeric::ublas::matrix<double> m_LastCatch;
+    boost::numeric::ublas::matrix<double> m_LastEffort;
+    boost::numeric::ublas::matrix<double> m_LastExploitation;
+    nmfForecastWhatIfResult m_Result;
+
+    std::thread m_Thread;
+
+    void processRequests();
+    void projectRequest(const int& RequestNum);
+
+public:
+    /**
+     * @brief Starts the projecting thread
+     * @param ModelData : model data with the form types, species and guild counts, guild
+     * membership, and the baseline forecast Catch, Effort, and Exploitation (RunLength+1 years)
+     * @param Parameters : estimated parameters, in nmfParameterOffsets order
+     * @param InitBiomass : biomass at the start of the forecast per species or guild
+     * @param OnResult : called on the projecting thread after each projection. The result
+     * is only valid during the call, so copy what's needed. A Qt caller should hand the
+     * copy back to the GUI thread with a queued connection.
+     */
+    nmfForecastWhatIf(const nmfStructsQt::SharedModelData& ModelData,
+                      const std::vector<double>& Parameters,
+                      const std::vector<double>& InitBiomass,
+                      Callback OnResult);
+    /**
+     * @brief Drops any waiting request and waits for a running projection to finish
+     */
+   ~nmfForecastWhatIf();
+
+    /**
+     * @brief Queues a projection of the passed harvest, replacing any request still waiting.
+     * Returns immediately.
+     * @param CatchData : forecast catch (time, species or guild)
+     * @param Effort : forecast effort (time, species or guild)
+     * @param Exploitation : forecast exploitation rate (time, species or guild)
+     * @return The request number, which is passed back in the result
+     */
+    int request(const boost::numeric::ublas::matrix<double>& CatchData,
+                const boost::numeric::ublas::matrix<double>& Effort,
+                const boost::numeric::ublas::matrix<double>& Exploitation);
+    /**
+     * @brief Queues a projection of the baseline harvest with one species' harvest scaled
+     * year by year, as drawn by a movable line
+     * @param Species : species or guild number
+     * @param YearlyMultipliers : harvest multiplier per forecast year (missing years are 1)
+     * @return The request number, which is passed back in the result
+     */
+    int requestScaled(const int& Species,
+                      const std::vector<double>& YearlyMultipliers);
+    /**
+     * @brief Waits until no request is waiting or running
+     */
+    void waitForIdle();
+    /**
+     * @brief Number of requests dropped because a newer one replaced them before they ran
+     * @return The number of dropped requests
+     */
+    int numSuperseded();
+    /**
+     * @brief Finds the first year at which two harvest matrices differ
+     * @param Harvest1 : first (time, species or guild) harvest
+     * @param Harvest2 : second (time, species or guild) harvest
+     * @return The first differing row (0 if the sizes differ, the number of rows if none do)
+     */
+    static int firstChangedYear(const boost::numeric::ublas::matrix<double>& Harvest1,
+                                const boost::numeric::ublas::matrix<double>& Harvest2);
+};
@@ -0,0 +1,273 @@
+#include "nmfFormSelection.h"
+#include "nmfConstants.h"
+#include "nmfUtils.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+nmfFormSelection::nmfFormSelection(const nmfStructsQt::SharedModelData& ModelData)
+{
+    m_ModelData = ModelData;
+}
+
+std::vector<nmfModelForms>
+nmfFormSelection::combinations(const std::vector<std::string>& Growth,
+                               const std::vector<std::string>& Harvest,
+                               const std::vector<std::string>& Competition,
+                               const std::vector<std::string>& Predation)
+{
+    nmfModelForms Forms;
+    std::vector<nmfModelForms> Combinations;
+
+    for (const std::string& growth : Growth) {
+        for (const std::string& harvest : Harvest) {
+            for (const std::string& competition : Competition) {
+                for (const std::string& predation : Predation) {
+                    Forms.Growth      = growth;
+                    Forms.Harvest     = harvest;
+                    Forms.Competition = competition;
+                    Forms.Predation   = predation;
+                    Combinations.push_back(Forms);
+                }
+            }
+        }
+    }
+
+    return Combinations;
+}
+
+std::vector<nmfModelForms>
+nmfFormSelection::allCombinations()
+{
+    return combinations({"Linear","Logistic"},
+                        {"Catch","Effort (qE)","Exploitation (F)"},
+                        {"NO_K","MS-PROD","AGG-PROD"},
+                        {"Type I","Type II","Type III"});
+}
+
+void
+nmfFormSelection::setForms(const nmfModelForms& Forms,
+                           const int& Iterations,
+                           nmfStructsQt::ModelRunSettings& FormSettings) const
+{
+    nmfParameterOffsets Offsets;
+    const nmfStructsQt::ModelRunSettings& Settings = m_ModelData.Settings;
+
+    FormSettings.GrowthForm      = Forms.Growth;
+    FormSettings.HarvestForm     = Forms.Harvest;
+    FormSettings.CompetitionForm = Forms.Competition;
+    FormSettings.PredationForm   = Forms.Predation;
+    Offsets.load(FormSettings);
+    FormSettings.TotalNumberParameters = Offsets.getTotalNumberParameters();
+
+    // The first pass caps every estimator's iterations at the budget
+    FormSettings.NLoptUseStopAfterIter = Settings.NLoptUseStopAfterIter;
+    FormSettings.NLoptStopAfterIter    = Settings.NLoptStopAfterIter;
+    FormSettings.BeesMaxGenerations    = Settings.BeesMaxGenerations;
+    FormSettings.GAGenerations         = Settings.GAGenerations;
+    if (Iterations > 0) {
+        FormSettings.NLoptStopAfterIter = (FormSettings.NLoptUseStopAfterIter) ?
+                    std::min(FormSettings.NLoptStopAfterIter,Iterations) : Iterations;
+        FormSettings.NLoptUseStopAfterIter = true;
+        FormSettings.BeesMaxGenerations    = std::min(FormSettings.BeesMaxGenerations,Iterations);
+        FormSettings.GAGenerations         = std::min(FormSettings.GAGenerations,Iterations);
+    }
+}
+
+bool
+nmfFormSelection::calculateAIC(const nmfStructsQt::SharedModelData& FormData,
+                               const int& NumParameters,
+                               const bool& ByGuilds,
+                               const boost::numeric::ublas::matrix<double>& EstBiomass,
+                               std::vector<double>& SpeciesAIC,
+                               double& AIC) const
+{
+    const nmfStructsQt::ModelRunSettings& Settings = FormData.Settings;
+    const nmfStructsQt::ModelInputData&   Inputs   = FormData.inputs();
+    bool isAggProd  = (Settings.CompetitionForm == "AGG-PROD");
+    bool isByGuilds = isAggProd || ByGuilds;
+    int NumSpeciesOrGuilds = (isByGuilds) ? Settings.NumGuilds : Settings.NumSpecies;
+    int NumYears;
+    double diff;
+    std::vector<double> SSResiduals(std::max(NumSpeciesOrGuilds,0),0.0);
+    std::vector<int> NumObservations(std::max(NumSpeciesOrGuilds,0),0);
+    boost::numeric::ublas::matrix<double> EstBiomassGuilds;
+    const boost::numeric::ublas::matrix<double>& Observed = (isByGuilds) ?
+            Inputs.ObservedBiomassByGuilds : Inputs.ObservedBiomassBySpecies;
+
+    SpeciesAIC.clear();
+    AIC = 0;
+    if ((NumSpeciesOrGuilds <= 0) || (int(Observed.size2()) < NumSpeciesOrGuilds)) {
+        return false;
+    }
+
+    // A species level fit is scored on the guild observations as the sums of its species
+    if (isByGuilds && ! isAggProd) {
+        nmfUtils::initialize(EstBiomassGuilds,EstBiomass.size1(),NumSpeciesOrGuilds);
+        for (const auto& Guild : Inputs.GuildSpecies) {
+            if ((Guild.first < 0) || (Guild.first >= NumSpeciesOrGuilds)) {
+                continue;
+            }
+            for (int species : Guild.second) {
+                if ((species < 0) || (species >= int(EstBiomass.size2()))) {
+                    return false;
+                }
+                for (unsigned time = 0; time < EstBiomass.size1(); ++time) {
+                    EstBiomassGuilds(time,Guild.first) += EstBiomass(time,species);
+                }
+            }
+        }
+    }
+    const boost::numeric::ublas::matrix<double>& Estimated = (isByGuilds && ! isAggProd) ?
+            EstBiomassGuilds : EstBiomass;
+    if (int(Estimated.size2()) < NumSpeciesOrGuilds) {
+        return false;
+    }
+    NumYears = std::min(Observed.size1(),Estimated.size1());
+
+    // Missing observations don't add to the residuals or to the number of observations
+    for (int time = 0; time < NumYears; ++time) {
+        for (int i = 0; i < NumSpeciesOrGuilds; ++i) {
+            if (Observed(time,i) != nmfConstants::NoValueDouble) {
+                diff = Estimated(time,i) - Observed(time,i);
+                SSResiduals[i] += diff*diff;
+                ++NumObservations[i];
+            }
+        }
+    }
+    for (int i = 0; i < NumSpeciesOrGuilds; ++i) {
+        if (NumObservations[i] == 0) {
+            return false;
+        }
+    }
+
+    nmfUtilsStatistics::calculateAIC(NumSpeciesOrGuilds,NumParameters,NumObservations,
+                                     SSResiduals,SpeciesAIC);
+    for (double aic : SpeciesAIC) {
+        AIC += aic;
+    }
+    AIC /= NumSpeciesOrGuilds;
+
+    return std::isfinite(AIC);
+}
+
+void
+nmfFormSelection::estimate(Estimator EstimateForms,
+                           const std::vector<int>& Combinations,
+                           const int& Iterations,
+                           const int& NumThreads,
+                           const bool& ByGuilds,
+                           std::vector<nmfFormSelectionResult>& Results)
+{
+    int NumCombinations = Combinations.size();
+
+    // Each combination only writes its own result, so no locking is needed
+    auto worker = [&](const nmfUtils::NextTask& nextCombination) {
+        int next;
+        std::vector<double> startParameters;
+        boost::numeric::ublas::matrix<double> estBiomass;
+        nmfStructsQt::SharedModelData FormData = m_ModelData; // shares the inputs, only the settings change
+
+        while (nextCombination(next)) {
+            nmfFormSelectionResult& Result = Results[Combinations[next]];
+
+            setForms(Result.Forms,Iterations,FormData.Settings);
+            Result.NumParameters = FormData.Settings.TotalNumberParameters;
+            Result.ByGuilds      = ByGuilds || (Result.Forms.Competition == "AGG-PROD");
+            startParameters.swap(Result.Parameters);
+            Result.Parameters.clear();
+            estBiomass.clear();
+            Result.Estimated = EstimateForms(FormData,startParameters,Result.Parameters,estBiomass) &&
+                               calculateAIC(FormData,Result.NumParameters,ByGuilds,estBiomass,
+                                            Result.SpeciesAIC,Result.AIC);
+        }
+    };
+    nmfUtils::runWorkers(NumThreads,NumCombinations,worker);
+}
+
+bool
+nmfFormSelection::run(Estimator EstimateForms,
+                      const std::vector<nmfModelForms>& Combinations,
+                      const nmfFormSelectionOptions& Options,
+                      std::vector<nmfFormSelectionResult>& Results)
+{
+    int NumCombinations = Combinations.size();
+    int rank;
+    int NumAggProd = 0;
+    bool ByGuilds;
+    double BestAIC = std::numeric_limits<double>::max();
+    std::vector<int> ToEstimate;
+
+    Results.assign(NumCombinations,nmfFormSelectionResult());
+    if (NumCombinations == 0) {
+        std::cout << "Error nmfFormSelection::run: No form combinations to estimate" << std::endl;
+        return false;
+    }
+    for (int c = 0; c < NumCombinations; ++c) {
+        Results[c].Forms = Combinations[c];
+        ToEstimate.push_back(c);
+        if (Combinations[c].Competition == "AGG-PROD") {
+            ++NumAggProd;
+        }
+    }
+
+    // AGG-PROD fits are to the guild biomass, so with any of them every combination is scored there
+    ByGuilds = (NumAggProd > 0) && (NumAggProd < NumCombinations);
+    if (ByGuilds && ((m_ModelData.Settings.NumGuilds <= 0) ||
+                     (m_ModelData.inputs().GuildSpecies.empty()))) {
+        std::cout << "Error nmfFormSelection::run: AGG-PROD combinations can only be compared " <<
+                     "with the others over guilds, and there are none" << std::endl;
+        return false;
+    }
+
+    if (Options.PartialIterations > 0) {
+        estimate(EstimateForms,ToEstimate,Options.PartialIterations,Options.NumThreads,ByGuilds,Results);
+        for (nmfFormSelectionResult& Result : Results) {
+            if (Result.Estimated) {
+                Result.PartialAIC = Result.AIC;
+                BestAIC = std::min(BestAIC,Result.AIC);
+            }
+        }
+
+        // Keep those within reach of the best, estimating the most promising first
+        ToEstimate.clear();
+        for (int c = 0; c < NumCombinations; ++c) {
+            nmfFormSelectionResult& Result = Results[c];
+            if (! Result.Estimated) {
+                continue;
+            }
+            if (Result.PartialAIC - BestAIC > Options.PruneDeltaAIC) {
+                Result.Pruned = true;
+            } else {
+                ToEstimate.push_back(c);
+            }
+        }
+        std::stable_sort(ToEstimate.begin(),ToEstimate.end(),[&](const int& a, const int& b) {
+            return Results[a].PartialAIC < Results[b].PartialAIC;
+        });
+    }
+    estimate(EstimateForms,ToEstimate,0,Options.NumThreads,ByGuilds,Results);
+
+    // Rank the fully estimated combinations
+    std::vector<int> Ranked;
+    for (int c : ToEstimate) {
+        if (Results[c].Estimated) {
+            Ranked.push_back(c);
+        }
+    }
+    std::stable_sort(Ranked.begin(),Ranked.end(),[&](const int& a, const int& b) {
+        return Results[a].AIC < Results[b].AIC;
+    });
+    rank = 0;
+    for (int c : Ranked) {
+        Results[c].Rank = ++rank;
+    }
+
+    if (Ranked.empty()) {
+        std::cout << "Error nmfFormSelection::run: No form combination could be estimated" << std::endl;
+        return false;
+    }
+
+    return true;
+}
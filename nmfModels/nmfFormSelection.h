@@ -0,0 +1,152 @@
+#pragma once
+
+#include <vector>
+#include <string>
+#include <iostream>
+#include <functional>
+
+#include <boost/numeric/ublas/matrix.hpp>
+
+#include "nmfUtilsStatistics.h"
+#include "nmfParameterView.h"
+
+/**
+ * @brief One combination of growth, harvest, competition, and predation forms
+ */
+struct nmfModelForms {
+    std::string Growth;
+    std::string Harvest;
+    std::string Competition;
+    std::string Predation;
+
+    /**
+     * @brief Name of the combination, e.g. "Logistic/Catch/NO_K/Type I"
+     * @return The form names separated by slashes
+     */
+    std::string name() const {
+        return Growth + "/" + Harvest + "/" + Competition + "/" + Predation;
+    }
+};
+
+/**
+ * @brief Form selection options
+ */
+struct nmfFormSelectionOptions {
+    int    NumThreads;        // 0 uses one thread per core
+    int    PartialIterations; // iteration budget of the first pass (0 skips it and estimates everything fully)
+    double PruneDeltaAIC;     // after the first pass, drop combinations whose AIC is more than
+                              // this above the best combination's
+    nmfFormSelectionOptions() : NumThreads(0), PartialIterations(0), PruneDeltaAIC(10.0) {}
+};
+
+/**
+ * @brief Estimation results and AIC of one form combination
+ */
+struct nmfFormSelectionResult {
+    nmfModelForms Forms;
+    int    NumParameters;     // number of parameters of the forms
+    bool   Estimated;         // false if the estimation failed
+    bool   Pruned;            // true if dropped after the first pass
+    bool   ByGuilds;          // true if scored on the guild observations
+    int    Rank;              // 1 is the lowest AIC (0 if failed or pruned)
+    double PartialAIC;        // AIC after the first pass (0 if there wasn't one)
+    double AIC;               // mean AIC over the species or guilds
+    std::vector<double> SpeciesAIC;  // AIC per species or guild
+    std::vector<double> Parameters;  // in the combination's nmfParameterOffsets order
+
+    nmfFormSelectionResult() : NumParameters(0), Estimated(false), Pruned(false),
+                               ByGuilds(false), Rank(0), PartialAIC(0), AIC(0) {}
+};
+
+/**
+ * @brief Estimates a set of model form combinations and ranks them by AIC. The combinations
+ * share the loaded input data and only differ in their form types and iteration limits, so
+ * the data are loaded and held once for the whole sweep.
+ *
+ * With a partial iteration budget the sweep runs in two passes. Every combination is first
+ * estimated with the budget, combinations whose AIC is hopelessly far above the best one
+ * are dropped, and the rest are then estimated fully, starting from their first pass
+ * parameters. The estimation itself is supplied by the caller and must be safe to run on
+ * several threads at once. nmfBeesEstimators::formSelection() gives the Bees Algorithm estimator.
+ *
+ * Combinations are ranked by their mean AIC over the species, or over the guilds if any of
+ * the combinations is AGG-PROD. AGG-PROD combinations are fit to the guild biomass, so every
+ * combination is then scored on the guild observations, with the estimated biomass of the
+ * other combinations summed over each guild's species, so that all AICs are over the same data.
+ * The AIC of each series is over the observations that aren't missing.
+ */
+class nmfFormSelection {
+
+public:
+    /**
+     * @brief Estimates one combination. Called on the combination's thread with model data
+     * holding the combination's forms (and, in the first pass, the iteration budget in the
+     * NLopt, Bees, and GA limits). StartParameters is empty or holds the first pass estimate.
+     * EstBiomass is (year, species or guild) in the units of the observed biomass.
+     */
+    typedef std::function<bool(const nmfStructsQt::SharedModelData& FormData,
+                               const std::vector<double>& StartParameters,
+                               std::vector<double>& Parameters,
+                               boost::numeric::ublas::matrix<double>& EstBiomass)> Estimator;
+
+private:
+    nmfStructsQt::SharedModelData m_ModelData;
+
+    void setForms(const nmfModelForms& Forms,
+                  const int& Iterations,
+                  nmfStructsQt::ModelRunSettings& FormSettings) const;
+    bool calculateAIC(const nmfStructsQt::SharedModelData& FormData,
+                      const int& NumParameters,
+                      const bool& ByGuilds,
+                      const boost::numeric::ublas::matrix<double>& EstBiomass,
+                      std::vector<double>& SpeciesAIC,
+                      double& AIC) const;
+    void estimate(Estimator EstimateForms,
+                  const std::vector<int>& Combinations,
+                  const int& Iterations,
+                  const int& NumThreads,
+                  const bool& ByGuilds,
+                  std::vector<nmfFormSelectionResult>& Results);
+
+public:
+    /**
+     * @brief Sets up a form selection sweep
+     * @param ModelData : model data with the observed biomass, the Catch, Effort, and
+     * Exploitation, the parameter ranges, and the estimation settings
+     */
+    nmfFormSelection(const nmfStructsQt::SharedModelData& ModelData);
+   ~nmfFormSelection() {}
+
+    /**
+     * @brief Every combination of the passed form types
+     * @param Growth : growth forms (e.g., Linear, Logistic)
+     * @param Harvest : harvest forms (e.g., Catch, Effort (qE), Exploitation (F))
+     * @param Competition : competition forms (e.g., NO_K, MS-PROD, AGG-PROD)
+     * @param Predation : predation forms (e.g., Type I, Type II, Type III)
+     * @return The combinations, growth varying slowest
+     */
+    static std::vector<nmfModelForms> combinations(const std::vector<std::string>& Growth,
+                                                   const std::vector<std::string>& Harvest,
+                                                   const std::vector<std::string>& Competition,
+                                                   const std::vector<std::string>& Predation);
+    /**
+     * @brief The 54 combinations of Linear and Logistic growth, Catch, Effort, and
+     * Exploitation harvest, NO_K, MS-PROD, and AGG-PROD competition, and Type I, II,
+     * and III predation
+     * @return The combinations
+     */
+    static std::vector<nmfModelForms> allCombinations();
+    /**
+     * @brief Estimates and ranks the combinations
+     * @param EstimateForms : the estimation to run on each combination
+     * @param Combinations : form combinations to compare
+     * @param Options : threads, first pass budget, and pruning margin
+     * @param Results : one result per combination, in the order passed
+     * @return True if at least one combination was estimated, else False (or if AGG-PROD
+     * combinations are mixed with others and there are no guilds to score them all on)
+     */
+    bool run(Estimator EstimateForms,
+             const std::vector<nmfModelForms>& Combinations,
+             const nmfFormSelectionOptions& Options,
+             std::vector<nmfFormSelectionResult>& Results);
+};
@@ -66,8 +66,17 @@ nmfGrowthForm::loadParameterRanges(
         std::vector<std::pair<double,double> >& parameterRanges,
         const nmfStructsQt::ModelDataStruct& dataStruct)
 {
-    bool isCheckedGrowthRate       = nmfUtils::isEstimateParameterChecked(dataStruct,"GrowthRate");
-    bool isCheckedCarryingCapacity = nmfUtils::isEstimateParameterChecked(dataStruct,"CarryingCapacity");
+    loadParameterRanges(parameterRanges,dataStruct,dataStruct);
+}
+
+void
+nmfGrowthForm::loadParameterRanges(
+        std::vector<std::pair<double,double> >& parameterRanges,
+        const nmfStructsQt::ModelRunSettings& settings,
+        const nmfStructsQt::ModelInputData& dataStruct)
+{
+    bool isCheckedGrowthRate       = nmfUtils::isEstimateParameterChecked(settings,"GrowthRate");
+    bool isCheckedCarryingCapacity = nmfUtils::isEstimateParameterChecked(settings,"CarryingCapacity");
 
     std::pair<double,double> aPair;
     m_numberParameters = 0;
@@ -156,24 +165,47 @@ nmfGrowthForm::extractParameters(
     startPos = numGrowthParameters;
 }
 
+void
+nmfGrowthForm::extractParameters(
+        const std::vector<double>& parameters,
+        const nmfParameterOffsets& offsets,
+        nmfVectorView&             growthRate,
+        nmfVectorView&             carryingCapacity,
+        double&                    systemCarryingCapacity)
+{
+    systemCarryingCapacity = 0;
+    growthRate       = nmfVectorView();
+    carryingCapacity = nmfVectorView();
+
+    if ((m_type == "Linear") || (m_type == "Logistic")) {
+        growthRate = offsets.vectorView(parameters,offsets.GrowthRate);
+    }
+    if (m_type == "Logistic") {
+        carryingCapacity = offsets.vectorView(parameters,offsets.CarryingCapacity);
+        for (unsigned i=0; i<carryingCapacity.size(); ++i) {
+            systemCarryingCapacity += carryingCapacity[i];
+        }
+    }
+}
+
 double
 nmfGrowthForm::evaluate(const int &SpeciesNum,
                         const double &biomassAtTimeT,
-                        const std::vector<double> &growthRate,
-                        const std::vector<double> &carryingCapacity)
+                        const nmfVectorView &growthRate,
+                        const nmfVectorView &carryingCapacity)
 {
     if (FunctionMap.find(m_type) == FunctionMap.end()) {
         return 0;
     } else {
-        return (this->*FunctionMap[m_type])(SpeciesNum,biomassAtTimeT,growthRate,carryingCapacity);
+        return (this->*FunctionMap.at(m_type))(SpeciesNum,biomassAtTimeT,growthRate,carryingCapacity);
     }
 }
 
 double
 nmfGrowthForm::NoGrowth(const int &speciesNum,
                         const double &biomassAtTime,
-                        const std::vector<double> &growthRate,
-                        const std::vector<double> &carryingCapacity)
+                        const nmfVectorView &growthRate,
+                        const nmfVectorView &carryingCapacity)
 {
     return 0.0;
 }
@@ -181,8 +213,8 @@ nmfGrowthForm::NoGrowth(const int &speciesNum,
 double
 nmfGrowthForm::LinearGrowth(const int &speciesNum,
                             const double &biomassAtTime,
-                            const std::vector<double> &growthRate,
-                            const std::vector<double> &carryingCapacity)
+                            const nmfVectorView &growthRate,
+                            const nmfVectorView &carryingCapacity)
 {
    return growthRate[speciesNum]*biomassAtTime;
 }
@@ -190,8 +222,8 @@ nmfGrowthForm::LinearGrowth(const int &speciesNum,
 double
 nmfGrowthForm::LogisticGrowth(const int &speciesNum,
                               const double &biomassAtTime,
-                              const std::vector<double> &growthRate,
-                              const std::vector<double> &carryingCapacity)
+                              const nmfVectorView &growthRate,
+                              const nmfVectorView &carryingCapacity)
 {
     return growthRate[speciesNum]*biomassAtTime * (1.0-biomassAtTime/carryingCapacity[speciesNum]);
 }
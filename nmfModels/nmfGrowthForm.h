@@ -10,6 +10,7 @@
 
 #include "nmfUtils.h"
 #include "nmfConstantsMSSPM.h"
+#include "nmfParameterView.h"
 
 
 class nmfGrowthForm {
@@ -27,8 +28,8 @@ private:
     std::map<std::string, double(nmfGrowthForm::*)(
             const int    &speciesNum,
             const double &initBiomass,
-            const std::vector<double> &growthRate,
-            const std::vector<double> &carryingCapacity
+            const nmfVectorView &growthRate,
+            const nmfVectorView &carryingCapacity
     )> FunctionMap;
 
 
@@ -39,8 +40,8 @@ public:
 
     double evaluate(const int    &speciesNum,
                     const double &biomassAtTime,
-                    const std::vector<double> &growthRate,
-                    const std::vector<double> &carryingCapacity);
+                    const nmfVectorView &growthRate,
+                    const nmfVectorView &carryingCapacity);
     int getNumParameters();
     void setType(std::string newType);
     std::string getType();
@@ -50,21 +51,31 @@ public:
             std::vector<double>&       growthRate,
             std::vector<double>&       carryingCapacity,
             double&                    systemCarryingCapacity);
+    void extractParameters(
+            const std::vector<double>& parameters,
+            const nmfParameterOffsets& offsets,
+            nmfVectorView&             growthRate,
+            nmfVectorView&             carryingCapacity,
+            double&                    systemCarryingCapacity);
     void loadParameterRanges(
             std::vector<std::pair<double,double> >& parameterRanges,
             const nmfStructsQt::ModelDataStruct& beeStruct);
+    void loadParameterRanges(
+            std::vector<std::pair<double,double> >& parameterRanges,
+            const nmfStructsQt::ModelRunSettings& settings,
+            const nmfStructsQt::ModelInputData& inputs);
     double NoGrowth(const int &speciesNum,
                     const double &biomassAtTime,
-                    const std::vector<double> &growthRate,
-                    const std::vector<double> &carryingCapacity);
+                    const nmfVectorView &growthRate,
+                    const nmfVectorView &carryingCapacity);
     double LinearGrowth(const int &speciesNum,
                         const double &biomassAtTime,
-                        const std::vector<double> &growthRate,
-                        const std::vector<double> &carryingCapacity);
+                        const nmfVectorView &growthRate,
+                        const nmfVectorView &carryingCapacity);
     double LogisticGrowth(const int &speciesNum,
                           const double &biomassAtTime,
-                          const std::vector<double> &growthRate,
-                          const std::vector<double> &carryingCapacity);
+                          const nmfVectorView &growthRate,
+                          const nmfVectorView &carryingCapacity);
     void setupFormMaps();
     void setAggProd(bool isAggProd);
     std::string getExpression();
@@ -95,15 +95,36 @@ nmfHarvestForm::extractParameters(
     }
 }
 
+void
+nmfHarvestForm::extractParameters(
+        const std::vector<double>& parameters,
+        const nmfParameterOffsets& offsets,
+        nmfVectorView& catchabilityRate)
+{
+    catchabilityRate = nmfVectorView();
+
+    if (m_type == "Effort (qE)") {
+        catchabilityRate = offsets.vectorView(parameters,offsets.Catchability);
+    }
+}
+
 
 void
 nmfHarvestForm::loadParameterRanges(
         std::vector<std::pair<double,double> >& parameterRanges,
         nmfStructsQt::ModelDataStruct& dataStruct)
+{
+    loadParameterRanges(parameterRanges,dataStruct,dataStruct);
+}
 
+void
+nmfHarvestForm::loadParameterRanges(
+        std::vector<std::pair<double,double> >& parameterRanges,
+        const nmfStructsQt::ModelRunSettings& settings,
+        const nmfStructsQt::ModelInputData& dataStruct)
 {
     std::pair<double,double> aPair;
-    bool isCheckedCatchability = nmfUtils::isEstimateParameterChecked(dataStruct,"Catchability");
+    bool isCheckedCatchability = nmfUtils::isEstimateParameterChecked(settings,"Catchability");
 
     m_numParameters = 0;
 
@@ -135,12 +156,12 @@ nmfHarvestForm::evaluate(const int& timeMinus1,
                          const boost::numeric::ublas::matrix<double>& Effort,
                          const boost::numeric::ublas::matrix<double>& Exploitation,
                          const double& biomassAtTime,
-                         const std::vector<double>& catchabilityRate)
+                         const nmfVectorView& catchabilityRate)
 {
     if (m_FunctionMap.find(m_type) == m_FunctionMap.end()) {
         return 0;
     } else {
-        return (this->*m_FunctionMap[m_type])(timeMinus1,speciesNum,Catch,Effort,Exploitation,
+        return (this->*m_FunctionMap.at(m_type))(timeMinus1,speciesNum,Catch,Effort,Exploitation,
                                               biomassAtTime,catchabilityRate);
     }
 }
@@ -153,7 +174,7 @@ nmfHarvestForm::NoHarvest(const int &timeMinus1,
                           const boost::numeric::ublas::matrix<double> &Effort,
                           const boost::numeric::ublas::matrix<double> &Exploitation,
                           const double& biomassAtTime,
-                          const std::vector<double>& catchabilityRate)
+                          const nmfVectorView& catchabilityRate)
 {
     return 0.0;
 }
@@ -165,7 +186,7 @@ nmfHarvestForm::CatchHarvest(const int &timeMinus1,
                              const boost::numeric::ublas::matrix<double> &Effort,
                              const boost::numeric::ublas::matrix<double> &Exploitation,
                              const double& biomassAtTime,
-                             const std::vector<double>& catchabilityRate)
+                             const nmfVectorView& catchabilityRate)
 {
    return Catch(timeMinus1,speciesNum);
 }
@@ -178,7 +199,7 @@ nmfHarvestForm::EffortHarvest(const int& timeMinus1,
                               const boost::numeric::ublas::matrix<double> &Effort,
                               const boost::numeric::ublas::matrix<double> &Exploitation,
                               const double& biomassAtTime,
-                              const std::vector<double>& catchabilityRate)
+                              const nmfVectorView& catchabilityRate)
 {
     if (catchabilityRate.size() == 0) {
         std::cout << "ERROR: No catchabilityRate rate found.  Please update code." << std::endl;
@@ -198,7 +219,7 @@ nmfHarvestForm::ExploitationHarvest(const int& timeMinus1,
                                     const boost::numeric::ublas::matrix<double> &Effort,
                                     const boost::numeric::ublas::matrix<double> &Exploitation,
                                     const double& biomassAtTime,
-                                    const std::vector<double>& catchabilityRate)
+                                    const nmfVectorView& catchabilityRate)
 {
    return Exploitation(timeMinus1,speciesNum)*biomassAtTime;
 }
@@ -13,6 +13,7 @@
 #include <boost/multi_array.hpp>
 
 #include "nmfUtils.h"
+#include "nmfParameterView.h"
 
 
 class nmfHarvestForm {
@@ -33,7 +34,7 @@ private:
             const boost::numeric::ublas::matrix<double> &Effort,
             const boost::numeric::ublas::matrix<double> &Exploitation,
             const double& biomassAtTime,
-            const std::vector<double>& catchabilityRate
+            const nmfVectorView& catchabilityRate
     )> m_FunctionMap;
 
 
@@ -48,44 +49,52 @@ public:
             const std::vector<double> &parameters,
             int& startPos,
             std::vector<double>& catchabilityRate);
+    void extractParameters(
+            const std::vector<double>& parameters,
+            const nmfParameterOffsets& offsets,
+            nmfVectorView& catchabilityRate);
     double evaluate(const int    &timeMinus1,
                     const int    &speciesNum,
                     const boost::numeric::ublas::matrix<double> &Catch,
                     const boost::numeric::ublas::matrix<double> &Effort,
                     const boost::numeric::ublas::matrix<double> &Exploitation,
                     const double& biomassAtTime,
-                    const std::vector<double>& catchabilityRate);
+                    const nmfVectorView& catchabilityRate);
     void loadParameterRanges(
                     std::vector<std::pair<double,double> >& parameterRanges,
                     nmfStructsQt::ModelDataStruct& beeStruct);
+    void loadParameterRanges(
+                    std::vector<std::pair<double,double> >& parameterRanges,
+                    const nmfStructsQt::ModelRunSettings& settings,
+                    const nmfStructsQt::ModelInputData& inputs);
     double NoHarvest(const int &timeMinus1,
                      const int &speciesNum,
                      const boost::numeric::ublas::matrix<double> &Catch,
                      const boost::numeric::ublas::matrix<double> &Effort,
                      const boost::numeric::ublas::matrix<double> &Exploitation,
                      const double& biomassAtTime,
-                     const std::vector<double>& catchabilityRate);
+                     const nmfVectorView& catchabilityRate);
     double ExploitationHarvest(const int &timeMinus1,
                                const int &speciesNum,
                                const boost::numeric::ublas::matrix<double> &Catch,
                                const boost::numeric::ublas::matrix<double> &Effort,
                                const boost::numeric::ublas::matrix<double> &Exploitation,
                                const double& biomassAtTime,
-                               const std::vector<double>& catchabilityRate);
+                               const nmfVectorView& catchabilityRate);
     double CatchHarvest(const int &timeMinus1,
                         const int &speciesNum,
                         const boost::numeric::ublas::matrix<double> &Catch,
                         const boost::numeric::ublas::matrix<double> &Effort,
                         const boost::numeric::ublas::matrix<double> &Exploitation,
                         const double& biomassAtTime,
-                        const std::vector<double>& catchabilityRate);
+                        const nmfVectorView& catchabilityRate);
     double EffortHarvest(const int& timeMinus1,
                          const int& speciesNum,
                          const boost::numeric::ublas::matrix<double> &Catch,
                          const boost::numeric::ublas::matrix<double> &Effort,
                          const boost::numeric::ublas::matrix<double> &Exploitation,
                          const double& biomassAtTime,
-                         const std::vector<double>& catchabilityRate);
+                         const nmfVectorView& catchabilityRate);
     void setupFormMaps();
     std::string getExpression();
     std::string getKey();
@@ -0,0 +1,144 @@
+#include "nmfMultiRunScheduler.h"
+
+#include <algorithm>
+#include <chrono>
+
+nmfMultiRunScheduler::nmfMultiRunScheduler(
+        const std::vector<nmfStructsQt::SharedModelData>& LineData)
+{
+    int NumRuns = 0;
+
+    m_LineData    = LineData;
+    m_NextToWrite = 0;
+    m_WallSeconds = 0;
+    for (const nmfStructsQt::SharedModelData& Line : m_LineData) {
+        m_Costs.push_back(estimateCost(Line.Settings));
+        m_FirstRun.push_back(NumRuns);
+        NumRuns += std::max(Line.Settings.NLoptNumberOfRuns,0);
+    }
+    m_FirstRun.push_back(NumRuns);
+}
+
+nmfMultiRunScheduler::nmfMultiRunScheduler(
+        const std::vector<nmfStructsQt::ModelDataStruct>& LineData)
+    : nmfMultiRunScheduler(std::vector<nmfStructsQt::SharedModelData>(
+                               LineData.begin(),LineData.end()))
+{
+}
+
+double
+nmfMultiRunScheduler::estimateCost(const nmfStructsQt::ModelRunSettings& LineData)
+{
+    bool isAggProd = (LineData.CompetitionForm == "AGG-PROD");
+    double NumSpeciesOrGuilds = std::max((isAggProd) ? LineData.NumGuilds : LineData.NumSpecies,1);
+    double NumParameters = std::max(LineData.TotalNumberParameters,1);
+    double TermsPerSpecies = 1;
+    double NumEvaluations;
+    const std::string& Algorithm = LineData.EstimationAlgorithm;
+
+    // Competition and predation sum over every other species or guild
+    if ((LineData.CompetitionForm != "NO_K") && (LineData.CompetitionForm != "Null")) {
+        TermsPerSpecies += NumSpeciesOrGuilds;
+    }
+    if (LineData.PredationForm != "Null") {
+        TermsPerSpecies += NumSpeciesOrGuilds;
+    }
+
+    if (Algorithm.find("Bees") != std::string::npos) {
+        NumEvaluations = double(std::max(LineData.BeesMaxGenerations,1)) *
+                         std::max(LineData.BeesNumTotal,1) *
+                         std::max(LineData.BeesNumRepetitions,1);
+    } else if (Algorithm.find("Genetic") != std::string::npos) {
+        NumEvaluations = double(std::max(LineData.GAGenerations,1)) * NumParameters;
+    } else {
+        // NLopt, which without an iteration limit takes roughly a hundred evaluations per parameter
+        NumEvaluations = (LineData.NLoptUseStopAfterIter) ?
+                    std::max(LineData.NLoptStopAfterIter,1) : 100*NumParameters;
+    }
+
+    return NumEvaluations * (LineData.RunLength+1) * NumSpeciesOrGuilds * TermsPerSpecies;
+}
+
+void
+nmfMultiRunScheduler::setCost(const int& LineNum, const double& Cost)
+{
+    if ((LineNum < 0) || (LineNum >= int(m_Costs.size()))) {
+        std::cout << "Error nmfMultiRunScheduler::setCost: Invalid line number " << LineNum << std::endl;
+        return;
+    }
+    m_Costs[LineNum] = Cost;
+}
+
+void
+nmfMultiRunScheduler::finish(const int& Index,
+                             ResultWriter WriteResult,
+                             std::vector<nmfMultiRunResult>& Results)
+{
+    std::lock_guard<std::mutex> lock(m_WriteMutex);
+
+    // Write this and every later result that was only waiting on it
+    m_Finished[Index] = 1;
+    while ((m_NextToWrite < int(Results.size())) && m_Finished[m_NextToWrite]) {
+        if (WriteResult) {
+            WriteResult(Results[m_NextToWrite]);
+        }
+        ++m_NextToWrite;
+    }
+}
+
+bool
+nmfMultiRunScheduler::run(Estimator EstimateRun,
+                          const int& NumThreads,
+                          ResultWriter WriteResult,
+                          std::vector<nmfMultiRunResult>& Results)
+{
+    int NumLines = m_LineData.size();
+    int NumRuns  = m_FirstRun.back();
+    bool ok = true;
+    auto StartTime = std::chrono::steady_clock::now();
+
+    Results.assign(NumRuns,nmfMultiRunResult());
+    m_Finished.assign(NumRuns,0);
+    m_NextToWrite = 0;
+    m_WallSeconds = 0;
+    if (NumRuns == 0) {
+        std::cout << "Error nmfMultiRunScheduler::run: No runs in the multi-run batch" << std::endl;
+        return false;
+    }
+
+    nmfWorkStealingPool Pool(std::min(std::max(NumThreads,0),NumRuns));
+    nmfTaskGroup Batch;
+
+    // Each run only writes its own result, the writer takes them in order as they become ready
+    for (int line = 0; line < NumLines; ++line) {
+        for (int run = 0; run < m_FirstRun[line+1]-m_FirstRun[line]; ++run) {
+            int index = m_FirstRun[line] + run;
+            Pool.submit([&,line,run,index]() {
+                nmfMultiRunResult& Result = Results[index];
+                auto RunStart = std::chrono::steady_clock::now();
+                Result.LineNum   = line;
+                Result.RunNum    = run;
+                Result.Estimated = EstimateRun(m_LineData[line],line,run,Pool,
+                                               Result.Parameters,Result.Fitness);
+                Result.Seconds   = std::chrono::duration<double>(
+                            std::chrono::steady_clock::now()-RunStart).count();
+                finish(index,WriteResult,Results);
+            },m_Costs[line],Batch);
+        }
+    }
+    Pool.wait(Batch);
+
+    m_WallSeconds = std::chrono::duration<double>(
+                std::chrono::steady_clock::now()-StartTime).count();
+    for (const nmfMultiRunResult& Result : Results) {
+        ok = ok && Result.Estimated;
+    }
+
+    return ok;
+}
+
+double
+nmfMultiRunScheduler::getWallSeconds() const
+{
+    return m_WallSeconds;
+}
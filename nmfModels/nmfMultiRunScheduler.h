@@ -0,0 +1,120 @@
+#pragma once
+
+#include <mutex>
+#include <vector>
+#include <string>
+#include <iostream>
+#include <functional>
+
+#include "nmfStructsQt.h"
+#include "nmfWorkStealingPool.h"
+
+/**
+ * @brief Estimate of one run of a multi-run line
+ */
+struct nmfMultiRunResult {
+    int    LineNum;        // line of the multi-run setup file, from 0
+    int    RunNum;         // run of the line, from 0
+    bool   Estimated;      // false if the estimation failed
+    double Fitness;        // objective value of the estimate
+    double Seconds;        // time from the run's start to its end
+    std::vector<double> Parameters;  // in nmfParameterOffsets order
+
+    nmfMultiRunResult() : LineNum(0), RunNum(0), Estimated(false), Fitness(0), Seconds(0) {}
+};
+
+/**
+ * @brief Runs a multi-run batch on a work-stealing pool. Every run of every line (each line
+ * has NLoptNumberOfRuns runs) is a separate task, and the tasks are started costliest first
+ * from an estimate of their cost, so the cheap runs fill in around the expensive ones at
+ * the end of the batch. The estimation is supplied by the caller (e.g., the MSSPM NLopt or
+ * Bees estimator), must be safe to run on several threads at once, and is passed the pool
+ * so that it can split a long run further, e.g. evaluating a Bees population in chunks
+ * with parallelFor().
+ *
+ * Results are passed to the writer in the order of the lines and runs, whatever order they
+ * finish in, so a batch writes the same output file on any number of threads.
+ *
+ * The line data are usually loaded with nmfUtilsQt::loadMultiRunData, copying a SharedModelData
+ * of the loaded model once per line and calling nmfUtilsQt::reloadDataStruct on the copy's
+ * settings with the line. Every line and run then reads the same input data, so a batch keeps
+ * only one copy of the model however many lines and threads it has.
+ */
+class nmfMultiRunScheduler {
+
+public:
+    /**
+     * @brief Estimates one run of a line. Called on the run's thread with the line's model data.
+     */
+    typedef std::function<bool(const nmfStructsQt::SharedModelData& LineData,
+                               const int& LineNum,
+                               const int& RunNum,
+                               nmfWorkStealingPool& Pool,
+                               std::vector<double>& Parameters,
+                               double& Fitness)> Estimator;
+    /**
+     * @brief Called with each result in line and run order, never on two threads at once
+     */
+    typedef std::function<void(const nmfMultiRunResult& Result)> ResultWriter;
+
+private:
+    std::vector<nmfStructsQt::SharedModelData> m_LineData;
+    std::vector<double> m_Costs;
+    std::vector<int>    m_FirstRun;      // index of each line's first run in the results
+    std::mutex          m_WriteMutex;
+    std::vector<char>   m_Finished;
+    int                 m_NextToWrite;
+    double              m_WallSeconds;
+
+    void finish(const int& Index,
+                ResultWriter WriteResult,
+                std::vector<nmfMultiRunResult>& Results);
+
+public:
+    /**
+     * @brief Sets up a multi-run batch
+     * @param LineData : model data of each line of the multi-run setup file, usually sharing
+     * their input data
+     */
+    nmfMultiRunScheduler(const std::vector<nmfStructsQt::SharedModelData>& LineData);
+    /**
+     * @brief Sets up a multi-run batch from full copies of the model data, each of which
+     * becomes its line's own shared input data
+     * @param LineData : model data of each line of the multi-run setup file
+     */
+    nmfMultiRunScheduler(const std::vector<nmfStructsQt::ModelDataStruct>& LineData);
+   ~nmfMultiRunScheduler() {}
+
+    /**
+     * @brief Rough cost of one run of a line, proportional to the number of objective function
+     * evaluations the line's algorithm makes times the cost of each. Only the ratios between
+     * lines matter.
+     * @param LineData : settings of the line
+     * @return The estimated cost
+     */
+    static double estimateCost(const nmfStructsQt::ModelRunSettings& LineData);
+    /**
+     * @brief Overrides the estimated cost of a line's runs, e.g. with their measured time in
+     * an earlier batch
+     * @param LineNum : line, from 0
+     * @param Cost : cost of one of the line's runs
+     */
+    void setCost(const int& LineNum, const double& Cost);
+    /**
+     * @brief Runs the batch
+     * @param EstimateRun : the estimation to run on each run of each line
+     * @param NumThreads : number of threads (0 uses one per core)
+     * @param WriteResult : called with each result in line and run order (may be empty)
+     * @param Results : every run's result, in line and run order
+     * @return True if every run was estimated, else False
+     */
+    bool run(Estimator EstimateRun,
+             const int& NumThreads,
+             ResultWriter WriteResult,
+             std::vector<nmfMultiRunResult>& Results);
+    /**
+     * @brief Elapsed time of the last run() call
+     * @return Seconds from the start to the end of the batch
+     */
+    double getWallSeconds() const;
+};
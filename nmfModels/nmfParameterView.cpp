@@ -0,0 +1,77 @@
+
+#include "nmfParameterView.h"
+
+nmfParameterOffsets::nmfParameterOffsets()
+{
+    m_TotalNumberParameters = 0;
+}
+
+void
+nmfParameterOffsets::append(nmfParameterBlock& block,
+                            const int& rows,
+                            const int& cols)
+{
+    block.Offset = m_TotalNumberParameters;
+    block.Rows   = rows;
+    block.Cols   = cols;
+    m_TotalNumberParameters += rows*cols;
+}
+
+void
+nmfParameterOffsets::load(const nmfStructsQt::ModelRunSettings& dataStruct)
+{
+    bool isAggProd     = (dataStruct.CompetitionForm == "AGG-PROD");
+    bool isLogistic    = (dataStruct.GrowthForm      == "Logistic");
+    bool isEffort      = (dataStruct.HarvestForm     == "Effort (qE)");
+    bool isAlpha       = (dataStruct.CompetitionForm == "NO_K");
+    bool isBetaSpecies = (dataStruct.CompetitionForm == "MS-PROD");
+    bool isRho         = (dataStruct.PredationForm   != "Null");
+    bool isHandling    = (dataStruct.PredationForm   == "Type II") ||
+                         (dataStruct.PredationForm   == "Type III");
+    bool isExponent    = (dataStruct.PredationForm   == "Type III");
+    int  NumSpecies    =  dataStruct.NumSpecies;
+    int  NumGuilds     =  dataStruct.NumGuilds;
+    int  NumSpeciesOrGuilds = (isAggProd) ? NumGuilds : NumSpecies;
+
+    *this = nmfParameterOffsets();
+
+    // Growth rates are always loaded, regardless of the growth form
+    append(InitBiomass,                 NumSpeciesOrGuilds,                       1);
+    append(GrowthRate,                  NumSpeciesOrGuilds,                       1);
+    append(CarryingCapacity,            (isLogistic)    ? NumSpeciesOrGuilds : 0, 1);
+    append(Catchability,                (isEffort)      ? NumSpeciesOrGuilds : 0, 1);
+    append(CompetitionAlpha,            (isAlpha)       ? NumSpecies         : 0, NumSpecies);
+    append(CompetitionBetaSpecies,      (isBetaSpecies) ? NumSpecies         : 0, NumSpecies);
+    append(CompetitionBetaGuilds,       (isBetaSpecies) ? NumSpecies         : 0, NumGuilds);
+    append(CompetitionBetaGuildsGuilds, (isAggProd)     ? NumGuilds          : 0, NumGuilds);
+    append(PredationRho,                (isRho)         ? NumSpeciesOrGuilds : 0, NumSpeciesOrGuilds);
+    append(PredationHandling,           (isHandling)    ? NumSpeciesOrGuilds : 0, NumSpeciesOrGuilds);
+    append(PredationExponent,           (isExponent)    ? NumSpeciesOrGuilds : 0, 1);
+    append(SurveyQ,                     NumSpeciesOrGuilds,                       1);
+}
+
+int
+nmfParameterOffsets::getTotalNumberParameters() const
+{
+    return m_TotalNumberParameters;
+}
+
+nmfVectorView
+nmfParameterOffsets::vectorView(const std::vector<double>& parameters,
+                                const nmfParameterBlock& block) const
+{
+    if ((block.size() == 0) || (block.Offset+block.size() > int(parameters.size()))) {
+        return nmfVectorView();
+    }
+    return nmfVectorView(parameters.data()+block.Offset,block.size());
+}
+
+nmfMatrixView
+nmfParameterOffsets::matrixView(const std::vector<double>& parameters,
+                                const nmfParameterBlock& block) const
+{
+    if ((block.size() == 0) || (block.Offset+block.size() > int(parameters.size()))) {
+        return nmfMatrixView();
+    }
+    return nmfMatrixView(parameters.data()+block.Offset,block.Rows,block.Cols);
+}
@@ -0,0 +1,185 @@
+#pragma once
+
+#include <vector>
+#include <string>
+#include <cassert>
+#include <cstddef>
+
+#include <boost/numeric/ublas/matrix.hpp>
+
+#include "nmfStructsQt.h"
+
+/**
+ * @brief Non-owning, strided, read-only view onto a run of doubles. Used so that the
+ * model forms can read their parameters directly out of a candidate's parameter vector
+ * without copying them into temporary containers. A view is implicitly constructible
+ * from a std::vector<double> so existing callers may continue passing vectors.
+ * Indexing is bounds checked by assert in debug builds.
+ */
+class nmfVectorView {
+
+private:
+    const double* m_data;
+    std::size_t   m_size;
+    std::size_t   m_stride;
+
+public:
+    nmfVectorView() : m_data(nullptr), m_size(0), m_stride(1) {}
+    nmfVectorView(const double* data,
+                  const std::size_t& size,
+                  const std::size_t& stride=1)
+        : m_data(data), m_size(size), m_stride(stride) {}
+    nmfVectorView(const std::vector<double>& vec)
+        : m_data(vec.data()), m_size(vec.size()), m_stride(1) {}
+
+    inline const double& operator[](const std::size_t& i) const {
+        assert(i < m_size);
+        return m_data[i*m_stride];
+    }
+    inline std::size_t size()   const { return m_size; }
+    inline bool        empty()  const { return (m_size == 0); }
+    inline std::size_t stride() const { return m_stride; }
+    inline const double* data() const { return m_data; }
+};
+
+/**
+ * @brief Non-owning, strided, read-only 2d view onto a run of doubles. Element (i,j) is
+ * found at data[i*rowStride + j*colStride], so a transposed view costs nothing. A view is
+ * implicitly constructible from a (row major) ublas matrix so existing callers may continue
+ * passing matrices. Indexing is bounds checked by assert in debug builds.
+ */
+class nmfMatrixView {
+
+private:
+    const double* m_data;
+    std::size_t   m_rows;
+    std::size_t   m_cols;
+    std::size_t   m_rowStride;
+    std::size_t   m_colStride;
+
+public:
+    nmfMatrixView() : m_data(nullptr), m_rows(0), m_cols(0), m_rowStride(0), m_colStride(1) {}
+    nmfMatrixView(const double* data,
+                  const std::size_t& rows,
+                  const std::size_t& cols)
+        : m_data(data), m_rows(rows), m_cols(cols), m_rowStride(cols), m_colStride(1) {}
+    nmfMatrixView(const double* data,
+                  const std::size_t& rows,
+                  const std::size_t& cols,
+                  const std::size_t& rowStride,
+                  const std::size_t& colStride)
+        : m_data(data), m_rows(rows), m_cols(cols), m_rowStride(rowStride), m_colStride(colStride) {}
+    nmfMatrixView(const boost::numeric::ublas::matrix<double>& matrix)
+        : m_data(matrix.data().begin()), m_rows(matrix.size1()), m_cols(matrix.size2()),
+          m_rowStride(matrix.size2()), m_colStride(1) {}
+
+    inline const double& operator()(const std::size_t& i,
+                                    const std::size_t& j) const {
+        assert((i < m_rows) && (j < m_cols));
+        return m_data[i*m_rowStride + j*m_colStride];
+    }
+    inline std::size_t size1() const { return m_rows; }
+    inline std::size_t size2() const { return m_cols; }
+    inline bool        empty() const { return ((m_rows == 0) || (m_cols == 0)); }
+
+    /**
+     * @brief Returns a transposed view onto the same storage
+     * @return A view with swapped dimensions and strides
+     */
+    inline nmfMatrixView transpose() const {
+        return nmfMatrixView(m_data,m_cols,m_rows,m_colStride,m_rowStride);
+    }
+    /**
+     * @brief Returns a view onto a single row of the matrix
+     * @param row : row of interest
+     * @return A vector view of length size2()
+     */
+    inline nmfVectorView row(const std::size_t& row) const {
+        return nmfVectorView(m_data+row*m_rowStride,m_cols,m_colStride);
+    }
+    /**
+     * @brief Returns a view onto a single column of the matrix
+     * @param col : column of interest
+     * @return A vector view of length size1()
+     */
+    inline nmfVectorView column(const std::size_t& col) const {
+        return nmfVectorView(m_data+col*m_colStride,m_rows,m_rowStride);
+    }
+};
+
+/**
+ * @brief Location of one parameter group inside a candidate's flat parameter vector
+ */
+struct nmfParameterBlock {
+    int Offset;
+    int Rows;
+    int Cols;
+    nmfParameterBlock() : Offset(0), Rows(0), Cols(0) {}
+    int size() const { return Rows*Cols; }
+};
+
+/**
+ * @brief Offset table describing where every parameter group lives in the flat
+ * parameter vector. It depends only upon the model form types and the number of
+ * species and guilds, so it's computed once per estimation and then used to hand
+ * out views for every candidate that's evaluated.
+ *
+ * The parameter order matches the order in which the parameter ranges are loaded:
+ * initial biomass, growth rate, carrying capacity, catchability, competition
+ * (alpha, beta species, beta guilds, beta guilds-guilds), predation (rho, handling,
+ * exponent), and survey Q.
+ */
+class nmfParameterOffsets {
+
+private:
+    int m_TotalNumberParameters;
+
+    void append(nmfParameterBlock& block,
+                const int& rows,
+                const int& cols);
+
+public:
+    nmfParameterBlock InitBiomass;
+    nmfParameterBlock GrowthRate;
+    nmfParameterBlock CarryingCapacity;
+    nmfParameterBlock Catchability;
+    nmfParameterBlock CompetitionAlpha;
+    nmfParameterBlock CompetitionBetaSpecies;
+    nmfParameterBlock CompetitionBetaGuilds;
+    nmfParameterBlock CompetitionBetaGuildsGuilds;
+    nmfParameterBlock PredationRho;
+    nmfParameterBlock PredationHandling;
+    nmfParameterBlock PredationExponent;
+    nmfParameterBlock SurveyQ;
+
+    nmfParameterOffsets();
+   ~nmfParameterOffsets() {}
+
+    /**
+     * @brief Computes the offset table from the form types and the number of species and guilds
+     * @param dataStruct : model settings containing the form types and species and guild counts
+     */
+    void load(const nmfStructsQt::ModelRunSettings& dataStruct);
+    /**
+     * @brief Returns the total number of parameters described by the offset table
+     * @return Total number of parameters
+     */
+    int getTotalNumberParameters() const;
+    /**
+     * @brief Returns a vector view onto a parameter block
+     * @param parameters : the candidate's flat parameter vector
+     * @param block : the parameter block of interest
+     * @return A view onto the block (empty if the block isn't used by the current forms)
+     */
+    nmfVectorView vectorView(const std::vector<double>& parameters,
+                             const nmfParameterBlock& block) const;
+    /**
+     * @brief Returns a matrix view onto a parameter block
+     * @param parameters : the candidate's flat parameter vector
+     * @param block : the parameter block of interest
+     * @return A row major view onto the block (empty if the block isn't used by the current forms)
+     */
+    nmfMatrixView matrixView(const std::vector<double>& parameters,
+                             const nmfParameterBlock& block) const;
+};
+
@@ -127,23 +127,59 @@ nmfPredationForm::extractExponentParameters(
     }
 }
 
+void
+nmfPredationForm::extractPredationParameters(
+        const std::vector<double> &parameters,
+        const nmfParameterOffsets& offsets,
+        nmfMatrixView &predation)
+{
+    predation = offsets.matrixView(parameters,offsets.PredationRho);
+}
+
+void
+nmfPredationForm::extractHandlingParameters(
+        const std::vector<double> &parameters,
+        const nmfParameterOffsets& offsets,
+        nmfMatrixView &handling)
+{
+    handling = offsets.matrixView(parameters,offsets.PredationHandling);
+}
+
+void
+nmfPredationForm::extractExponentParameters(
+        const std::vector<double> &parameters,
+        const nmfParameterOffsets& offsets,
+        nmfVectorView &exponents)
+{
+    exponents = offsets.vectorView(parameters,offsets.PredationExponent);
+}
+
 void
 nmfPredationForm::loadParameterRanges(
         std::vector<std::pair<double,double> >& parameterRanges,
         nmfStructsQt::ModelDataStruct& dataStruct)
 {
-    bool isCheckedRho      = nmfUtils::isEstimateParameterChecked(dataStruct,"PredationRho");
-    bool isCheckedHandling = nmfUtils::isEstimateParameterChecked(dataStruct,"Handling");
-    bool isCheckedExponent = nmfUtils::isEstimateParameterChecked(dataStruct,"PredationExponent");
+    loadParameterRanges(parameterRanges,dataStruct,dataStruct);
+}
+
+void
+nmfPredationForm::loadParameterRanges(
+        std::vector<std::pair<double,double> >& parameterRanges,
+        const nmfStructsQt::ModelRunSettings& settings,
+        const nmfStructsQt::ModelInputData& dataStruct)
+{
+    bool isCheckedRho      = nmfUtils::isEstimateParameterChecked(settings,"PredationRho");
+    bool isCheckedHandling = nmfUtils::isEstimateParameterChecked(settings,"Handling");
+    bool isCheckedExponent = nmfUtils::isEstimateParameterChecked(settings,"PredationExponent");
     double min;
     std::pair<double,double> aPair;
 
     if (m_type == "Null")
         return;
 
-    m_numSpecies = dataStruct.NumSpecies;
-    m_numGuilds  = dataStruct.NumGuilds;
-    m_isAggProd  = (dataStruct.CompetitionForm == "AGG-PROD");
+    m_numSpecies = settings.NumSpecies;
+    m_numGuilds  = settings.NumGuilds;
+    m_isAggProd  = (settings.CompetitionForm == "AGG-PROD");
     m_NumSpeciesOrGuilds = (m_isAggProd) ? m_numGuilds : m_numSpecies;
 
     for (unsigned i=0; i<dataStruct.PredationRhoMin.size(); ++i) {
@@ -199,9 +235,9 @@ nmfPredationForm::loadParameterRanges(
 double
 nmfPredationForm::evaluate(const int &timeMinus1,
                            const int &SpeciesNum,
-                           const boost::numeric::ublas::matrix<double> &EstPredation,
-                           const boost::numeric::ublas::matrix<double> &EstHandling,
-                           const std::vector<double> &EstExponent,
+                           const nmfMatrixView &EstPredation,
+                           const nmfMatrixView &EstHandling,
+                           const nmfVectorView &EstExponent,
                            const boost::numeric::ublas::matrix<double> &EstimatedBiomass,
                            const double &EstimatedBiomassTimeMinus1)
 {
@@ -209,7 +245,7 @@ nmfPredationForm::evaluate(const int &timeMinus1,
     if (m_FunctionMap.find(m_type) == m_FunctionMap.end()) {
         return 0;
     } else {
-        return (this->*m_FunctionMap[m_type])(timeMinus1,SpeciesNum,
+        return (this->*m_FunctionMap.at(m_type))(timeMinus1,SpeciesNum,
                                      EstPredation,EstHandling,EstExponent,
                                      EstimatedBiomass,EstimatedBiomassTimeMinus1);
     }
@@ -218,9 +254,9 @@ nmfPredationForm::evaluate(const int &timeMinus1,
 double
 nmfPredationForm::TypeNullPredation(const int &timeMinus1,
                                     const int &SpeciesNum,
-                                    const boost::numeric::ublas::matrix<double> &EstPredation,
-                                    const boost::numeric::ublas::matrix<double> &EstHandling,
-                                    const std::vector<double> &EstExponent,
+                                    const nmfMatrixView &EstPredation,
+                                    const nmfMatrixView &EstHandling,
+                                    const nmfVectorView &EstExponent,
                                     const boost::numeric::ublas::matrix<double> &EstimatedBiomass,
                                     const double &EstimatedBiomassTimeMinus1)
 {
@@ -230,9 +266,9 @@ nmfPredationForm::TypeNullPredation(const int &timeMinus1,
 double
 nmfPredationForm::TypeIPredation(const int &timeMinus1,
                                  const int &SpeciesNum,
-                                 const boost::numeric::ublas::matrix<double> &EstPredation,
-                                 const boost::numeric::ublas::matrix<double> &EstHandling,
-                                 const std::vector<double> &EstExponent,
+                                 const nmfMatrixView &EstPredation,
+                                 const nmfMatrixView &EstHandling,
+                                 const nmfVectorView &EstExponent,
                                  const boost::numeric::ublas::matrix<double> &EstimatedBiomass,
                                  const double &biomassAtTimeMinus1)
 {
@@ -249,9 +285,9 @@ nmfPredationForm::TypeIPredation(const int &timeMinus1,
 double
 nmfPredationForm::TypeIIPredation(const int &timeMinus1,
                                   const int &SpeciesNum,
-                                  const boost::numeric::ublas::matrix<double> &EstPredation,
-                                  const boost::numeric::ublas::matrix<double> &EstHandling,
-                                  const std::vector<double> &EstExponent,
+                                  const nmfMatrixView &EstPredation,
+                                  const nmfMatrixView &EstHandling,
+                                  const nmfVectorView &EstExponent,
                                   const boost::numeric::ublas::matrix<double> &EstimatedBiomass,
                                   const double &biomassAtTimeMinus1)
 {
@@ -282,9 +318,9 @@ nmfPredationForm::TypeIIPredation(const int &timeMinus1,
 double
 nmfPredationForm::TypeIIIPredation(const int &timeMinus1,
                                    const int &SpeciesNum,
-                                   const boost::numeric::ublas::matrix<double> &EstPredation,
-                                   const boost::numeric::ublas::matrix<double> &EstHandling,
-                                   const std::vector<double> &EstExponent,
+                                   const nmfMatrixView &EstPredation,
+                                   const nmfMatrixView &EstHandling,
+                                   const nmfVectorView &EstExponent,
                                    const boost::numeric::ublas::matrix<double> &EstimatedBiomass,
                                    const double &EstimatedBiomassTimeMinus1)
 {
@@ -13,6 +13,7 @@
 #include <boost/multi_array.hpp>
 
 #include "nmfUtils.h"
+#include "nmfParameterView.h"
 
 class nmfPredationForm {
 
@@ -31,9 +32,9 @@ private:
     std::map<std::string, double(nmfPredationForm::*)(
             const int &timeMinus1,
             const int &SpeciesNum,
-            const boost::numeric::ublas::matrix<double> &EstPredation,
-            const boost::numeric::ublas::matrix<double> &EstHandling,
-            const std::vector<double> &EstExponent,
+            const nmfMatrixView &EstPredation,
+            const nmfMatrixView &EstHandling,
+            const nmfVectorView &EstExponent,
             const boost::numeric::ublas::matrix<double> &EstimatedBiomass,
             const double &EstimatedBiomassTimeMinus1
     )> m_FunctionMap;
@@ -58,47 +59,63 @@ public:
             const std::vector<double> &parameters,
             int& startPos,
             std::vector<double> &exponents);
+    void extractPredationParameters(
+            const std::vector<double> &parameters,
+            const nmfParameterOffsets& offsets,
+            nmfMatrixView &predation);
+    void extractHandlingParameters(
+            const std::vector<double> &parameters,
+            const nmfParameterOffsets& offsets,
+            nmfMatrixView &handling);
+    void extractExponentParameters(
+            const std::vector<double> &parameters,
+            const nmfParameterOffsets& offsets,
+            nmfVectorView &exponents);
     void loadParameterRanges(
             std::vector<std::pair<double,double> >& parameterRanges,
             nmfStructsQt::ModelDataStruct& beeStruct);
+    void loadParameterRanges(
+            std::vector<std::pair<double,double> >& parameterRanges,
+            const nmfStructsQt::ModelRunSettings& settings,
+            const nmfStructsQt::ModelInputData& inputs);
 
     double evaluate(const int &timeMinus1,
                     const int &SpeciesNum,
-                    const boost::numeric::ublas::matrix<double> &EstPredation,
-                    const boost::numeric::ublas::matrix<double> &EstHandling,
-                    const std::vector<double> &EstExponent,
+                    const nmfMatrixView &EstPredation,
+                    const nmfMatrixView &EstHandling,
+                    const nmfVectorView &EstExponent,
                     const boost::numeric::ublas::matrix<double> &EstimatedBiomass,
                     const double &EstimatedBiomassTimeMinus1);
 
     double TypeNullPredation(const int &timeMinus1,
                              const int &SpeciesNum,
-                             const boost::numeric::ublas::matrix<double> &EstPredation,
-                             const boost::numeric::ublas::matrix<double> &EstHandling,
-                             const std::vector<double> &EstExponent,
+                             const nmfMatrixView &EstPredation,
+                             const nmfMatrixView &EstHandling,
+                             const nmfVectorView &EstExponent,
                              const boost::numeric::ublas::matrix<double> &EstimatedBiomass,
                              const double &EstimatedBiomassTimeMinus1);
 
     double TypeIPredation(const int &timeMinus1,
                           const int &SpeciesNum,
-                          const boost::numeric::ublas::matrix<double> &EstPredation,
-                          const boost::numeric::ublas::matrix<double> &EstHandling,
-                          const std::vector<double> &EstExponent,
+                          const nmfMatrixView &EstPredation,
+                          const nmfMatrixView &EstHandling,
+                          const nmfVectorView &EstExponent,
                           const boost::numeric::ublas::matrix<double> &EstimatedBiomass,
                           const double &biomassAtTime);
 
     double TypeIIPredation(const int &timeMinus1,
                            const int &SpeciesNum,
-                           const boost::numeric::ublas::matrix<double> &EstPredation,
-                           const boost::numeric::ublas::matrix<double> &EstHandling,
-                           const std::vector<double> &EstExponent,
+                           const nmfMatrixView &EstPredation,
+                           const nmfMatrixView &EstHandling,
+                           const nmfVectorView &EstExponent,
                            const boost::numeric::ublas::matrix<double> &EstimatedBiomass,
                            const double &EstimatedBiomassTimeMinus1);
 
     double TypeIIIPredation(const int &timeMinus1,
                             const int &SpeciesNum,
-                            const boost::numeric::ublas::matrix<double> &EstPredation,
-                            const boost::numeric::ublas::matrix<double> &EstHandling,
-                            const std::vector<double> &EstExponent,
+                            const nmfMatrixView &EstPredation,
+                            const nmfMatrixView &EstHandling,
+                            const nmfVectorView &EstExponent,
                             const boost::numeric::ublas::matrix<double> &EstimatedBiomass,
                             const double &EstimatedBiomassTimeMinus1);
     void setupFormMaps();
@@ -0,0 +1,198 @@
+#include "nmfRetrospective.h"
+#include "nmfUtils.h"
+#include "nmfUtilsStatistics.h"
+
+#include <algorithm>
+#include <cmath>
+
+nmfRetrospective::nmfRetrospective(
+        const nmfStructsQt::ModelDataStruct& ModelData,
+        const int& NumPeels)
+{
+    m_NumPeels           = NumPeels;
+    m_NumSpeciesOrGuilds = (ModelData.CompetitionForm == "AGG-PROD") ?
+                            ModelData.NumGuilds : ModelData.NumSpecies;
+    m_NumFinished        = 0;
+    m_IsFinished.assign(std::max(NumPeels+1,0),0);
+
+    m_Offsets.load(ModelData);
+    if (! buildPeelData(ModelData,NumPeels,m_PeelData)) {
+        m_PeelData.clear();
+    }
+}
+
+bool
+nmfRetrospective::buildPeelData(
+        const nmfStructsQt::ModelDataStruct& ModelData,
+        const int& NumPeels,
+        std::vector<nmfStructsQt::ModelDataStruct>& PeelData)
+{
+    int NumRows;
+    const std::vector<boost::numeric::ublas::matrix<double> nmfStructsQt::ModelDataStruct::*> TimeSeries =
+        {&nmfStructsQt::ModelDataStruct::ObservedBiomassBySpecies,
+         &nmfStructsQt::ModelDataStruct::ObservedBiomassByGuilds,
+         &nmfStructsQt::ModelDataStruct::Catch,
+         &nmfStructsQt::ModelDataStruct::Effort,
+         &nmfStructsQt::ModelDataStruct::Exploitation};
+
+    PeelData.clear();
+    if ((NumPeels < 1) || (ModelData.RunLength-NumPeels < 1)) {
+        std::cout << "Error nmfRetrospective::buildPeelData: Can't peel " << NumPeels <<
+                     " years from a run length of " << ModelData.RunLength << std::endl;
+        return false;
+    }
+
+    // Everything but the time series is shared, so copy the model data with the time
+    // series emptied and then size them per peel
+    nmfStructsQt::ModelDataStruct Base = ModelData;
+    for (auto series : TimeSeries) {
+        (Base.*series).resize(0,0,false);
+    }
+    Base.isMohnsRho = true;
+    PeelData.assign(NumPeels+1,Base);
+    for (int peel = 0; peel <= NumPeels; ++peel) {
+        PeelData[peel].RunLength = ModelData.RunLength - peel;
+    }
+
+    // One pass over each series' years copies every row into all of the peels that keep it
+    for (auto series : TimeSeries) {
+        const boost::numeric::ublas::matrix<double>& Full = ModelData.*series;
+        NumRows = Full.size1();
+        for (int peel = 0; peel <= NumPeels; ++peel) {
+            (PeelData[peel].*series).resize(std::max(NumRows-peel,0),Full.size2(),false);
+        }
+        for (int time = 0; time < NumRows; ++time) {
+            for (int peel = 0; (peel <= NumPeels) && (time < NumRows-peel); ++peel) {
+                boost::numeric::ublas::matrix<double>& Peeled = PeelData[peel].*series;
+                for (unsigned j = 0; j < Full.size2(); ++j) {
+                    Peeled(time,j) = Full(time,j);
+                }
+            }
+        }
+    }
+
+    return true;
+}
+
+bool
+nmfRetrospective::run(Estimator EstimatePeel,
+                      const int& NumThreads,
+                      PeelFinished OnPeelFinished,
+                      std::vector<nmfRetrospectivePeel>& Peels)
+{
+    int NumRuns = m_NumPeels+1;
+
+    Peels.clear();
+    if (m_PeelData.empty()) {
+        std::cout << "Error nmfRetrospective::run: No peel data" << std::endl;
+        return false;
+    }
+
+    m_NumFinished = 0;
+    m_Finished.assign(NumRuns,nmfRetrospectivePeel());
+    m_IsFinished.assign(NumRuns,0);
+    Peels.assign(NumRuns,nmfRetrospectivePeel());
+
+    // Peel 0 has the most years so it's started first
+    auto worker = [&](const nmfUtils::NextTask& nextPeel) {
+        int peel;
+        int numFinished;
+        while (nextPeel(peel)) {
+            nmfRetrospectivePeel& Peel = Peels[peel];
+            Peel.Peel      = peel;
+            Peel.Estimated = EstimatePeel(m_PeelData[peel],Peel);
+            {
+                std::lock_guard<std::mutex> lock(m_Mutex);
+                addPeel(Peel);
+                numFinished = m_NumFinished;
+            }
+            if (OnPeelFinished) {
+                std::lock_guard<std::mutex> lock(m_CallbackMutex);
+                OnPeelFinished(Peel,numFinished);
+            }
+        }
+    };
+    nmfUtils::runWorkers(NumThreads,NumRuns,worker);
+
+    if (! m_IsFinished[0]) {
+        std::cout << "Error nmfRetrospective::run: Estimation of the full time series (peel 0) failed" << std::endl;
+        return false;
+    }
+
+    return true;
+}
+
+void
+nmfRetrospective::addPeel(const nmfRetrospectivePeel& Peel)
+{
+    ++m_NumFinished;
+    if (Peel.Estimated) {
+        m_Finished[Peel.Peel]   = Peel;
+        m_IsFinished[Peel.Peel] = 1;
+    }
+}
+
+bool
+nmfRetrospective::getParameterRho(const nmfParameterBlock& Block,
+                                  std::vector<double>& MohnsRho)
+{
+    int NumPeels = 0;
+    std::vector<double> EstParameter;
+    std::lock_guard<std::mutex> lock(m_Mutex);
+
+    MohnsRho.clear();
+    if (m_IsFinished.empty() || ! m_IsFinished[0]) {
+        return false;
+    }
+
+    // Laid out as calculateMohnsRhoForParameter expects: the finished peels from the
+    // largest down, then peel 0
+    for (int peel = m_NumPeels; peel >= 0; --peel) {
+        if (m_IsFinished[peel]) {
+            if (int(m_Finished[peel].Parameters.size()) < Block.Offset+Block.size()) {
+                return false;
+            }
+            EstParameter.insert(EstParameter.end(),
+                                m_Finished[peel].Parameters.begin()+Block.Offset,
+                                m_Finished[peel].Parameters.begin()+Block.Offset+Block.size());
+            NumPeels += (peel > 0) ? 1 : 0;
+        }
+    }
+
+    return nmfUtilsStatistics::calculateMohnsRhoForParameter(
+                NumPeels,Block.size(),m_PeelData[0].RunLength,EstParameter,MohnsRho);
+}
+
+bool
+nmfRetrospective::getBiomassRho(std::vector<double>& MohnsRho)
+{
+    int NumYears;
+    std::vector<std::vector<double> > TimeSeries;
+    std::lock_guard<std::mutex> lock(m_Mutex);
+
+    MohnsRho.clear();
+    if (m_IsFinished.empty() || ! m_IsFinished[0]) {
+        return false;
+    }
+
+    // Laid out as calculateMohnsRhoForTimeSeries expects: peel 0, then the finished peels,
+    // each one species or guild after another
+    for (int peel = 0; peel <= m_NumPeels; ++peel) {
+        if (m_IsFinished[peel]) {
+            const boost::numeric::ublas::matrix<double>& EstBiomass = m_Finished[peel].EstBiomass;
+            if (int(EstBiomass.size2()) < m_NumSpeciesOrGuilds) {
+                return false;
+            }
+            NumYears = EstBiomass.size1();
+            TimeSeries.push_back(std::vector<double>(m_NumSpeciesOrGuilds*NumYears));
+            for (int i = 0; i < m_NumSpeciesOrGuilds; ++i) {
+                for (int time = 0; time < NumYears; ++time) {
+                    TimeSeries.back()[i*NumYears+time] = EstBiomass(time,i);
+                }
+            }
+        }
+    }
+
+    return nmfUtilsStatistics::calculateMohnsRhoForTimeSeries(
+                int(TimeSeries.size())-1,m_NumSpeciesOrGuilds,TimeSeries,MohnsRho);
+}
@@ -0,0 +1,121 @@
+#pragma once
+
+#include <vector>
+#include <string>
+#include <iostream>
+#include <functional>
+#include <mutex>
+
+#include <boost/numeric/ublas/matrix.hpp>
+
+#include "nmfStructsQt.h"
+#include "nmfParameterView.h"
+
+/**
+ * @brief Estimation results of one retrospective peel
+ */
+struct nmfRetrospectivePeel {
+    int  Peel;                  // number of years removed from the end of the time series
+    bool Estimated;             // false if the estimation failed
+    std::vector<double> Parameters;                   // in nmfParameterOffsets order
+    boost::numeric::ublas::matrix<double> EstBiomass; // (year, species or guild) over the peel's years
+
+    nmfRetrospectivePeel() : Peel(0), Estimated(false) {}
+};
+
+/**
+ * @brief Runs a retrospective analysis: the model is re-estimated with 0, 1, ..., NumPeels
+ * years removed from the end of the time series and Mohn's rho is found from how far each
+ * peel's estimates are from those of the full (peel 0) run. The data of every peel are cut
+ * from the loaded model data in a single pass, the peels are estimated at the same time on
+ * separate threads, and Mohn's rho may be found over the peels finished so far at any
+ * time. Mohn's rho itself is calculated by nmfUtilsStatistics.
+ * The estimation itself is supplied by the caller and must be safe to run on several threads
+ * at once. nmfBeesEstimators::retrospective() gives the Bees Algorithm estimator.
+ */
+class nmfRetrospective {
+
+public:
+    /**
+     * @brief Estimates one peel. Called on the peel's thread with the peel's model data,
+     * it fills Parameters and EstBiomass of the passed peel and returns True on success.
+     */
+    typedef std::function<bool(const nmfStructsQt::ModelDataStruct& PeelData,
+                               nmfRetrospectivePeel& Peel)> Estimator;
+    /**
+     * @brief Called after each peel is finished, one call at a time, with the number of
+     * peels finished so far
+     */
+    typedef std::function<void(const nmfRetrospectivePeel& Peel,
+                               const int& NumFinished)> PeelFinished;
+
+private:
+    int m_NumPeels;
+    int m_NumSpeciesOrGuilds;
+    nmfParameterOffsets m_Offsets;
+    std::vector<nmfStructsQt::ModelDataStruct> m_PeelData; // by peel
+
+    // Estimates of the peels finished so far, guarded by m_Mutex
+    std::mutex m_Mutex;
+    std::mutex m_CallbackMutex;
+    int  m_NumFinished;
+    std::vector<nmfRetrospectivePeel> m_Finished; // by peel
+    std::vector<int> m_IsFinished;                // by peel, 1 if estimated
+
+    void addPeel(const nmfRetrospectivePeel& Peel);
+
+public:
+    /**
+     * @brief Cuts the data for every peel out of the loaded model data
+     * @param ModelData : model data with the observed biomass and the Catch, Effort, and
+     * Exploitation over the full time series (RunLength+1 years)
+     * @param NumPeels : number of years to peel off (peels 1..NumPeels are compared to peel 0)
+     */
+    nmfRetrospective(const nmfStructsQt::ModelDataStruct& ModelData,
+                     const int& NumPeels);
+   ~nmfRetrospective() {}
+
+    /**
+     * @brief Builds the model data of peels 0 through NumPeels in one pass over the years.
+     * Peel p has RunLength-p and the first RunLength+1-p rows of every time series.
+     * @param ModelData : model data over the full time series
+     * @param NumPeels : number of years to peel off
+     * @param PeelData : model data per peel
+     * @return False if there are too few years for the number of peels, else True
+     */
+    static bool buildPeelData(const nmfStructsQt::ModelDataStruct& ModelData,
+                              const int& NumPeels,
+                              std::vector<nmfStructsQt::ModelDataStruct>& PeelData);
+    /**
+     * @brief Estimates every peel, spread over threads, largest peel data first
+     * @param EstimatePeel : the estimation to run on each peel
+     * @param NumThreads : number of threads to use (0 uses one per core)
+     * @param OnPeelFinished : called as each peel finishes (may be empty)
+     * @param Peels : estimation results, by peel
+     * @return False if the data couldn't be peeled or peel 0 failed, else True
+     */
+    bool run(Estimator EstimatePeel,
+             const int& NumThreads,
+             PeelFinished OnPeelFinished,
+             std::vector<nmfRetrospectivePeel>& Peels);
+    /**
+     * @brief Mohn's rho of each parameter of a block over the peels finished so far, from
+     * nmfUtilsStatistics::calculateMohnsRhoForParameter
+     * @param Block : parameter block of interest (e.g., offsets().GrowthRate)
+     * @param MohnsRho : Mohn's rho per parameter of the block
+     * @return False if peel 0 isn't done, no other peel is, or a peel 0 estimate is 0, else True
+     */
+    bool getParameterRho(const nmfParameterBlock& Block,
+                         std::vector<double>& MohnsRho);
+    /**
+     * @brief Mohn's rho of the estimated biomass per species or guild over the peels finished
+     * so far, from nmfUtilsStatistics::calculateMohnsRhoForTimeSeries
+     * @param MohnsRho : Mohn's rho per species or guild
+     * @return False if peel 0 isn't done, no other peel is, or a peel 0 biomass is 0, else True
+     */
+    bool getBiomassRho(std::vector<double>& MohnsRho);
+
+    const nmfStructsQt::ModelDataStruct& peelData(const int& Peel) const { return m_PeelData[Peel]; }
+    const nmfParameterOffsets& offsets() const { return m_Offsets; }
+    int numPeels() const { return m_NumPeels; }
+};
@@ -0,0 +1,31 @@
+#
+# Checks of the MSSPM model classes. Run with "make check".
+#
+
+QT       = core sql
+
+CONFIG  += c++14 console testcase
+CONFIG  -= app_bundle
+
+TARGET   = tst_nmfModels
+TEMPLATE = app
+
+DEFINES += NMF_HEADLESS
+
+INCLUDEPATH += \
+    .. \
+    ../../nmfUtilities
+
+SOURCES += \
+    tst_nmfModels.cpp \
+    ../nmfCompetitionForm.cpp \
+    ../nmfForecastProjection.cpp \
+    ../nmfGrowthForm.cpp \
+    ../nmfHarvestForm.cpp \
+    ../nmfParameterView.cpp \
+    ../nmfPredationForm.cpp \
+    ../../nmfUtilities/nmfLogger.cpp \
+    ../../nmfUtilities/nmfUtils.cpp \
+    ../../nmfUtilities/nmfUtilsComplex.cpp \
+    ../../nmfUtilities/nmfUtilsQtCore.cpp \
+    ../../nmfUtilities/nmfUtilsStatistics.cpp
@@ -0,0 +1,123 @@
+/**
+ * @file tst_nmfModels.cpp
+ * @brief Checks of the MSSPM model projections
+ * @date Oct 19, 2026
+ *
+ * Returns 0 if every check passes, else the number of failed checks.
+ *
+ */
+
+#include <cmath>
+#include <iostream>
+#include <vector>
+
+#include "nmfForecastProjection.h"
+
+static int NumFailed = 0;
+
+static void
+check(const bool& ok, const std::string& what)
+{
+    std::cout << ((ok) ? "PASS   : " : "FAIL!  : ") << what << std::endl;
+    if (! ok) {
+        ++NumFailed;
+    }
+}
+
+static bool
+isClose(const double& a, const double& b)
+{
+    return (std::fabs(a-b) <= 1e-9*std::max(1.0,std::fabs(b)));
+}
+
+// Under AGG-PROD the columns are guilds, so the guild carrying capacities must be the
+// growth form's guild values even when there are more species than guilds
+static void
+testAggProdProjection()
+{
+    const int NumSpecies = 5;
+    const int NumGuilds  = 2;
+    const int NumYears   = 11;
+    const std::vector<double> InitBiomass = {400.0, 900.0};
+    const std::vector<double> r = {0.4, 0.25};
+    const std::vector<double> K = {2000.0, 5000.0};
+    const double Beta[NumGuilds][NumGuilds] = {{0.0, 0.02}, {0.01, 0.0}};
+    double systemK = K[0]+K[1];
+    double competition;
+    double expected[NumYears][NumGuilds];
+    bool ok = true;
+    bool guildsOk = true;
+    nmfStructsQt::ModelDataStruct ModelData;
+    std::vector<double> Parameters;
+    boost::numeric::ublas::matrix<double> catchData;
+    boost::numeric::ublas::matrix<double> effort;
+    boost::numeric::ublas::matrix<double> exploitation;
+    boost::numeric::ublas::matrix<double> estBiomassSpecies;
+    boost::numeric::ublas::matrix<double> estBiomassGuilds;
+
+    ModelData.GrowthForm      = "Logistic";
+    ModelData.HarvestForm     = "Null";
+    ModelData.CompetitionForm = "AGG-PROD";
+    ModelData.PredationForm   = "Null";
+    ModelData.NumSpecies      = NumSpecies;
+    ModelData.NumGuilds       = NumGuilds;
+    ModelData.RunLength       = NumYears-1;
+    ModelData.GuildSpecies[0] = {0, 2, 4};
+    ModelData.GuildSpecies[1] = {1, 3};
+    ModelData.GuildNum        = {0, 1, 0, 1, 0};
+
+    nmfForecastProjection Projection(ModelData,InitBiomass);
+    const nmfParameterOffsets& Offsets = Projection.offsets();
+    Parameters.assign(Offsets.getTotalNumberParameters(),1.0);
+    for (int i=0; i<NumGuilds; ++i) {
+        Parameters[Offsets.InitBiomass.Offset+i]      = InitBiomass[i];
+        Parameters[Offsets.GrowthRate.Offset+i]       = r[i];
+        Parameters[Offsets.CarryingCapacity.Offset+i] = K[i];
+        for (int j=0; j<NumGuilds; ++j) {
+            Parameters[Offsets.CompetitionBetaGuildsGuilds.Offset+i*NumGuilds+j] = Beta[i][j];
+        }
+    }
+    nmfUtils::initialize(catchData,   NumYears,NumGuilds);
+    nmfUtils::initialize(effort,      NumYears,NumGuilds);
+    nmfUtils::initialize(exploitation,NumYears,NumGuilds);
+
+    // B(t) = B + rB(1-B/K) - rB·Σβ(I,J)B(J)/(Kσ-K)
+    for (int i=0; i<NumGuilds; ++i) {
+        expected[0][i] = InitBiomass[i];
+    }
+    for (int time=1; time<NumYears; ++time) {
+        for (int i=0; i<NumGuilds; ++i) {
+            competition = 0;
+            for (int j=0; j<NumGuilds; ++j) {
+                competition += Beta[i][j]*expected[time-1][j];
+            }
+            expected[time][i] = expected[time-1][i] +
+                    r[i]*expected[time-1][i]*(1.0-expected[time-1][i]/K[i]) -
+                    r[i]*expected[time-1][i]*competition/(systemK-K[i]);
+        }
+    }
+
+    nmfForecastForms Forms(ModelData);
+    Projection.initializeBiomass(estBiomassSpecies,estBiomassGuilds);
+    check(Projection.isValid(Parameters) &&
+          Projection.project(Forms,Parameters,catchData,effort,exploitation,
+                             estBiomassSpecies,estBiomassGuilds),
+          "AGG-PROD projection with more species than guilds runs");
+    for (int time=0; time<NumYears; ++time) {
+        for (int i=0; i<NumGuilds; ++i) {
+            ok       = ok       && isClose(estBiomassSpecies(time,i),expected[time][i]);
+            guildsOk = guildsOk && isClose(estBiomassGuilds(time,i), expected[time][i]);
+        }
+    }
+    check(ok,       "AGG-PROD projection uses the guild carrying capacities");
+    check(guildsOk, "AGG-PROD guild biomass is the projected guild columns");
+}
+
+int main()
+{
+    testAggProdProjection();
+
+    std::cout << "Totals: " << NumFailed << " failed" << std::endl;
+
+    return NumFailed;
+}
@@ -10,9 +10,15 @@
 #pragma once
 
 #include <iostream>
+#include <map>
+#include <memory>
 #include <string>
 #include <vector>
 
+#include <QString>
+
+// Headless (NMF_HEADLESS) builds only have QtCore, so they don't get the dialogs
+#ifndef NMF_HEADLESS
 #include <QComboBox>
 #include <QDialog>
 #include <QFileInfo>
@@ -20,7 +26,7 @@
 #include <QLabel>
 #include <QLineEdit>
 #include <QPushButton>
-#include <QString>
+#endif
 
 #include "nmfLogger.h"
 
@@ -44,6 +50,7 @@ class nmfDatabase;
  */
 namespace nmfStructsQt {
 
+#ifndef NMF_HEADLESS
 /**
  * @brief This class displays a QDialog and allows the user to do a screen
  * grab of the displayed chart. The user may save the file to either a jpg
@@ -110,6 +117,7 @@ public:
     }
 
 };
+#endif
 
 
 /**
@@ -194,10 +202,11 @@ struct ModelReviewStruct {
 
 
 /**
- * @brief The data structure used for parameter estimation. It contains the parameter
- * min max limits as well as the input data.
+ * @brief The settings of a parameter estimation: the model forms, the estimation
+ * algorithm and its settings, and which parameters are estimated. They're small and are
+ * copied for every run.
  */
-struct ModelDataStruct {
+struct ModelRunSettings {
 
     bool   isMohnsRho;
     bool   showDiagnosticChart;
@@ -243,6 +252,17 @@ struct ModelDataStruct {
     std::string ObjectiveCriterion;
     std::string ScalingAlgorithm;
 
+    std::vector<double>         Parameters;
+    std::vector<EstimateRunBox> EstimateRunBoxes;
+};
+
+/**
+ * @brief The input data of a parameter estimation: the observed biomass, harvest data,
+ * guilds, and the parameter values and min max limits. These are by far the largest part
+ * of the model data and are the same for every run of a multi-run line, so concurrent runs
+ * share them through SharedModelData.
+ */
+struct ModelInputData {
     std::map<int,std::vector<int> >       GuildSpecies; // List of species numbers that make up guild num
     std::vector<int>                      GuildNum;     // Specifies which species are members of which guilds
     boost::numeric::ublas::matrix<double> ObservedBiomassBySpecies;
@@ -281,10 +301,78 @@ struct ModelDataStruct {
     std::vector<std::vector<double> >     PredationHandlingMax;
     std::vector<double>                   PredationExponentMin;
     std::vector<double>                   PredationExponentMax;
-    std::vector<double>                   Parameters;
 //  boost::numeric::ublas::matrix<double> OutputBiomass;
+};
 
-    std::vector<EstimateRunBox> EstimateRunBoxes;
+/**
+ * @brief The data structure used for parameter estimation. It contains the parameter
+ * min max limits as well as the input data.
+ */
+struct ModelDataStruct : public ModelRunSettings, public ModelInputData {
+    ModelDataStruct() = default;
+    ModelDataStruct(const ModelRunSettings& Settings,
+                    const ModelInputData&   Inputs)
+        : ModelRunSettings(Settings), ModelInputData(Inputs) {}
+};
+
+/**
+ * @brief Model data of one run that shares its input data with every other copy. Copying
+ * only copies the settings and a reference to the inputs, so any number of runs can
+ * hold the same model without duplicating it. A run that needs to change its inputs calls
+ * editInputs(), which gives it a private copy first if the inputs are shared (copy on write).
+ *
+ * The shared inputs are never modified, so they can be read from several threads at once.
+ * An object itself must not be edited by one thread while another thread copies it.
+ */
+class SharedModelData {
+
+private:
+    std::shared_ptr<ModelInputData> m_Inputs;
+
+public:
+    ModelRunSettings Settings;
+
+    SharedModelData()
+        : m_Inputs(std::make_shared<ModelInputData>()), Settings() {}
+    /**
+     * @brief Copies the model data's inputs once into a new shared block
+     * @param ModelData : the full model data
+     */
+    SharedModelData(const ModelDataStruct& ModelData)
+        : m_Inputs(std::make_shared<ModelInputData>(ModelData)), Settings(ModelData) {}
+
+    /**
+     * @brief The (possibly shared) input data, to be read only
+     * @return Reference to the input data
+     */
+    const ModelInputData& inputs() const {
+        return *m_Inputs;
+    }
+    /**
+     * @brief The input data for changing, copied first if any other object shares them
+     * @return Reference to this object's own input data
+     */
+    ModelInputData& editInputs() {
+        if (m_Inputs.use_count() > 1) {
+            m_Inputs = std::make_shared<ModelInputData>(*m_Inputs);
+        }
+        return *m_Inputs;
+    }
+    /**
+     * @brief Checks if two objects share the same input data
+     * @param Other : the other object
+     * @return True if neither has copied the inputs since they were shared, else False
+     */
+    bool sharesInputsWith(const SharedModelData& Other) const {
+        return (m_Inputs == Other.m_Inputs);
+    }
+    /**
+     * @brief Makes a full model data structure, for the functions that take one
+     * @return A copy of the settings and the input data
+     */
+    ModelDataStruct toModelData() const {
+        return ModelDataStruct(Settings,*m_Inputs);
+    }
 };
 
 
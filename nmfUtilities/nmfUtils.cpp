@@ -8,6 +8,7 @@
  * file as well.
  */
 
+#include <atomic>
 #include <ctime>
 #include <fstream>
 #include "nmfUtils.h"
@@ -296,6 +297,29 @@ double round(double number, int decimalPlaces)
     return  std::floor(number*factor+0.5)/factor;
 }
 
+void runWorkers(const int& NumThreads,
+                const int& NumTasks,
+                const std::function<void(const NextTask& nextTask)>& Worker)
+{
+    int numThreads = (NumThreads > 0) ? NumThreads : int(std::thread::hardware_concurrency());
+    std::atomic<int> NextTaskNum(0);
+    std::vector<std::thread> Threads;
+
+    NextTask nextTask = [&](int& taskNum) {
+        taskNum = NextTaskNum++;
+        return (taskNum < NumTasks);
+    };
+
+    numThreads = std::max(1,std::min(numThreads,NumTasks));
+    for (int i = 1; i < numThreads; ++i) {
+        Threads.push_back(std::thread(std::cref(Worker),std::cref(nextTask)));
+    }
+    Worker(nextTask);
+    for (std::thread& thread : Threads) {
+        thread.join();
+    }
+}
+
 void split(std::string main, std::string delim, std::string &str1, std::string &str2)
 {
     if (main.empty()) {
@@ -506,7 +530,7 @@ void reset(boost::numeric::ublas::matrix<double>& mat,
 }
 
 bool isEstimateParameterChecked(
-        const nmfStructsQt::ModelDataStruct& dataStruct,
+        const nmfStructsQt::ModelRunSettings& dataStruct,
         const std::string& ParameterName)
 {
     bool isChecked = false;
@@ -10,20 +10,28 @@
 
 #pragma once
 
+#include <algorithm>
+#include <array>
 #include <ctime>
 #include <cmath>
 #include <iomanip>
 #include <iostream>
 #include <fstream>
+#include <functional>
 #include <map>
 #include <random>
 #include <string>
+#include <thread>
 #include <utility>
 #include <vector>
 
 #include <QDir>
 
+#ifdef NMF_HEADLESS
+#include "nmfUtilsQtCore.h"
+#else
 #include "nmfUtilsQt.h"
+#endif
 #include "nmfStructsQt.h"
 #include "nmfConstantsMSVPA.h"
 #include "nmfLogger.h"
@@ -415,6 +423,500 @@ namespace nmfUtils {
     bool invertMatrix(
             boost::numeric::ublas::matrix<double>& matrix,
             boost::numeric::ublas::matrix<double>& inverseMatrix);
+    /**
+     * @brief LU factorizes a small fixed size matrix in place using partial pivoting. The size
+     * is a compile time constant so the loops may be fully unrolled and no heap memory is used.
+     * @param matrix : matrix to factorize, replaced with its L (unit diagonal) and U factors
+     * @param pivots : row permutation found during factorization
+     * @return True if the matrix was factorized, False if it's singular
+     */
+    template<std::size_t N>
+    bool luFactorizeFixed(std::array<std::array<double,N>,N>& matrix,
+                          std::array<std::size_t,N>& pivots)
+    {
+        for (std::size_t col=0; col<N; ++col) {
+            std::size_t pivotRow = col;
+            for (std::size_t row=col+1; row<N; ++row) {
+                if (std::fabs(matrix[row][col]) > std::fabs(matrix[pivotRow][col])) {
+                    pivotRow = row;
+                }
+            }
+            pivots[col] = pivotRow;
+            if (matrix[pivotRow][col] == 0.0) {
+                return false;
+            }
+            if (pivotRow != col) {
+                std::swap(matrix[pivotRow],matrix[col]);
+            }
+            double invPivot = 1.0/matrix[col][col];
+            for (std::size_t row=col+1; row<N; ++row) {
+                double factor = matrix[row][col] * invPivot;
+                matrix[row][col] = factor;
+                for (std::size_t j=col+1; j<N; ++j) {
+                    matrix[row][j] -= factor * matrix[col][j];
+                }
+            }
+        }
+        return true;
+    }
+    /**
+     * @brief Solves the system using a matrix that was factorized by luFactorizeFixed
+     * @param lu : the LU factors
+     * @param pivots : row permutation found during factorization
+     * @param rhs : right hand side, replaced with the solution
+     */
+    template<std::size_t N>
+    void luSubstituteFixed(const std::array<std::array<double,N>,N>& lu,
+                           const std::array<std::size_t,N>& pivots,
+                           std::array<double,N>& rhs)
+    {
+        for (std::size_t i=0; i<N; ++i) {
+            std::swap(rhs[i],rhs[pivots[i]]);
+        }
+        for (std::size_t i=1; i<N; ++i) {
+            for (std::size_t j=0; j<i; ++j) {
+                rhs[i] -= lu[i][j] * rhs[j];
+            }
+        }
+        for (std::size_t k=N; k-- > 0; ) {
+            for (std::size_t j=k+1; j<N; ++j) {
+                rhs[k] -= lu[k][j] * rhs[j];
+            }
+            rhs[k] /= lu[k][k];
+        }
+    }
+    /**
+     * @brief Finds the inverse of a small fixed size matrix without using the heap. Unlike
+     * invertMatrix, the passed matrix isn't modified.
+     * @param matrix : matrix whose inverse is desired
+     * @param inverseMatrix : the inverse of the passed in matrix
+     * @return True if inverse was found, else False
+     */
+    template<std::size_t N>
+    bool invertMatrixFixed(const std::array<std::array<double,N>,N>& matrix,
+                           std::array<std::array<double,N>,N>& inverseMatrix)
+    {
+        std::array<std::array<double,N>,N> lu = matrix;
+        std::array<std::size_t,N> pivots;
+        std::array<double,N> column;
+
+        if (! luFactorizeFixed(lu,pivots)) {
+            return false;
+        }
+        for (std::size_t j=0; j<N; ++j) {
+            column.fill(0.0);
+            column[j] = 1.0;
+            luSubstituteFixed(lu,pivots,column);
+            for (std::size_t i=0; i<N; ++i) {
+                inverseMatrix[i][j] = column[i];
+            }
+        }
+        return true;
+    }
+    /**
+     * @brief Solves matrix * solution = rhs for a small fixed size general matrix using LU with partial pivoting
+     * @param matrix : system matrix
+     * @param rhs : right hand side
+     * @param solution : the solution vector
+     * @return True if a solution was found, False if the matrix is singular
+     */
+    template<std::size_t N>
+    bool solveLUFixed(const std::array<std::array<double,N>,N>& matrix,
+                      const std::array<double,N>& rhs,
+                      std::array<double,N>& solution)
+    {
+        std::array<std::array<double,N>,N> lu = matrix;
+        std::array<std::size_t,N> pivots;
+
+        if (! luFactorizeFixed(lu,pivots)) {
+            return false;
+        }
+        solution = rhs;
+        luSubstituteFixed(lu,pivots,solution);
+        return true;
+    }
+    /**
+     * @brief Solves matrix * solution = rhs for a small fixed size symmetric positive definite
+     * matrix (i.e., the normal equations of a least squares fit) using a Cholesky factorization.
+     * Only the lower triangle of the matrix is used.
+     * @param matrix : symmetric positive definite system matrix
+     * @param rhs : right hand side
+     * @param solution : the solution vector
+     * @return True if a solution was found, False if the matrix isn't positive definite
+     */
+    template<std::size_t N>
+    bool solveCholeskyFixed(const std::array<std::array<double,N>,N>& matrix,
+                            const std::array<double,N>& rhs,
+                            std::array<double,N>& solution)
+    {
+        std::array<std::array<double,N>,N> L;
+
+        for (std::size_t i=0; i<N; ++i) {
+            for (std::size_t j=0; j<=i; ++j) {
+                double sum = matrix[i][j];
+                for (std::size_t k=0; k<j; ++k) {
+                    sum -= L[i][k] * L[j][k];
+                }
+                if (i == j) {
+                    if (sum <= 0.0) {
+                        return false;
+                    }
+                    L[i][i] = std::sqrt(sum);
+                } else {
+                    L[i][j] = sum / L[j][j];
+                }
+            }
+        }
+        // Forward substitution with L then back substitution with L transpose
+        for (std::size_t i=0; i<N; ++i) {
+            double sum = rhs[i];
+            for (std::size_t k=0; k<i; ++k) {
+                sum -= L[i][k] * solution[k];
+            }
+            solution[i] = sum / L[i][i];
+        }
+        for (std::size_t i=N; i-- > 0; ) {
+            double sum = solution[i];
+            for (std::size_t k=i+1; k<N; ++k) {
+                sum -= L[k][i] * solution[k];
+            }
+            solution[i] = sum / L[i][i];
+        }
+        return true;
+    }
+    /**
+     * @brief Number of systems the batched solvers work on together. The systems' elements are
+     * interleaved (element [i][j] of every system is contiguous) so the innermost loops run
+     * across the systems with unit stride and can be vectorized by the compiler.
+     */
+    const std::size_t BatchLanes = 8;
+    /**
+     * @brief LU factorizes BatchLanes interleaved fixed size matrices in place using partial
+     * pivoting. Each system gets the same operations in the same order as luFactorizeFixed.
+     * @param matrix : interleaved matrices to factorize, replaced with their LU factors
+     * @param pivots : each system's row permutation
+     * @param isValid : per system flag, set to 0 if the system is singular
+     */
+    template<std::size_t N>
+    void luFactorizeLanes(double (&matrix)[N][N][BatchLanes],
+                          std::size_t (&pivots)[N][BatchLanes],
+                          char (&isValid)[BatchLanes])
+    {
+        double invPivot[BatchLanes];
+
+        for (std::size_t col=0; col<N; ++col) {
+            // The pivot row differs per system, so the pivot search and row swap are per system
+            for (std::size_t lane=0; lane<BatchLanes; ++lane) {
+                std::size_t pivotRow = col;
+                for (std::size_t row=col+1; row<N; ++row) {
+                    if (std::fabs(matrix[row][col][lane]) > std::fabs(matrix[pivotRow][col][lane])) {
+                        pivotRow = row;
+                    }
+                }
+                pivots[col][lane] = pivotRow;
+                if (matrix[pivotRow][col][lane] == 0.0) {
+                    // Singular, so keep going on a harmless pivot and discard the result
+                    isValid[lane] = 0;
+                    matrix[pivotRow][col][lane] = 1.0;
+                }
+                if (pivotRow != col) {
+                    for (std::size_t j=0; j<N; ++j) {
+                        std::swap(matrix[pivotRow][j][lane],matrix[col][j][lane]);
+                    }
+                }
+            }
+            for (std::size_t lane=0; lane<BatchLanes; ++lane) {
+                invPivot[lane] = 1.0/matrix[col][col][lane];
+            }
+            for (std::size_t row=col+1; row<N; ++row) {
+                for (std::size_t lane=0; lane<BatchLanes; ++lane) {
+                    matrix[row][col][lane] *= invPivot[lane];
+                }
+                for (std::size_t j=col+1; j<N; ++j) {
+                    for (std::size_t lane=0; lane<BatchLanes; ++lane) {
+                        matrix[row][j][lane] -= matrix[row][col][lane] * matrix[col][j][lane];
+                    }
+                }
+            }
+        }
+    }
+    /**
+     * @brief Solves BatchLanes interleaved systems factorized by luFactorizeLanes
+     * @param lu : the interleaved LU factors
+     * @param pivots : each system's row permutation
+     * @param rhs : interleaved right hand sides, replaced with the solutions
+     */
+    template<std::size_t N>
+    void luSubstituteLanes(const double (&lu)[N][N][BatchLanes],
+                           const std::size_t (&pivots)[N][BatchLanes],
+                           double (&rhs)[N][BatchLanes])
+    {
+        for (std::size_t i=0; i<N; ++i) {
+            for (std::size_t lane=0; lane<BatchLanes; ++lane) {
+                std::swap(rhs[i][lane],rhs[pivots[i][lane]][lane]);
+            }
+        }
+        for (std::size_t i=1; i<N; ++i) {
+            for (std::size_t j=0; j<i; ++j) {
+                for (std::size_t lane=0; lane<BatchLanes; ++lane) {
+                    rhs[i][lane] -= lu[i][j][lane] * rhs[j][lane];
+                }
+            }
+        }
+        for (std::size_t k=N; k-- > 0; ) {
+            for (std::size_t j=k+1; j<N; ++j) {
+                for (std::size_t lane=0; lane<BatchLanes; ++lane) {
+                    rhs[k][lane] -= lu[k][j][lane] * rhs[j][lane];
+                }
+            }
+            for (std::size_t lane=0; lane<BatchLanes; ++lane) {
+                rhs[k][lane] /= lu[k][k][lane];
+            }
+        }
+    }
+    /**
+     * @brief Solves BatchLanes interleaved symmetric positive definite systems using Cholesky.
+     * Each system gets the same operations in the same order as solveCholeskyFixed.
+     * @param matrix : interleaved system matrices (only the lower triangles are used)
+     * @param rhs : interleaved right hand sides
+     * @param solution : interleaved solution vectors
+     * @param isValid : per system flag, set to 0 if the system isn't positive definite
+     */
+    template<std::size_t N>
+    void solveCholeskyLanes(const double (&matrix)[N][N][BatchLanes],
+                            const double (&rhs)[N][BatchLanes],
+                            double (&solution)[N][BatchLanes],
+                            char (&isValid)[BatchLanes])
+    {
+        double L[N][N][BatchLanes];
+        double sum[BatchLanes];
+
+        for (std::size_t i=0; i<N; ++i) {
+            for (std::size_t j=0; j<=i; ++j) {
+                for (std::size_t lane=0; lane<BatchLanes; ++lane) {
+                    sum[lane] = matrix[i][j][lane];
+                }
+                for (std::size_t k=0; k<j; ++k) {
+                    for (std::size_t lane=0; lane<BatchLanes; ++lane) {
+                        sum[lane] -= L[i][k][lane] * L[j][k][lane];
+                    }
+                }
+                if (i == j) {
+                    for (std::size_t lane=0; lane<BatchLanes; ++lane) {
+                        isValid[lane] &= (sum[lane] > 0.0);
+                        L[i][i][lane] = std::sqrt((sum[lane] > 0.0) ? sum[lane] : 1.0);
+                    }
+                } else {
+                    for (std::size_t lane=0; lane<BatchLanes; ++lane) {
+                        L[i][j][lane] = sum[lane] / L[j][j][lane];
+                    }
+                }
+            }
+        }
+        // Forward substitution with L then back substitution with L transpose
+        for (std::size_t i=0; i<N; ++i) {
+            for (std::size_t lane=0; lane<BatchLanes; ++lane) {
+                sum[lane] = rhs[i][lane];
+            }
+            for (std::size_t k=0; k<i; ++k) {
+                for (std::size_t lane=0; lane<BatchLanes; ++lane) {
+                    sum[lane] -= L[i][k][lane] * solution[k][lane];
+                }
+            }
+            for (std::size_t lane=0; lane<BatchLanes; ++lane) {
+                solution[i][lane] = sum[lane] / L[i][i][lane];
+            }
+        }
+        for (std::size_t i=N; i-- > 0; ) {
+            for (std::size_t lane=0; lane<BatchLanes; ++lane) {
+                sum[lane] = solution[i][lane];
+            }
+            for (std::size_t k=i+1; k<N; ++k) {
+                for (std::size_t lane=0; lane<BatchLanes; ++lane) {
+                    sum[lane] -= L[k][i][lane] * solution[k][lane];
+                }
+            }
+            for (std::size_t lane=0; lane<BatchLanes; ++lane) {
+                solution[i][lane] = sum[lane] / L[i][i][lane];
+            }
+        }
+    }
+    /**
+     * @brief Copies up to BatchLanes matrices, starting at the first one, into interleaved
+     * storage. Missing systems at the end of the batch are padded with the identity.
+     * @param matrices : the batch's matrices
+     * @param first : index of the first matrix to copy
+     * @param interleaved : the interleaved matrices
+     * @return Number of systems copied
+     */
+    template<std::size_t N>
+    std::size_t interleaveMatrices(const std::vector<std::array<std::array<double,N>,N> >& matrices,
+                                   const std::size_t& first,
+                                   double (&interleaved)[N][N][BatchLanes])
+    {
+        std::size_t numLanes = std::min(BatchLanes,matrices.size()-first);
+
+        for (std::size_t i=0; i<N; ++i) {
+            for (std::size_t j=0; j<N; ++j) {
+                for (std::size_t lane=0; lane<BatchLanes; ++lane) {
+                    interleaved[i][j][lane] = (lane < numLanes) ? matrices[first+lane][i][j] :
+                                                                  ((i == j) ? 1.0 : 0.0);
+                }
+            }
+        }
+        return numLanes;
+    }
+    /**
+     * @brief Finds the inverses of many small fixed size matrices (i.e., one per species for
+     * every bootstrap or ensemble member). The matrices are factorized BatchLanes at a time
+     * with their elements interleaved, so the arithmetic is vectorized across the matrices.
+     * The results are identical to those of invertMatrixFixed.
+     * @param matrices : matrices whose inverses are desired
+     * @param inverseMatrices : the inverses of the passed in matrices (a singular matrix's inverse is left as all zeros)
+     * @param isValid : per matrix flag, 1 if its inverse was found, else 0
+     * @return Number of matrices whose inverse could not be found
+     */
+    template<std::size_t N>
+    int invertMatrixBatch(const std::vector<std::array<std::array<double,N>,N> >& matrices,
+                          std::vector<std::array<std::array<double,N>,N> >& inverseMatrices,
+                          std::vector<char>& isValid)
+    {
+        int numFailed = 0;
+        std::size_t numLanes;
+        std::size_t numMatrices = matrices.size();
+        double lu[N][N][BatchLanes];
+        double column[N][BatchLanes];
+        std::size_t pivots[N][BatchLanes];
+        char laneIsValid[BatchLanes];
+
+        inverseMatrices.resize(numMatrices);
+        isValid.resize(numMatrices);
+        for (std::size_t first=0; first<numMatrices; first+=BatchLanes) {
+            numLanes = interleaveMatrices(matrices,first,lu);
+            std::fill(laneIsValid,laneIsValid+BatchLanes,1);
+            luFactorizeLanes(lu,pivots,laneIsValid);
+            for (std::size_t j=0; j<N; ++j) {
+                for (std::size_t i=0; i<N; ++i) {
+                    for (std::size_t lane=0; lane<BatchLanes; ++lane) {
+                        column[i][lane] = (i == j) ? 1.0 : 0.0;
+                    }
+                }
+                luSubstituteLanes(lu,pivots,column);
+                for (std::size_t lane=0; lane<numLanes; ++lane) {
+                    for (std::size_t i=0; i<N; ++i) {
+                        inverseMatrices[first+lane][i][j] = (laneIsValid[lane]) ? column[i][lane] : 0.0;
+                    }
+                }
+            }
+            for (std::size_t lane=0; lane<numLanes; ++lane) {
+                isValid[first+lane] = laneIsValid[lane];
+                numFailed += (laneIsValid[lane]) ? 0 : 1;
+            }
+        }
+        return numFailed;
+    }
+    /**
+     * @brief Solves many small fixed size systems. Uses Cholesky if the matrices are known to be
+     * symmetric positive definite, else LU with partial pivoting. The systems are solved
+     * BatchLanes at a time with their elements interleaved, so the arithmetic is vectorized
+     * across the systems. The results are identical to those of solveCholeskyFixed and solveLUFixed.
+     * @param matrices : system matrices
+     * @param rhs : right hand sides, one per matrix
+     * @param solutions : the solution vectors (a failed system's solution is left as all zeros)
+     * @param isValid : per system flag, 1 if it was solved, else 0
+     * @param isSymmetricPositiveDefinite : if true, solve using Cholesky
+     * @return Number of systems that could not be solved
+     */
+    template<std::size_t N>
+    int solveBatch(const std::vector<std::array<std::array<double,N>,N> >& matrices,
+                   const std::vector<std::array<double,N> >& rhs,
+                   std::vector<std::array<double,N> >& solutions,
+                   std::vector<char>& isValid,
+                   const bool& isSymmetricPositiveDefinite=false)
+    {
+        int numFailed = 0;
+        std::size_t numLanes;
+        std::size_t numSystems = std::min(matrices.size(),rhs.size());
+        double lanesMatrix[N][N][BatchLanes];
+        double lanesRhs[N][BatchLanes];
+        double lanesSolution[N][BatchLanes];
+        std::size_t pivots[N][BatchLanes];
+        char laneIsValid[BatchLanes];
+
+        if (matrices.size() != rhs.size()) {
+            std::cout << "Error nmfUtils::solveBatch: number of matrices (" << matrices.size()
+                      << ") doesn't match number of right hand sides (" << rhs.size() << ")" << std::endl;
+        }
+        solutions.resize(numSystems);
+        isValid.resize(numSystems);
+        for (std::size_t first=0; first<numSystems; first+=BatchLanes) {
+            numLanes = std::min(BatchLanes,numSystems-first);
+            interleaveMatrices(matrices,first,lanesMatrix);
+            for (std::size_t i=0; i<N; ++i) {
+                for (std::size_t lane=0; lane<BatchLanes; ++lane) {
+                    lanesRhs[i][lane] = (lane < numLanes) ? rhs[first+lane][i] : 0.0;
+                }
+            }
+            std::fill(laneIsValid,laneIsValid+BatchLanes,1);
+            if (isSymmetricPositiveDefinite) {
+                solveCholeskyLanes(lanesMatrix,lanesRhs,lanesSolution,laneIsValid);
+            } else {
+                luFactorizeLanes(lanesMatrix,pivots,laneIsValid);
+                luSubstituteLanes(lanesMatrix,pivots,lanesRhs);
+                std::copy(&lanesRhs[0][0],&lanesRhs[0][0]+N*BatchLanes,&lanesSolution[0][0]);
+            }
+            for (std::size_t lane=0; lane<numLanes; ++lane) {
+                for (std::size_t i=0; i<N; ++i) {
+                    solutions[first+lane][i] = (laneIsValid[lane]) ? lanesSolution[i][lane] : 0.0;
+                }
+                isValid[first+lane] = laneIsValid[lane];
+                numFailed += (laneIsValid[lane]) ? 0 : 1;
+            }
+        }
+        return numFailed;
+    }
+    /**
+     * @brief Cache blocked matrix product C += A*B over contiguous row major buffers.
+     * The loops are tiled so that a BlockSize x BlockSize tile of A and the matching rows
+     * of B stay in cache, and the innermost loop runs with unit stride over B and C. Each
+     * element of C is accumulated in increasing k order, so the result is the same as
+     * that of the plain triple loop.
+     * @param A : M x K matrix
+     * @param B : K x N matrix
+     * @param C : M x N matrix that the product is added to
+     * @param M : number of rows of A and C
+     * @param N : number of columns of B and C
+     * @param K : number of columns of A and rows of B
+     */
+    template<std::size_t BlockSize=64>
+    void multiplyBlocked(const double* A,
+                         const double* B,
+                         double* C,
+                         const std::size_t& M,
+                         const std::size_t& N,
+                         const std::size_t& K)
+    {
+        for (std::size_t ii=0; ii<M; ii+=BlockSize) {
+            std::size_t iEnd = std::min(ii+BlockSize,M);
+            for (std::size_t kk=0; kk<K; kk+=BlockSize) {
+                std::size_t kEnd = std::min(kk+BlockSize,K);
+                for (std::size_t jj=0; jj<N; jj+=BlockSize) {
+                    std::size_t jEnd = std::min(jj+BlockSize,N);
+                    for (std::size_t i=ii; i<iEnd; ++i) {
+                        const double* rowA = A + i*K;
+                        double*       rowC = C + i*N;
+                        for (std::size_t k=kk; k<kEnd; ++k) {
+                            const double  a    = rowA[k];
+                            const double* rowB = B + k*N;
+                            for (std::size_t j=jj; j<jEnd; ++j) {
+                                rowC[j] += a * rowB[j];
+                            }
+                        }
+                    }
+                }
+            }
+        }
+    }
     /**
      * @brief Checks a list from within the passes Data_Struct to see if a specific parameter has has its checkbox checked on the Estimation Tab6 page
      * @param dataStruct : data structure to check a list for the passed parameter name
@@ -422,7 +924,7 @@ namespace nmfUtils {
      * @return True if parameter should be estimated, false otherwise
      */
     bool isEstimateParameterChecked(
-            const nmfStructsQt::ModelDataStruct& dataStruct,
+            const nmfStructsQt::ModelRunSettings& dataStruct,
             const std::string& ParameterName);
     /**
      * @brief Tests the passed value if there's no decimal part and returns true, else returns false
@@ -441,6 +943,75 @@ namespace nmfUtils {
      * @return True or False signifying current operating system is Windows
      */
     bool isOSWindows();
+    /**
+     * @brief Finds the indices of the k smallest values without fully sorting the values.
+     * Uses nth_element followed by a sort of only the k selected, so is O(n + k log k).
+     * Ties are broken by index so the result is deterministic.
+     * @param values : values to select from
+     * @param k : number of indices to return (clamped to the number of values)
+     * @param indices : indices of the k smallest values, in ascending order of value
+     * @param compare : comparison function (defaults to less than)
+     */
+    template<typename T, typename Compare=std::less<T> >
+    void partialSortIndices(const std::vector<T>& values,
+                            int k,
+                            std::vector<int>& indices,
+                            Compare compare=Compare())
+    {
+        int numValues = values.size();
+        auto isBefore = [&values,&compare](const int& lhs, const int& rhs) {
+            if (compare(values[lhs],values[rhs])) {
+                return true;
+            } else if (compare(values[rhs],values[lhs])) {
+                return false;
+            }
+            return (lhs < rhs);
+        };
+
+        k = (k < 0) ? 0 : ((k > numValues) ? numValues : k);
+        indices.resize(numValues);
+        for (int i=0; i<numValues; ++i) {
+            indices[i] = i;
+        }
+        if ((k > 0) && (k < numValues)) {
+            std::nth_element(indices.begin(),indices.begin()+(k-1),indices.end(),isBefore);
+        }
+        std::sort(indices.begin(),indices.begin()+k,isBefore);
+        indices.resize(k);
+    }
+    /**
+     * @brief Reorders the passed items so that the first k are the k smallest items, in
+     * ascending order, without fully sorting the items. The remaining items follow in their
+     * original order. Ties are broken by original position so the result is deterministic.
+     * Works for move only types (i.e., std::unique_ptr).
+     * @param items : items to reorder
+     * @param k : number of smallest items to place at the front
+     * @param compare : comparison function
+     */
+    template<typename T, typename Compare>
+    void partialSortStable(std::vector<T>& items,
+                           int k,
+                           Compare compare)
+    {
+        int numItems = items.size();
+        std::vector<int>  topIndices;
+        std::vector<bool> isSelected(numItems,false);
+        std::vector<T>    reordered;
+
+        partialSortIndices(items,k,topIndices,compare);
+
+        reordered.reserve(numItems);
+        for (int index : topIndices) {
+            reordered.emplace_back(std::move(items[index]));
+            isSelected[index] = true;
+        }
+        for (int i=0; i<numItems; ++i) {
+            if (! isSelected[i]) {
+                reordered.emplace_back(std::move(items[i]));
+            }
+        }
+        items.swap(reordered);
+    }
     /**
      * @brief prints out a 3d double array
      * @param name : name of array
@@ -571,6 +1142,23 @@ namespace nmfUtils {
      */
     double round(double number,
                  int decimalPlaces);
+    /**
+     * @brief Hands the next task number to a worker of runWorkers. Returns False once
+     * every task has been handed out.
+     */
+    typedef std::function<bool(int& taskNum)> NextTask;
+    /**
+     * @brief Runs tasks 0..NumTasks-1 on a pool of worker threads and waits for them
+     * all. The calling thread is one of the workers. Each worker calls Worker once, which
+     * sets up its own state and then pulls task numbers with nextTask until it returns False.
+     * @param NumThreads : number of threads to use (if <= 0, one per hardware thread); no
+     * more threads than tasks are used
+     * @param NumTasks : number of tasks
+     * @param Worker : the worker's loop, called once on each thread
+     */
+    void runWorkers(const int& NumThreads,
+                    const int& NumTasks,
+                    const std::function<void(const NextTask& nextTask)>& Worker);
     /**
      * @brief splits a string by a specific delimeter
      * @param main : the string to split
@@ -39,6 +39,115 @@ void Complex(int NDim,
 } // end Complex
 
 
+void ComplexMultiStart(int NDim,
+                       int &NYears,
+                       boost::numeric::ublas::vector<double> &G,
+                       boost::numeric::ublas::vector<double> &H,
+                       boost::numeric::ublas::matrix<double> &SRData,
+                       const int &NumStarts,
+                       const int &Seed,
+                       const int &NumThreads,
+                       ComplexMultiStartOut &Out)
+{
+    const double DedupTol = 0.001; // fraction of each constraint range within which vertices are the same
+    unsigned BaseSeed = (Seed < 0) ? unsigned(nmfUtilsQt::getCurrentTime().currentMSecsSinceEpoch()) : unsigned(Seed);
+    boost::numeric::ublas::matrix<double> StartVarEst;
+    std::vector<int> DistinctStarts;
+    bool isSame;
+
+    nmfUtils::initialize(StartVarEst,std::max(NumStarts,1),NDim+1);
+
+    Out.MaxF              = 0.0;
+    Out.ItFlag            = 1;
+    Out.BestStart         = -1;
+    Out.NumStarts         = NumStarts;
+    Out.NumConverged      = 0;
+    Out.NumDistinctOptima = 0;
+    Out.NumAtBest         = 0;
+    Out.StartMaxF.assign(std::max(NumStarts,0),0.0);
+    Out.StartItFlag.assign(std::max(NumStarts,0),1);
+    nmfUtils::initialize(Out.VarEst,NDim+1);
+    if (NumStarts <= 0) {
+        std::cout << "Error nmfUtilsComplex::ComplexMultiStart: NumStarts must be > 0" << std::endl;
+        return;
+    }
+
+    // Each worker pulls the next start and reuses its own workspace
+    nmfUtils::runWorkers(NumThreads,NumStarts,[&](const nmfUtils::NextTask& nextStart) {
+        ComplexWorkspace Workspace;
+        boost::numeric::ublas::vector<double> VarEst;
+        std::uniform_real_distribution<double> dist(0.0,1.0);
+        double MaxF;
+        int ItFlag;
+        int start;
+
+        Workspace.resize(NDim);
+        nmfUtils::initialize(VarEst,NDim+1);
+        while (nextStart(start)) {
+            std::mt19937_64 rng(BaseSeed + unsigned(start));
+            for (int i = 1; i <= Workspace.K; ++i) {
+                for (int j = 1; j <= NDim; ++j) {
+                    Workspace.R(i,j) = dist(rng);
+                }
+            }
+            Cons(Workspace, NYears, SRData, G, H, MaxF, VarEst, ItFlag);
+            Out.StartMaxF[start]   = MaxF;
+            Out.StartItFlag[start] = ItFlag;
+            for (int j = 1; j <= NDim; ++j) {
+                StartVarEst(start,j) = VarEst(j);
+            }
+        }
+    });
+
+    // Pick the best start (lowest start index wins ties so the result is deterministic)
+    Out.BestStart = 0;
+    for (int start = 0; start < NumStarts; ++start) {
+        if (Out.StartMaxF[start] > Out.StartMaxF[Out.BestStart]) {
+            Out.BestStart = start;
+        }
+        Out.NumConverged += (Out.StartItFlag[start] == 0) ? 1 : 0;
+    }
+    Out.MaxF   = Out.StartMaxF[Out.BestStart];
+    Out.ItFlag = Out.StartItFlag[Out.BestStart];
+    for (int j = 1; j <= NDim; ++j) {
+        Out.VarEst(j) = StartVarEst(Out.BestStart,j);
+    }
+
+    // Deduplicate the converged vertices
+    for (int start = 0; start < NumStarts; ++start) {
+        if (Out.StartItFlag[start] != 0) {
+            continue;
+        }
+        isSame = false;
+        for (int distinct : DistinctStarts) {
+            isSame = true;
+            for (int j = 1; j <= NDim; ++j) {
+                if (std::fabs(StartVarEst(start,j)-StartVarEst(distinct,j)) > DedupTol*(H(j)-G(j))) {
+                    isSame = false;
+                    break;
+                }
+            }
+            if (isSame) {
+                break;
+            }
+        }
+        if (! isSame) {
+            DistinctStarts.push_back(start);
+        }
+        isSame = true;
+        for (int j = 1; j <= NDim; ++j) {
+            if (std::fabs(StartVarEst(start,j)-Out.VarEst(j)) > DedupTol*(H(j)-G(j))) {
+                isSame = false;
+                break;
+            }
+        }
+        Out.NumAtBest += (isSame) ? 1 : 0;
+    }
+    Out.NumDistinctOptima = DistinctStarts.size();
+
+} // end ComplexMultiStart
+
+
 void Cons(boost::numeric::ublas::matrix<double> &X,
           boost::numeric::ublas::matrix<double> &R,
           int &NDim,
@@ -49,26 +158,56 @@ void Cons(boost::numeric::ublas::matrix<double> &X,
           boost::numeric::ublas::vector<double> &H,
           boost::numeric::ublas::vector<double> &VarEst,
           int &ItFlag)
+{
+    ComplexWorkspace Workspace;
+
+    Workspace.resize(NDim);
+    for (int i = 1; i <= Workspace.K; ++i) {
+        for (int j = 1; j <= NDim; ++j) {
+            Workspace.R(i,j) = R(i,j);
+        }
+    }
+
+    Cons(Workspace, NYears, SRData, G, H, MaxF, VarEst, ItFlag);
+
+    for (int i = 1; i <= Workspace.K; ++i) {
+        for (int j = 1; j <= NDim; ++j) {
+            X(i,j) = Workspace.X(i,j);
+        }
+    }
+
+} // end Cons
+
+
+void Cons(ComplexWorkspace &Workspace,
+          int &NYears,
+          boost::numeric::ublas::matrix<double> &SRData,
+          boost::numeric::ublas::vector<double> &G,
+          boost::numeric::ublas::vector<double> &H,
+          double &MaxF,
+          boost::numeric::ublas::vector<double> &VarEst,
+          int &ItFlag)
 {
     const int    ITMAX  = 500;      // Maximum number of iterations
     const double AALPHA =   1.3;    // Reflection factor
     const double BBETA  =   0.0001; // Convergence parameter
     const int    GAMMA  =   5;      // Convergence parameter
 
-    int K = NDim+1; // Number of points in complex = NDim + 1
+    int &NDim = Workspace.NDim;
+    int &K    = Workspace.K; // Number of points in complex = NDim + 1
     int IT = 1;     // Iteration Index
     int IEV2;       // Index of point with maximum function value
     int IEV1;       // Index of point with minimum function value
     int KOUNT=0;
     int ITempLow=0;
 
-    boost::numeric::ublas::vector<double> XC;
-    boost::numeric::ublas::vector<double> Y;
-    boost::numeric::ublas::vector<double> TempX;
+    boost::numeric::ublas::matrix<double> &X     = Workspace.X;
+    boost::numeric::ublas::matrix<double> &R     = Workspace.R;
+    boost::numeric::ublas::vector<double> &XC    = Workspace.XC;    // centroid
+    boost::numeric::ublas::vector<double> &Y     = Workspace.Y;     // holds function values for evaluation
+    boost::numeric::ublas::vector<double> &TempX = Workspace.TempX; // holds variable values for evaluation
 
-    nmfUtils::initialize(XC,   NDim+1); // centroid
-    nmfUtils::initialize(Y,    NDim+2); // holds function values for evaluation
-    nmfUtils::initialize(TempX,NDim+1); // holds variable values for evaluation
+    Y.clear();
 
     // Generate K starting points from random values
     for (int i = 1; i <= K; ++i) {
@@ -187,6 +326,7 @@ void Cons(boost::numeric::ublas::matrix<double> &X,
     }
 
     ItFlag = (IT > ITMAX) ? 1 : 0;
+    Workspace.NumIterations = IT;
 
 } // end Cons
 
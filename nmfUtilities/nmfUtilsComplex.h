@@ -11,6 +11,7 @@
 #include <vector>
 #include <map>
 #include <math.h>
+#include <random>
 
 #include <boost/numeric/ublas/matrix.hpp>
 #include <boost/numeric/ublas/io.hpp>
@@ -24,6 +25,83 @@
  */
 namespace nmfUtilsComplex {
 
+/**
+ * @brief Holds all of the points, function values, and scratch vectors used
+ * by a single Complex run so that they're allocated once and may be reused
+ * across runs (i.e., one workspace per thread in the multi-start driver).
+ * As in the original code, indices 1..K and 1..NDim are used.
+ */
+struct ComplexWorkspace {
+    int NDim;  // Number of dimensions
+    int K;     // Number of points in complex = NDim + 1
+    int NumIterations; // Number of iterations used by the last run
+    boost::numeric::ublas::matrix<double> X;     // points of the complex
+    boost::numeric::ublas::matrix<double> R;     // random numbers used to generate the starting points
+    boost::numeric::ublas::vector<double> XC;    // centroid
+    boost::numeric::ublas::vector<double> Y;     // function values of the points
+    boost::numeric::ublas::vector<double> TempX; // variable values for evaluation
+
+    ComplexWorkspace() : NDim(0), K(0), NumIterations(0) {}
+    /**
+     * @brief Sizes the workspace for the given number of dimensions. Does nothing if
+     * it's already that size.
+     * @param nDim : number of dimensions
+     */
+    void resize(const int& nDim) {
+        if ((nDim == NDim) && (X.size1() > 0)) {
+            return;
+        }
+        NDim = nDim;
+        K    = nDim + 1;
+        nmfUtils::initialize(X,    K+1,   NDim+1);
+        nmfUtils::initialize(R,    NDim+2,NDim+1);
+        nmfUtils::initialize(XC,   NDim+1);
+        nmfUtils::initialize(Y,    NDim+2);
+        nmfUtils::initialize(TempX,NDim+1);
+    }
+};
+
+/**
+ * @brief Holds the best fit and convergence diagnostics from ComplexMultiStart
+ */
+struct ComplexMultiStartOut {
+    double MaxF;              // best function value found over all starts
+    boost::numeric::ublas::vector<double> VarEst; // parameters of the best fit (indices 1..NDim)
+    int    ItFlag;            // 1 if maxits reached for the best start
+    int    BestStart;         // index of the start that found the best fit
+    int    NumStarts;         // number of starts run
+    int    NumConverged;      // number of starts that converged before ITMAX
+    int    NumDistinctOptima; // number of distinct converged vertices
+    int    NumAtBest;         // number of converged starts that found the best vertex
+    std::vector<double> StartMaxF;   // best function value per start
+    std::vector<int>    StartItFlag; // ItFlag per start
+};
+
+/**
+ * @brief Runs many independently seeded Complex maximizations of USERFUNC concurrently and
+ * returns the best fit. The starts run on the workers of nmfUtils::runWorkers and each
+ * worker reuses its own workspace. Since each start's random numbers depend only upon the
+ * seed and the start index, the results don't depend upon the number of threads used.
+ * @param NDim : number of dimensions
+ * @param NYears : number of years of data
+ * @param G : lower constraints (indices 1..NDim)
+ * @param H : upper constraints (indices 1..NDim)
+ * @param SRData : stock recruitment data
+ * @param NumStarts : number of starts to run
+ * @param Seed : seed value (if < 0, the current time is used)
+ * @param NumThreads : number of threads to use (if <= 0, the number of hardware threads is used)
+ * @param Out : the best fit and convergence diagnostics
+ */
+void ComplexMultiStart(int NDim,
+                       int &NYears,
+                       boost::numeric::ublas::vector<double> &G,
+                       boost::numeric::ublas::vector<double> &H,
+                       boost::numeric::ublas::matrix<double> &SRData,
+                       const int &NumStarts,
+                       const int &Seed,
+                       const int &NumThreads,
+                       ComplexMultiStartOut &Out);
+
 /**
  * @brief This subroutine perfroms a maximization of the user defined function USERFUNC
  * with NDim Dimenstions under inequality constrants of the form:
@@ -60,6 +138,26 @@ void Cons(boost::numeric::ublas::matrix<double> &X,
           boost::numeric::ublas::vector<double> &H,
           boost::numeric::ublas::vector<double> &VarEst,
           int &ItFlag);
+/**
+ * @brief Same as Cons but all points and scratch vectors are taken from the
+ * workspace. The random numbers in Workspace.R must have been set.
+ * @param Workspace : sized workspace for the run
+ * @param NYears : number of years of data
+ * @param SRData : stock recruitment data
+ * @param G : lower constraints
+ * @param H : upper constraints
+ * @param MaxF : the function value at the maximum
+ * @param VarEst : the parameter values at the maximum
+ * @param ItFlag : 1 if maxits reached
+ */
+void Cons(ComplexWorkspace &Workspace,
+          int &NYears,
+          boost::numeric::ublas::matrix<double> &SRData,
+          boost::numeric::ublas::vector<double> &G,
+          boost::numeric::ublas::vector<double> &H,
+          double &MaxF,
+          boost::numeric::ublas::vector<double> &VarEst,
+          int &ItFlag);
 /**
  * @brief Explicit constraint violation correction. This checks independent
  * variables against explicit and implicit constraints -- and throws the
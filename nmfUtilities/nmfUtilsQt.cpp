@@ -2012,32 +2012,6 @@ modelCopy(QStandardItemModel* originalModel, QStandardItemModel* copyModel)
     }
 }
 
-bool
-loadMultiRunData(const nmfStructsQt::ModelDataStruct& dataStruct,
-                 std::vector<QString>& MultiRunLines,
-                 int& TotalIndividualRuns)
-{
-    bool retv = false;
-
-    TotalIndividualRuns = 0;
-
-    std::string line;
-    QString lineStr;
-std::cout << "Loading multi run file: " << dataStruct.MultiRunSetupFilename << std::endl;
-    std::ifstream multiRunFile(dataStruct.MultiRunSetupFilename);
-    if (multiRunFile.is_open()) {
-        getline(multiRunFile,line); // First line is the header
-        while (getline(multiRunFile,line)) {
-            lineStr = QString::fromStdString(line);
-            TotalIndividualRuns += lineStr.split(',')[0].toInt();
-            MultiRunLines.push_back(lineStr);
-        }
-        multiRunFile.close();
-        retv = true;
-    }
-    return retv;
-}
-
 /*
  * To delay execution without freezing GUI. Useful if you need to let
  * any signals catch up with the application.
@@ -2052,67 +2026,6 @@ std::cout << "Loading multi run file: " << dataStruct.MultiRunSetupFilename << s
 //    eventLoop.exec();
 //}
 
-void
-reloadDataStruct(
-        nmfStructsQt::ModelDataStruct& dataStruct,
-        const QString& MultiRunLine)
-{
-    QStringList parts = MultiRunLine.split(",");
-//std::cout << "num parts: " << parts.size() << std::endl;
-//for (int ii=0; ii<parts.size(); ++ii) {
-// std::cout << ii << ": " << parts[ii].toStdString() << std::endl;
-//}
-    dataStruct.NLoptNumberOfRuns     = parts[0].toInt();
-
-    dataStruct.ObjectiveCriterion    = parts[1].toStdString();
-    dataStruct.EstimationAlgorithm   = parts[2].toStdString();
-    dataStruct.MinimizerAlgorithm    = parts[3].toStdString();
-    dataStruct.ScalingAlgorithm      = parts[4].toStdString();
-
-//std::cout << "Processing: " << dataStruct.NLoptNumberOfRuns << " runs: " <<
-//             dataStruct.EstimationAlgorithm << "," <<
-//             dataStruct.MinimizerAlgorithm << "," <<
-//             dataStruct.ObjectiveCriterion << "," <<
-//             dataStruct.ScalingAlgorithm << std::endl;
-
-    dataStruct.BeesMaxGenerations    = parts[5].toInt();
-    dataStruct.BeesNumTotal          = parts[6].toInt();
-    dataStruct.BeesNumBestSites      = parts[7].toInt();
-    dataStruct.BeesNumEliteSites     = parts[8].toInt();
-    dataStruct.BeesNumElite          = parts[9].toInt();
-    dataStruct.BeesNumOther          = parts[10].toInt();
-    dataStruct.BeesNeighborhoodSize  = parts[11].toFloat();
-    dataStruct.BeesNumRepetitions    = parts[12].toInt();
-
-    dataStruct.NLoptUseStopVal       = parts[14].toInt();
-    dataStruct.NLoptStopVal          = parts[15].toInt();
-    dataStruct.NLoptUseStopAfterTime = parts[17].toInt();
-    dataStruct.NLoptStopAfterTime    = parts[18].toInt();
-    dataStruct.NLoptUseStopAfterIter = parts[20].toInt();
-    dataStruct.NLoptStopAfterIter    = parts[21].toInt();
-
-    dataStruct.EstimateRunBoxes.clear();
-    int startIndex = 22;
-    nmfStructsQt::EstimateRunBox runBox;
-    for (int col=22; col<parts.size()-3; col+=3) {
-        if ((parts[col+1].toInt()==1) && (parts[col+2].toInt()==1)) {
-            runBox.parameter = nmfConstantsMSSPM::EstimateCheckboxNames[(col-startIndex)/3];
-            runBox.state     = std::make_pair(true,true);
-            dataStruct.EstimateRunBoxes.push_back(runBox);
-        } else {
-            runBox.parameter = "";
-            runBox.state     = std::make_pair(false,false);
-            dataStruct.EstimateRunBoxes.push_back(runBox);
-        }
-    }
-}
-
-QDateTime
-getCurrentTime()
-{
-    return QDateTime::currentDateTime();
-}
-
 std::string
 elapsedTime(QDateTime startTime)
 {
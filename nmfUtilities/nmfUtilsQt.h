@@ -58,6 +58,7 @@
 
 #include "nmfUtils.h"
 #include "nmfStructsQt.h"
+#include "nmfUtilsQtCore.h"
 #include "nmfConstantsMSCAA.h"
 #include "nmfConstantsMSSPM.h"
 #include "nmfConstantsMSVPA.h"
@@ -385,16 +386,6 @@ namespace nmfUtilsQt {
                                     const QString& inputFilename,
                                     QList<QString>& SpeciesGuilds,
                                     QString& errorMsg);
-    /**
-     * @brief Loads all of the multi-run file data into a vector of QStrings
-     * @param DataStruct : struct containing all run parameters
-     * @param MultiRunLines : contents of multi-run file
-     * @param TotalIndividualRuns : total number of individual runs
-     * @return True if a successful load, false otherwise
-     */
-    bool loadMultiRunData(const nmfStructsQt::ModelDataStruct& DataStruct,
-                          std::vector<QString>& MultiRunLines,
-                          int& TotalIndividualRuns);
     /**
      * @brief Load data from a .csv file into a QTableWidget
      * @param parentTabWidget : parent widget onto which any popup message will be displayed
@@ -459,14 +450,6 @@ namespace nmfUtilsQt {
      */
     QString pasteAll(QApplication* qtApp,
                      QTableView* tableView);
-    /**
-     * @brief Reloads the passed dataStruct with the passed line from the multi-run line file
-     * @param dataStruct : the data struct to reload
-     * @param MultiRunLine : a line from the multi-run line file
-     */
-    void reloadDataStruct(
-            nmfStructsQt::ModelDataStruct& dataStruct,
-            const QString& MultiRunLine);
     /**
      * @brief Removes the Qt settings file from the file system.
      * Useful for resetting the application GUI in case it disappears
@@ -722,11 +705,6 @@ namespace nmfUtilsQt {
      */
     bool extractTag(const QString filename,
                     QString& tag);
-    /**
-     * @brief Returns the current time
-     * @return the current time
-     */
-    QDateTime getCurrentTime();
     /**
      * @brief Calculates the time elapsed between the passed startTime and the currentTime
      * @param startTime : The start time with which to calculate the elapsed time
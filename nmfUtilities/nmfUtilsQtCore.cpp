@@ -0,0 +1,448 @@
+/**
+ @file nmfUtilsQtCore.cpp
+ @copyright 2017 NOAA - National Marine Fisheries Service
+ @brief Qt functions that only need QtCore
+ @date Oct 19, 2026
+*/
+
+#include "nmfUtilsQtCore.h"
+
+#include <iomanip>
+#include <map>
+
+namespace {
+
+typedef nmfStructsQt::ModelDataStruct ModelData;
+
+/*
+ * Calls Visit(name,field) on every field of the model data, in the order they're saved.
+ * Data may be const (saving) or not (loading).
+ */
+template<class Data, class Visitor>
+void
+visitModelDataFields(Data& data, Visitor& Visit)
+{
+    Visit("isMohnsRho",                     data.isMohnsRho);
+    Visit("showDiagnosticChart",            data.showDiagnosticChart);
+    Visit("useFixedSeed",                   data.useFixedSeed);
+    Visit("NLoptUseStopVal",                data.NLoptUseStopVal);
+    Visit("NLoptUseStopAfterTime",          data.NLoptUseStopAfterTime);
+    Visit("NLoptUseStopAfterIter",          data.NLoptUseStopAfterIter);
+    Visit("NLoptStopVal",                   data.NLoptStopVal);
+    Visit("NLoptStopAfterTime",             data.NLoptStopAfterTime);
+    Visit("NLoptStopAfterIter",             data.NLoptStopAfterIter);
+    Visit("NLoptNumberOfRuns",              data.NLoptNumberOfRuns);
+    Visit("MultiRunSpeciesFilename",        data.MultiRunSpeciesFilename);
+    Visit("MultiRunModelFilename",          data.MultiRunModelFilename);
+    Visit("MultiRunSetupFilename",          data.MultiRunSetupFilename);
+    Visit("RunLength",                      data.RunLength);
+    Visit("NumSpecies",                     data.NumSpecies);
+    Visit("NumGuilds",                      data.NumGuilds);
+    Visit("BeesMaxGenerations",             data.BeesMaxGenerations);
+    Visit("BeesNumTotal",                   data.BeesNumTotal);
+    Visit("BeesNumBestSites",               data.BeesNumBestSites);
+    Visit("BeesNumEliteSites",              data.BeesNumEliteSites);
+    Visit("BeesNumElite",                   data.BeesNumElite);
+    Visit("BeesNumOther",                   data.BeesNumOther);
+    Visit("BeesNeighborhoodSize",           data.BeesNeighborhoodSize);
+    Visit("BeesNumRepetitions",             data.BeesNumRepetitions);
+    Visit("GAGenerations",                  data.GAGenerations);
+    Visit("GAConvergence",                  data.GAConvergence);
+    Visit("TotalNumberParameters",          data.TotalNumberParameters);
+    Visit("Benchmark",                      data.Benchmark);
+    Visit("GrowthForm",                     data.GrowthForm);
+    Visit("HarvestForm",                    data.HarvestForm);
+    Visit("CompetitionForm",                data.CompetitionForm);
+    Visit("PredationForm",                  data.PredationForm);
+    Visit("EstimationAlgorithm",            data.EstimationAlgorithm);
+    Visit("MinimizerAlgorithm",             data.MinimizerAlgorithm);
+    Visit("ObjectiveCriterion",             data.ObjectiveCriterion);
+    Visit("ScalingAlgorithm",               data.ScalingAlgorithm);
+    Visit("GuildSpecies",                   data.GuildSpecies);
+    Visit("GuildNum",                       data.GuildNum);
+    Visit("ObservedBiomassBySpecies",       data.ObservedBiomassBySpecies);
+    Visit("ObservedBiomassByGuilds",        data.ObservedBiomassByGuilds);
+    Visit("Catch",                          data.Catch);
+    Visit("Effort",                         data.Effort);
+    Visit("InitBiomass",                    data.InitBiomass);
+    Visit("InitBiomassMin",                 data.InitBiomassMin);
+    Visit("InitBiomassMax",                 data.InitBiomassMax);
+    Visit("GrowthRate",                     data.GrowthRate);
+    Visit("GrowthRateMin",                  data.GrowthRateMin);
+    Visit("GrowthRateMax",                  data.GrowthRateMax);
+    Visit("CarryingCapacity",               data.CarryingCapacity);
+    Visit("CarryingCapacityMin",            data.CarryingCapacityMin);
+    Visit("CarryingCapacityMax",            data.CarryingCapacityMax);
+    Visit("Exploitation",                   data.Exploitation);
+    Visit("ExploitationRateMin",            data.ExploitationRateMin);
+    Visit("ExploitationRateMax",            data.ExploitationRateMax);
+    Visit("Catchability",                   data.Catchability);
+    Visit("CatchabilityMin",                data.CatchabilityMin);
+    Visit("CatchabilityMax",                data.CatchabilityMax);
+    Visit("SurveyQ",                        data.SurveyQ);
+    Visit("SurveyQMin",                     data.SurveyQMin);
+    Visit("SurveyQMax",                     data.SurveyQMax);
+    Visit("CompetitionMin",                 data.CompetitionMin);
+    Visit("CompetitionMax",                 data.CompetitionMax);
+    Visit("CompetitionBetaSpeciesMin",      data.CompetitionBetaSpeciesMin);
+    Visit("CompetitionBetaSpeciesMax",      data.CompetitionBetaSpeciesMax);
+    Visit("CompetitionBetaGuildsMin",       data.CompetitionBetaGuildsMin);
+    Visit("CompetitionBetaGuildsMax",       data.CompetitionBetaGuildsMax);
+    Visit("CompetitionBetaGuildsGuildsMin", data.CompetitionBetaGuildsGuildsMin);
+    Visit("CompetitionBetaGuildsGuildsMax", data.CompetitionBetaGuildsGuildsMax);
+    Visit("PredationRhoMin",                data.PredationRhoMin);
+    Visit("PredationRhoMax",                data.PredationRhoMax);
+    Visit("PredationHandlingMin",           data.PredationHandlingMin);
+    Visit("PredationHandlingMax",           data.PredationHandlingMax);
+    Visit("PredationExponentMin",           data.PredationExponentMin);
+    Visit("PredationExponentMax",           data.PredationExponentMax);
+    Visit("Parameters",                     data.Parameters);
+    Visit("EstimateRunBoxes",               data.EstimateRunBoxes);
+}
+
+// Values are written after the field name on the same line, with matrices and
+// lists continuing on the lines after it
+
+void writeValue(std::ostream& out, const bool& value)   { out << int(value); }
+void writeValue(std::ostream& out, const int& value)    { out << value; }
+void writeValue(std::ostream& out, const float& value)  { out << value; }
+void writeValue(std::ostream& out, const double& value) { out << value; }
+void writeValue(std::ostream& out, const std::string& value) { out << value; }
+
+void
+writeValue(std::ostream& out, const boost::numeric::ublas::matrix<double>& value)
+{
+    out << value.size1() << " " << value.size2();
+    for (unsigned i = 0; i < value.size1(); ++i) {
+        out << "\n";
+        for (unsigned j = 0; j < value.size2(); ++j) {
+            out << " " << value(i,j);
+        }
+    }
+}
+
+template<class Vector>
+void
+writeList(std::ostream& out, const Vector& value)
+{
+    out << value.size();
+    for (unsigned i = 0; i < value.size(); ++i) {
+        out << " ";
+        writeValue(out,value[i]);
+    }
+}
+
+void writeValue(std::ostream& out, const boost::numeric::ublas::vector<double>& value) { writeList(out,value); }
+void writeValue(std::ostream& out, const std::vector<double>& value) { writeList(out,value); }
+void writeValue(std::ostream& out, const std::vector<int>& value)    { writeList(out,value); }
+
+void
+writeValue(std::ostream& out, const std::vector<std::vector<double> >& value)
+{
+    out << value.size();
+    for (const std::vector<double>& row : value) {
+        out << "\n";
+        writeList(out,row);
+    }
+}
+
+void
+writeValue(std::ostream& out, const std::map<int,std::vector<int> >& value)
+{
+    out << value.size();
+    for (const auto& item : value) {
+        out << "\n" << item.first << " ";
+        writeList(out,item.second);
+    }
+}
+
+void
+writeValue(std::ostream& out, const std::vector<nmfStructsQt::EstimateRunBox>& value)
+{
+    out << value.size();
+    for (const nmfStructsQt::EstimateRunBox& runBox : value) {
+        out << "\n" << int(runBox.state.first) << " " << int(runBox.state.second) <<
+               " " << runBox.parameter;
+    }
+}
+
+bool readValue(std::istream& in, int& value)    { return bool(in >> value); }
+bool readValue(std::istream& in, float& value)  { return bool(in >> value); }
+bool readValue(std::istream& in, double& value) { return bool(in >> value); }
+
+bool
+readValue(std::istream& in, bool& value)
+{
+    int intValue;
+    if (! (in >> intValue)) {
+        return false;
+    }
+    value = (intValue != 0);
+    return true;
+}
+
+// The rest of the line, which may be empty or have spaces in it
+bool
+readValue(std::istream& in, std::string& value)
+{
+    if (! std::getline(in,value)) {
+        return false;
+    }
+    if (! value.empty() && (value[0] == ' ')) {
+        value.erase(0,1);
+    }
+    return true;
+}
+
+bool
+readValue(std::istream& in, boost::numeric::ublas::matrix<double>& value)
+{
+    unsigned NumRows;
+    unsigned NumCols;
+
+    if (! (in >> NumRows >> NumCols)) {
+        return false;
+    }
+    value.resize(NumRows,NumCols,false);
+    for (unsigned i = 0; i < NumRows; ++i) {
+        for (unsigned j = 0; j < NumCols; ++j) {
+            if (! (in >> value(i,j))) {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+template<class Vector>
+bool
+readList(std::istream& in, Vector& value)
+{
+    unsigned NumItems;
+
+    if (! (in >> NumItems)) {
+        return false;
+    }
+    value.resize(NumItems);
+    for (unsigned i = 0; i < NumItems; ++i) {
+        if (! readValue(in,value[i])) {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool readValue(std::istream& in, boost::numeric::ublas::vector<double>& value) { return readList(in,value); }
+bool readValue(std::istream& in, std::vector<double>& value) { return readList(in,value); }
+bool readValue(std::istream& in, std::vector<int>& value)    { return readList(in,value); }
+
+bool
+readValue(std::istream& in, std::vector<std::vector<double> >& value)
+{
+    unsigned NumRows;
+
+    if (! (in >> NumRows)) {
+        return false;
+    }
+    value.resize(NumRows);
+    for (unsigned i = 0; i < NumRows; ++i) {
+        if (! readList(in,value[i])) {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool
+readValue(std::istream& in, std::map<int,std::vector<int> >& value)
+{
+    unsigned NumItems;
+    int key;
+
+    value.clear();
+    if (! (in >> NumItems)) {
+        return false;
+    }
+    for (unsigned i = 0; i < NumItems; ++i) {
+        if (! (in >> key) || ! readList(in,value[key])) {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool
+readValue(std::istream& in, std::vector<nmfStructsQt::EstimateRunBox>& value)
+{
+    unsigned NumItems;
+    int first;
+    int second;
+
+    if (! (in >> NumItems)) {
+        return false;
+    }
+    value.resize(NumItems);
+    for (unsigned i = 0; i < NumItems; ++i) {
+        if (! (in >> first >> second) || ! readValue(in,value[i].parameter)) {
+            return false;
+        }
+        value[i].state = std::make_pair(first != 0,second != 0);
+    }
+    return true;
+}
+
+struct FieldWriter {
+    std::ostream& out;
+    template<class T>
+    void operator()(const char* Name, const T& field) {
+        out << Name << " ";
+        writeValue(out,field);
+        out << "\n";
+    }
+};
+
+struct FieldReader {
+    std::istream& in;
+    const std::string& Name;
+    bool Found;
+    bool OK;
+    template<class T>
+    void operator()(const char* FieldName, T& field) {
+        if (! Found && (Name == FieldName)) {
+            Found = true;
+            OK    = readValue(in,field);
+        }
+    }
+};
+
+}
+
+namespace nmfUtilsQt {
+
+QDateTime
+getCurrentTime()
+{
+    return QDateTime::currentDateTime();
+}
+
+bool
+loadMultiRunData(const nmfStructsQt::ModelDataStruct& dataStruct,
+                 std::vector<QString>& MultiRunLines,
+                 int& TotalIndividualRuns)
+{
+    bool retv = false;
+
+    TotalIndividualRuns = 0;
+
+    std::string line;
+    QString lineStr;
+    std::ifstream multiRunFile(dataStruct.MultiRunSetupFilename);
+    if (multiRunFile.is_open()) {
+        getline(multiRunFile,line); // First line is the header
+        while (getline(multiRunFile,line)) {
+            lineStr = QString::fromStdString(line);
+            TotalIndividualRuns += lineStr.split(',')[0].toInt();
+            MultiRunLines.push_back(lineStr);
+        }
+        multiRunFile.close();
+        retv = true;
+    }
+    return retv;
+}
+
+void
+reloadDataStruct(
+        nmfStructsQt::ModelRunSettings& dataStruct,
+        const QString& MultiRunLine)
+{
+    QStringList parts = MultiRunLine.split(",");
+    dataStruct.NLoptNumberOfRuns     = parts[0].toInt();
+
+    dataStruct.ObjectiveCriterion    = parts[1].toStdString();
+    dataStruct.EstimationAlgorithm   = parts[2].toStdString();
+    dataStruct.MinimizerAlgorithm    = parts[3].toStdString();
+    dataStruct.ScalingAlgorithm      = parts[4].toStdString();
+
+    dataStruct.BeesMaxGenerations    = parts[5].toInt();
+    dataStruct.BeesNumTotal          = parts[6].toInt();
+    dataStruct.BeesNumBestSites      = parts[7].toInt();
+    dataStruct.BeesNumEliteSites     = parts[8].toInt();
+    dataStruct.BeesNumElite          = parts[9].toInt();
+    dataStruct.BeesNumOther          = parts[10].toInt();
+    dataStruct.BeesNeighborhoodSize  = parts[11].toFloat();
+    dataStruct.BeesNumRepetitions    = parts[12].toInt();
+
+    dataStruct.NLoptUseStopVal       = parts[14].toInt();
+    dataStruct.NLoptStopVal          = parts[15].toInt();
+    dataStruct.NLoptUseStopAfterTime = parts[17].toInt();
+    dataStruct.NLoptStopAfterTime    = parts[18].toInt();
+    dataStruct.NLoptUseStopAfterIter = parts[20].toInt();
+    dataStruct.NLoptStopAfterIter    = parts[21].toInt();
+
+    dataStruct.EstimateRunBoxes.clear();
+    int startIndex = 22;
+    nmfStructsQt::EstimateRunBox runBox;
+    for (int col=22; col<parts.size()-3; col+=3) {
+        if ((parts[col+1].toInt()==1) && (parts[col+2].toInt()==1)) {
+            runBox.parameter = nmfConstantsMSSPM::EstimateCheckboxNames[(col-startIndex)/3];
+            runBox.state     = std::make_pair(true,true);
+            dataStruct.EstimateRunBoxes.push_back(runBox);
+        } else {
+            runBox.parameter = "";
+            runBox.state     = std::make_pair(false,false);
+            dataStruct.EstimateRunBoxes.push_back(runBox);
+        }
+    }
+}
+
+bool
+saveModelData(const nmfStructsQt::ModelDataStruct& dataStruct,
+              const std::string& filename)
+{
+    std::ofstream outputFile(filename);
+
+    if (! outputFile.is_open()) {
+        std::cout << "Error nmfUtilsQt::saveModelData: Couldn't open " << filename << std::endl;
+        return false;
+    }
+
+    // Enough digits that the values read back are the same doubles
+    outputFile << std::setprecision(17);
+    FieldWriter Writer{outputFile};
+    visitModelDataFields(dataStruct,Writer);
+    outputFile.close();
+
+    return bool(outputFile);
+}
+
+bool
+loadModelData(const std::string& filename,
+              nmfStructsQt::ModelDataStruct& dataStruct)
+{
+    std::string name;
+    std::ifstream inputFile(filename);
+
+    if (! inputFile.is_open()) {
+        std::cout << "Error nmfUtilsQt::loadModelData: Couldn't open " << filename << std::endl;
+        return false;
+    }
+
+    while (inputFile >> name) {
+        FieldReader Reader{inputFile,name,false,false};
+        visitModelDataFields(dataStruct,Reader);
+        if (! Reader.Found) {
+            std::cout << "Error nmfUtilsQt::loadModelData: Unknown field " << name <<
+                         " in " << filename << std::endl;
+            return false;
+        }
+        if (! Reader.OK) {
+            std::cout << "Error nmfUtilsQt::loadModelData: Couldn't read " << name <<
+                         " in " << filename << std::endl;
+            return false;
+        }
+    }
+
+    return true;
+}
+
+} // end namespace
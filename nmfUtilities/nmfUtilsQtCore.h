@@ -0,0 +1,69 @@
+/**
+ * @file nmfUtilsQtCore.h
+ * @brief Definition for the Qt functions that don't need any widgets
+ * @date Oct 19, 2026
+ *
+ * This file contains the common functions that only need QtCore, so that they can
+ * also be used by the headless (command line) tools. They're in the nmfUtilsQt
+ * namespace with the rest of the Qt functions.
+ *
+ */
+
+#pragma once
+
+#include <iostream>
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include <QDateTime>
+#include <QString>
+#include <QStringList>
+
+#include "nmfStructsQt.h"
+#include "nmfConstantsMSSPM.h"
+
+namespace nmfUtilsQt {
+
+    /**
+     * @brief Returns the current time
+     * @return the current time
+     */
+    QDateTime getCurrentTime();
+    /**
+     * @brief Loads all of the multi-run file data into a vector of QStrings
+     * @param DataStruct : struct containing all run parameters
+     * @param MultiRunLines : contents of multi-run file
+     * @param TotalIndividualRuns : total number of individual runs
+     * @return True if a successful load, false otherwise
+     */
+    bool loadMultiRunData(const nmfStructsQt::ModelDataStruct& DataStruct,
+                          std::vector<QString>& MultiRunLines,
+                          int& TotalIndividualRuns);
+    /**
+     * @brief Reloads the passed dataStruct with the passed line from the multi-run line file
+     * @param dataStruct : the settings to reload (only the estimation settings are on the line)
+     * @param MultiRunLine : a line from the multi-run line file
+     */
+    void reloadDataStruct(
+            nmfStructsQt::ModelRunSettings& dataStruct,
+            const QString& MultiRunLine);
+    /**
+     * @brief Saves all of the passed dataStruct to a text file, one field per line, so that
+     * the estimation can be rerun elsewhere (e.g., by the command line batch tool)
+     * @param dataStruct : the data struct to save
+     * @param filename : name of the model data file
+     * @return True if the file was written, false otherwise
+     */
+    bool saveModelData(const nmfStructsQt::ModelDataStruct& dataStruct,
+                       const std::string& filename);
+    /**
+     * @brief Loads a data struct from a file written by saveModelData
+     * @param filename : name of the model data file
+     * @param dataStruct : the data struct to load
+     * @return True if every field in the file was read, false otherwise
+     */
+    bool loadModelData(const std::string& filename,
+                       nmfStructsQt::ModelDataStruct& dataStruct);
+
+}
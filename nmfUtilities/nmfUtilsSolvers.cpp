@@ -51,5 +51,135 @@ void SolveF(const double Catch, const double N, const double M, double &F)
 }
 
 
+int SolveFBatch(const boost::numeric::ublas::matrix<double> &Catch,
+                const boost::numeric::ublas::matrix<double> &N,
+                const boost::numeric::ublas::matrix<double> &M,
+                boost::numeric::ublas::matrix<double> &F,
+                const bool &warmStart)
+{
+    const int    MaxIt   = 100;
+    const double Tol     = 0.0000000001; // same as in SolveF
+    const double MaxF    = 10.0;         // same starting upper limit as in SolveF
+    const int    NumRows = Catch.size1();
+    const int    NumCols = Catch.size2();
+    int    ItNum;
+    int    NumActive;
+    int    NumNotConverged = 0;
+    int    NumEmpty = 0;
+    double Z;
+    double expZ;
+    double newF;
+    double popeE;
+    std::vector<double> E(NumRows);
+    std::vector<double> Mcol(NumRows);
+    std::vector<double> LowF(NumRows);
+    std::vector<double> UppF(NumRows);
+    std::vector<double> Fcol(NumRows);
+    std::vector<double> Resid(NumRows);
+    std::vector<double> Deriv(NumRows);
+    std::vector<char>   isActive(NumRows);
+
+    if ((N.size1() != Catch.size1()) || (N.size2() != Catch.size2()) ||
+        (M.size1() != Catch.size1()) || (M.size2() != Catch.size2())) {
+        std::cout << "Error nmfUtilsSolvers::SolveFBatch: Catch, N, and M must be the same size" << std::endl;
+        return NumRows*NumCols;
+    }
+    F.resize(NumRows,NumCols,false);
+
+    for (int col=0; col<NumCols; ++col) {
+
+        // Set up the bracket and starting value of every cell in the column
+        NumActive = 0;
+        for (int row=0; row<NumRows; ++row) {
+            Mcol[row] = M(row,col);
+            LowF[row] = 0.0;
+            UppF[row] = MaxF;
+            if (N(row,col) <= 0.0) { // No population, so F is zero (and any catch is an error)
+                E[row]    = 0.0;
+                Fcol[row] = 0.0;
+                isActive[row] = 0;
+                if (Catch(row,col) > 0.0) {
+                    ++NumEmpty;
+                }
+                continue;
+            }
+            E[row]    = Catch(row,col) / N(row,col);
+            if (E[row] <= Tol) { // If it's zero then F is zero
+                Fcol[row] = 0.0;
+                isActive[row] = 0;
+                continue;
+            }
+            if ((col > 0) && warmStart) {
+                Fcol[row] = F(row,col-1);
+            } else { // Pope's approximation
+                popeE = E[row] * std::exp(0.5*Mcol[row]);
+                Fcol[row] = (popeE < 1.0) ? -std::log(1.0-popeE) : 0.5*MaxF;
+            }
+            if ((Fcol[row] <= 0.0) || (Fcol[row] >= MaxF) || std::isnan(Fcol[row])) {
+                Fcol[row] = 0.5*MaxF;
+            }
+            isActive[row] = 1;
+            ++NumActive;
+        }
+
+        ItNum = 0;
+        while ((NumActive > 0) && (ItNum < MaxIt)) {
+            ++ItNum;
+
+            // Residual and analytic derivative of F/Z*(1-exp(-Z)) - E for all cells
+            for (int row=0; row<NumRows; ++row) {
+                Z          = Fcol[row] + Mcol[row];
+                expZ       = std::exp(-Z);
+                Resid[row] = (Fcol[row] / Z) * (1.0 - expZ) - E[row];
+                Deriv[row] = (Mcol[row] / (Z*Z)) * (1.0 - expZ) + (Fcol[row] / Z) * expZ;
+            }
+
+            NumActive = 0;
+            for (int row=0; row<NumRows; ++row) {
+                if (! isActive[row]) {
+                    continue;
+                }
+                if (std::fabs(Resid[row]) <= Tol) {
+                    isActive[row] = 0;
+                    continue;
+                }
+                // The catch equation increases with F so the sign of the residual tightens the bracket
+                if (Resid[row] > 0.0) {
+                    UppF[row] = Fcol[row];
+                } else {
+                    LowF[row] = Fcol[row];
+                }
+                newF = Fcol[row] - Resid[row] / Deriv[row];
+                if ((Deriv[row] <= 0.0) || (newF <= LowF[row]) || (newF >= UppF[row])) {
+                    newF = 0.5 * (LowF[row] + UppF[row]);
+                }
+                Fcol[row] = newF;
+                if (UppF[row] - LowF[row] <= Tol) {
+                    isActive[row] = 0;
+                    continue;
+                }
+                ++NumActive;
+            }
+        } // end while
+
+        NumNotConverged += NumActive;
+        for (int row=0; row<NumRows; ++row) {
+            F(row,col) = Fcol[row];
+        }
+    }
+
+    if (NumEmpty > 0) {
+        std::cout << "Error nmfUtilsSolvers::SolveFBatch: " << NumEmpty
+                  << " of " << NumRows*NumCols << " cells have catch but no population, F set to 0" << std::endl;
+    }
+    if (NumNotConverged > 0) {
+        std::cout << "Error nmfUtilsSolvers::SolveFBatch: " << NumNotConverged
+                  << " of " << NumRows*NumCols << " cells did not converge" << std::endl;
+    }
+
+    return NumNotConverged+NumEmpty;
+}
+
+
 
 } // end namespace nmfSolvers
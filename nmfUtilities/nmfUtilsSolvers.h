@@ -10,6 +10,7 @@
 #include <string>
 #include <vector>
 #include <map>
+#include <cmath>
 
 #include <boost/numeric/ublas/matrix.hpp>
 #include <boost/numeric/ublas/io.hpp>
@@ -37,5 +38,26 @@ void SolveF(const double Catch,
             const double M,
             double &F);
 
+/**
+ * @brief Solves for the mortality rate (F) of every cell of a catch matrix at once (i.e., all
+ * ages of all years). Each cell solves the same equation as SolveF, Catch/N = F/Z*(1-exp(-Z)),
+ * by a safeguarded Newton iteration: the analytic derivative is used while the step stays
+ * inside the current [low,high] bracket and a bisection step is taken otherwise. The cells of
+ * a column are iterated together and each cell stops once it has converged.
+ * @param Catch : the total number (of fish) removed during the time period, per cell
+ * @param N : the initial population size, per cell
+ * @param M : the total "other mortality", per cell
+ * @param F : the solved mortality rates (resized to the size of Catch)
+ * @param warmStart : if true, each column is started from the F values solved for the
+ * previous column (i.e., the neighboring age) instead of from Pope's approximation
+ * @return Number of cells that did not converge or that have catch but no population. Cells
+ * with no population (N <= 0) get an F of 0 rather than the NaN of Catch/N.
+ */
+int SolveFBatch(const boost::numeric::ublas::matrix<double> &Catch,
+                const boost::numeric::ublas::matrix<double> &N,
+                const boost::numeric::ublas::matrix<double> &M,
+                boost::numeric::ublas::matrix<double> &F,
+                const bool &warmStart=false);
+
 }
 
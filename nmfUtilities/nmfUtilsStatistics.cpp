@@ -13,7 +13,9 @@ namespace nmfUtilsStatistics {
 
 void ShepSRR(boost::numeric::ublas::matrix<double> &Data,
              int &NYears,
-             NLRegOut &NLOut)
+             NLRegOut &NLOut,
+             const int &NumStarts,
+             const int &Seed)
 {
     int ItFlag;
     int KInd = 0;
@@ -122,8 +124,17 @@ void ShepSRR(boost::numeric::ublas::matrix<double> &Data,
     H(3) = 2.5;
 
     // Call the fitter...
-    nmfUtilsComplex::Complex(3, NYears, G, H, X,
-                             SRData, RegSS, Parms, ItFlag);
+    if (NumStarts > 1) {
+        nmfUtilsComplex::ComplexMultiStartOut MultiStartOut;
+        nmfUtilsComplex::ComplexMultiStart(3, NYears, G, H, SRData,
+                                           NumStarts, Seed, 0, MultiStartOut);
+        RegSS  = MultiStartOut.MaxF;
+        Parms  = MultiStartOut.VarEst;
+        ItFlag = MultiStartOut.ItFlag;
+    } else {
+        nmfUtilsComplex::Complex(3, NYears, G, H, X,
+                                 SRData, RegSS, Parms, ItFlag);
+    }
     RegSS = -RegSS;
     // WOW...it works...more or less...
 
@@ -197,9 +208,7 @@ void USERFUNC(boost::numeric::ublas::vector<double> &Parms,
     double K;
     double Diff2;
     double SumSquares;
-    boost::numeric::ublas::vector<double> PredVal;
-
-    nmfUtils::initialize(PredVal,NYears);
+    double PredVal;
 
     A = Parms(1);
     K = Parms(2);
@@ -207,8 +216,8 @@ void USERFUNC(boost::numeric::ublas::vector<double> &Parms,
 
     SumSquares = 0.0;
     for (int i = 0; i <= NYears-1; ++i) {
-        PredVal(i) = (A * SRData(i,0)) / (1.0 + std::pow((SRData(i,0)/K),B));
-        Diff2 = std::pow((PredVal(i) - SRData(i, 1)), 2.0);
+        PredVal = (A * SRData(i,0)) / (1.0 + std::pow((SRData(i,0)/K),B));
+        Diff2 = std::pow((PredVal - SRData(i, 1)), 2.0);
         SumSquares += Diff2;
     }
 
@@ -301,7 +310,7 @@ double BetaI(double A, double B, double X)
         BT = 0;
     else {
         try {
-            BT = std::exp(GAMMLN(A + B) - GAMMLN(A) - GAMMLN(B) + (A * std::log(X))	+ (B * std::log(1.0 - X)));
+            BT = std::exp(GAMMLNCached(A + B) - GAMMLNCached(A) - GAMMLNCached(B) + (A * std::log(X))	+ (B * std::log(1.0 - X)));
         } catch (...) {
             std::cout << "Error BetaI-1: " << std::endl;
         }
@@ -322,6 +331,45 @@ double BetaI(double A, double B, double X)
 } // end BetaI
 
 
+bool BetaIBatch(const std::vector<double>& A,
+                const std::vector<double>& B,
+                const std::vector<double>& X,
+                std::vector<double>& values)
+{
+    int NumLanes = X.size();
+    std::vector<double> BT(NumLanes,0);
+    std::vector<bool>   isSwapped(NumLanes,false);
+    std::vector<double> laneA(NumLanes);
+    std::vector<double> laneB(NumLanes);
+    std::vector<double> laneX(NumLanes);
+    std::vector<double> CF;
+    bool converged;
+
+    for (int i=0; i<NumLanes; ++i) {
+        if ((X[i] != 0) && (X[i] != 1)) {
+            BT[i] = std::exp(GAMMLNCached(A[i] + B[i]) - GAMMLNCached(A[i]) - GAMMLNCached(B[i]) +
+                             (A[i] * std::log(X[i])) + (B[i] * std::log(1.0 - X[i])));
+        }
+        // Use the symmetry relation for lanes where the continued fraction converges slowly
+        isSwapped[i] = (X[i] >= ((A[i] + 1.0) / (A[i] + B[i] + 2.0)));
+        laneA[i] = (isSwapped[i]) ? B[i] : A[i];
+        laneB[i] = (isSwapped[i]) ? A[i] : B[i];
+        laneX[i] = (isSwapped[i]) ? 1.0 - X[i] : X[i];
+    }
+
+    converged = BetaCFBatch(laneA,laneB,laneX,CF);
+
+    values.resize(NumLanes);
+    for (int i=0; i<NumLanes; ++i) {
+        values[i] = (isSwapped[i]) ? 1.0 - BT[i] * CF[i] / laneA[i] :
+                                           BT[i] * CF[i] / laneA[i];
+    }
+
+    return converged;
+
+} // end BetaIBatch
+
+
 double BetaCF(double A, double B, double X) {
     const double EPS = 0.0000003;
     const int ITMAX = 100;
@@ -387,6 +435,81 @@ double BetaCF(double A, double B, double X) {
 } // end BetaCF
 
 
+bool BetaCFBatch(const std::vector<double>& A,
+                 const std::vector<double>& B,
+                 const std::vector<double>& X,
+                 std::vector<double>& values)
+{
+    const double EPS = 0.0000003;
+    const int ITMAX = 100;
+
+    int NumLanes = X.size();
+    int NumActive = NumLanes;
+    int M = 0;
+    double EM;
+    double TEM;
+    double d;
+    double Ap;
+    double Bp;
+    double App;
+    double Bpp;
+    std::vector<double> AM(NumLanes,1.0);
+    std::vector<double> BM(NumLanes,1.0);
+    std::vector<double> AZ(NumLanes,1.0);
+    std::vector<double> BZ(NumLanes);
+    std::vector<double> Aold(NumLanes);
+    std::vector<char>   isActive(NumLanes,1); // per lane convergence mask
+
+    for (int i=0; i<NumLanes; ++i) {
+        BZ[i] = 1.0 - (A[i] + B[i]) * X[i] / (A[i] + 1.0);
+    }
+
+    while ((M < ITMAX) && (NumActive > 0))
+    {
+        ++M;
+        EM  = M;
+        TEM = EM + EM;
+
+        // Same recurrence as BetaCF, applied to every lane. Converged lanes keep their values.
+        for (int i=0; i<NumLanes; ++i) {
+            d   = EM * (B[i] - M) * X[i] / ((A[i] - 1.0 + TEM) * (A[i] + TEM));
+            Ap  = AZ[i] + d * AM[i];
+            Bp  = BZ[i] + d * BM[i];
+            d   = -(A[i] + EM) * (A[i] + B[i] + EM) * X[i] / ((A[i] + TEM) * (A[i] + 1.0 + TEM));
+            App = Ap + d * AZ[i];
+            Bpp = Bp + d * BZ[i];
+            if (isActive[i]) {
+                Aold[i] = AZ[i];
+                AM[i]   = Ap / Bpp;
+                BM[i]   = Bp / Bpp;
+                AZ[i]   = App / Bpp;
+                BZ[i]   = 1.0;
+            }
+        }
+
+        NumActive = 0;
+        for (int i=0; i<NumLanes; ++i) {
+            if (isActive[i] && (std::fabs(AZ[i] - Aold[i]) < (EPS * std::fabs(AZ[i])))) {
+                isActive[i] = 0;
+            }
+            NumActive += isActive[i];
+        }
+
+    } // end while M
+
+    // As in BetaCF, lanes that didn't converge return their last iterate
+    values = AZ;
+
+    if (NumActive > 0) {
+        std::cout << "\nBetaCFBatch error: ItMaxReached for " << NumActive << " of " << NumLanes << " values" << std::endl;
+        return false;
+    }
+
+    return true;
+
+} // end BetaCFBatch
+
+
 double GAMMLN(double XX) {
     double retv;
     double X;
@@ -425,6 +548,29 @@ double GAMMLN(double XX) {
 } // end GAMMLN
 
 
+double GAMMLNCached(double XX)
+{
+    // Holds GAMMLN(n/2) for n = 1...MaxIndex, i.e. for all integer and half integer values up to MaxIndex/2
+    const int MaxIndex = 2000;
+    static const std::vector<double> Table = []() {
+        std::vector<double> table(MaxIndex+1,0.0);
+        for (int n=1; n<=MaxIndex; ++n) {
+            table[n] = GAMMLN(0.5*n);
+        }
+        return table;
+    }();
+
+    double twoXX = 2.0*XX;
+    int    index = int(twoXX);
+
+    if ((index >= 1) && (index <= MaxIndex) && (double(index) == twoXX)) {
+        return Table[index];
+    }
+    return GAMMLN(XX);
+
+} // end GAMMLNCached
+
+
 
 // Does the factorial...can still overflow with large values
 double FACTRL(int N)
@@ -496,11 +642,61 @@ double ProbF(double F, int DF1, int DF2)
 } // end ProbF
 
 
+void ProbFBatch(const std::vector<double>& F,
+                const std::vector<int>& DF1,
+                const std::vector<int>& DF2,
+                std::vector<double>& probF)
+{
+    int NumLanes = F.size();
+    std::vector<double> A(NumLanes);
+    std::vector<double> B(NumLanes);
+    std::vector<double> X1(NumLanes);
+    std::vector<double> X2(NumLanes);
+    std::vector<double> Val1;
+    std::vector<double> Val2;
+
+    for (int i=0; i<NumLanes; ++i) {
+        A[i]  = 0.5 * DF2[i];
+        B[i]  = 0.5 * DF1[i];
+        X1[i] = DF2[i] / (DF2[i] + DF1[i] * F[i]);
+        X2[i] = DF1[i] / (DF1[i] + DF2[i] / F[i]);
+    }
+
+    BetaIBatch(A,B,X1,Val1);
+    BetaIBatch(B,A,X2,Val2);
+
+    probF.resize(NumLanes);
+    for (int i=0; i<NumLanes; ++i) {
+        probF[i] = (Val1[i] + (1 - Val2[i])) / 2;
+    }
+
+} // end ProbFBatch
+
+
 double ProbT(double T, int DF) {
     return BetaI(0.5 * DF, 0.5, DF / (DF + T * T));
 } // end ProbT
 
 
+void ProbTBatch(const std::vector<double>& T,
+                const std::vector<int>& DF,
+                std::vector<double>& probT)
+{
+    int NumLanes = T.size();
+    std::vector<double> A(NumLanes);
+    std::vector<double> B(NumLanes,0.5);
+    std::vector<double> X(NumLanes);
+
+    for (int i=0; i<NumLanes; ++i) {
+        A[i] = 0.5 * DF[i];
+        X[i] = DF[i] / (DF[i] + T[i] * T[i]);
+    }
+
+    BetaIBatch(A,B,X,probT);
+
+} // end ProbTBatch
+
+
 void calculateSSResiduals(const int& NumSpeciesOrGuilds,
                           const int& RunLength,
                           const std::vector<double>& Observed,
@@ -582,6 +778,18 @@ void calculateAIC(const int& NumSpeciesOrGuilds,
     }
 }
 
+void calculateAIC(const int& NumSpeciesOrGuilds,
+                  const int& NumParameters,
+                  const std::vector<int>& NumObservations,
+                  const std::vector<double>& SSResiduals,
+                  std::vector<double>& AIC)
+{
+    AIC.clear();
+    for (int i=0;i<NumSpeciesOrGuilds;++i) {
+        AIC.push_back(NumObservations[i]*std::log(SSResiduals[i]/NumObservations[i]) + 2 * NumParameters);
+    }
+}
+
 bool calculateR(const int& NumSpeciesOrGuilds,
                 const int& RunLength,
                 const std::vector<double>& MeanObserved,
@@ -739,6 +947,131 @@ bool calculateMEF(const int& NumSpeciesOrGuilds,
     return true;
 }
 
+bool calculateFitStatistics(const int& NumSpeciesOrGuilds,
+                            const int& NumParameters,
+                            const int& RunLength,
+                            const std::vector<double>& Observed,
+                            const std::vector<double>& Estimated,
+                            FitStatisticsOut& Stats)
+{
+    const int NumLanes = 4;
+    bool   retv = true;
+    int    j;
+    int    NumYears = RunLength+1;
+    const double* obs;
+    const double* est;
+    double shiftObs,shiftEst;
+    double diffObs,diffEst;
+    double diff,logRatio;
+    double sumObs[NumLanes],sumEst[NumLanes];
+    double sumSqObs[NumLanes],sumSqEst[NumLanes],sumObsEst[NumLanes];
+    double sumSqRes[NumLanes],sumAbsRes[NumLanes];
+    double totObs,totEst,totSqObs,totSqEst,totObsEst;
+    double sumSqResiduals,sumAbsResiduals,sumSqLogRatio;
+    double meanObs,meanEst;
+    double m2Obs,m2Est,coMoment;
+    double ssDeviations,ssTotals,den;
+
+    Stats = FitStatisticsOut();
+
+    if ((RunLength == 0) ||
+        (int(Observed.size())  < NumSpeciesOrGuilds*NumYears) ||
+        (int(Estimated.size()) < NumSpeciesOrGuilds*NumYears)) {
+        return false;
+    }
+
+    for (int i=0; i<NumSpeciesOrGuilds; ++i) {
+        obs = &Observed[i*NumYears];
+        est = &Estimated[i*NumYears];
+
+        // Sums are taken about the series' first values (the shifted data algorithm), which
+        // keeps the moments as stable as running means without a division per year. Each
+        // lane sums every NumLanes'th year so the lanes can be vectorized by the compiler.
+        shiftObs = obs[0];
+        shiftEst = est[0];
+        for (int k=0; k<NumLanes; ++k) {
+            sumObs[k]   = sumEst[k]   = 0;
+            sumSqObs[k] = sumSqEst[k] = sumObsEst[k] = 0;
+            sumSqRes[k] = sumAbsRes[k] = 0;
+        }
+        for (j=0; j+NumLanes<=NumYears; j+=NumLanes) {
+            for (int k=0; k<NumLanes; ++k) {
+                diffObs       = obs[j+k] - shiftObs;
+                diffEst       = est[j+k] - shiftEst;
+                diff          = est[j+k] - obs[j+k];
+                sumObs[k]    += diffObs;
+                sumEst[k]    += diffEst;
+                sumSqObs[k]  += diffObs*diffObs;
+                sumSqEst[k]  += diffEst*diffEst;
+                sumObsEst[k] += diffObs*diffEst;
+                sumSqRes[k]  += diff*diff;
+                sumAbsRes[k] += std::fabs(diff);
+            }
+        }
+        for (int k=0; j<NumYears; ++j,++k) {
+            diffObs       = obs[j] - shiftObs;
+            diffEst       = est[j] - shiftEst;
+            diff          = est[j] - obs[j];
+            sumObs[k]    += diffObs;
+            sumEst[k]    += diffEst;
+            sumSqObs[k]  += diffObs*diffObs;
+            sumSqEst[k]  += diffEst*diffEst;
+            sumObsEst[k] += diffObs*diffEst;
+            sumSqRes[k]  += diff*diff;
+            sumAbsRes[k] += std::fabs(diff);
+        }
+        totObs = totEst = totSqObs = totSqEst = totObsEst = 0;
+        sumSqResiduals = sumAbsResiduals = 0;
+        for (int k=0; k<NumLanes; ++k) {
+            totObs          += sumObs[k];
+            totEst          += sumEst[k];
+            totSqObs        += sumSqObs[k];
+            totSqEst        += sumSqEst[k];
+            totObsEst       += sumObsEst[k];
+            sumSqResiduals  += sumSqRes[k];
+            sumAbsResiduals += sumAbsRes[k];
+        }
+
+        // The log can't be vectorized, so it's kept out of the loop above
+        sumSqLogRatio = 0;
+        for (j=0; j<NumYears; ++j) {
+            logRatio       = std::log(obs[j]/est[j]);
+            sumSqLogRatio += logRatio*logRatio;
+        }
+
+        meanObs  = shiftObs + totObs/NumYears;
+        meanEst  = shiftEst + totEst/NumYears;
+        m2Obs    = totSqObs  - totObs*totObs/NumYears;
+        m2Est    = totSqEst  - totEst*totEst/NumYears;
+        coMoment = totObsEst - totObs*totEst/NumYears;
+
+        // Σ(Eₜ-Ō)² = Σ(Eₜ-Ē)² + n(Ē-Ō)²
+        ssDeviations = m2Est + NumYears*(meanEst-meanObs)*(meanEst-meanObs);
+        ssTotals     = ssDeviations + sumSqResiduals;
+        den          = std::sqrt(m2Obs*m2Est);
+
+        Stats.MeanObserved.push_back(meanObs);
+        Stats.MeanEstimated.push_back(meanEst);
+        Stats.SSResiduals.push_back(sumSqResiduals);
+        Stats.SSDeviations.push_back(ssDeviations);
+        Stats.SSTotals.push_back(ssTotals);
+        Stats.RSquared.push_back((ssTotals == 0) ? 0 : ssDeviations/ssTotals);
+        Stats.CorrelationCoeff.push_back((den == 0) ? 0 : coMoment/den);
+        Stats.AIC.push_back(NumYears*std::log(sumSqResiduals/NumYears) + 2*NumParameters);
+        Stats.RMSE.push_back(std::sqrt(sumSqResiduals/NumYears));
+        Stats.RI.push_back(std::exp(std::sqrt(sumSqLogRatio/NumYears)));
+        Stats.AE.push_back(meanEst-meanObs);
+        Stats.AAE.push_back(sumAbsResiduals/NumYears);
+        Stats.MEF.push_back((m2Obs == 0) ? 0 : (m2Obs-sumSqResiduals)/m2Obs);
+
+        if ((ssDeviations == 0) || (den == 0) || (m2Obs == 0)) {
+            retv = false;
+        }
+    }
+
+    return retv;
+}
+
 bool calculateMohnsRhoForParameter(
         const int& NumPeels,
         const int& NumSpecies,
@@ -783,51 +1116,38 @@ bool calculateMohnsRhoForTimeSeries(
         const std::vector<std::vector<double> >& TimeSeries,
         std::vector<double>& mohnsRhoValue)
 {
-    int PeelRunLength=0;
-    int num=0;
+    int RefNumYears;
+    int PeelNumYears;
     double den;
-    double value=0;
+    double value;
 
-    if ((TimeSeries.size() == 0) ||
-        (NumPeels < 1) ||
-        (NumSpecies == 0)) {
+    mohnsRhoValue.clear();
+    if ((NumPeels < 1) ||
+        (NumSpecies == 0) ||
+        (int(TimeSeries.size()) < NumPeels+1)) {
         return false;
     }
-std::cout << "Calculating Mohns Rho est biomass..." << std::endl;
-std::cout << "Time series: " << TimeSeries.size() << std::endl;
-for (unsigned i=0; i<TimeSeries.size(); ++i) {
-std::cout << "Time series sub sizes: " << TimeSeries[i].size() << std::endl;
-}
-    mohnsRhoValue.clear();
-/*
+
+    // Time series are organized from peel 0 (the full time series) to NumPeels, each
+    // one species after another. Each peel is compared to peel 0 in the peel's last year.
+    RefNumYears = TimeSeries[0].size()/NumSpecies;
     for (int species=0; species<NumSpecies; ++species) {
-        num = 0;
-        for (int peel=0; peel<=NumPeels-1; ++peel) {
-            PeelRunLength = TimeSeries[peel].size()/NumSpecies;
-            for (int i=0; i<PeelRunLength; ++i) {
-                den = TimeSeries[NumPeels-1][species*PeelRunLength+i];
-                value += (TimeSeries[peel][species*PeelRunLength+i] - den)/den;
-                ++num;
+        value = 0;
+        for (int peel=1; peel<=NumPeels; ++peel) {
+            PeelNumYears = TimeSeries[peel].size()/NumSpecies;
+            if ((PeelNumYears < 1) || (PeelNumYears > RefNumYears)) {
+                mohnsRhoValue.clear();
+                return false;
             }
-        }
-        value /= num;
-        mohnsRhoValue.push_back(value);
-    }
-std::cout << "den: " << den << ", species*PeelRunLength+i: " << species*PeelRunLength+i << std::endl;
-std::cout << "Species: " << species << ", value: " << value << ", num: " << num << std::endl;
-*/
-    for (int species=0; species<NumSpecies; ++species) {
-        num = 0;
-        for (int peel=NumPeels; peel>0; --peel) { // Ex. 3: 3,2,1; skip 0
-            PeelRunLength = TimeSeries[peel].size()/NumSpecies;
-            for (int i=0; i<PeelRunLength; ++i) {
-                den = TimeSeries[0][i];
-                value += (TimeSeries[peel][i] - den)/den;
-                ++num;
+            den = TimeSeries[0][species*RefNumYears+PeelNumYears-1];
+            if (den == 0) {
+                mohnsRhoValue.clear();
+                return false;
             }
-            value /= num;
-            mohnsRhoValue.push_back(value);
+            value += (TimeSeries[peel][species*PeelNumYears+PeelNumYears-1] - den)/den;
         }
+        value /= NumPeels;
+        mohnsRhoValue.push_back(value);
     }
 
     return true;
@@ -952,3 +1272,106 @@ double calculateSumOfSquares(const boost::numeric::ublas::matrix<double>& EstBio
 
 } // end namespace nmfStatUtils
 
+
+nmfQuantileSketch::nmfQuantileSketch(const double& relativeAccuracy)
+{
+    double alpha = std::min(std::max(relativeAccuracy,1.0e-6),0.5);
+
+    m_RelativeAccuracy = alpha;
+    m_LogGamma  = std::log((1.0+alpha)/(1.0-alpha));
+    m_Count     = 0;
+    m_ZeroCount = 0;
+    m_Min       =  std::numeric_limits<double>::infinity();
+    m_Max       = -std::numeric_limits<double>::infinity();
+}
+
+int
+nmfQuantileSketch::binIndex(const double& magnitude) const
+{
+    return int(std::ceil(std::log(magnitude)/m_LogGamma));
+}
+
+double
+nmfQuantileSketch::binValue(const int& index) const
+{
+    // Value within the bin with the smallest worst case relative error: 2γ^i/(γ+1)
+    double gamma = std::exp(m_LogGamma);
+    return 2.0*std::exp(index*m_LogGamma)/(gamma+1.0);
+}
+
+void
+nmfQuantileSketch::add(const double& value)
+{
+    if (std::isnan(value)) {
+        return;
+    }
+    if (std::fabs(value) < std::numeric_limits<double>::min()) {
+        ++m_ZeroCount;
+    } else if (value > 0) {
+        ++m_PositiveBins[binIndex(value)];
+    } else {
+        ++m_NegativeBins[binIndex(-value)];
+    }
+    m_Min = std::min(m_Min,value);
+    m_Max = std::max(m_Max,value);
+    ++m_Count;
+}
+
+bool
+nmfQuantileSketch::merge(const nmfQuantileSketch& sketch)
+{
+    if (sketch.m_RelativeAccuracy != m_RelativeAccuracy) {
+        std::cout << "Error nmfQuantileSketch::merge: Sketches have different accuracies" << std::endl;
+        return false;
+    }
+    for (const std::pair<const int,long>& bin : sketch.m_PositiveBins) {
+        m_PositiveBins[bin.first] += bin.second;
+    }
+    for (const std::pair<const int,long>& bin : sketch.m_NegativeBins) {
+        m_NegativeBins[bin.first] += bin.second;
+    }
+    m_ZeroCount += sketch.m_ZeroCount;
+    m_Count     += sketch.m_Count;
+    m_Min = std::min(m_Min,sketch.m_Min);
+    m_Max = std::max(m_Max,sketch.m_Max);
+    return true;
+}
+
+double
+nmfQuantileSketch::quantile(const double& quantile) const
+{
+    long rank;
+    long cumulative = 0;
+    double q = std::min(std::max(quantile,0.0),1.0);
+
+    if (m_Count == 0) {
+        return 0;
+    }
+    if (q == 0) {
+        return m_Min;
+    }
+    if (q == 1) {
+        return m_Max;
+    }
+    rank = long(q*(m_Count-1));
+
+    // Walk the bins from the most negative to the most positive value
+    for (std::map<int,long>::const_reverse_iterator bin = m_NegativeBins.rbegin();
+         bin != m_NegativeBins.rend(); ++bin) {
+        cumulative += bin->second;
+        if (cumulative > rank) {
+            return std::min(m_Max,std::max(m_Min,-binValue(bin->first)));
+        }
+    }
+    cumulative += m_ZeroCount;
+    if (cumulative > rank) {
+        return 0;
+    }
+    for (const std::pair<const int,long>& bin : m_PositiveBins) {
+        cumulative += bin.second;
+        if (cumulative > rank) {
+            return std::min(m_Max,std::max(m_Min,binValue(bin.first)));
+        }
+    }
+    return m_Max;
+}
@@ -8,6 +8,7 @@
 
 #include <iomanip>
 #include <iostream>
+#include <limits>
 #include <map>
 #include <math.h>
 #include <string>
@@ -62,6 +63,79 @@ struct LinRegOut {
     int    N;       // Holds sample size
 };
 
+/**
+ * @brief Holds goodness of fit statistics per species or guild, as
+ * calculated in a single pass by calculateFitStatistics
+ */
+struct FitStatisticsOut {
+    std::vector<double> MeanObserved;     // Ō
+    std::vector<double> MeanEstimated;    // Ē
+    std::vector<double> SSResiduals;      // Σ(Oₜ-Eₜ)²
+    std::vector<double> SSDeviations;     // Σ(Eₜ-Ō)²
+    std::vector<double> SSTotals;         // SSResiduals + SSDeviations
+    std::vector<double> RSquared;         // SSDeviations/SSTotals
+    std::vector<double> CorrelationCoeff; // R
+    std::vector<double> AIC;              // n*ln(SSResiduals/n) + 2*K
+    std::vector<double> RMSE;             // sqrt{(Σ(Eₜ-Oₜ)²)/n}
+    std::vector<double> RI;               // exp[sqrt{(1/n)Σ([log(Oₜ/Eₜ)]²)}]
+    std::vector<double> AE;               // Ē-Ō
+    std::vector<double> AAE;              // Σ|Eₜ-Oₜ| / n
+    std::vector<double> MEF;              // [Σ(Oₜ-Ō)²-Σ(Eₜ-Oₜ)²] / Σ(Oₜ-Ō)²
+};
+
+/**
+ * @brief Streaming quantile sketch with a guaranteed relative accuracy. Values are
+ * counted in logarithmically spaced bins (bin i holds values in (γ^(i-1),γ^i], with
+ * γ = (1+α)/(1-α)), so any quantile is returned to within a relative error α of a value
+ * of that rank. Two sketches with the same accuracy merge by adding their bin counts,
+ * which makes the result independent of the order the values were added in, so
+ * sketches filled on different threads can be combined deterministically.
+ */
+class nmfQuantileSketch {
+
+private:
+    double m_RelativeAccuracy;
+    double m_LogGamma;
+    long   m_Count;
+    long   m_ZeroCount;
+    double m_Min;
+    double m_Max;
+    std::map<int,long> m_PositiveBins;
+    std::map<int,long> m_NegativeBins; // binned by magnitude
+
+    int    binIndex(const double& magnitude) const;
+    double binValue(const int& index) const;
+
+public:
+    /**
+     * @brief Creates an empty sketch
+     * @param relativeAccuracy : relative accuracy α of the returned quantiles (0 < α < 1)
+     */
+    nmfQuantileSketch(const double& relativeAccuracy=0.01);
+   ~nmfQuantileSketch() {}
+
+    /**
+     * @brief Adds a value to the sketch (NaN values are ignored)
+     * @param value : value to add
+     */
+    void add(const double& value);
+    /**
+     * @brief Adds the counts of another sketch with the same accuracy to this one
+     * @param sketch : sketch to merge in
+     * @return True if merged, False if the accuracies differ
+     */
+    bool merge(const nmfQuantileSketch& sketch);
+    /**
+     * @brief Returns the approximate value at the given quantile
+     * @param quantile : quantile of interest, from 0 to 1
+     * @return The value at the quantile (0 if the sketch is empty)
+     */
+    double quantile(const double& quantile) const;
+    long   count() const { return m_Count; }
+    double min()   const { return m_Min;   }
+    double max()   const { return m_Max;   }
+};
+
 namespace nmfUtilsStatistics {
 
 
@@ -71,6 +145,35 @@ namespace nmfUtilsStatistics {
 
     double BETAFUNC(double A, double B);
 
+    /**
+     * @brief Batched version of BetaCF. The continued fraction is evaluated for all
+     * (A,B,X) lanes together in structure of arrays form so the inner loops can be
+     * vectorized by the compiler. Each lane stops updating once it has converged and
+     * the iteration stops once all lanes have converged. As with BetaCF, a lane that
+     * hasn't converged after the maximum number of iterations holds its last iterate.
+     * @param A : first beta parameter per lane
+     * @param B : second beta parameter per lane
+     * @param X : x value per lane
+     * @param values : continued fraction value per lane
+     * @return False if any lane reached the maximum number of iterations, else True
+     */
+    bool BetaCFBatch(const std::vector<double>& A,
+                     const std::vector<double>& B,
+                     const std::vector<double>& X,
+                     std::vector<double>& values);
+    /**
+     * @brief Batched version of BetaI, the incomplete beta function Iₓ(A,B)
+     * @param A : first beta parameter per lane
+     * @param B : second beta parameter per lane
+     * @param X : x value per lane
+     * @param values : incomplete beta function value per lane
+     * @return False if any lane's continued fraction didn't converge, else True
+     */
+    bool BetaIBatch(const std::vector<double>& A,
+                    const std::vector<double>& B,
+                    const std::vector<double>& X,
+                    std::vector<double>& values);
+
     /**
      * @brief Calculates the average absolute error: Σ|Eₜ-Oₜ| / n
      * @param numSpeciesOrGuilds : the number of either species or guilds
@@ -111,6 +214,41 @@ namespace nmfUtilsStatistics {
                       const int& runLength,
                       const std::vector<double>& ssResiduals,
                       std::vector<double>& aic);
+    /**
+     * @brief Calculates Akaike Info Criterion as above for series with missing observations,
+     * where n is the number of observations each series' residuals are over
+     * @param numSpeciesOrGuilds : the number of either species or guilds
+     * @param numParameters : number of parameters
+     * @param numObservations : number of observations per species or guild
+     * @param ssResiduals : sum of square residuals per species or guild
+     * @param aic : Akaika Info Criterion per species or guild
+     */
+    void calculateAIC(const int& numSpeciesOrGuilds,
+                      const int& numParameters,
+                      const std::vector<int>& numObservations,
+                      const std::vector<double>& ssResiduals,
+                      std::vector<double>& aic);
+    /**
+     * @brief Calculates all of the goodness of fit statistics (SSResiduals, SSDeviations,
+     * SSTotals, RSquared, R, AIC, RMSE, RI, AE, AAE, MEF) for every species or guild in
+     * a single vectorizable pass over each one's data. The means and sums of squares are
+     * accumulated about the series' first values (shifted data), so no intermediate mean
+     * pass is required. Only the log ratios for RI are summed in a second, scalar loop.
+     * @param numSpeciesOrGuilds : the number of either species or guilds
+     * @param numParameters : number of parameters (used in the AIC calculation)
+     * @param runLength : time period in years
+     * @param observed : observed biomass
+     * @param estimated : estimated biomass
+     * @param fitStatistics : struct containing all statistics per species or guild
+     * @return True if no error, else False (i.e., a statistic's denominator was 0); statistics
+     * that can't be calculated are set to 0
+     */
+    bool calculateFitStatistics(const int& numSpeciesOrGuilds,
+                                const int& numParameters,
+                                const int& runLength,
+                                const std::vector<double>& observed,
+                                const std::vector<double>& estimated,
+                                FitStatisticsOut& fitStatistics);
     /**
      * @brief Calculates the negative log maximum likelihood value
      * where (e)stimated, (o)bserved, and (m)ean (B)iomass
@@ -171,13 +309,15 @@ namespace nmfUtilsStatistics {
                                        const std::vector<double>& estParameter,
                                        std::vector<double>& mohnsRhoValue);
     /**
-     * @brief Calculates the Mohns Rho values for the given time series
+     * @brief Calculates the Mohns Rho values for the given time series, the mean over the
+     * peels of (X_peel(T) - X_0(T)) / X_0(T) where T is the peel's last year
      * @param numPeels : number of peels, where a peel is defined as a
      * year range which is 1 year less than the previous
      * @param numSpecies : number of species
-     * @param timeSeries : time series to calculate Mohns rho values for
+     * @param timeSeries : time series to calculate Mohns rho values for, by peel from
+     * peel 0 (the full time series) to numPeels, each one species after another
      * @param mohnsRhoValue : Mohns Rho value per species
-     * @return True if no error found, else False
+     * @return True if no error found, else False (i.e., a peel 0 value was 0)
      */
     bool calculateMohnsRhoForTimeSeries(
             const int& numPeels,
@@ -301,6 +441,14 @@ namespace nmfUtilsStatistics {
 
     double GAMMLN(double XX);
 
+    /**
+     * @brief Same as GAMMLN but values for integer and half integer arguments (i.e., the
+     * degrees of freedom / 2 used in ProbF and ProbT) are looked up in a table built once
+     * @param XX : value to find the log gamma of
+     * @return The log gamma value
+     */
+    double GAMMLNCached(double XX);
+
     /**
      * @brief This is a public procedure to calculate linear regression coefficients
      * and significance tests.  Results are output to a publicly declared variable
@@ -324,9 +472,40 @@ namespace nmfUtilsStatistics {
     double ProbT(double T,
                  int DF);
 
+    /**
+     * @brief Batched version of ProbF
+     * @param F : F ratio per lane
+     * @param DF1 : numerator degrees of freedom per lane
+     * @param DF2 : denominator degrees of freedom per lane
+     * @param probF : probability per lane
+     */
+    void ProbFBatch(const std::vector<double>& F,
+                    const std::vector<int>& DF1,
+                    const std::vector<int>& DF2,
+                    std::vector<double>& probF);
+    /**
+     * @brief Batched version of ProbT
+     * @param T : t value per lane
+     * @param DF : degrees of freedom per lane
+     * @param probT : probability per lane
+     */
+    void ProbTBatch(const std::vector<double>& T,
+                    const std::vector<int>& DF,
+                    std::vector<double>& probT);
+
+    /**
+     * @brief Fits the Shepherd stock recruitment curve using the Complex maximization
+     * @param Data : spawning stock biomass and recruits per year
+     * @param NYears : number of years of data
+     * @param NLOut : the fitted parameters and regression statistics
+     * @param NumStarts : if > 1, the number of concurrent seeded Complex starts to run, keeping the best fit
+     * @param Seed : seed for the multi-start random numbers (if < 0, the current time is used)
+     */
     void ShepSRR(boost::numeric::ublas::matrix<double> &Data,
                  int &NYears,
-                 NLRegOut &NLOut);
+                 NLRegOut &NLOut,
+                 const int &NumStarts=1,
+                 const int &Seed=-1);
 
     /**
      * @brief Calculates the sums of squares against the actual data and
@@ -2,8 +2,128 @@
 #include "nmfConstants.h"
 #include "nmfUtilsStatisticsAveraging.h"
 
+nmfUtilsRunningMoments::nmfUtilsRunningMoments()
+{
+    clear();
+}
+
+void
+nmfUtilsRunningMoments::clear()
+{
+    m_Count        = 0;
+    m_MaxLogWeight = 0;
+    m_SumWeights   = 0;
+    m_Mean.clear();
+    m_M2.clear();
+    m_WeightedMean.clear();
+    m_WeightedM2.clear();
+}
+
+void
+nmfUtilsRunningMoments::add(const std::vector<double>& values,
+                            const double& aic)
+{
+    int numValues = values.size();
+    double delta;
+    double weight;
+    double scale;
+    double logWeight = -0.5*aic;
+
+    if (m_Count == 0) {
+        m_Mean.assign(numValues,0);
+        m_M2.assign(numValues,0);
+        m_WeightedMean.assign(numValues,0);
+        m_WeightedM2.assign(numValues,0);
+        m_MaxLogWeight = logWeight;
+    } else if (numValues != int(m_Mean.size())) {
+        std::cout << "Error nmfUtilsRunningMoments::add: Found " << numValues <<
+                     " values, expected " << m_Mean.size() << std::endl;
+        return;
+    }
+    ++m_Count;
+
+    // Weights are stored relative to the largest weight, so if this run's weight is
+    // the new largest, rescale what's been accumulated so far.
+    if (logWeight > m_MaxLogWeight) {
+        scale = std::exp(m_MaxLogWeight-logWeight);
+        m_SumWeights *= scale;
+        for (int i=0; i<numValues; ++i) {
+            m_WeightedM2[i] *= scale;
+        }
+        m_MaxLogWeight = logWeight;
+    }
+    weight = std::exp(logWeight-m_MaxLogWeight);
+    m_SumWeights += weight;
+
+    for (int i=0; i<numValues; ++i) {
+        // Welford
+        delta      = values[i] - m_Mean[i];
+        m_Mean[i] += delta/m_Count;
+        m_M2[i]   += delta*(values[i]-m_Mean[i]);
+
+        // West
+        if (m_SumWeights > 0) {
+            delta              = values[i] - m_WeightedMean[i];
+            m_WeightedMean[i] += (weight/m_SumWeights)*delta;
+            m_WeightedM2[i]   += weight*delta*(values[i]-m_WeightedMean[i]);
+        }
+    }
+}
+
+int
+nmfUtilsRunningMoments::count() const
+{
+    return m_Count;
+}
+
+const std::vector<double>&
+nmfUtilsRunningMoments::mean() const
+{
+    return m_Mean;
+}
+
+const std::vector<double>&
+nmfUtilsRunningMoments::weightedMean() const
+{
+    return m_WeightedMean;
+}
+
+void
+nmfUtilsRunningMoments::variance(std::vector<double>& variance) const
+{
+    variance.assign(m_M2.size(),0);
+    if (m_Count > 0) {
+        for (unsigned i=0; i<m_M2.size(); ++i) {
+            variance[i] = m_M2[i]/m_Count;
+        }
+    }
+}
+
+void
+nmfUtilsRunningMoments::weightedVariance(std::vector<double>& variance) const
+{
+    variance.assign(m_WeightedM2.size(),0);
+    if (m_SumWeights > 0) {
+        for (unsigned i=0; i<m_WeightedM2.size(); ++i) {
+            variance[i] = m_WeightedM2[i]/m_SumWeights;
+        }
+    }
+}
+
+
 nmfUtilsStatisticsAveraging::nmfUtilsStatisticsAveraging()
 {
+    m_IsStreaming                = false;
+    m_StreamNumberOfTopRunsToUse = 100;
+    m_StreamIsPercent            = true;
+    m_StreamTotalNumberOfRuns    = 0;
+    m_StreamMaxRunsHeld          = 1000;
+    m_StreamAICQuantile          = 1.0;
+    m_StreamNumRuns              = 0;
+    m_StreamFitnessSum           = 0;
+    m_StreamFitnessMin           = 0;
+    m_StreamFitnessMax           = 0;
+
     clearEstData();
     clearTrimmedData();
     clearAveragedData();
@@ -65,6 +185,131 @@ nmfUtilsStatisticsAveraging::clearTrimmedData()
     m_EstCompetitionBetaSpecies_trimmed.clear();
     m_EstCompetitionBetaGuilds_trimmed.clear();
     m_EstCompetitionBetaGuildsGuilds_trimmed.clear();
+    m_EstCatchability_trimmed.clear();
+    m_EstSurveyQ_trimmed.clear();
+    m_EstBiomass_trimmed.clear();
+}
+
+void
+nmfUtilsStatisticsAveraging::setStreaming(const int& numberOfTopRunsToUse,
+                                          const bool& isPercent,
+                                          const int& totalNumberOfRuns,
+                                          const int& maxRunsHeld)
+{
+    m_IsStreaming                = true;
+    m_StreamNumberOfTopRunsToUse = numberOfTopRunsToUse;
+    m_StreamIsPercent            = isPercent;
+    m_StreamTotalNumberOfRuns    = totalNumberOfRuns;
+    m_StreamMaxRunsHeld          = std::max(maxRunsHeld,1);
+    m_StreamNumRuns              = 0;
+    m_StreamFitnessSum           = 0;
+    m_StreamFitnessMin           = 0;
+    m_StreamFitnessMax           = 0;
+    m_StreamFitnessMedian        = nmfQuantileSketch(0.001);
+    m_StreamBestFitness.clear();
+    m_Fitness.clear();
+    m_StreamVectorSizes.clear();
+    m_StreamMatrixShapes.clear();
+    m_StreamMoments.clear();
+    m_StreamAICSketch   = nmfQuantileSketch(0.001);
+    m_StreamAICQuantile = numberOfTopRunsToUse/100.0;
+    m_StreamTopRuns.clear();
+    m_StreamVariance.clear();
+}
+
+int
+nmfUtilsStatisticsAveraging::getStreamNumberOfTopRuns()
+{
+    int numTopRuns;
+
+    // Returns -1 if all runs are used, 0 if the runs to keep must be chosen by the AIC
+    // sketch (the total isn't known or the percent would hold too many runs)
+    if (m_StreamNumberOfTopRunsToUse == 100) {
+        return -1;
+    } else if (! m_StreamIsPercent) {
+        return m_StreamNumberOfTopRunsToUse;
+    } else if (m_StreamTotalNumberOfRuns > 0) {
+        numTopRuns = std::max(1,int(m_StreamTotalNumberOfRuns*(m_StreamNumberOfTopRunsToUse/100.0)));
+        return (numTopRuns <= m_StreamMaxRunsHeld) ? numTopRuns : 0;
+    }
+    return 0;
+}
+
+void
+nmfUtilsStatisticsAveraging::flattenEstData(
+        std::vector<double>& flat,
+        const std::vector<const std::vector<double>* >& vectors,
+        const std::vector<const boost::numeric::ublas::matrix<double>* >& matrices)
+{
+    int size;
+    int numRows;
+    int numCols;
+    bool isFirstRun = m_StreamVectorSizes.empty() && m_StreamMatrixShapes.empty();
+
+    // The shapes are taken from the first run. As in calculateWeighted, all vectors are
+    // sized by the first vector (the number of species) and any vector or matrix with a
+    // different shape is zero padded (or truncated) to match.
+    if (isFirstRun) {
+        for (unsigned i=0; i<vectors.size(); ++i) {
+            m_StreamVectorSizes.push_back(vectors[0]->size());
+        }
+        for (const boost::numeric::ublas::matrix<double>* mat : matrices) {
+            m_StreamMatrixShapes.push_back(std::make_pair(int(mat->size1()),int(mat->size2())));
+        }
+    }
+
+    flat.clear();
+    for (unsigned i=0; i<vectors.size(); ++i) {
+        size = m_StreamVectorSizes[i];
+        for (int j=0; j<size; ++j) {
+            flat.push_back((j < int(vectors[i]->size())) ? (*vectors[i])[j] : 0.0);
+        }
+    }
+    for (unsigned i=0; i<matrices.size(); ++i) {
+        numRows = m_StreamMatrixShapes[i].first;
+        numCols = m_StreamMatrixShapes[i].second;
+        for (int row=0; row<numRows; ++row) {
+            for (int col=0; col<numCols; ++col) {
+                flat.push_back(((row < int(matrices[i]->size1())) && (col < int(matrices[i]->size2()))) ?
+                                (*matrices[i])(row,col) : 0.0);
+            }
+        }
+    }
+}
+
+void
+nmfUtilsStatisticsAveraging::unflattenEstData(
+        const std::vector<double>& flat,
+        const std::vector<std::vector<double>* >& vectors,
+        const std::vector<boost::numeric::ublas::matrix<double>* >& matrices)
+{
+    int m = 0;
+    int numRows;
+    int numCols;
+
+    for (unsigned i=0; i<vectors.size(); ++i) {
+        vectors[i]->clear();
+        if (flat.empty()) {
+            continue;
+        }
+        for (int j=0; j<m_StreamVectorSizes[i]; ++j) {
+            vectors[i]->push_back(flat[m++]);
+        }
+    }
+    for (unsigned i=0; i<matrices.size(); ++i) {
+        if (flat.empty()) {
+            matrices[i]->clear();
+            continue;
+        }
+        numRows = m_StreamMatrixShapes[i].first;
+        numCols = m_StreamMatrixShapes[i].second;
+        nmfUtils::initialize(*matrices[i],numRows,numCols);
+        for (int row=0; row<numRows; ++row) {
+            for (int col=0; col<numCols; ++col) {
+                (*matrices[i])(row,col) = flat[m++];
+            }
+        }
+    }
 }
 
 void
@@ -85,6 +330,60 @@ nmfUtilsStatisticsAveraging::loadEstData(
         boost::numeric::ublas::matrix<double>& EstPredationHandling,
         boost::numeric::ublas::matrix<double>& EstBiomass)
 {
+    if (m_IsStreaming) {
+        int numTopRuns = getStreamNumberOfTopRuns();
+        double aic = AIC.back();
+        std::vector<double> flat;
+        auto compareAIC = [](const std::pair<double,std::vector<double> >& lhs,
+                             const std::pair<double,std::vector<double> >& rhs) {
+            return (lhs.first < rhs.first);
+        };
+
+        // Fitness statistics, and the best fitness values with their run numbers
+        m_StreamFitnessSum += Fitness;
+        m_StreamFitnessMin  = (m_StreamNumRuns == 0) ? Fitness : std::min(m_StreamFitnessMin,Fitness);
+        m_StreamFitnessMax  = (m_StreamNumRuns == 0) ? Fitness : std::max(m_StreamFitnessMax,Fitness);
+        m_StreamFitnessMedian.add(Fitness);
+        if (int(m_StreamBestFitness.size()) < m_StreamMaxRunsHeld) {
+            m_StreamBestFitness.push_back(std::make_pair(Fitness,m_StreamNumRuns));
+            std::push_heap(m_StreamBestFitness.begin(),m_StreamBestFitness.end());
+        } else if (Fitness < m_StreamBestFitness.front().first) {
+            std::pop_heap(m_StreamBestFitness.begin(),m_StreamBestFitness.end());
+            m_StreamBestFitness.back() = std::make_pair(Fitness,m_StreamNumRuns);
+            std::push_heap(m_StreamBestFitness.begin(),m_StreamBestFitness.end());
+        }
+        ++m_StreamNumRuns;
+
+        flattenEstData(flat,
+                       {&EstInitBiomass,&EstGrowthRates,&EstCarryingCapacities,
+                        &EstPredationExponent,&EstCatchability,&EstSurveyQ},
+                       {&EstCompetitionAlpha,&EstCompetitionBetaSpecies,&EstCompetitionBetaGuilds,
+                        &EstCompetitionBetaGuildsGuilds,&EstPredationRho,&EstPredationHandling,
+                        &EstBiomass});
+        if (numTopRuns < 0) {
+            // Using all runs, so just merge this one
+            m_StreamMoments.add(flat,aic);
+        } else if (numTopRuns > 0) {
+            // Keep only the best (i.e., lowest AIC) numTopRuns runs
+            if (int(m_StreamTopRuns.size()) < numTopRuns) {
+                m_StreamTopRuns.push_back(std::make_pair(aic,flat));
+                std::push_heap(m_StreamTopRuns.begin(),m_StreamTopRuns.end(),compareAIC);
+            } else if (aic < m_StreamTopRuns.front().first) {
+                std::pop_heap(m_StreamTopRuns.begin(),m_StreamTopRuns.end(),compareAIC);
+                m_StreamTopRuns.back() = std::make_pair(aic,flat);
+                std::push_heap(m_StreamTopRuns.begin(),m_StreamTopRuns.end(),compareAIC);
+            }
+        } else {
+            // Total number of runs isn't known, so admit runs whose AIC is within
+            // the running estimate of the requested AIC percentile
+            m_StreamAICSketch.add(aic);
+            if (aic <= m_StreamAICSketch.quantile(m_StreamAICQuantile)) {
+                m_StreamMoments.add(flat,aic);
+            }
+        }
+        return;
+    }
+
     m_Fitness.push_back(Fitness);
     m_AIC.push_back(AIC.back()); // Store only the last element of AIC (it's the model average over all species for that particular run)
     m_EstInitBiomass.push_back(EstInitBiomass);
@@ -119,7 +418,17 @@ nmfUtilsStatisticsAveraging::getAveData(std::vector<double>& Fitness,
                                         boost::numeric::ublas::matrix<double>& AvePredationHandling,
                                         boost::numeric::ublas::matrix<double>& AveBiomass)
 {
-    Fitness                   = m_Fitness;
+    // In streaming mode only the best fitness values are kept, so return those, best first
+    if (m_IsStreaming) {
+        std::vector<std::pair<double,int> > best = m_StreamBestFitness;
+        std::sort_heap(best.begin(),best.end());
+        Fitness.clear();
+        for (const std::pair<double,int>& run : best) {
+            Fitness.push_back(run.first);
+        }
+    } else {
+        Fitness = m_Fitness;
+    }
     AveInitBiomass            = m_AveInitBiomass;
     AveGrowthRates            = m_AveGrowthRates;
     AveCarryingCapacities     = m_AveCarryingCapacities;
@@ -142,24 +451,27 @@ nmfUtilsStatisticsAveraging::calculateWeighted(const std::vector<double>& weight
     int numCols;
     int NumRuns    = m_EstInitBiomass_trimmed.size();
     int NumSpecies = m_EstInitBiomass_trimmed[0].size();
-    int index=0;
     double sum;
-    std::vector<std::vector<double> > aveVector = {m_AveInitBiomass,
-                                                   m_AveGrowthRates,
-                                                   m_AveCarryingCapacities,
-                                                   m_AvePredationExponent,
-                                                   m_AveCatchability,
-                                                   m_AveSurveyQ};
+
     clearAveragedData();
 
-    // Find averages for all vector estimated parameters
-    for (std::vector<std::vector<double> > estVector : {m_EstInitBiomass_trimmed,
-                                                        m_EstGrowthRates_trimmed,
-                                                        m_EstCarryingCapacities_trimmed,
-                                                        m_EstPredationExponent_trimmed,
-                                                        m_EstCatchability_trimmed,
-                                                        m_EstSurveyQ_trimmed})
-    {
+    // Find averages for all vector estimated parameters. The est and ave lists must be in the same order.
+    std::vector<std::vector<double>* > aveVectors = {
+         &m_AveInitBiomass,
+         &m_AveGrowthRates,
+         &m_AveCarryingCapacities,
+         &m_AvePredationExponent,
+         &m_AveCatchability,
+         &m_AveSurveyQ};
+    std::vector<const std::vector<std::vector<double> >* > estVectors = {
+         &m_EstInitBiomass_trimmed,
+         &m_EstGrowthRates_trimmed,
+         &m_EstCarryingCapacities_trimmed,
+         &m_EstPredationExponent_trimmed,
+         &m_EstCatchability_trimmed,
+         &m_EstSurveyQ_trimmed};
+    for (unsigned index=0; index<estVectors.size(); ++index) {
+        const std::vector<std::vector<double> >& estVector = *estVectors[index];
         for (int species=0; species<NumSpecies; ++species) {
             sum = 0;
             for (int run=0; run<NumRuns; ++run) {
@@ -169,57 +481,127 @@ nmfUtilsStatisticsAveraging::calculateWeighted(const std::vector<double>& weight
                     sum = 0;
                 }
             }
-            aveVector[index].push_back(sum);
+            aveVectors[index]->push_back(sum);
         }
-        ++index;
     }
-    m_AveInitBiomass        = aveVector[0];
-    m_AveGrowthRates        = aveVector[1];
-    m_AveCarryingCapacities = aveVector[2];
-    m_AvePredationExponent  = aveVector[3];
-    m_AveCatchability       = aveVector[4];
-    m_AveSurveyQ            = aveVector[5];
 
     // Find averages for all matrix estimated parameters
-    index = 0;
-    std::vector< boost::numeric::ublas::matrix<double> > aveMatrix =
-        {m_AveCompetitionAlpha,
-         m_AveCompetitionBetaSpecies,
-         m_AveCompetitionBetaGuilds,
-         m_AveCompetitionBetaGuildsGuilds,
-         m_AvePredationRho,
-         m_AvePredationHandling,
-         m_AveBiomass};
-    for (std::vector<boost::numeric::ublas::matrix<double> > estMatrix : {
-         m_EstCompetitionAlpha_trimmed,
-         m_EstCompetitionBetaGuildsGuilds_trimmed,
-         m_EstCompetitionBetaSpecies_trimmed,
-         m_EstCompetitionBetaGuilds_trimmed,
-         m_EstPredationRho_trimmed,
-         m_EstPredationHandling_trimmed,
-         m_EstBiomass_trimmed})
-    {
+    std::vector<boost::numeric::ublas::matrix<double>* > aveMatrices = {
+         &m_AveCompetitionAlpha,
+         &m_AveCompetitionBetaSpecies,
+         &m_AveCompetitionBetaGuilds,
+         &m_AveCompetitionBetaGuildsGuilds,
+         &m_AvePredationRho,
+         &m_AvePredationHandling,
+         &m_AveBiomass};
+    std::vector<const std::vector<boost::numeric::ublas::matrix<double> >* > estMatrices = {
+         &m_EstCompetitionAlpha_trimmed,
+         &m_EstCompetitionBetaSpecies_trimmed,
+         &m_EstCompetitionBetaGuilds_trimmed,
+         &m_EstCompetitionBetaGuildsGuilds_trimmed,
+         &m_EstPredationRho_trimmed,
+         &m_EstPredationHandling_trimmed,
+         &m_EstBiomass_trimmed};
+    for (unsigned index=0; index<estMatrices.size(); ++index) {
+        const std::vector<boost::numeric::ublas::matrix<double> >& estMatrix = *estMatrices[index];
         numRows = estMatrix[0].size1(); // OK to use 0 since all matrices of same type
         numCols = estMatrix[0].size2(); // have the same dimensions
-        nmfUtils::initialize(aveMatrix[index],numRows,numCols);
+        nmfUtils::initialize(*aveMatrices[index],numRows,numCols);
         for (int time=0; time<numRows; ++time) {
             for (int species=0; species<numCols; ++species) {
                 sum = 0;
                 for (int run=0; run<NumRuns; ++run) {
                     sum += estMatrix[run](time,species) * weights[run];
                 }
-                aveMatrix[index](time,species) = sum;
+                (*aveMatrices[index])(time,species) = sum;
             }
         }
-        ++index;
     }
-    m_AveCompetitionAlpha            = aveMatrix[0];
-    m_AveCompetitionBetaSpecies      = aveMatrix[1];
-    m_AveCompetitionBetaGuilds       = aveMatrix[2];
-    m_AveCompetitionBetaGuildsGuilds = aveMatrix[3];
-    m_AvePredationRho                = aveMatrix[4];
-    m_AvePredationHandling           = aveMatrix[5];
-    m_AveBiomass                     = aveMatrix[6];
+}
+
+void
+nmfUtilsStatisticsAveraging::calculateStreamingAverage(const QString& averagingAlgorithm)
+{
+    nmfUtilsRunningMoments topRunsMoments;
+    const nmfUtilsRunningMoments* moments = &m_StreamMoments;
+    bool isAICWeighted = (averagingAlgorithm == "AIC Weighted");
+
+    if (m_FunctionMap.find(averagingAlgorithm) == m_FunctionMap.end()) {
+        std::cout << "Error nmfUtilsStatisticsAveraging::calculateStreamingAverage: Unknown averaging algorithm: " <<
+                     averagingAlgorithm.toStdString() << std::endl;
+        return;
+    }
+
+    // If holding the top runs, merge them now (in AIC order so the result is reproducible)
+    if (! m_StreamTopRuns.empty()) {
+        std::vector<int> order;
+        nmfUtils::partialSortIndices(m_StreamTopRuns,m_StreamTopRuns.size(),order,
+                                     [](const std::pair<double,std::vector<double> >& lhs,
+                                        const std::pair<double,std::vector<double> >& rhs) {
+            return (lhs.first < rhs.first);
+        });
+        for (int i : order) {
+            topRunsMoments.add(m_StreamTopRuns[i].second,m_StreamTopRuns[i].first);
+        }
+        moments = &topRunsMoments;
+    }
+
+    clearAveragedData();
+    m_StreamVariance.clear();
+    if (moments->count() == 0) {
+        std::cout << "Error nmfUtilsStatisticsAveraging::calculateStreamingAverage: No runs found" << std::endl;
+        return;
+    }
+
+    unflattenEstData((isAICWeighted) ? moments->weightedMean() : moments->mean(),
+                     {&m_AveInitBiomass,&m_AveGrowthRates,&m_AveCarryingCapacities,
+                      &m_AvePredationExponent,&m_AveCatchability,&m_AveSurveyQ},
+                     {&m_AveCompetitionAlpha,&m_AveCompetitionBetaSpecies,&m_AveCompetitionBetaGuilds,
+                      &m_AveCompetitionBetaGuildsGuilds,&m_AvePredationRho,&m_AvePredationHandling,
+                      &m_AveBiomass});
+    if (isAICWeighted) {
+        moments->weightedVariance(m_StreamVariance);
+    } else {
+        moments->variance(m_StreamVariance);
+    }
+}
+
+void
+nmfUtilsStatisticsAveraging::getStreamFitnessSummary(int& NumRuns,
+                                                     double& Mean,
+                                                     double& Min,
+                                                     double& Median,
+                                                     double& Max) const
+{
+    NumRuns = m_StreamNumRuns;
+    Mean    = (m_StreamNumRuns > 0) ? m_StreamFitnessSum/m_StreamNumRuns : 0;
+    Min     = m_StreamFitnessMin;
+    Median  = m_StreamFitnessMedian.quantile(0.5);
+    Max     = m_StreamFitnessMax;
+}
+
+void
+nmfUtilsStatisticsAveraging::getVarianceData(
+        std::vector<double>& VarInitBiomass,
+        std::vector<double>& VarGrowthRates,
+        std::vector<double>& VarCarryingCapacities,
+        std::vector<double>& VarPredationExponent,
+        std::vector<double>& VarCatchability,
+        std::vector<double>& VarSurveyQ,
+        boost::numeric::ublas::matrix<double>& VarCompetitionAlpha,
+        boost::numeric::ublas::matrix<double>& VarCompetitionBetaSpecies,
+        boost::numeric::ublas::matrix<double>& VarCompetitionBetaGuilds,
+        boost::numeric::ublas::matrix<double>& VarCompetitionBetaGuildsGuilds,
+        boost::numeric::ublas::matrix<double>& VarPredationRho,
+        boost::numeric::ublas::matrix<double>& VarPredationHandling,
+        boost::numeric::ublas::matrix<double>& VarBiomass)
+{
+    unflattenEstData(m_StreamVariance,
+                     {&VarInitBiomass,&VarGrowthRates,&VarCarryingCapacities,
+                      &VarPredationExponent,&VarCatchability,&VarSurveyQ},
+                     {&VarCompetitionAlpha,&VarCompetitionBetaSpecies,&VarCompetitionBetaGuilds,
+                      &VarCompetitionBetaGuildsGuilds,&VarPredationRho,&VarPredationHandling,
+                      &VarBiomass});
 }
 
 
@@ -228,6 +610,12 @@ nmfUtilsStatisticsAveraging::calculateAverage(const int& numberOfTopRunsToUse,
                                               const bool& isPercent,
                                               const QString& averagingAlgorithm)
 {
+    // In streaming mode the runs have already been merged (and trimmed) as they were loaded
+    if (m_IsStreaming) {
+        calculateStreamingAverage(averagingAlgorithm);
+        return;
+    }
+
     // Need to trim vectors and matrices to include only the top n as specified by the following arguments
     bool ok = createTrimmedStructures(numberOfTopRunsToUse,isPercent);
 
@@ -269,28 +657,13 @@ std::cout << "==> Num Runs: " << NumRuns << std::endl;
             NumRuns_trimmed = NumRuns*(numberOfTopRunsToUse/100.0);
         }
 std::cout << "==> Num Runs Trimmed: " << NumRuns_trimmed << std::endl;
-        // Go through the fitness vector and keep the top NumRuns_trimmed runs
-        // Copy the list and then sort it
-        std::vector<double> m_AIC_sorted = m_AIC;
-        std::sort(m_AIC_sorted.begin(),m_AIC_sorted.end());
-        // Next, find the position of the top NumRuns_trimmed fitness values
+        // Find the positions of the top NumRuns_trimmed (i.e., lowest) AIC values. Only
+        // those are selected and ordered, and runs with equal AIC values are kept in run order.
         std::vector<int> positionOfTopNRuns;
-
-        int run=0;
-        double fitnessValueToFind;
-        while (run < NumRuns_trimmed) {
-            // Find index of m_AIC_sorted in m_AIC
-            fitnessValueToFind = m_AIC_sorted[run];
-std::cout << "==>top n value: " << fitnessValueToFind << std::endl;
-            std::vector<double>::iterator iter = std::find(m_AIC.begin(), m_AIC.end(), fitnessValueToFind);
-            if (iter != m_AIC.end())
-                // Get index of element from iterator
-                positionOfTopNRuns.push_back(std::distance(m_AIC.begin(),iter));
-            else {
-                std::cout << "Error createTrimmedStructures: Item not found" << std::endl;
-                return false;
-            }
-            ++run;
+        nmfUtils::partialSortIndices(m_AIC,NumRuns_trimmed,positionOfTopNRuns);
+        if (positionOfTopNRuns.empty()) {
+            std::cout << "Error createTrimmedStructures: No runs found" << std::endl;
+            return false;
         }
 
         // Now copy the appropriate
@@ -9,6 +9,8 @@
  */
 #pragma once
 
+#include <algorithm>
+#include <cmath>
 #include <iostream>
 #include <ctime>
 #include <stdio.h>
@@ -18,10 +20,72 @@
 #include <QString>
 
 #include "nmfUtils.h"
+#include "nmfUtilsStatistics.h"
 
 #include <boost/numeric/ublas/matrix.hpp>
 
 
+/**
+ * @brief Streaming mean and variance accumulator for a fixed length set of values
+ * (one set per run). Keeps both unweighted (Welford) moments and AIC weighted
+ * (West) moments. The AIC weights, exp(-AIC/2), are kept relative to the largest
+ * weight seen so far (log-sum-exp form) so they never overflow or underflow and
+ * each run can be merged as soon as it completes.
+ */
+class nmfUtilsRunningMoments {
+
+private:
+    int                 m_Count;
+    double              m_MaxLogWeight;
+    double              m_SumWeights;
+    std::vector<double> m_Mean;
+    std::vector<double> m_M2;
+    std::vector<double> m_WeightedMean;
+    std::vector<double> m_WeightedM2;
+
+public:
+    nmfUtilsRunningMoments();
+   ~nmfUtilsRunningMoments() {}
+
+    /**
+     * @brief Merges a run's values into the running moments
+     * @param values : flattened values for the run (must be the same length for every run)
+     * @param aic : the run's AIC value used to weight the run
+     */
+    void add(const std::vector<double>& values,
+             const double& aic);
+    /**
+     * @brief Clears all accumulated moments
+     */
+    void clear();
+    /**
+     * @brief Returns the number of runs merged so far
+     * @return Number of runs
+     */
+    int count() const;
+    /**
+     * @brief Returns the unweighted mean of every value
+     * @return Vector of means
+     */
+    const std::vector<double>& mean() const;
+    /**
+     * @brief Returns the AIC weighted mean of every value
+     * @return Vector of weighted means
+     */
+    const std::vector<double>& weightedMean() const;
+    /**
+     * @brief Returns the unweighted (population) variance of every value
+     * @param variance : vector of variances
+     */
+    void variance(std::vector<double>& variance) const;
+    /**
+     * @brief Returns the AIC weighted variance of every value
+     * @param variance : vector of weighted variances
+     */
+    void weightedVariance(std::vector<double>& variance) const;
+};
+
+
 class nmfUtilsStatisticsAveraging {
 
 private:
@@ -68,8 +132,38 @@ private:
     std::vector< boost::numeric::ublas::matrix<double> > m_EstPredationHandling_trimmed;
     std::vector< boost::numeric::ublas::matrix<double> > m_EstBiomass_trimmed;
 
+    // Streaming mode data. Rather than storing every run, each run is flattened and
+    // merged into running moments (or, when trimming to the top N runs, held in a
+    // buffer of at most N runs).
+    bool   m_IsStreaming;
+    int    m_StreamNumberOfTopRunsToUse;
+    bool   m_StreamIsPercent;
+    int    m_StreamTotalNumberOfRuns;
+    int    m_StreamMaxRunsHeld;
+    int    m_StreamNumRuns;
+    std::vector<int> m_StreamVectorSizes;
+    std::vector<std::pair<int,int> > m_StreamMatrixShapes;
+    nmfUtilsRunningMoments m_StreamMoments;
+    nmfQuantileSketch m_StreamAICSketch;
+    double m_StreamAICQuantile;
+    std::vector<std::pair<double,std::vector<double> > > m_StreamTopRuns; // max heap on AIC
+    std::vector<double> m_StreamVariance;
+    std::vector<std::pair<double,int> > m_StreamBestFitness; // max heap on fitness of (fitness,run)
+    nmfQuantileSketch m_StreamFitnessMedian;
+    double m_StreamFitnessSum;
+    double m_StreamFitnessMin;
+    double m_StreamFitnessMax;
+
     std::map<QString, void(nmfUtilsStatisticsAveraging::*)()> m_FunctionMap;
     void calculateWeighted(const std::vector<double>& weights);
+    void calculateStreamingAverage(const QString& averagingAlgorithm);
+    void flattenEstData(std::vector<double>& flat,
+                        const std::vector<const std::vector<double>* >& vectors,
+                        const std::vector<const boost::numeric::ublas::matrix<double>* >& matrices);
+    void unflattenEstData(const std::vector<double>& flat,
+                          const std::vector<std::vector<double>* >& vectors,
+                          const std::vector<boost::numeric::ublas::matrix<double>* >& matrices);
+    int  getStreamNumberOfTopRuns();
     bool createTrimmedStructures(const int& numberOfTopRunsToUse,
                                  const bool& isPercent);
     void clearAveragedData();
@@ -98,6 +192,57 @@ public:
     void calculateAverage(const int& numberOfTopRunsToUse,
                           const bool& isPercent,
                           const QString& averagingAlgorithm);
+    /**
+     * @brief Switches the class into streaming mode. In streaming mode each run passed to
+     * loadEstData is merged into running means and variances instead of being stored, so
+     * memory doesn't grow with the number of runs. Since runs are merged as they complete,
+     * the trimming options must be known up front. If trimming to the top N runs, only those
+     * N runs are held. If trimming to a percent of a known total number of runs and that
+     * percent is at most maxRunsHeld runs, only those runs are held. Otherwise a constant
+     * memory AIC percentile sketch is used as the admission threshold, which gives an
+     * approximate trimmed average.
+     *
+     * The run fitness values aren't stored either: getAveData returns the best maxRunsHeld
+     * of them and getStreamFitnessSummary returns their count, mean, min, median, and max.
+     * @param numberOfTopRunsToUse : number (or percent) of the top runs to use; 100 uses all runs
+     * @param isPercent : true if numberOfTopRunsToUse is a percent
+     * @param totalNumberOfRuns : total number of runs expected, or 0 if not known
+     * @param maxRunsHeld : most runs held for an exact percent trim, and most fitness values kept
+     */
+    void setStreaming(const int& numberOfTopRunsToUse,
+                      const bool& isPercent,
+                      const int& totalNumberOfRuns,
+                      const int& maxRunsHeld=1000);
+    /**
+     * @brief Returns the fitness statistics of every run loaded in streaming mode
+     * @param NumRuns : number of runs loaded
+     * @param Mean : mean fitness
+     * @param Min : lowest (best) fitness
+     * @param Median : approximate median fitness (from a quantile sketch)
+     * @param Max : highest fitness
+     */
+    void getStreamFitnessSummary(int& NumRuns,
+                                 double& Mean,
+                                 double& Min,
+                                 double& Median,
+                                 double& Max) const;
+    /**
+     * @brief Returns the variance of each estimated parameter and biomass cell over the
+     * runs used in the last streaming average; the arguments mirror those of getAveData.
+     */
+    void getVarianceData(std::vector<double>& VarInitBiomass,
+                         std::vector<double>& VarGrowthRates,
+                         std::vector<double>& VarCarryingCapacities,
+                         std::vector<double>& VarExponent,
+                         std::vector<double>& VarCatchability,
+                         std::vector<double>& VarSurveyQ,
+                         boost::numeric::ublas::matrix<double>& VarCompetitionAlpha,
+                         boost::numeric::ublas::matrix<double>& VarCompetitionBetaSpecies,
+                         boost::numeric::ublas::matrix<double>& VarCompetitionBetaGuilds,
+                         boost::numeric::ublas::matrix<double>& VarCompetitionBetaGuildsGuilds,
+                         boost::numeric::ublas::matrix<double>& VarPredationRho,
+                         boost::numeric::ublas::matrix<double>& VarPredationHandling,
+                         boost::numeric::ublas::matrix<double>& VarBiomass);
     void calculateUnweighted();
     void calculateAICWeighted();
     void getAveData(std::vector<double>& Fitness,
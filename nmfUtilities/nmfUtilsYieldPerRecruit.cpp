@@ -0,0 +1,413 @@
+
+#include "nmfUtilsYieldPerRecruit.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace {
+
+// Fraction of a cohort that dies during the year per unit of total mortality,
+// (1-exp(-Z))/Z, which goes to 1 as Z goes to 0
+inline double deathFraction(const double& Z)
+{
+    return (Z > 0) ? -std::expm1(-Z)/Z : 1.0;
+}
+
+// Derivative of the death fraction with respect to Z
+inline double deathFractionDerivative(const double& Z,
+                                      const double& survival,
+                                      const double& fraction)
+{
+    if (Z < 1e-4) {
+        return -0.5 + Z/3.0 - Z*Z/8.0;
+    }
+    return (survival - fraction)/Z;
+}
+
+}
+
+constexpr double nmfYieldPerRecruit::MaxFMax;
+constexpr double nmfYieldPerRecruit::MaxF;
+constexpr double nmfYieldPerRecruit::ScanStep;
+constexpr double nmfYieldPerRecruit::Tolerance;
+constexpr double nmfYieldPerRecruit::NoReference;
+
+nmfYieldPerRecruit::nmfYieldPerRecruit(
+        const boost::numeric::ublas::vector<double>& WeightAtAge,
+        const boost::numeric::ublas::vector<double>& Selectivity,
+        const boost::numeric::ublas::vector<double>& M2atAge,
+        const boost::numeric::ublas::vector<double>& M1atAge,
+        const boost::numeric::ublas::vector<double>& Maturity,
+        const int& NumAges)
+{
+    bool hasMaturity = (int(Maturity.size()) >= NumAges);
+
+    m_NumAges = NumAges;
+    m_HasFMax = false;
+    m_HasF01  = false;
+    m_FMax    = NoReference;
+    m_F01     = NoReference;
+    m_Weight.resize(NumAges);
+    m_Selectivity.resize(NumAges);
+    m_NaturalMortality.resize(NumAges);
+    m_Maturity.assign(NumAges,0.0);
+    for (int age = 0; age < NumAges; ++age) {
+        m_Weight[age]           = WeightAtAge(age);
+        m_Selectivity[age]      = Selectivity(age);
+        m_NaturalMortality[age] = M1atAge(age) + std::max(M2atAge(age),0.0);
+        if (hasMaturity) {
+            m_Maturity[age] = Maturity(age);
+        }
+    }
+}
+
+double
+nmfYieldPerRecruit::yieldPerRecruit(const double& F) const
+{
+    std::vector<double> YPR;
+
+    yieldPerRecruit(std::vector<double>(1,F),YPR);
+
+    return YPR[0];
+}
+
+void
+nmfYieldPerRecruit::yieldPerRecruit(const std::vector<double>& F,
+                                    std::vector<double>& YPR) const
+{
+    int NumF = F.size();
+    double Z;
+    double selectivity;
+    double mortality;
+    double weight;
+    std::vector<double> alive(NumF,1.0);
+
+    // Ages are the outer loop so each age's terms are applied across the whole F grid
+    YPR.assign(NumF,0.0);
+    for (int age = 0; age < m_NumAges; ++age) {
+        selectivity = m_Selectivity[age];
+        mortality   = m_NaturalMortality[age];
+        weight      = m_Weight[age];
+        for (int k = 0; k < NumF; ++k) {
+            Z = selectivity*F[k] + mortality;
+            YPR[k]   += alive[k] * selectivity*F[k] * deathFraction(Z) * weight;
+            alive[k] *= std::exp(-Z);
+        }
+    }
+}
+
+double
+nmfYieldPerRecruit::spawningBiomassPerRecruit(const double& F) const
+{
+    std::vector<double> SSB;
+
+    spawningBiomassPerRecruit(std::vector<double>(1,F),SSB);
+
+    return SSB[0];
+}
+
+void
+nmfYieldPerRecruit::spawningBiomassPerRecruit(const std::vector<double>& F,
+                                              std::vector<double>& SSB) const
+{
+    int NumF = F.size();
+    double selectivity;
+    double mortality;
+    double matureWeight;
+    std::vector<double> alive(NumF,1.0);
+
+    SSB.assign(NumF,0.0);
+    for (int age = 0; age < m_NumAges; ++age) {
+        selectivity  = m_Selectivity[age];
+        mortality    = m_NaturalMortality[age];
+        matureWeight = m_Weight[age] * m_Maturity[age];
+        for (int k = 0; k < NumF; ++k) {
+            alive[k] *= std::exp(-(selectivity*F[k] + mortality));
+            SSB[k]   += alive[k] * matureWeight;
+        }
+    }
+}
+
+void
+nmfYieldPerRecruit::derivatives(const double& F,
+                                double& dYPR,
+                                double& dSSB) const
+{
+    double Z;
+    double survival;
+    double fraction;
+    double selectivity;
+    double alive = 1.0;
+    double cumSelectivity = 0.0; // derivative of -log(alive) with respect to F
+
+    dYPR = 0.0;
+    dSSB = 0.0;
+    for (int age = 0; age < m_NumAges; ++age) {
+        selectivity = m_Selectivity[age];
+        Z = selectivity*F + m_NaturalMortality[age];
+        survival = std::exp(-Z);
+        fraction = deathFraction(Z);
+        dYPR += m_Weight[age] * alive *
+               (selectivity*fraction - cumSelectivity*selectivity*F*fraction +
+                selectivity*F*selectivity*deathFractionDerivative(Z,survival,fraction));
+        alive *= survival;
+        cumSelectivity += selectivity;
+        dSSB -= m_Weight[age] * m_Maturity[age] * alive * cumSelectivity;
+    }
+}
+
+double
+nmfYieldPerRecruit::slope(const double& F) const
+{
+    double dYPR;
+    double dSSB;
+
+    derivatives(F,dYPR,dSSB);
+
+    return dYPR;
+}
+
+double
+nmfYieldPerRecruit::solveSlope(const double& target,
+                               const double& maxF) const
+{
+    const int MaxIter = 100;
+    double a = 0.0;
+    double b = 0.0;
+    double c;
+    double d = 0.0;
+    double e = 0.0;
+    double fa = slope(0.0) - target;
+    double fb = fa;
+    double fc;
+    double p;
+    double q;
+    double r;
+    double s;
+    double tol;
+    double xm;
+    double min1;
+    double min2;
+
+    if (fa <= 0) {
+        return NoReference;
+    }
+
+    // Bracket the first F where the slope drops to the target on a coarse grid
+    while (fb > 0) {
+        if (b >= maxF) {
+            return NoReference;
+        }
+        a  = b;
+        fa = fb;
+        b  = std::min(b+ScanStep,maxF);
+        fb = slope(b) - target;
+    }
+
+    // Brent's method on [a,b]
+    c  = b;
+    fc = fb;
+    for (int iter = 0; iter < MaxIter; ++iter) {
+        if ((fb > 0 && fc > 0) || (fb < 0 && fc < 0)) {
+            c  = a;
+            fc = fa;
+            e  = d = b-a;
+        }
+        if (std::fabs(fc) < std::fabs(fb)) {
+            a  = b;
+            b  = c;
+            c  = a;
+            fa = fb;
+            fb = fc;
+            fc = fa;
+        }
+        tol = 2.0*std::numeric_limits<double>::epsilon()*std::fabs(b) + 0.5*Tolerance;
+        xm  = 0.5*(c-b);
+        if ((std::fabs(xm) <= tol) || (fb == 0)) {
+            return b;
+        }
+        if ((std::fabs(e) >= tol) && (std::fabs(fa) > std::fabs(fb))) {
+            s = fb/fa;
+            if (a == c) {
+                p = 2.0*xm*s;
+                q = 1.0-s;
+            } else {
+                q = fa/fc;
+                r = fb/fc;
+                p = s*(2.0*xm*q*(q-r) - (b-a)*(r-1.0));
+                q = (q-1.0)*(r-1.0)*(s-1.0);
+            }
+            if (p > 0) {
+                q = -q;
+            }
+            p = std::fabs(p);
+            min1 = 3.0*xm*q - std::fabs(tol*q);
+            min2 = std::fabs(e*q);
+            if (2.0*p < std::min(min1,min2)) {
+                e = d;
+                d = p/q;
+            } else {
+                d = xm;
+                e = d;
+            }
+        } else {
+            d = xm;
+            e = d;
+        }
+        a  = b;
+        fa = fb;
+        b += (std::fabs(d) > tol) ? d : ((xm > 0) ? tol : -tol);
+        fb = slope(b) - target;
+    }
+
+    return b;
+}
+
+double
+nmfYieldPerRecruit::FMax()
+{
+    double FMax;
+
+    {
+        std::lock_guard<std::mutex> lock(m_Mutex);
+        if (m_HasFMax) {
+            return m_FMax;
+        }
+    }
+
+    // Two threads may both solve for it, but they get the same value
+    FMax = solveSlope(0.0,MaxFMax);
+
+    std::lock_guard<std::mutex> lock(m_Mutex);
+    m_FMax    = FMax;
+    m_HasFMax = true;
+
+    return FMax;
+}
+
+double
+nmfYieldPerRecruit::F01()
+{
+    double F01;
+
+    {
+        std::lock_guard<std::mutex> lock(m_Mutex);
+        if (m_HasF01) {
+            return m_F01;
+        }
+    }
+
+    F01 = solveSlope(0.1*slope(0.0),MaxF);
+
+    std::lock_guard<std::mutex> lock(m_Mutex);
+    m_F01    = F01;
+    m_HasF01 = true;
+
+    return F01;
+}
+
+double
+nmfYieldPerRecruit::FAtSpawningRatio(const double& Fraction)
+{
+    const int MaxIter = 100;
+    double low  = 0.0;
+    double high = 1.0;
+    double F;
+    double nextF;
+    double value;
+    double dYPR;
+    double dSSB;
+    double target;
+
+    {
+        std::lock_guard<std::mutex> lock(m_Mutex);
+        std::map<double,double>::const_iterator cached = m_FAtSpawningRatio.find(Fraction);
+        if (cached != m_FAtSpawningRatio.end()) {
+            return cached->second;
+        }
+    }
+
+    target = Fraction * spawningBiomassPerRecruit(0.0);
+    F = NoReference;
+    if ((target > 0) && (Fraction < 1)) {
+
+        // SSB/R decreases with F, so double the upper bound until it's bracketed
+        while ((spawningBiomassPerRecruit(high) > target) && (high < MaxF)) {
+            low  = high;
+            high = std::min(2.0*high,MaxF);
+        }
+        if (spawningBiomassPerRecruit(high) <= target) {
+
+            // Newton steps on the analytic derivative, falling back to
+            // bisection whenever a step would leave the bracket
+            F = 0.5*(low+high);
+            for (int iter = 0; iter < MaxIter; ++iter) {
+                value = spawningBiomassPerRecruit(F) - target;
+                if (value > 0) {
+                    low  = F;
+                } else {
+                    high = F;
+                }
+                derivatives(F,dYPR,dSSB);
+                nextF = (dSSB < 0) ? F - value/dSSB : 0.5*(low+high);
+                if ((nextF <= low) || (nextF >= high)) {
+                    nextF = 0.5*(low+high);
+                }
+                if ((std::fabs(nextF-F) <= Tolerance) || (high-low <= Tolerance)) {
+                    F = nextF;
+                    break;
+                }
+                F = nextF;
+            }
+        }
+    }
+    std::lock_guard<std::mutex> lock(m_Mutex);
+    m_FAtSpawningRatio[Fraction] = F;
+
+    return F;
+}
+
+std::shared_ptr<nmfYieldPerRecruit>
+nmfYieldPerRecruitCache::get(
+        const boost::numeric::ublas::vector<double>& WeightAtAge,
+        const boost::numeric::ublas::vector<double>& Selectivity,
+        const boost::numeric::ublas::vector<double>& M2atAge,
+        const boost::numeric::ublas::vector<double>& M1atAge,
+        const boost::numeric::ublas::vector<double>& Maturity,
+        const int& NumAges)
+{
+    bool hasMaturity = (int(Maturity.size()) >= NumAges);
+    std::vector<double> key;
+    std::shared_ptr<nmfYieldPerRecruit> engine;
+
+    key.reserve(5*NumAges+1);
+    key.push_back(NumAges);
+    for (int age = 0; age < NumAges; ++age) {
+        key.push_back(WeightAtAge(age));
+        key.push_back(Selectivity(age));
+        key.push_back(M2atAge(age));
+        key.push_back(M1atAge(age));
+        key.push_back(hasMaturity ? Maturity(age) : 0.0);
+    }
+
+    std::lock_guard<std::mutex> lock(m_Mutex);
+    std::map<std::vector<double>,std::shared_ptr<nmfYieldPerRecruit> >::iterator it = m_Cache.find(key);
+    if (it != m_Cache.end()) {
+        return it->second;
+    }
+    if (m_Cache.size() >= m_MaxEntries) {
+        m_Cache.clear();
+    }
+    engine = std::make_shared<nmfYieldPerRecruit>(WeightAtAge,Selectivity,M2atAge,M1atAge,Maturity,NumAges);
+    m_Cache[key] = engine;
+
+    return engine;
+}
+
+void
+nmfYieldPerRecruitCache::clear()
+{
+    std::lock_guard<std::mutex> lock(m_Mutex);
+    m_Cache.clear();
+}
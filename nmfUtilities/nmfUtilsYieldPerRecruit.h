@@ -0,0 +1,160 @@
+/**
+ * @file nmfUtilsYieldPerRecruit.h
+ * @brief This header file defines the yield and spawning biomass per recruit engine
+ * used for the YPR curves and the F reference points.
+ */
+
+#pragma once
+
+#include <map>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include <boost/numeric/ublas/vector.hpp>
+
+/**
+ * @brief Yield per recruit (YPR) and spawning stock biomass per recruit (SSB/R) for one
+ * species and year. The per age terms that don't depend upon the fully recruited F are
+ * found once, so a whole F grid is evaluated as an age by F array in a single pass, and
+ * the analytic derivatives with respect to F are available for the reference points.
+ * Fmax and F0.1 are the roots of the YPR slope (found with Brent's method) and the
+ * F at a fraction of the unfished SSB/R is found with a safeguarded Newton iteration.
+ * The reference points are computed on first use and then kept. They're computed outside
+ * of the lock and published under it, so an engine may be shared between threads.
+ */
+class nmfYieldPerRecruit {
+
+private:
+    int m_NumAges;
+    std::vector<double> m_Weight;
+    std::vector<double> m_Selectivity;      // partial recruitment, multiplies the fully recruited F
+    std::vector<double> m_NaturalMortality; // M1 + M2 (negative M2 treated as 0)
+    std::vector<double> m_Maturity;         // may be all 0 if SSB/R isn't needed
+    std::mutex m_Mutex; // guards the reference points below, as engines are shared through the cache
+    bool   m_HasFMax;
+    bool   m_HasF01;
+    double m_FMax;
+    double m_F01;
+    std::map<double,double> m_FAtSpawningRatio;
+
+    double slope(const double& F) const;
+    double solveSlope(const double& target,
+                      const double& maxF) const;
+
+public:
+    static constexpr double MaxFMax     = 4.0;  // Fmax is undefined if the YPR still rises at this F
+    static constexpr double MaxF        = 10.0; // largest F searched for the other reference points
+    static constexpr double ScanStep    = 0.05; // coarse step used to bracket the first root
+    static constexpr double Tolerance   = 1e-10;
+    static constexpr double NoReference = -9;   // returned if a reference point doesn't exist
+
+    /**
+     * @brief Stores the per age inputs for one species and year
+     * @param WeightAtAge : weight at age
+     * @param Selectivity : partial recruitment at age (i.e., F at age / fully recruited F)
+     * @param M2atAge : predation mortality at age (negative values are treated as 0)
+     * @param M1atAge : residual natural mortality at age
+     * @param Maturity : proportion mature at age (may be empty if SSB/R isn't needed)
+     * @param NumAges : number of ages to use
+     */
+    nmfYieldPerRecruit(const boost::numeric::ublas::vector<double>& WeightAtAge,
+                       const boost::numeric::ublas::vector<double>& Selectivity,
+                       const boost::numeric::ublas::vector<double>& M2atAge,
+                       const boost::numeric::ublas::vector<double>& M1atAge,
+                       const boost::numeric::ublas::vector<double>& Maturity,
+                       const int& NumAges);
+   ~nmfYieldPerRecruit() {}
+
+    /**
+     * @brief Yield per recruit at a fully recruited F
+     * @param F : fully recruited fishing mortality
+     * @return Yield per recruit
+     */
+    double yieldPerRecruit(const double& F) const;
+    /**
+     * @brief Yield per recruit over a grid of fully recruited F values
+     * @param F : fully recruited fishing mortalities
+     * @param YPR : yield per recruit at each F (resized to the size of F)
+     */
+    void yieldPerRecruit(const std::vector<double>& F,
+                         std::vector<double>& YPR) const;
+    /**
+     * @brief Spawning stock biomass per recruit at a fully recruited F
+     * @param F : fully recruited fishing mortality
+     * @return Spawning stock biomass per recruit
+     */
+    double spawningBiomassPerRecruit(const double& F) const;
+    /**
+     * @brief Spawning stock biomass per recruit over a grid of fully recruited F values
+     * @param F : fully recruited fishing mortalities
+     * @param SSB : spawning stock biomass per recruit at each F (resized to the size of F)
+     */
+    void spawningBiomassPerRecruit(const std::vector<double>& F,
+                                   std::vector<double>& SSB) const;
+    /**
+     * @brief Analytic derivatives of the yield and spawning biomass per recruit with respect to F
+     * @param F : fully recruited fishing mortality
+     * @param dYPR : derivative of the yield per recruit
+     * @param dSSB : derivative of the spawning stock biomass per recruit
+     */
+    void derivatives(const double& F,
+                     double& dYPR,
+                     double& dSSB) const;
+    /**
+     * @brief F giving the maximum yield per recruit
+     * @return Fmax, or NoReference if the YPR still increases at MaxFMax
+     */
+    double FMax();
+    /**
+     * @brief F where the YPR slope is 10% of its slope at the origin
+     * @return F0.1, or NoReference if not found below MaxF
+     */
+    double F01();
+    /**
+     * @brief F giving a fraction of the unfished spawning stock biomass per recruit (e.g., 0.1
+     * for F at 10% of max SSB/R, or the %SPR target)
+     * @param Fraction : fraction of the unfished SSB/R
+     * @return F at the fraction, or NoReference if not found below MaxF
+     */
+    double FAtSpawningRatio(const double& Fraction);
+};
+
+/**
+ * @brief Keeps the yield per recruit engines that have been built so that redrawing a
+ * chart for the same species, years, and selectivity doesn't recompute the reference
+ * points. Engines are keyed by their inputs, so a change to any input gives a new entry.
+ */
+class nmfYieldPerRecruitCache {
+
+private:
+    std::size_t m_MaxEntries;
+    std::mutex  m_Mutex;
+    std::map<std::vector<double>,std::shared_ptr<nmfYieldPerRecruit> > m_Cache;
+
+public:
+    nmfYieldPerRecruitCache(const std::size_t& MaxEntries=512) : m_MaxEntries(MaxEntries) {}
+   ~nmfYieldPerRecruitCache() {}
+
+    /**
+     * @brief Returns the engine for the given inputs, building it if it isn't cached
+     * @param WeightAtAge : weight at age
+     * @param Selectivity : partial recruitment at age
+     * @param M2atAge : predation mortality at age
+     * @param M1atAge : residual natural mortality at age
+     * @param Maturity : proportion mature at age (may be empty)
+     * @param NumAges : number of ages to use
+     * @return Shared engine for the inputs
+     */
+    std::shared_ptr<nmfYieldPerRecruit> get(
+            const boost::numeric::ublas::vector<double>& WeightAtAge,
+            const boost::numeric::ublas::vector<double>& Selectivity,
+            const boost::numeric::ublas::vector<double>& M2atAge,
+            const boost::numeric::ublas::vector<double>& M1atAge,
+            const boost::numeric::ublas::vector<double>& Maturity,
+            const int& NumAges);
+    /**
+     * @brief Removes all cached engines
+     */
+    void clear();
+};
@@ -0,0 +1,236 @@
+#include "nmfWorkStealingPool.h"
+
+#include <algorithm>
+
+// The pool and queue of the thread running this code, and how many tasks deep it is
+static thread_local const nmfWorkStealingPool* t_Pool  = nullptr;
+static thread_local int                        t_Index = -1;
+static thread_local int                        t_Depth = 0;
+
+nmfWorkStealingPool::nmfWorkStealingPool(const int& NumThreads)
+{
+    m_NumThreads = (NumThreads > 0) ? NumThreads : int(std::thread::hardware_concurrency());
+    m_NumThreads = std::max(1,m_NumThreads);
+    m_Stop       = false;
+    m_NumSpawned   = 0;
+    m_NumSubmitted = 0;
+
+    // Queue 0 belongs to whichever thread waits on the pool
+    for (int i = 0; i < m_NumThreads; ++i) {
+        m_Queues.push_back(std::unique_ptr<WorkerQueue>(new WorkerQueue()));
+    }
+    for (int i = 1; i < m_NumThreads; ++i) {
+        m_Threads.push_back(std::thread(&nmfWorkStealingPool::worker,this,i));
+    }
+}
+
+nmfWorkStealingPool::~nmfWorkStealingPool()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_Mutex);
+        m_Stop = true;
+    }
+    m_Condition.notify_all();
+    for (std::thread& thread : m_Threads) {
+        thread.join();
+    }
+}
+
+int
+nmfWorkStealingPool::numThreads() const
+{
+    return m_NumThreads;
+}
+
+int
+nmfWorkStealingPool::workerIndex() const
+{
+    return (t_Pool == this) ? t_Index : -1;
+}
+
+void
+nmfWorkStealingPool::submit(std::function<void()> Run,
+                            const double& Cost,
+                            nmfTaskGroup& Group)
+{
+    ++Group.NumPending;
+    {
+        std::lock_guard<std::mutex> lock(m_Mutex);
+        m_Submitted.insert(std::make_pair(Cost,Task{Run,&Group}));
+        ++m_NumSubmitted;
+    }
+    // Threads waiting on their own sub-tasks don't take top level tasks, so all are woken
+    m_Condition.notify_all();
+}
+
+void
+nmfWorkStealingPool::spawn(std::function<void()> Run,
+                           nmfTaskGroup& Group)
+{
+    int Index = workerIndex();
+
+    if (Index < 0) {
+        submit(Run,0,Group);
+        return;
+    }
+
+    ++Group.NumPending;
+    {
+        std::lock_guard<std::mutex> lock(m_Queues[Index]->Mutex);
+        m_Queues[Index]->Tasks.push_back(Task{Run,&Group});
+    }
+    {
+        std::lock_guard<std::mutex> lock(m_Mutex);
+        ++m_NumSpawned;
+    }
+    m_Condition.notify_one();
+}
+
+bool
+nmfWorkStealingPool::pop(const int& Index,
+                         const bool& AllowSubmitted,
+                         Task& task)
+{
+    int victim;
+
+    // Own sub-tasks newest first, since they're the ones most likely still in cache
+    if (Index >= 0) {
+        std::lock_guard<std::mutex> lock(m_Queues[Index]->Mutex);
+        std::deque<Task>& Tasks = m_Queues[Index]->Tasks;
+        if (! Tasks.empty()) {
+            task = Tasks.back();
+            Tasks.pop_back();
+            --m_NumSpawned;
+            return true;
+        }
+    }
+
+    // Then steal the oldest sub-task of another thread
+    for (int i = 1; i <= m_NumThreads; ++i) {
+        victim = (std::max(Index,0) + i) % m_NumThreads;
+        if (victim == Index) {
+            continue;
+        }
+        std::lock_guard<std::mutex> lock(m_Queues[victim]->Mutex);
+        std::deque<Task>& Tasks = m_Queues[victim]->Tasks;
+        if (! Tasks.empty()) {
+            task = Tasks.front();
+            Tasks.pop_front();
+            --m_NumSpawned;
+            return true;
+        }
+    }
+
+    // Only then start a new top level task, the costliest one left
+    if (AllowSubmitted) {
+        std::lock_guard<std::mutex> lock(m_Mutex);
+        if (! m_Submitted.empty()) {
+            task = m_Submitted.begin()->second;
+            m_Submitted.erase(m_Submitted.begin());
+            --m_NumSubmitted;
+            return true;
+        }
+    }
+
+    return false;
+}
+
+void
+nmfWorkStealingPool::execute(Task& task)
+{
+    nmfTaskGroup* Group = task.Group;
+
+    ++t_Depth;
+    task.Run();
+    --t_Depth;
+    task.Run = nullptr;
+
+    // The group may be gone as soon as its count reaches zero, so it isn't touched again
+    if (--Group->NumPending == 0) {
+        std::lock_guard<std::mutex> lock(m_Mutex);
+        m_Condition.notify_all();
+    }
+}
+
+void
+nmfWorkStealingPool::worker(const int Index)
+{
+    Task task;
+
+    t_Pool  = this;
+    t_Index = Index;
+    while (true) {
+        if (pop(Index,true,task)) {
+            execute(task);
+            continue;
+        }
+        std::unique_lock<std::mutex> lock(m_Mutex);
+        m_Condition.wait(lock,[&]() {
+            return m_Stop || (m_NumSpawned > 0) || (m_NumSubmitted > 0);
+        });
+        if (m_Stop) {
+            return;
+        }
+    }
+}
+
+void
+nmfWorkStealingPool::wait(nmfTaskGroup& Group)
+{
+    Task task;
+    bool isExternal = (t_Pool != this);
+    const nmfWorkStealingPool* PreviousPool = t_Pool;
+    int PreviousIndex = t_Index;
+
+    if (isExternal) {
+        t_Pool  = this;
+        t_Index = 0;
+    }
+
+    // A task waiting for its own sub-tasks only helps with sub-tasks, as starting
+    // another top level task here would hold up the rest of this one
+    bool AllowSubmitted = (t_Depth == 0);
+    while (Group.NumPending > 0) {
+        if (pop(t_Index,AllowSubmitted,task)) {
+            execute(task);
+            continue;
+        }
+        std::unique_lock<std::mutex> lock(m_Mutex);
+        m_Condition.wait(lock,[&]() {
+            return (Group.NumPending == 0) || (m_NumSpawned > 0) ||
+                   (AllowSubmitted && (m_NumSubmitted > 0));
+        });
+    }
+
+    if (isExternal) {
+        t_Pool  = PreviousPool;
+        t_Index = PreviousIndex;
+    }
+}
+
+void
+nmfWorkStealingPool::parallelFor(const int& Begin,
+                                 const int& End,
+                                 const int& ChunkSize,
+                                 std::function<void(int,int)> Run)
+{
+    int chunkSize = (ChunkSize > 0) ? ChunkSize :
+                    std::max(1,(End-Begin)/(4*m_NumThreads));
+    nmfTaskGroup Group;
+
+    if (End <= Begin) {
+        return;
+    }
+    if ((m_NumThreads == 1) || (End-Begin <= chunkSize)) {
+        Run(Begin,End);
+        return;
+    }
+
+    // The first chunk is run here, the others are left for this and other threads to pick up
+    for (int first = Begin+chunkSize; first < End; first += chunkSize) {
+        int last = std::min(first+chunkSize,End);
+        spawn([=]() { Run(first,last); },Group);
+    }
+    Run(Begin,std::min(Begin+chunkSize,End));
+    wait(Group);
+}
@@ -0,0 +1,110 @@
+#pragma once
+
+#include <map>
+#include <deque>
+#include <mutex>
+#include <atomic>
+#include <memory>
+#include <thread>
+#include <vector>
+#include <functional>
+#include <condition_variable>
+
+/**
+ * @brief Counts the unfinished tasks of a group so that a thread can wait for all of them
+ */
+class nmfTaskGroup {
+public:
+    std::atomic<int> NumPending;
+    nmfTaskGroup() : NumPending(0) {}
+};
+
+/**
+ * @brief A pool of threads that share tasks of very different costs.
+ *
+ * Top level tasks are submitted with an estimated cost and are started most costly first,
+ * so the short tasks fill in around the long ones at the end of a batch instead of the other
+ * way around. A running task can split its work into sub-tasks (e.g., repetitions or chunks
+ * of a population) with spawn() or parallelFor(). These go on the running thread's own queue,
+ * which the thread works through newest first while idle threads steal the oldest (and so
+ * usually largest) ones from its other end.
+ *
+ * A thread waiting for a group doesn't block while there's work, it runs other tasks until
+ * the group has finished. The thread that calls wait() from outside the pool works as one of
+ * the pool's threads, so a pool of NumThreads starts NumThreads-1 threads of its own, and only
+ * one outside thread should wait on the pool at a time.
+ */
+class nmfWorkStealingPool {
+
+    struct Task {
+        std::function<void()> Run;
+        nmfTaskGroup* Group;
+    };
+    struct WorkerQueue {
+        std::mutex Mutex;
+        std::deque<Task> Tasks;
+    };
+
+    int m_NumThreads;
+    bool m_Stop;
+    std::atomic<int> m_NumSpawned;         // sub-tasks in the threads' own queues
+    std::atomic<int> m_NumSubmitted;       // top level tasks not yet started
+    std::mutex m_Mutex;                    // guards the submitted queue and the sleeping threads
+    std::condition_variable m_Condition;
+    std::multimap<double,Task,std::greater<double> > m_Submitted; // most costly first, then in submission order
+    std::vector<std::unique_ptr<WorkerQueue> > m_Queues;
+    std::vector<std::thread> m_Threads;
+
+    int  workerIndex() const;
+    bool pop(const int& Index, const bool& AllowSubmitted, Task& task);
+    void execute(Task& task);
+    void worker(const int Index);
+
+public:
+    /**
+     * @brief Starts the pool's threads
+     * @param NumThreads : number of threads including the waiting thread (0 uses one thread per core)
+     */
+    nmfWorkStealingPool(const int& NumThreads);
+   ~nmfWorkStealingPool();
+
+    /**
+     * @brief Number of threads working on the pool's tasks, including the waiting thread
+     * @return The number of threads
+     */
+    int numThreads() const;
+    /**
+     * @brief Queues a top level task
+     * @param Run : the task
+     * @param Cost : estimated cost of the task in any units, the costliest tasks are started first
+     * @param Group : group the task is counted in
+     */
+    void submit(std::function<void()> Run,
+                const double& Cost,
+                nmfTaskGroup& Group);
+    /**
+     * @brief Queues a sub-task on the calling thread's own queue (or as a top level task
+     * if the calling thread isn't one of the pool's)
+     * @param Run : the task
+     * @param Group : group the task is counted in
+     */
+    void spawn(std::function<void()> Run,
+               nmfTaskGroup& Group);
+    /**
+     * @brief Runs queued tasks until every task of the group has finished
+     * @param Group : group to wait for
+     */
+    void wait(nmfTaskGroup& Group);
+    /**
+     * @brief Splits a range into chunks, runs them as sub-tasks, and waits for them
+     * @param Begin : first index
+     * @param End : one past the last index
+     * @param ChunkSize : number of indexes per sub-task (0 splits the range into about
+     * four chunks per thread)
+     * @param Run : called with the first and one past the last index of each chunk
+     */
+    void parallelFor(const int& Begin,
+                     const int& End,
+                     const int& ChunkSize,
+                     std::function<void(int,int)> Run);
+};
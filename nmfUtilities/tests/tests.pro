@@ -0,0 +1,23 @@
+#
+# Checks of the shared utilities. Run with "make check".
+#
+
+QT       = core sql
+
+CONFIG  += c++14 console testcase
+CONFIG  -= app_bundle
+
+TARGET   = tst_nmfUtilities
+TEMPLATE = app
+
+DEFINES += NMF_HEADLESS
+
+INCLUDEPATH += ..
+
+SOURCES += \
+    tst_nmfUtilities.cpp \
+    ../nmfLogger.cpp \
+    ../nmfUtils.cpp \
+    ../nmfUtilsComplex.cpp \
+    ../nmfUtilsQtCore.cpp \
+    ../nmfUtilsStatistics.cpp
@@ -0,0 +1,159 @@
+/**
+ * @file tst_nmfUtilities.cpp
+ * @brief Checks of the shared utilities
+ * @date Oct 19, 2026
+ *
+ * Returns 0 if every check passes, else the number of failed checks.
+ *
+ */
+
+#include <cmath>
+#include <cstring>
+#include <iostream>
+#include <random>
+#include <vector>
+
+#include "nmfUtilsComplex.h"
+#include "nmfUtilsStatistics.h"
+
+static int NumFailed = 0;
+
+static void
+check(const bool& ok, const std::string& what)
+{
+    std::cout << ((ok) ? "PASS   : " : "FAIL!  : ") << what << std::endl;
+    if (! ok) {
+        ++NumFailed;
+    }
+}
+
+static bool
+sameBits(const double& a, const double& b)
+{
+    return (std::memcmp(&a,&b,sizeof(double)) == 0);
+}
+
+// Lanes that converge and lanes that reach the iteration limit must give the scalar values
+static void
+testBetaCFBatchMatchesScalar()
+{
+    std::vector<double> A = {2.0, 1.0e6, 3.5, 4.0e5};
+    std::vector<double> B = {3.0, 1.0e6, 1.5, 6.0e5};
+    std::vector<double> X = {0.4, 0.5,   0.2, 0.4};
+    std::vector<double> values;
+    bool converged;
+    bool same = true;
+
+    converged = nmfUtilsStatistics::BetaCFBatch(A,B,X,values);
+    check(! converged, "BetaCFBatch reports lanes that reach the iteration limit");
+    for (int i=0; i<int(X.size()); ++i) {
+        same = same && sameBits(values[i],nmfUtilsStatistics::BetaCF(A[i],B[i],X[i]));
+    }
+    check(same, "BetaCFBatch matches BetaCF, including lanes at the iteration limit");
+
+    A = {2.0, 3.5};
+    B = {3.0, 1.5};
+    X = {0.4, 0.2};
+    converged = nmfUtilsStatistics::BetaCFBatch(A,B,X,values);
+    check(converged, "BetaCFBatch reports convergence when every lane converges");
+}
+
+static void
+testBetaIBatchMatchesScalar()
+{
+    std::vector<double> A = {2.0, 1.0e6, 0.5, 7.0};
+    std::vector<double> B = {3.0, 1.0e6, 0.5, 2.0};
+    std::vector<double> X = {0.4, 0.5,   0.9, 0.0};
+    std::vector<double> values;
+    bool converged;
+    bool same = true;
+
+    converged = nmfUtilsStatistics::BetaIBatch(A,B,X,values);
+    check(! converged, "BetaIBatch reports a continued fraction that didn't converge");
+    for (int i=0; i<int(X.size()); ++i) {
+        same = same && sameBits(values[i],nmfUtilsStatistics::BetaI(A[i],B[i],X[i]));
+    }
+    check(same, "BetaIBatch matches BetaI");
+}
+
+// Shepherd stock recruitment data (spawners, recruits) with multiplicative noise
+static void
+makeStockRecruitData(const int& NYears,
+                     boost::numeric::ublas::matrix<double>& SRData,
+                     boost::numeric::ublas::vector<double>& G,
+                     boost::numeric::ublas::vector<double>& H)
+{
+    double spawners;
+    std::mt19937_64 rng(7);
+    std::uniform_real_distribution<double> dist(0.0,1.0);
+
+    nmfUtils::initialize(SRData,NYears+1,3);
+    for (int i=0; i<=NYears; ++i) {
+        spawners    = 100.0 + 900.0*dist(rng);
+        SRData(i,0) = spawners;
+        SRData(i,1) = 5.0*spawners/(1.0+spawners/400.0) * (0.8+0.4*dist(rng));
+    }
+    nmfUtils::initialize(G,4);
+    nmfUtils::initialize(H,4);
+    G(1) = 0.1; H(1) = 50.0;
+    G(2) = 1.0; H(2) = 2000.0;
+    G(3) = 0.1; H(3) = 5.0;
+}
+
+// A multi-start run's starts must be single Complex runs (Cons) from their own seeded
+// random numbers, and the best fit mustn't depend upon the number of threads
+static void
+testComplexMultiStart()
+{
+    const int NDim = 3;
+    const int NumStarts = 8;
+    const int Seed = 11;
+    int nDim   = NDim; // Cons takes the dimensions by reference
+    int NYears = 20;
+    int itFlag;
+    double maxF;
+    bool same = true;
+    std::uniform_real_distribution<double> dist(0.0,1.0);
+    boost::numeric::ublas::vector<double> G;
+    boost::numeric::ublas::vector<double> H;
+    boost::numeric::ublas::vector<double> varEst;
+    boost::numeric::ublas::matrix<double> SRData;
+    boost::numeric::ublas::matrix<double> X;
+    boost::numeric::ublas::matrix<double> R;
+    nmfUtilsComplex::ComplexMultiStartOut out1;
+    nmfUtilsComplex::ComplexMultiStartOut out4;
+
+    makeStockRecruitData(NYears,SRData,G,H);
+    nmfUtilsComplex::ComplexMultiStart(NDim,NYears,G,H,SRData,NumStarts,Seed,1,out1);
+    nmfUtilsComplex::ComplexMultiStart(NDim,NYears,G,H,SRData,NumStarts,Seed,4,out4);
+
+    for (int start=0; start<NumStarts; ++start) {
+        same = same && sameBits(out1.StartMaxF[start],out4.StartMaxF[start]);
+    }
+    check(same && (out1.BestStart == out4.BestStart),
+          "ComplexMultiStart gives the same fits on 1 and 4 threads");
+
+    std::mt19937_64 rng(Seed);
+    nmfUtils::initialize(X,NDim+2,NDim+1);
+    nmfUtils::initialize(R,NDim+2,NDim+1);
+    nmfUtils::initialize(varEst,NDim+1);
+    for (int i=1; i<=NDim+1; ++i) {
+        for (int j=1; j<=NDim; ++j) {
+            R(i,j) = dist(rng);
+        }
+    }
+    nmfUtilsComplex::Cons(X,R,nDim,NYears,maxF,SRData,G,H,varEst,itFlag);
+    check(sameBits(maxF,out1.StartMaxF[0]) && (itFlag == out1.StartItFlag[0]),
+          "ComplexMultiStart's first start matches a single Cons run");
+}
+
+int main()
+{
+    testBetaCFBatchMatchesScalar();
+    testBetaIBatchMatchesScalar();
+    testComplexMultiStart();
+
+    std::cout << "Totals: " << NumFailed << " failed" << std::endl;
+
+    return NumFailed;
+}